@@ -1,6 +1,7 @@
 #include "Actor.h"
 #include <vector>
 #include "../Game.h"
+#include "../Commons/SceneGraph.h"
 #include "../Components/Component.h"
 #include "../Components/SpriteComponent.h"
 
@@ -9,11 +10,13 @@ Actor::Actor(Game* game)
 ,mPosition(Math::VEC3_ZERO)
 ,mScale(Math::VEC3_UNIT)
 ,mRotation(Quaternion())
+,mParent(nullptr)
+,mSceneNode(-1)
 ,mGame(game)
-,mRecalculateWorldTransform(true)
 {
     // アクタ追加
     mGame->AddActor(this);
+    mSceneNode = mGame->GetSceneGraph()->AddNode(this);
 }
 
 Actor::~Actor()
@@ -25,6 +28,13 @@ Actor::~Actor()
     {
         delete mComponents.back();
     }
+    // 子は親から外し、ローカル座標をそのままワールド座標とする
+    while (!mChildren.empty())
+    {
+        mChildren.back()->SetParent(nullptr);
+    }
+    SetParent(nullptr);
+    mGame->GetSceneGraph()->RemoveNode(mSceneNode);
 }
 
 // 更新処理
@@ -32,7 +42,6 @@ void Actor::Update(float deltaTime)
 {
     if (mState == EActive)
     {
-        CalculateWouldTransform();
         UpdateComponents(deltaTime);
         UpdateActor(deltaTime);
     }
@@ -53,7 +62,7 @@ void Actor::UpdateActor(float deltaTime)
 }
 
 // キー入力処理
-void Actor::ProcessInput(const uint8_t *state)
+void Actor::ProcessInput(const InputSystem* input)
 {
 }
 
@@ -83,19 +92,79 @@ void Actor::RemoveComponent(Component* component)
     }
 }
 
-// ワールド変換座標計算処理
-void Actor::CalculateWouldTransform()
+// ローカル変換座標計算処理
+// *シーングラフの更新からワーカースレッドで呼ばれる（読み取りのみ）
+Matrix4 Actor::ComputeLocalTransform() const
 {
-    // ワールド変換座標を再計算する
-    if (mRecalculateWorldTransform)
+    // 拡大縮小 -> 回転 -> 平行移動
+    // を逆の順番で乗算する。
+    Matrix4 local = Matrix4::CreateTranslation(mPosition.x, mPosition.y, mPosition.z);
+    local *= Matrix4::CreateQuaternion(mRotation);
+    local *= Matrix4::CreateScale(mScale.x, mScale.y, mScale.z);
+    return local;
+}
+
+void Actor::MarkTransformDirty()
+{
+    mGame->GetSceneGraph()->MarkDirty(mSceneNode);
+}
+
+// 親子関係の設定
+bool Actor::SetParent(Actor* parent)
+{
+    if (parent == mParent) return true;
+    // 循環する親子関係は不可
+    for (Actor* ancestor = parent; ancestor; ancestor = ancestor->mParent)
+    {
+        if (ancestor == this) return false;
+    }
+    if (mParent)
     {
-        // 拡大縮小 -> 回転 -> 平行移動
-        // を逆の順番で乗算する。
-        mRecalculateWorldTransform = false;
-        mWorldTransform = Matrix4::CreateTranslation(mPosition.x, mPosition.y, mPosition.z);
-        mWorldTransform *= Matrix4::CreateQuaternion(mRotation);
-        mWorldTransform *= Matrix4::CreateScale(mScale.x, mScale.y, mScale.z);
+        auto iter = std::find(mParent->mChildren.begin(), mParent->mChildren.end(), this);
+        if (iter != mParent->mChildren.end()) mParent->mChildren.erase(iter);
     }
+    mParent = parent;
+    if (mParent) mParent->mChildren.emplace_back(this);
+    // ノードを並べ直し、ワールド座標を再計算する
+    SceneGraph* sceneGraph = mGame->GetSceneGraph();
+    sceneGraph->MarkStructureDirty();
+    sceneGraph->MarkDirty(mSceneNode);
+    return true;
+}
+
+const Matrix4& Actor::GetWorldTransform() const
+{
+    return mGame->GetSceneGraph()->GetWorldTransform(mSceneNode);
+}
+
+unsigned int Actor::GetTransformVersion() const
+{
+    return mGame->GetSceneGraph()->GetTransformVersion(mSceneNode);
+}
+
+// ワールド変換座標の平行移動成分
+Vector3 Actor::GetWorldPosition() const
+{
+    const Matrix4& world = GetWorldTransform();
+    return Vector3(world.matrix[0][3], world.matrix[1][3], world.matrix[2][3]);
+}
+
+// ワールド変換座標のZ軸（大きさを除く）
+Vector3 Actor::GetWorldForward() const
+{
+    const Matrix4& world = GetWorldTransform();
+    return Vector3::Normalize(Vector3(world.matrix[0][2], world.matrix[1][2], world.matrix[2][2]));
+}
+
+// ワールド変換座標の各軸の長さ
+Vector3 Actor::GetWorldScale() const
+{
+    const Matrix4& world = GetWorldTransform();
+    auto axisLength = [&world](int axis) {
+        return sqrtf(world.matrix[0][axis] * world.matrix[0][axis] + world.matrix[1][axis] * world.matrix[1][axis]
+                     + world.matrix[2][axis] * world.matrix[2][axis]);
+    };
+    return Vector3(axisLength(0), axisLength(1), axisLength(2));
 }
 
 // 前方ベクトルを取得する
@@ -110,17 +179,17 @@ void Actor::SetRotationX(float radian)
 {
     Quaternion q(Math::VEC3_UNIT_X, radian);
     mRotation = Quaternion::Concatenate(mRotation, q);
-    mRecalculateWorldTransform = true;
+    MarkTransformDirty();
 }
 void Actor::SetRotationY(float radian)
 {
     Quaternion q(Math::VEC3_UNIT_Y, radian);
     mRotation = Quaternion::Concatenate(mRotation, q);
-    mRecalculateWorldTransform = true;
+    MarkTransformDirty();
 }
 void Actor::SetRotationZ(float radian)
 {
     Quaternion q(Math::VEC3_UNIT_Z, radian);
     mRotation = Quaternion::Concatenate(mRotation, q);
-    mRecalculateWorldTransform = true;
+    MarkTransformDirty();
 }
@@ -4,6 +4,8 @@
 
 // アクタクラス
 // *各アクタはこのクラスを継承する
+// *位置、回転、大きさは親のアクタからの相対（親が無ければワールド座標）
+//  ワールド変換座標はシーングラフが親子の順に計算する（アクタの更新後にまとめて再計算される）
 class Actor
 {
 public:
@@ -19,26 +21,38 @@ public:
     void Update(float deltaTime);              // 更新処理
     void UpdateComponents(float deltaTime);    // コンポーネント更新処理
     virtual void UpdateActor(float deltaTime); // アクタ更新処理
-    virtual void ProcessInput(const uint8_t *state); // キー入力処理
+    virtual void ProcessInput(const class InputSystem* input); // キー入力処理（購読時のみ呼ばれる）
 
     void AddComponent(class Component* component);    // コンポーネント追加処理
     void RemoveComponent(class Component* component); // コンポーネント削除処理
 
-    void CalculateWouldTransform(); // ワールド座標計算処理
+    Matrix4 ComputeLocalTransform() const; // ローカル変換座標（拡大縮小 -> 回転 -> 平行移動）
 
-    Vector3 GetForward() const; // 前方ベクトルの取得
+    // 親子関係の設定（nullptrで外す、ローカル座標はそのまま親からの相対として扱う）
+    // *自身の子孫は親にできない
+    bool SetParent(Actor* parent);
+
+    Vector3 GetForward() const; // 前方ベクトルの取得（ローカル）
+    Vector3 GetWorldPosition() const; // ワールド座標の位置
+    Vector3 GetWorldForward() const;  // ワールド座標の前方ベクトル
+    Vector3 GetWorldScale() const;    // ワールド座標の大きさ（各軸の長さ）
 
     void SetRotationX(float radian); // X軸の回転処理
     void SetRotationY(float radian); // Y軸の回転処理
     void SetRotationZ(float radian); // Z軸の回転処理
 
 private:
+    friend class SceneGraph; // ノード番号の付け直し
+
+    void MarkTransformDirty(); // ローカル座標の変更をシーングラフに通知
+
     State mState;         // 状態
     Vector3 mPosition;    // 位置
     Vector3 mScale;       // 大きさ
     Quaternion mRotation; // 回転
-    Matrix4 mWorldTransform;         // ワールド変換座標
-    bool mRecalculateWorldTransform; // 再計算フラグ
+    Actor* mParent;                  // 親のアクタ
+    std::vector<Actor*> mChildren;   // 子のアクタ
+    int mSceneNode;                  // シーングラフのノード番号
 
     std::vector<class Component*> mComponents; // 保有するコンポーネント
     class Game* mGame; // ゲームクラス
@@ -50,11 +64,15 @@ public:
     class Game* GetGame() const { return mGame; }
     // 座標の設定は再計算させる
     const Vector3& GetPosition() const { return mPosition; }
-    void SetPosition(const Vector3& pos) { mPosition = pos; mRecalculateWorldTransform = true; }
+    void SetPosition(const Vector3& pos) { mPosition = pos; MarkTransformDirty(); }
     const Vector3& GetScale() const { return mScale; }
-    void SetScale(const Vector3& scale) { mScale = scale; mRecalculateWorldTransform = true; }
+    void SetScale(const Vector3& scale) { mScale = scale; MarkTransformDirty(); }
     const Quaternion& GetRotation() const { return mRotation; }
-    void SetRotation(const Quaternion& rotation) { mRotation = rotation; mRecalculateWorldTransform = true; }
-    const Matrix4& GetWorldTransform() const { return mWorldTransform; }
+    void SetRotation(const Quaternion& rotation) { mRotation = rotation; MarkTransformDirty(); }
+    Actor* GetParent() const { return mParent; }
+    const std::vector<Actor*>& GetChildren() const { return mChildren; }
+    const std::vector<class Component*>& GetComponents() const { return mComponents; }
+    const Matrix4& GetWorldTransform() const;
+    unsigned int GetTransformVersion() const; // ワールド変換座標を再計算するたびに増える（GPUへの転送の要否の判定用）
 
 };
@@ -1,11 +1,19 @@
 #include "Camera.h"
 #include "../Game.h"
-#include <SDL.h>
+#include "../Commons/InputSystem.h"
 
 Camera::Camera(class Game *game)
 : Actor(game)
 , mTargetActor(nullptr)
-{}
+{
+    // 入力を購読する
+    game->GetInputSystem()->AddSubscriber(this);
+}
+
+Camera::~Camera()
+{
+    GetGame()->GetInputSystem()->RemoveSubscriber(this);
+}
 
 void Camera::UpdateActor(float deltaTime)
 {
@@ -20,34 +28,34 @@ void Camera::UpdateActor(float deltaTime)
     GetGame()->GetRenderer()->SetViewMatrix(viewMatrix);
 }
 
-void Camera::ProcessInput(const uint8_t *state)
+void Camera::ProcessInput(const InputSystem* input)
 {
-    Actor::ProcessInput(state);
+    Actor::ProcessInput(input);
 
     // TODO カメラ移動処理
     float moveSpeed = 10.0f;
     Vector3 pos = GetPosition();
-    if (state[SDL_SCANCODE_A])
+    if (input->IsActionHeld(InputSystem::MOVE_LEFT))
     {
         pos.x += moveSpeed;
     }
-    if (state[SDL_SCANCODE_D])
+    if (input->IsActionHeld(InputSystem::MOVE_RIGHT))
     {
         pos.x -= moveSpeed;
     }
-    if (state[SDL_SCANCODE_W])
+    if (input->IsActionHeld(InputSystem::MOVE_UP))
     {
         pos.y += moveSpeed;
     }
-    if (state[SDL_SCANCODE_S])
+    if (input->IsActionHeld(InputSystem::MOVE_DOWN))
     {
         pos.y -= moveSpeed;
     }
-    if (state[SDL_SCANCODE_UP])
+    if (input->IsActionHeld(InputSystem::MOVE_FORWARD))
     {
         pos.z += moveSpeed;
     }
-    if (state[SDL_SCANCODE_DOWN])
+    if (input->IsActionHeld(InputSystem::MOVE_BACK))
     {
         pos.z -= moveSpeed;
     }
@@ -5,9 +5,10 @@
 class Camera : public Actor {
 public:
     Camera(class Game* game);
+    ~Camera();
 
     void UpdateActor(float deltaTime) override;
-    void ProcessInput(const uint8_t* state) override;
+    void ProcessInput(const class InputSystem* input) override;
 
 private:
     class Actor* mTargetActor;
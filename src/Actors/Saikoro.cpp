@@ -8,8 +8,7 @@ Saikoro::Saikoro(class Game *game, Shader::ShaderType type)
 {
     // メッシュ、シェーダの設定
     auto* meshComp = new MeshComponent(this);
-    auto* mesh = game->GetRenderer()->GetMesh(game->GetAssetsPath() + "saikoro.fbx");
-    meshComp->SetMesh(mesh);
+    meshComp->SetMesh(game->GetRenderer()->InternMesh(game->GetAssetsPath() + "saikoro.fbx"));
     auto* shader = game->GetRenderer()->GetShader(type);
     meshComp->SetShader(shader);
 }
@@ -22,8 +21,3 @@ void Saikoro::UpdateActor(float deltaTime)
     SetRotationX(Math::ToRadians(testRot));
     SetRotationZ(Math::ToRadians(testRot));
 }
-
-void Saikoro::ProcessInput(const uint8_t *state)
-{
-    Actor::ProcessInput(state);
-}
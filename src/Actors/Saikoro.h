@@ -8,7 +8,6 @@ public:
     Saikoro(class Game* game, Shader::ShaderType type = Shader::ShaderType::BASIC);
 
     void UpdateActor(float deltaTime) override;
-    void ProcessInput(const uint8_t* state) override;
 
 private:
     // 回転テスト用
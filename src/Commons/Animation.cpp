@@ -0,0 +1,308 @@
+#include "Animation.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIMATION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const float ROTATION_SCALE = 32767.0f;  // 回転の量子化（snorm16）
+    const float RANGE_STEPS = 65535.0f;     // 平行移動、拡大縮小の量子化（unorm16）
+
+    int16_t QuantizeRotation(float value)
+    {
+        value = std::max(-1.0f, std::min(1.0f, value));
+        return static_cast<int16_t>(lroundf(value * ROTATION_SCALE));
+    }
+
+    uint16_t QuantizeRange(float value, float min, float step)
+    {
+        if (step <= 0.0f) return 0;
+        long quantized = lroundf((value - min) / step);
+        return static_cast<uint16_t>(std::max(0L, std::min(65535L, quantized)));
+    }
+
+#ifdef ANIMATION_USE_SSE2
+    // 4つのint16、uint16をfloatに変換
+    inline __m128 LoadInt16(const int16_t* keys)
+    {
+        __m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keys));
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16));
+    }
+    inline __m128 LoadUInt16(const uint16_t* keys)
+    {
+        __m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keys));
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(value, _mm_setzero_si128()));
+    }
+    // a + (b - a) * t
+    inline __m128 Lerp(__m128 a, __m128 b, __m128 t)
+    {
+        return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+    }
+#endif
+}
+
+void AnimationPose::Resize(int count)
+{
+    jointCount = count;
+    paddedJointCount = (count + 3) & ~3;
+    for (auto& component : rotation) component.assign(paddedJointCount, 0.0f);
+    for (auto& component : translation) component.assign(paddedJointCount, 0.0f);
+    for (auto& component : scale) component.assign(paddedJointCount, 1.0f);
+    rotation[3].assign(paddedJointCount, 1.0f);
+}
+
+Skeleton::Skeleton()
+{}
+
+int Skeleton::AddJoint(const std::string& name, int parent, const Matrix4& inverseBindPose)
+{
+    mNames.emplace_back(name);
+    mParents.emplace_back(parent < GetJointCount() ? parent : -1);
+    mInverseBindPoses.emplace_back(inverseBindPose);
+    return GetJointCount() - 1;
+}
+
+int Skeleton::FindJoint(const std::string& name) const
+{
+    auto iter = std::find(mNames.begin(), mNames.end(), name);
+    return iter != mNames.end() ? static_cast<int>(iter - mNames.begin()) : -1;
+}
+
+// ボーン行列パレットの計算
+// *ローカル変換（平行移動 * 回転 * 拡大縮小）に親のモデル座標を掛け、バインド時の逆行列を掛ける
+void Skeleton::ComputePalette(const AnimationPose& pose, std::vector<Matrix4>& models, float* outPalette) const
+{
+    const int jointCount = GetJointCount();
+    models.resize(jointCount);
+    for (int joint = 0; joint < jointCount; joint++)
+    {
+        Quaternion q(pose.rotation[0][joint], pose.rotation[1][joint], pose.rotation[2][joint], pose.rotation[3][joint]);
+        Matrix4 local = Matrix4::CreateQuaternion(q);
+        const float scale[3] = { pose.scale[0][joint], pose.scale[1][joint], pose.scale[2][joint] };
+        for (int row = 0; row < 3; row++)
+        {
+            local.matrix[row][0] *= scale[0];
+            local.matrix[row][1] *= scale[1];
+            local.matrix[row][2] *= scale[2];
+            local.matrix[row][3] = pose.translation[row][joint];
+        }
+        int parent = mParents[joint];
+        models[joint] = parent >= 0 ? models[parent] * local : local;
+
+        Matrix4 skin = models[joint] * mInverseBindPoses[joint];
+        float* out = &outPalette[joint * PALETTE_FLOATS];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                out[row * 4 + column] = skin.matrix[row][column];
+            }
+        }
+    }
+}
+
+void Skeleton::ComputeBindPalette(float* outPalette) const
+{
+    for (int joint = 0; joint < GetJointCount(); joint++)
+    {
+        float* out = &outPalette[joint * PALETTE_FLOATS];
+        for (int i = 0; i < PALETTE_FLOATS; i++)
+        {
+            out[i] = (i % 5 == 0) ? 1.0f : 0.0f; // 対角成分（0, 5, 10）のみ1
+        }
+    }
+}
+
+AnimationClip::AnimationClip()
+:mJointCount(0)
+,mPaddedJointCount(0)
+,mFrameCount(0)
+,mSampleRate(30.0f)
+,mDuration(0.0f)
+{}
+
+void AnimationClip::Build(const std::string& name, int jointCount, int frameCount, float sampleRate,
+                          const std::vector<Key>& keys)
+{
+    mName = name;
+    mJointCount = jointCount;
+    mPaddedJointCount = (jointCount + 3) & ~3;
+    mFrameCount = std::max(frameCount, 2);
+    mSampleRate = sampleRate;
+    mDuration = (mFrameCount - 1) / sampleRate;
+    const int padded = mPaddedJointCount;
+    auto getKey = [&](int frame, int joint) -> const Key& {
+        return keys[std::min(frame, frameCount - 1) * jointCount + joint];
+    };
+
+    // 関節と軸ごとの範囲（幅0の軸は全フレーム同じ値）
+    // *余りの関節は平行移動0、拡大縮小1とする
+    mTranslationMin.assign(3 * padded, 0.0f);
+    mTranslationStep.assign(3 * padded, 0.0f);
+    mScaleMin.assign(3 * padded, 1.0f);
+    mScaleStep.assign(3 * padded, 0.0f);
+    for (int joint = 0; joint < jointCount; joint++)
+    {
+        Vector3 tMin = getKey(0, joint).translation;
+        Vector3 tMax = tMin;
+        Vector3 sMin = getKey(0, joint).scale;
+        Vector3 sMax = sMin;
+        for (int frame = 1; frame < mFrameCount; frame++)
+        {
+            const Key& key = getKey(frame, joint);
+            tMin = Vector3(std::min(tMin.x, key.translation.x), std::min(tMin.y, key.translation.y), std::min(tMin.z, key.translation.z));
+            tMax = Vector3(std::max(tMax.x, key.translation.x), std::max(tMax.y, key.translation.y), std::max(tMax.z, key.translation.z));
+            sMin = Vector3(std::min(sMin.x, key.scale.x), std::min(sMin.y, key.scale.y), std::min(sMin.z, key.scale.z));
+            sMax = Vector3(std::max(sMax.x, key.scale.x), std::max(sMax.y, key.scale.y), std::max(sMax.z, key.scale.z));
+        }
+        const float tMinAxes[3] = { tMin.x, tMin.y, tMin.z };
+        const float tMaxAxes[3] = { tMax.x, tMax.y, tMax.z };
+        const float sMinAxes[3] = { sMin.x, sMin.y, sMin.z };
+        const float sMaxAxes[3] = { sMax.x, sMax.y, sMax.z };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            mTranslationMin[axis * padded + joint] = tMinAxes[axis];
+            mTranslationStep[axis * padded + joint] = (tMaxAxes[axis] - tMinAxes[axis]) / RANGE_STEPS;
+            mScaleMin[axis * padded + joint] = sMinAxes[axis];
+            mScaleStep[axis * padded + joint] = (sMaxAxes[axis] - sMinAxes[axis]) / RANGE_STEPS;
+        }
+    }
+
+    // 量子化
+    // *回転は前フレームと内積が負なら符号を反転し、補間で遠回りしないようにする
+    mRotations.assign(static_cast<size_t>(mFrameCount) * 4 * padded, 0);
+    mTranslations.assign(static_cast<size_t>(mFrameCount) * 3 * padded, 0);
+    mScales.assign(static_cast<size_t>(mFrameCount) * 3 * padded, 0);
+    std::vector<Quaternion> previous(jointCount);
+    for (int frame = 0; frame < mFrameCount; frame++)
+    {
+        for (int joint = 0; joint < padded; joint++)
+        {
+            const size_t rotationBase = static_cast<size_t>(frame) * 4 * padded + joint;
+            const size_t rangeBase = static_cast<size_t>(frame) * 3 * padded + joint;
+            if (joint >= jointCount)
+            {
+                mRotations[rotationBase + 3 * padded] = static_cast<int16_t>(ROTATION_SCALE); // 単位クォータニオン
+                continue;
+            }
+            const Key& key = getKey(frame, joint);
+            Quaternion q = key.rotation;
+            if (frame > 0)
+            {
+                const Quaternion& p = previous[joint];
+                if (q.x * p.x + q.y * p.y + q.z * p.z + q.w * p.w < 0.0f) q = Quaternion(-q.x, -q.y, -q.z, -q.w);
+            }
+            previous[joint] = q;
+            mRotations[rotationBase + 0 * padded] = QuantizeRotation(q.x);
+            mRotations[rotationBase + 1 * padded] = QuantizeRotation(q.y);
+            mRotations[rotationBase + 2 * padded] = QuantizeRotation(q.z);
+            mRotations[rotationBase + 3 * padded] = QuantizeRotation(q.w);
+
+            const float translation[3] = { key.translation.x, key.translation.y, key.translation.z };
+            const float scale[3] = { key.scale.x, key.scale.y, key.scale.z };
+            for (int axis = 0; axis < 3; axis++)
+            {
+                mTranslations[rangeBase + axis * padded] = QuantizeRange(translation[axis], mTranslationMin[axis * padded + joint],
+                                                                         mTranslationStep[axis * padded + joint]);
+                mScales[rangeBase + axis * padded] = QuantizeRange(scale[axis], mScaleMin[axis * padded + joint],
+                                                                   mScaleStep[axis * padded + joint]);
+            }
+        }
+    }
+}
+
+void AnimationClip::Sample(float time, bool isLoop, AnimationPose& outPose) const
+{
+    if (outPose.paddedJointCount != mPaddedJointCount) outPose.Resize(mJointCount);
+    if (mFrameCount < 2) return;
+
+    // 補間する2フレームと割合
+    if (isLoop && mDuration > 0.0f)
+    {
+        time = fmodf(time, mDuration);
+        if (time < 0.0f) time += mDuration;
+    }
+    float frame = std::max(0.0f, std::min(time, mDuration)) * mSampleRate;
+    int frame0 = std::min(static_cast<int>(frame), mFrameCount - 2);
+    float t = std::min(frame - frame0, 1.0f);
+    const int frame1 = frame0 + 1;
+
+    const int padded = mPaddedJointCount;
+    const float invRotationScale = 1.0f / ROTATION_SCALE;
+    int joint = 0;
+#ifdef ANIMATION_USE_SSE2
+    const __m128 vt = _mm_set1_ps(t);
+    const __m128 rotationScale = _mm_set1_ps(invRotationScale);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; joint + 4 <= padded; joint += 4)
+    {
+        // 回転（補間して正規化）
+        __m128 r[4];
+        for (int c = 0; c < 4; c++)
+        {
+            __m128 a = LoadInt16(GetRotationKeys(frame0, c) + joint);
+            __m128 b = LoadInt16(GetRotationKeys(frame1, c) + joint);
+            r[c] = _mm_mul_ps(Lerp(a, b, vt), rotationScale);
+        }
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], r[0]), _mm_mul_ps(r[1], r[1])),
+                                     _mm_add_ps(_mm_mul_ps(r[2], r[2]), _mm_mul_ps(r[3], r[3])));
+        __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+        for (int c = 0; c < 4; c++)
+        {
+            _mm_storeu_ps(&outPose.rotation[c][joint], _mm_mul_ps(r[c], invLength));
+        }
+        // 平行移動、拡大縮小（補間して範囲に戻す）
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const size_t range = axis * padded + joint;
+            __m128 ta = LoadUInt16(GetTranslationKeys(frame0, axis) + joint);
+            __m128 tb = LoadUInt16(GetTranslationKeys(frame1, axis) + joint);
+            __m128 translation = _mm_add_ps(_mm_loadu_ps(&mTranslationMin[range]),
+                                            _mm_mul_ps(_mm_loadu_ps(&mTranslationStep[range]), Lerp(ta, tb, vt)));
+            _mm_storeu_ps(&outPose.translation[axis][joint], translation);
+            __m128 sa = LoadUInt16(GetScaleKeys(frame0, axis) + joint);
+            __m128 sb = LoadUInt16(GetScaleKeys(frame1, axis) + joint);
+            __m128 scale = _mm_add_ps(_mm_loadu_ps(&mScaleMin[range]),
+                                      _mm_mul_ps(_mm_loadu_ps(&mScaleStep[range]), Lerp(sa, sb, vt)));
+            _mm_storeu_ps(&outPose.scale[axis][joint], scale);
+        }
+    }
+#endif
+    for (; joint < padded; joint++)
+    {
+        float r[4];
+        float lengthSq = 0.0f;
+        for (int c = 0; c < 4; c++)
+        {
+            float a = GetRotationKeys(frame0, c)[joint];
+            float b = GetRotationKeys(frame1, c)[joint];
+            r[c] = (a + (b - a) * t) * invRotationScale;
+            lengthSq += r[c] * r[c];
+        }
+        float invLength = 1.0f / sqrtf(lengthSq);
+        for (int c = 0; c < 4; c++)
+        {
+            outPose.rotation[c][joint] = r[c] * invLength;
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const size_t range = axis * padded + joint;
+            float ta = GetTranslationKeys(frame0, axis)[joint];
+            float tb = GetTranslationKeys(frame1, axis)[joint];
+            outPose.translation[axis][joint] = mTranslationMin[range] + mTranslationStep[range] * (ta + (tb - ta) * t);
+            float sa = GetScaleKeys(frame0, axis)[joint];
+            float sb = GetScaleKeys(frame1, axis)[joint];
+            outPose.scale[axis][joint] = mScaleMin[range] + mScaleStep[range] * (sa + (sb - sa) * t);
+        }
+    }
+}
+
+size_t AnimationClip::GetBytes() const
+{
+    return mRotations.size() * sizeof(int16_t) + (mTranslations.size() + mScales.size()) * sizeof(uint16_t)
+           + (mTranslationMin.size() + mTranslationStep.size() + mScaleMin.size() + mScaleStep.size()) * sizeof(float);
+}
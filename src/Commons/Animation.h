@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Math.h"
+
+// ポーズ（関節ごとのローカル変換）
+// *SIMDで4関節ずつ処理するため成分ごとの配列で持つ（関節数は4の倍数に切り上げる）
+struct AnimationPose
+{
+    AnimationPose()
+    :jointCount(0)
+    ,paddedJointCount(0)
+    {}
+
+    void Resize(int jointCount);
+
+    int jointCount;
+    int paddedJointCount;
+    std::vector<float> rotation[4];    // クォータニオン(x, y, z, w)
+    std::vector<float> translation[3];
+    std::vector<float> scale[3];
+};
+
+// スケルトンクラス
+// *関節は親が子より前に並ぶ（先頭から順に親の行列を掛けていける）
+// *GL、FBX SDKに依存しないため、合成したスケルトンでも計測、検証できる
+class Skeleton
+{
+public:
+    Skeleton();
+
+    // 関節の追加（番号を返す、parentは追加済の関節か-1）
+    // *inverseBindPoseはメッシュ座標から関節座標への変換（バインド時）
+    int AddJoint(const std::string& name, int parent, const Matrix4& inverseBindPose);
+    int FindJoint(const std::string& name) const; // 見つからなければ-1
+    void SetInverseBindPose(int joint, const Matrix4& inverseBindPose) { mInverseBindPoses[joint] = inverseBindPose; }
+
+    // ポーズからボーン行列パレット（行優先の3x4行列、12要素ずつ）を計算する
+    // *modelsは関節ごとのモデル座標の作業領域（呼出元が使い回す）
+    void ComputePalette(const AnimationPose& pose, std::vector<Matrix4>& models, float* outPalette) const;
+    // 全ての関節が単位行列のパレット（アニメーション無しではバインド時の形のまま）
+    void ComputeBindPalette(float* outPalette) const;
+
+private:
+    std::vector<std::string> mNames;
+    std::vector<int> mParents;
+    std::vector<Matrix4> mInverseBindPoses;
+
+public:
+    int GetJointCount() const { return static_cast<int>(mParents.size()); }
+    int GetParent(int joint) const { return mParents[joint]; }
+    const std::string& GetJointName(int joint) const { return mNames[joint]; }
+
+    // パレットの1関節あたりのfloat数（行優先の3x4行列）
+    static const int PALETTE_FLOATS = 12;
+
+};
+
+// アニメーションクリップクラス
+// *関節ごとのトラックを一定間隔でサンプリングしたキーを16bitに量子化して持つ
+//  回転は各成分を[-1, 1]で、平行移動・拡大縮小は関節と軸ごとの範囲（最小値と幅）で正規化する
+// *キーはフレームごとに成分ごと・関節の順（SoA）に並べ、評価時は4関節ずつSIMDで補間する
+// *1関節1フレームあたり20バイト（floatで持つ場合の半分）
+class AnimationClip
+{
+public:
+    // 量子化前のキー
+    struct Key
+    {
+        Quaternion rotation;
+        Vector3 translation;
+        Vector3 scale;
+    };
+
+    AnimationClip();
+
+    // サンプリング済のキーから作成（keysは[frame * jointCount + joint]の順、frameCountは2以上）
+    void Build(const std::string& name, int jointCount, int frameCount, float sampleRate,
+               const std::vector<Key>& keys);
+
+    // 時刻のポーズを評価（ループしない場合は最後のフレームで止まる）
+    // *隣接フレームのキーを線形補間し、回転は正規化する（作成時に符号を揃えているため反転の判定は不要）
+    void Sample(float time, bool isLoop, AnimationPose& outPose) const;
+
+private:
+    // 量子化したキーのフレーム、成分ごとの先頭
+    const int16_t* GetRotationKeys(int frame, int component) const
+    {
+        return &mRotations[(static_cast<size_t>(frame) * 4 + component) * mPaddedJointCount];
+    }
+    const uint16_t* GetTranslationKeys(int frame, int component) const
+    {
+        return &mTranslations[(static_cast<size_t>(frame) * 3 + component) * mPaddedJointCount];
+    }
+    const uint16_t* GetScaleKeys(int frame, int component) const
+    {
+        return &mScales[(static_cast<size_t>(frame) * 3 + component) * mPaddedJointCount];
+    }
+
+    std::string mName;
+    int mJointCount;
+    int mPaddedJointCount; // 4の倍数に切り上げた関節数
+    int mFrameCount;
+    float mSampleRate;     // 1秒あたりのフレーム数
+    float mDuration;       // 秒
+
+    std::vector<int16_t> mRotations;     // [frame][x, y, z, w][joint]
+    std::vector<uint16_t> mTranslations; // [frame][x, y, z][joint]
+    std::vector<uint16_t> mScales;       // [frame][x, y, z][joint]
+    // 関節と軸ごとの範囲（[x, y, z][joint]、幅は量子化の1段階あたりの値）
+    std::vector<float> mTranslationMin;
+    std::vector<float> mTranslationStep;
+    std::vector<float> mScaleMin;
+    std::vector<float> mScaleStep;
+
+public:
+    const std::string& GetName() const { return mName; }
+    int GetJointCount() const { return mJointCount; }
+    int GetFrameCount() const { return mFrameCount; }
+    float GetDuration() const { return mDuration; }
+    size_t GetBytes() const; // キーと範囲のバイト数
+
+};
@@ -0,0 +1,439 @@
+#include "AssetPack.h"
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include "JobSystem.h"
+#include "Lz4Codec.h"
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // パックのヘッダ
+    // *ヘッダの後にエントリのデータを並べ、末尾に目次（エントリ、ブロック、文字列テーブル）を置く
+    const uint32_t PACK_MAGIC = 0x4B415041; // "APAK"
+    const uint32_t PACK_VERSION = 1;
+
+    struct PackHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t blockCount;
+        uint32_t stringBytes;
+        uint32_t alignment;  // エントリの先頭の境界
+        uint64_t tocOffset;  // 目次の先頭
+    };
+
+    // 圧縮してもこれ以上残るなら非圧縮で格納する（マップした領域をそのまま使える方を優先）
+    const float MIN_COMPRESSION_RATIO = 0.9f;
+
+    bool ReadWholeFile(const std::string& filePath, std::vector<unsigned char>& outData)
+    {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        outData.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(reinterpret_cast<char*>(outData.data()), outData.size());
+        return static_cast<bool>(file);
+    }
+}
+
+AssetPack::AssetPack()
+:mData(nullptr)
+,mSize(0)
+#ifdef _WIN32
+,mFileHandle(nullptr)
+,mMappingHandle(nullptr)
+#else
+,mFileDescriptor(-1)
+#endif
+{}
+
+AssetPack::~AssetPack()
+{
+    Close();
+}
+
+// パックを開く
+// *目次だけをコピーし、データはマップしたまま必要になった時に読む（OSがページ単位で読み込む）
+bool AssetPack::Open(const std::string& packPath)
+{
+    Close();
+    if (!Map(packPath)) return false;
+
+    PackHeader header;
+    bool isValid = mSize >= sizeof(header);
+    if (isValid)
+    {
+        std::memcpy(&header, mData, sizeof(header));
+        const uint64_t tocBytes = static_cast<uint64_t>(header.entryCount) * sizeof(Entry)
+            + static_cast<uint64_t>(header.blockCount) * sizeof(Block) + header.stringBytes;
+        isValid = header.magic == PACK_MAGIC && header.version == PACK_VERSION
+               && header.tocOffset >= sizeof(header) && header.tocOffset + tocBytes == mSize;
+    }
+    if (!isValid)
+    {
+        SDL_Log("Invalid asset pack. (%s)", packPath.c_str());
+        Close();
+        return false;
+    }
+
+    const unsigned char* cursor = mData + header.tocOffset;
+    mEntries.resize(header.entryCount);
+    if (!mEntries.empty()) std::memcpy(mEntries.data(), cursor, mEntries.size() * sizeof(Entry));
+    cursor += mEntries.size() * sizeof(Entry);
+    // 圧縮したエントリが無ければブロックは0個（空のvectorのdata()はnullptrになり得る）
+    mBlocks.resize(header.blockCount);
+    if (!mBlocks.empty()) std::memcpy(mBlocks.data(), cursor, mBlocks.size() * sizeof(Block));
+    cursor += mBlocks.size() * sizeof(Block);
+    mStrings.assign(cursor, cursor + header.stringBytes);
+
+    // 目次の検証、ブロックの位置の計算
+    // *エントリのデータ、ブロックが範囲内で、ブロックの合計がエントリのサイズと一致すること
+    isValid = mStrings.empty() || mStrings.back() == '\0';
+    mBlockOffsets.assign(mBlocks.size(), 0);
+    for (size_t i = 0; i < mEntries.size() && isValid; i++)
+    {
+        const Entry& entry = mEntries[i];
+        isValid = entry.pathOffset < mStrings.size()
+               && entry.offset <= header.tocOffset && entry.storedSize <= header.tocOffset - entry.offset;
+        if (!isValid) break;
+        if (entry.compression == COMPRESSION_NONE)
+        {
+            isValid = entry.storedSize == entry.size && entry.blockCount == 0;
+        }
+        else if (entry.compression == COMPRESSION_LZ4)
+        {
+            isValid = static_cast<uint64_t>(entry.firstBlock) + entry.blockCount <= mBlocks.size();
+            uint64_t stored = 0;
+            uint64_t size = 0;
+            for (uint32_t b = 0; b < entry.blockCount && isValid; b++)
+            {
+                const Block& block = mBlocks[entry.firstBlock + b];
+                const bool isLast = b + 1 == entry.blockCount;
+                isValid = isLast ? block.size <= BLOCK_SIZE : block.size == BLOCK_SIZE;
+                mBlockOffsets[entry.firstBlock + b] = stored;
+                stored += block.storedSize;
+                size += block.size;
+            }
+            isValid = isValid && stored == entry.storedSize && size == entry.size;
+        }
+        else
+        {
+            isValid = false;
+        }
+        if (isValid) mPathIndices.emplace(GetPath(static_cast<int>(i)), static_cast<int>(i));
+    }
+    if (!isValid)
+    {
+        SDL_Log("Broken asset pack. (%s)", packPath.c_str());
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::Close()
+{
+    Unmap();
+    mEntries.clear();
+    mBlocks.clear();
+    mBlockOffsets.clear();
+    mStrings.clear();
+    mPathIndices.clear();
+}
+
+int AssetPack::FindEntry(const std::string& path) const
+{
+    auto iter = mPathIndices.find(path);
+    return iter != mPathIndices.end() ? iter->second : -1;
+}
+
+const unsigned char* AssetPack::GetMappedData(int entry) const
+{
+    const Entry& info = mEntries[entry];
+    return info.compression == COMPRESSION_NONE ? mData + info.offset : nullptr;
+}
+
+const unsigned char* AssetPack::GetBlockData(int entry, int block) const
+{
+    const Entry& info = mEntries[entry];
+    return mData + info.offset + mBlockOffsets[info.firstBlock + block];
+}
+
+// エントリの展開
+// *ブロックごとに展開先が決まっているため、ジョブは互いに書込が重ならない
+bool AssetPack::Decompress(int entry, unsigned char* out, JobSystem* jobSystem) const
+{
+    const Entry& info = mEntries[entry];
+    if (info.compression == COMPRESSION_NONE)
+    {
+        std::memcpy(out, mData + info.offset, info.size);
+        return true;
+    }
+
+    std::atomic<bool> isValid(true);
+    auto decompress = [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++)
+        {
+            const Block& block = mBlocks[info.firstBlock + b];
+            const unsigned char* src = GetBlockData(entry, static_cast<int>(b));
+            unsigned char* dest = out + b * BLOCK_SIZE;
+            if (block.storedSize == block.size) std::memcpy(dest, src, block.size);
+            else if (!Lz4Codec::Decompress(src, block.storedSize, dest, block.size)) isValid = false;
+        }
+    };
+    if (jobSystem && info.blockCount > 1) jobSystem->ParallelFor(info.blockCount, 1, decompress);
+    else decompress(0, info.blockCount);
+    return isValid;
+}
+
+void AssetPack::Prefetch(int entry) const
+{
+#ifndef _WIN32
+    // ページの境界に揃えて先読みを要求する
+    const Entry& info = mEntries[entry];
+    const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t begin = info.offset / pageSize * pageSize;
+    const uint64_t end = info.offset + info.storedSize;
+    if (end > begin) madvise(const_cast<unsigned char*>(mData) + begin, end - begin, MADV_WILLNEED);
+#else
+    (void)entry;
+#endif
+}
+
+bool AssetPack::Verify(int entry) const
+{
+    const Entry& info = mEntries[entry];
+    const unsigned char* data = GetMappedData(entry);
+    std::vector<unsigned char> decompressed;
+    if (!data)
+    {
+        decompressed.resize(info.size);
+        if (!Decompress(entry, decompressed.data())) return false;
+        data = decompressed.data();
+    }
+    return HashContent(data, info.size) == info.contentHash;
+}
+
+// パックの作成
+// *エントリのデータを順に書き、最後に目次とヘッダを書く
+bool AssetPack::Write(const std::string& packPath, const std::vector<Source>& sources, bool compress,
+                      uint32_t alignment, JobSystem* jobSystem, WriteStats* outStats)
+{
+    std::ofstream file(packPath, std::ios::binary);
+    if (!file.is_open())
+    {
+        SDL_Log("Failed open asset pack for write. (%s)", packPath.c_str());
+        return false;
+    }
+    alignment = std::max(alignment, 1u);
+    PackHeader header = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+
+    WriteStats stats = {};
+    std::vector<Entry> entries;
+    std::vector<Block> blocks;
+    std::vector<char> strings;
+    std::unordered_map<uint64_t, int> contentEntries; // 内容のハッシュ -> データを書いたエントリ
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> sharedData; // 共有する候補の内容（比較用）
+    std::vector<std::vector<unsigned char>> compressed;
+    const std::vector<char> padding(alignment, 0);
+    for (const auto& source : sources)
+    {
+        if (!ReadWholeFile(source.filePath, data))
+        {
+            SDL_Log("Failed read asset pack source. (%s)", source.filePath.c_str());
+            return false;
+        }
+        Entry entry = {};
+        entry.contentHash = HashContent(data.data(), data.size());
+        entry.size = data.size();
+        entry.pathOffset = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), source.path.begin(), source.path.end());
+        strings.emplace_back('\0');
+        stats.sourceBytes += data.size();
+
+        // 同じ内容なら書いたデータを共有する
+        // *ハッシュが衝突した別のアセットを共有しないよう、書いた元のファイルと内容を比べる
+        //  （エントリはソースと同じ順に並ぶため、エントリの番号がソースの番号）
+        auto shared = contentEntries.find(entry.contentHash);
+        bool isSame = false;
+        if (shared != contentEntries.end() && entries[shared->second].size == entry.size)
+        {
+            isSame = ReadWholeFile(sources[shared->second].filePath, sharedData) && sharedData.size() == data.size()
+                  && std::memcmp(sharedData.data(), data.data(), data.size()) == 0;
+        }
+        if (isSame)
+        {
+            const Entry& other = entries[shared->second];
+            entry.offset = other.offset;
+            entry.storedSize = other.storedSize;
+            entry.compression = other.compression;
+            entry.firstBlock = other.firstBlock;
+            entry.blockCount = other.blockCount;
+            entries.emplace_back(entry);
+            stats.sharedCount++;
+            continue;
+        }
+
+        // ブロックごとに圧縮（小さくならないブロックはそのまま）
+        const size_t blockCount = compress ? (data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE : 0;
+        compressed.assign(blockCount, std::vector<unsigned char>());
+        auto compressBlocks = [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; b++)
+            {
+                const size_t start = b * BLOCK_SIZE;
+                const size_t size = std::min<size_t>(BLOCK_SIZE, data.size() - start);
+                std::vector<unsigned char>& out = compressed[b];
+                out.resize(Lz4Codec::GetMaxCompressedBytes(size));
+                const size_t compressedSize = Lz4Codec::Compress(data.data() + start, size, out.data());
+                if (compressedSize < size) out.resize(compressedSize);
+                else out.assign(data.begin() + start, data.begin() + start + size);
+            }
+        };
+        if (jobSystem && blockCount > 1) jobSystem->ParallelFor(blockCount, 1, compressBlocks);
+        else compressBlocks(0, blockCount);
+        uint64_t storedSize = 0;
+        for (const auto& block : compressed) storedSize += block.size();
+        const bool isCompressed = blockCount > 0 && storedSize < data.size() * MIN_COMPRESSION_RATIO;
+
+        // 境界に揃えて書く
+        const uint64_t aligned = (position + alignment - 1) / alignment * alignment;
+        file.write(padding.data(), aligned - position);
+        entry.offset = aligned;
+        if (isCompressed)
+        {
+            entry.compression = COMPRESSION_LZ4;
+            entry.storedSize = storedSize;
+            entry.firstBlock = static_cast<uint32_t>(blocks.size());
+            entry.blockCount = static_cast<uint32_t>(blockCount);
+            for (size_t b = 0; b < blockCount; b++)
+            {
+                Block block;
+                block.storedSize = static_cast<uint32_t>(compressed[b].size());
+                block.size = static_cast<uint32_t>(std::min<size_t>(BLOCK_SIZE, data.size() - b * BLOCK_SIZE));
+                blocks.emplace_back(block);
+                file.write(reinterpret_cast<const char*>(compressed[b].data()), compressed[b].size());
+            }
+            stats.compressedCount++;
+        }
+        else
+        {
+            entry.compression = COMPRESSION_NONE;
+            entry.storedSize = data.size();
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+        position = aligned + entry.storedSize;
+        contentEntries.emplace(entry.contentHash, static_cast<int>(entries.size()));
+        entries.emplace_back(entry);
+    }
+
+    // 目次、ヘッダ
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.blockCount = static_cast<uint32_t>(blocks.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.alignment = alignment;
+    header.tocOffset = position;
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(Block));
+    file.write(strings.data(), strings.size());
+    stats.packBytes = static_cast<uint64_t>(file.tellp());
+    file.seekp(0, std::ios::beg);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!file)
+    {
+        SDL_Log("Failed write asset pack. (%s)", packPath.c_str());
+        return false;
+    }
+    stats.entryCount = static_cast<int>(entries.size());
+    if (outStats) *outStats = stats;
+    return true;
+}
+
+uint64_t AssetPack::HashContent(const unsigned char* data, size_t size, uint64_t seed)
+{
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool AssetPack::Map(const std::string& packPath)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(packPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!view)
+    {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mData = static_cast<const unsigned char*>(view);
+    mSize = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = open(packPath.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat status;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (view == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+    mFileDescriptor = fd;
+    mData = static_cast<const unsigned char*>(view);
+    mSize = static_cast<uint64_t>(status.st_size);
+#endif
+    return true;
+}
+
+void AssetPack::Unmap()
+{
+    if (!mData) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mData);
+    CloseHandle(static_cast<HANDLE>(mMappingHandle));
+    CloseHandle(static_cast<HANDLE>(mFileHandle));
+    mMappingHandle = mFileHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(mData), static_cast<size_t>(mSize));
+    close(mFileDescriptor);
+    mFileDescriptor = -1;
+#endif
+    mData = nullptr;
+    mSize = 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// アセットパッククラス
+// *複数のアセットを1つのファイルにまとめ、先頭のヘッダと末尾の目次(TOC)から位置を引く
+//  （アセットごとのファイルオープンとシークを無くし、HDDでも連続して読める）
+// *ファイルはメモリマップで開き、非圧縮のエントリはマップした領域をそのまま返す（コピー無し）
+// *圧縮したエントリは一定サイズのブロックごとにLZ4で圧縮する（ブロックは独立しているため並列に展開できる）
+//  圧縮しても小さくならないブロックはそのまま格納する
+// *エントリの先頭は指定の境界に揃え、内容のハッシュを持つ（同じ内容のエントリはデータを共有する）
+// *書込はオフライン（パック作成ツール）で行う
+class AssetPack
+{
+public:
+    enum Compression
+    {
+        COMPRESSION_NONE, // 非圧縮（マップした領域をそのまま使う）
+        COMPRESSION_LZ4,  // ブロックごとにLZ4
+    };
+
+    // 目次のエントリ
+    struct Entry
+    {
+        uint64_t contentHash; // 展開後の内容のハッシュ
+        uint64_t offset;      // データの先頭（ファイル先頭から）
+        uint64_t size;        // 展開後のバイト数
+        uint64_t storedSize;  // 格納しているバイト数
+        uint32_t pathOffset;  // 文字列テーブル内のパス（パックのルートからの相対、区切りは'/'）
+        uint32_t compression; // Compression
+        uint32_t firstBlock;  // 先頭のブロック（圧縮時のみ）
+        uint32_t blockCount;
+    };
+
+    // 圧縮したブロック
+    struct Block
+    {
+        uint32_t storedSize; // 格納しているバイト数（sizeと同じなら非圧縮のまま）
+        uint32_t size;       // 展開後のバイト数
+    };
+
+    // パックに入れるファイル
+    struct Source
+    {
+        std::string path;     // パック内のパス
+        std::string filePath; // 読み込むファイル
+    };
+
+    // 作成の集計
+    struct WriteStats
+    {
+        int entryCount;
+        int sharedCount;       // 同じ内容のエントリとデータを共有した数
+        int compressedCount;   // 圧縮して格納した数
+        uint64_t sourceBytes;  // 元のファイルの合計
+        uint64_t packBytes;    // パックのファイルサイズ
+    };
+
+    AssetPack();
+    ~AssetPack();
+
+    bool Open(const std::string& packPath);
+    void Close();
+
+    int FindEntry(const std::string& path) const; // 見つからなければ-1
+    // 非圧縮のエントリのマップした領域（圧縮されていればnullptr）
+    const unsigned char* GetMappedData(int entry) const;
+    // 展開（outは展開後のバイト数以上、jobSystemがあればブロックを並列に展開する）
+    bool Decompress(int entry, unsigned char* out, class JobSystem* jobSystem = nullptr) const;
+    // 読み込む前にOSに先読みを要求する（対応していない環境では何もしない）
+    void Prefetch(int entry) const;
+    // 内容のハッシュを検証する
+    bool Verify(int entry) const;
+
+    // パックの作成（compressがfalseなら全て非圧縮、jobSystemがあればブロックを並列に圧縮する）
+    static bool Write(const std::string& packPath, const std::vector<Source>& sources, bool compress,
+                      uint32_t alignment, class JobSystem* jobSystem, WriteStats* outStats = nullptr);
+    // 内容のハッシュ（FNV-1a 64bit）
+    static uint64_t HashContent(const unsigned char* data, size_t size, uint64_t seed = 14695981039346656037ULL);
+
+    // 圧縮のブロックサイズ
+    static const uint32_t BLOCK_SIZE = 256 * 1024;
+    // 既定のエントリの境界（ページサイズ）
+    static const uint32_t DEFAULT_ALIGNMENT = 4096;
+
+private:
+    bool Map(const std::string& packPath);
+    void Unmap();
+    const unsigned char* GetBlockData(int entry, int block) const;
+
+    // メモリマップ
+    const unsigned char* mData;
+    uint64_t mSize;
+#ifdef _WIN32
+    void* mFileHandle;
+    void* mMappingHandle;
+#else
+    int mFileDescriptor;
+#endif
+
+    std::vector<Entry> mEntries;
+    std::vector<Block> mBlocks;
+    std::vector<uint64_t> mBlockOffsets;        // ブロックのエントリ先頭からの位置
+    std::vector<char> mStrings;                 // 文字列テーブル（null終端で連結）
+    std::unordered_map<std::string, int> mPathIndices; // パス -> エントリ番号
+
+public:
+    bool IsOpen() const { return mData != nullptr; }
+    int GetEntryCount() const { return static_cast<int>(mEntries.size()); }
+    const Entry& GetEntry(int entry) const { return mEntries[entry]; }
+    const char* GetPath(int entry) const { return &mStrings[mEntries[entry].pathOffset]; }
+    uint64_t GetSize() const { return mSize; }
+
+};
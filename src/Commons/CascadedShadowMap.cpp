@@ -0,0 +1,243 @@
+#include "CascadedShadowMap.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include "Shader.h"
+#include "Mesh.h"
+#include "../Actors/Actor.h"
+#include "../Components/MeshComponent.h"
+
+CascadedShadowMap::CascadedShadowMap(int resolution, int cascadeCount)
+:mResolution(resolution)
+,mCascadeCount(std::max(0, std::min(cascadeCount, static_cast<int>(MAX_CASCADES))))
+,mMaxDistance(3000.0f)
+,mSplitLambda(0.75f)
+,mCasterExtension(2000.0f)
+,mTexture(0)
+,mFrameBuffer(0)
+{
+    for (int i = 0; i < MAX_CASCADES; i++)
+    {
+        mCascades[i] = Cascade();
+        mNormalOffsets[i] = 0.0f;
+    }
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{}
+
+bool CascadedShadowMap::Initialize()
+{
+    glGenFramebuffers(1, &mFrameBuffer);
+    return CreateTexture();
+}
+
+void CascadedShadowMap::Shutdown()
+{
+    DeleteTexture();
+    glDeleteFramebuffers(1, &mFrameBuffer);
+    mFrameBuffer = 0;
+}
+
+bool CascadedShadowMap::SetQuality(int resolution, int cascadeCount)
+{
+    mResolution = resolution;
+    mCascadeCount = std::max(0, std::min(cascadeCount, static_cast<int>(MAX_CASCADES)));
+    DeleteTexture();
+    return CreateTexture();
+}
+
+// カスケードの更新
+void CascadedShadowMap::Update(const Matrix4& view, const Matrix4& projection, const Vector3& lightDirection)
+{
+    if (mCascadeCount == 0) return;
+
+    // 射影行列からニア・ファーと画角を求める
+    const Matrix4& p = projection;
+    float nearZ = -p.matrix[2][3] / p.matrix[2][2];
+    float farZ = p.matrix[2][2] * nearZ / (p.matrix[2][2] - 1.0f);
+    farZ = std::min(farZ, mMaxDistance);
+    float tanX = 1.0f / p.matrix[0][0];
+    float tanY = 1.0f / p.matrix[1][1];
+    float diagonal = sqrtf(tanX * tanX + tanY * tanY); // 奥行き1での対角線の半分
+
+    // 光源の向きのみのビュー行列（平行移動を含めないため、カメラが動いても回転しない）
+    Vector3 up = fabsf(Vector3::Normalize(lightDirection).y) > 0.99f ? Math::VEC3_UNIT_X : Math::VEC3_UNIT_Y;
+    mLightView = Matrix4::CreateLookAt(Math::VEC3_ZERO, lightDirection, up);
+    const Matrix4 invView = view.Invert();
+
+    for (int i = 0; i < mCascadeCount; i++)
+    {
+        Cascade& cascade = mCascades[i];
+        // 対数分割と均等分割の混合
+        auto split = [&](int index) {
+            float t = static_cast<float>(index) / mCascadeCount;
+            float logSplit = nearZ * powf(farZ / nearZ, t);
+            float uniformSplit = nearZ + (farZ - nearZ) * t;
+            return mSplitLambda * logSplit + (1.0f - mSplitLambda) * uniformSplit;
+        };
+        cascade.splitNear = split(i);
+        cascade.splitFar = split(i + 1);
+
+        // 分割した視錐台の外接球（中心はビュー空間のZ軸上）
+        // *半径は射影と分割のみで決まるため、カメラの回転で大きさが変わらない
+        float d0 = cascade.splitNear;
+        float d1 = cascade.splitFar;
+        float a = d0 * diagonal;
+        float b = d1 * diagonal;
+        float centerZ = std::min(d1, 0.5f * (d0 + d1) + (b * b - a * a) / (2.0f * (d1 - d0)));
+        float radius = sqrtf(b * b + (d1 - centerZ) * (d1 - centerZ));
+        radius = ceilf(radius * 16.0f) / 16.0f;
+
+        // ワールド座標 -> 光源空間
+        const Matrix4& iv = invView;
+        Vector3 worldCenter(iv.matrix[0][2] * centerZ + iv.matrix[0][3],
+                            iv.matrix[1][2] * centerZ + iv.matrix[1][3],
+                            iv.matrix[2][2] * centerZ + iv.matrix[2][3]);
+        const Matrix4& lv = mLightView;
+        Vector3 center(lv.matrix[0][0]*worldCenter.x + lv.matrix[0][1]*worldCenter.y + lv.matrix[0][2]*worldCenter.z,
+                       lv.matrix[1][0]*worldCenter.x + lv.matrix[1][1]*worldCenter.y + lv.matrix[1][2]*worldCenter.z,
+                       lv.matrix[2][0]*worldCenter.x + lv.matrix[2][1]*worldCenter.y + lv.matrix[2][2]*worldCenter.z);
+
+        // テクセル単位に丸める
+        float texel = 2.0f * radius / mResolution;
+        center.x = floorf(center.x / texel) * texel;
+        center.y = floorf(center.y / texel) * texel;
+
+        cascade.center = center;
+        cascade.radius = radius;
+        cascade.nearZ = center.z - radius - mCasterExtension;
+        cascade.farZ = center.z + radius;
+        cascade.texelWorldSize = texel;
+
+        // 正射影（深度は-1〜1）
+        float depthRange = cascade.farZ - cascade.nearZ;
+        float ortho[4][4] =
+        {
+            { 1.0f/radius, 0.0f,        0.0f,              -center.x/radius },
+            { 0.0f,        1.0f/radius, 0.0f,              -center.y/radius },
+            { 0.0f,        0.0f,        2.0f/depthRange,   -(cascade.farZ + cascade.nearZ)/depthRange },
+            { 0.0f,        0.0f,        0.0f,              1.0f },
+        };
+        cascade.viewProjection = Matrix4(ortho) * mLightView;
+
+        // クリップ座標(-1〜1) -> テクスチャ座標(0〜1)
+        float bias[4][4] =
+        {
+            { 0.5f, 0.0f, 0.0f, 0.5f },
+            { 0.0f, 0.5f, 0.0f, 0.5f },
+            { 0.0f, 0.0f, 0.5f, 0.5f },
+            { 0.0f, 0.0f, 0.0f, 1.0f },
+        };
+        cascade.shadowMatrix = Matrix4(bias) * cascade.viewProjection;
+        mShadowMatrices[i] = cascade.shadowMatrix;
+        // 自己遮蔽を防ぐため、法線方向に1.5テクセルずらして参照する
+        mNormalOffsets[i] = texel * 1.5f;
+    }
+}
+
+// 影の描画
+void CascadedShadowMap::Draw(const std::vector<MeshComponent*>& meshes, Shader* depthShader)
+{
+    for (int i = 0; i < MAX_CASCADES; i++) mCascades[i].casterCount = 0;
+    if (mCascadeCount == 0 || !mTexture) return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffer);
+    glViewport(0, 0, mResolution, mResolution);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    // 傾きに応じた深度バイアス
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.5f, 2.0f);
+    depthShader->SetActive();
+
+    const Matrix4& lv = mLightView;
+    for (int i = 0; i < mCascadeCount; i++)
+    {
+        Cascade& cascade = mCascades[i];
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mTexture, 0, i);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        depthShader->SetViewProjectionUniform(cascade.viewProjection);
+
+        for (auto meshComp : meshes)
+        {
+            Mesh* mesh = meshComp->GetMesh();
+            if (!mesh) continue;
+            // 境界球がカスケードの範囲（光源側は延長）に掛からないものは除外
+            Actor* actor = meshComp->GetActor();
+            const Vector3 pos = actor->GetWorldPosition();
+            const Vector3 scale = actor->GetWorldScale();
+            float radius = mesh->GetRadius() * std::max(scale.x, std::max(scale.y, scale.z));
+            float x = lv.matrix[0][0]*pos.x + lv.matrix[0][1]*pos.y + lv.matrix[0][2]*pos.z;
+            float y = lv.matrix[1][0]*pos.x + lv.matrix[1][1]*pos.y + lv.matrix[1][2]*pos.z;
+            float z = lv.matrix[2][0]*pos.x + lv.matrix[2][1]*pos.y + lv.matrix[2][2]*pos.z;
+            if (fabsf(x - cascade.center.x) > cascade.radius + radius) continue;
+            if (fabsf(y - cascade.center.y) > cascade.radius + radius) continue;
+            if (z - radius > cascade.farZ || z + radius < cascade.nearZ) continue;
+
+            meshComp->DrawDepth(depthShader, cascade.viewProjection);
+            cascade.casterCount++;
+        }
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void CascadedShadowMap::Bind(int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+int CascadedShadowMap::GetCasterCount() const
+{
+    int count = 0;
+    for (int i = 0; i < mCascadeCount; i++) count += mCascades[i].casterCount;
+    return count;
+}
+
+bool CascadedShadowMap::CreateTexture()
+{
+    if (mCascadeCount == 0) return true;
+
+    // 比較モードの深度テクスチャ（線形補間で2x2のPCFがハードウェアで行われる）
+    glGenTextures(1, &mTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, mResolution, mResolution, mCascadeCount,
+                 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // 深度のみのフレームバッファ
+    glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mTexture, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    bool isComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!isComplete)
+    {
+        SDL_Log("Failed create shadow map frame buffer.");
+        DeleteTexture();
+        mCascadeCount = 0;
+        return false;
+    }
+    return true;
+}
+
+void CascadedShadowMap::DeleteTexture()
+{
+    glDeleteTextures(1, &mTexture);
+    mTexture = 0;
+}
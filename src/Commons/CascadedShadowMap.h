@@ -0,0 +1,79 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include "Math.h"
+
+// カスケードシャドウマップクラス（平行光源の影）
+// *視錐台を奥行き方向に分割し、手前ほど高い密度のシャドウマップを割り当てる
+// *各カスケードは分割した視錐台の外接球で覆い、光源空間でテクセル単位に位置を丸める
+//  （カメラが回転・移動しても影の輪郭がちらつかない）
+// *影の描画は位置座標のみの深度シェーダで行い、カスケードごとに範囲外の物体を除外する
+class CascadedShadowMap
+{
+public:
+    static const int MAX_CASCADES = 4; // シェーダのMAX_SHADOW_CASCADESと同じ
+
+    CascadedShadowMap(int resolution, int cascadeCount);
+    ~CascadedShadowMap();
+
+    bool Initialize();
+    void Shutdown();
+
+    // 解像度、カスケード数の変更（テクスチャを作り直す、カスケード数0で影無し）
+    bool SetQuality(int resolution, int cascadeCount);
+
+    // カスケードの範囲、行列の更新
+    void Update(const Matrix4& view, const Matrix4& projection, const Vector3& lightDirection);
+
+    // 影の描画（depthShaderは位置座標のみの頂点シェーダ）
+    void Draw(const std::vector<class MeshComponent*>& meshes, class Shader* depthShader);
+
+    // シャドウマップをバインド
+    void Bind(int unit) const;
+
+private:
+    bool CreateTexture();
+    void DeleteTexture();
+
+    // カスケード
+    struct Cascade
+    {
+        float splitNear;        // ビュー空間の奥行きの範囲
+        float splitFar;
+        Vector3 center;         // 外接球の中心（光源空間、テクセル単位に丸め済）
+        float radius;           // 外接球の半径
+        float nearZ;            // 光源空間の奥行きの範囲（手前は遮蔽物のため延長）
+        float farZ;
+        Matrix4 viewProjection; // 光源のビュー射影行列
+        Matrix4 shadowMatrix;   // ワールド -> シャドウマップ(uv, 深度)
+        float texelWorldSize;   // 1テクセルのワールドでの大きさ
+        int casterCount;        // 描画した遮蔽物数
+    };
+    Cascade mCascades[MAX_CASCADES];
+    Matrix4 mLightView; // 光源の向きのみのビュー行列
+
+    int mResolution;
+    int mCascadeCount;
+    float mMaxDistance;      // 影を描画する最大距離
+    float mSplitLambda;      // 分割の対数・均等の混合比（1で対数）
+    float mCasterExtension;  // 光源側に延長する距離（範囲外の遮蔽物の影も落とす）
+
+    GLuint mTexture;     // 深度テクスチャ配列（カスケードごとのレイヤー）
+    GLuint mFrameBuffer;
+
+    // シェーダ用の配列
+    Matrix4 mShadowMatrices[MAX_CASCADES];
+    float mNormalOffsets[MAX_CASCADES];
+
+public:
+    int GetResolution() const { return mResolution; }
+    int GetCascadeCount() const { return mCascadeCount; }
+    GLuint GetTexture() const { return mTexture; }
+    float GetSplitFar(int cascade) const { return mCascades[cascade].splitFar; }
+    int GetCasterCount() const;
+    const Matrix4* GetShadowMatrices() const { return mShadowMatrices; }
+    const float* GetNormalOffsets() const { return mNormalOffsets; }
+    void SetMaxDistance(float distance) { mMaxDistance = distance; }
+    void SetSplitLambda(float lambda) { mSplitLambda = lambda; }
+
+};
@@ -0,0 +1,344 @@
+#include "ClusteredLighting.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include "JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CLUSTER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const int LIGHT_TEXELS = ClusteredLighting::LIGHT_FLOATS / 4; // 1光源あたりのvec4数
+    const float POINT_LIGHT_CONE = -2.0f; // 点光源の照射角（シェーダで判定）
+
+#ifdef CLUSTER_USE_SSE2
+    // mask ? a : b
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+#endif
+}
+
+ClusteredLighting::ClusteredLighting(int tilesX, int tilesY, int slices)
+:mTilesX(tilesX)
+,mTilesY(tilesY)
+,mSlices(slices)
+,mNear(1.0f)
+,mFar(1000.0f)
+,mXScale(1.0f)
+,mYScale(1.0f)
+,mSliceScale(0.0f)
+,mSliceBias(0.0f)
+,mTileWidth(1.0f)
+,mTileHeight(1.0f)
+,mLightBuffer(0)
+,mLightTexture(0)
+,mGridBuffer(0)
+,mGridTexture(0)
+,mIndexBuffer(0)
+,mIndexTexture(0)
+,mStats()
+{
+    mViewZRow[0] = mViewZRow[1] = mViewZRow[3] = 0.0f;
+    mViewZRow[2] = 1.0f;
+    mClusterLights.resize(mTilesX * mTilesY * mSlices);
+}
+
+ClusteredLighting::~ClusteredLighting()
+{}
+
+bool ClusteredLighting::Initialize()
+{
+    // バッファとテクスチャを関連付けておく（データは毎フレーム再確保）
+    auto createBuffer = [](GLuint& buffer, GLuint& texture, GLenum format, size_t bytes) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    };
+    createBuffer(mLightBuffer, mLightTexture, GL_RGBA32F, sizeof(float) * 4 * LIGHT_TEXELS);
+    createBuffer(mGridBuffer, mGridTexture, GL_RG32UI, sizeof(uint32_t) * 2 * mClusterLights.size());
+    createBuffer(mIndexBuffer, mIndexTexture, GL_R32UI, sizeof(uint32_t));
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    // 光源が無い場合も全クラスタ0件として参照できるようにする
+    mGridData.assign(mClusterLights.size() * 2, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, mGridBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, mGridData.size() * sizeof(uint32_t), mGridData.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    return true;
+}
+
+void ClusteredLighting::Shutdown()
+{
+    GLuint buffers[] = { mLightBuffer, mGridBuffer, mIndexBuffer };
+    GLuint textures[] = { mLightTexture, mGridTexture, mIndexTexture };
+    glDeleteBuffers(3, buffers);
+    glDeleteTextures(3, textures);
+    mLightBuffer = mGridBuffer = mIndexBuffer = 0;
+    mLightTexture = mGridTexture = mIndexTexture = 0;
+}
+
+void ClusteredLighting::Update(const std::vector<Light>& lights,
+                               const Matrix4& view, const Matrix4& projection,
+                               float screenWidth, float screenHeight,
+                               JobSystem* jobSystem)
+{
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+
+    // 射影行列から視錐台パラメータを求める
+    // *m22 = f/(f-n)、m23 = -nf/(f-n)
+    const float m22 = projection.matrix[2][2];
+    const float m23 = projection.matrix[2][3];
+    mNear = -m23 / m22;
+    mFar = mNear + mNear / (m22 - 1.0f);
+    mXScale = projection.matrix[0][0];
+    mYScale = projection.matrix[1][1];
+    // スライス番号 = log(z/near) / log(far/near) * slices
+    mSliceScale = mSlices / logf(mFar / mNear);
+    mSliceBias = -mSliceScale * logf(mNear);
+    for (int i = 0; i < 4; i++) mViewZRow[i] = view.matrix[2][i];
+    mTileWidth = screenWidth / mTilesX;
+    mTileHeight = screenHeight / mTilesY;
+
+    // 光源ごとのクラスタ範囲
+    ComputeLightBounds(lights, view);
+
+    // Zスライスごとに並列で割り当てる（スライス間で書込先が重ならない）
+    auto assign = [this](size_t begin, size_t end) { AssignSlices(begin, end); };
+    if (jobSystem) jobSystem->ParallelFor(mSlices, 1, assign);
+    else assign(0, mSlices);
+
+    // クラスタごとのリストを1つの配列に詰める
+    mGridData.resize(mClusterLights.size() * 2);
+    mIndexData.clear();
+    int maxLights = 0;
+    for (size_t i = 0; i < mClusterLights.size(); i++)
+    {
+        const auto& list = mClusterLights[i];
+        mGridData[i * 2 + 0] = static_cast<uint32_t>(mIndexData.size());
+        mGridData[i * 2 + 1] = static_cast<uint32_t>(list.size());
+        mIndexData.insert(mIndexData.end(), list.begin(), list.end());
+        maxLights = std::max(maxLights, static_cast<int>(list.size()));
+    }
+    Upload(lights);
+
+    mStats.lightCount = static_cast<int>(lights.size());
+    mStats.visibleLightCount = static_cast<int>(mVisibleLights.size());
+    mStats.indexCount = static_cast<int>(mIndexData.size());
+    mStats.maxLightsPerCluster = maxLights;
+    mStats.assignMs = (SDL_GetPerformanceCounter() - startCounter) * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
+void ClusteredLighting::Bind(int firstUnit) const
+{
+    const GLuint textures[] = { mLightTexture, mGridTexture, mIndexTexture };
+    for (int i = 0; i < 3; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+// 光源のビュー空間座標と画面上の範囲を求め、クラスタ範囲に変換する
+void ClusteredLighting::ComputeLightBounds(const std::vector<Light>& lights, const Matrix4& view)
+{
+    // SIMDで4つずつ処理するため端数を切り上げる
+    const size_t count = lights.size();
+    const size_t padded = (count + 3) & ~static_cast<size_t>(3);
+    mViewX.assign(padded, 0.0f);
+    mViewY.assign(padded, 0.0f);
+    mViewZ.assign(padded, 0.0f);
+    mRadius.assign(padded, 0.0f);
+    mNdcMinX.resize(padded);
+    mNdcMaxX.resize(padded);
+    mNdcMinY.resize(padded);
+    mNdcMaxY.resize(padded);
+    for (size_t i = 0; i < count; i++)
+    {
+        // 変換前のワールド座標を一時的に格納
+        mViewX[i] = lights[i].position.x;
+        mViewY[i] = lights[i].position.y;
+        mViewZ[i] = lights[i].position.z;
+        mRadius[i] = lights[i].radius;
+    }
+
+    const float (&m)[4][4] = view.matrix;
+    size_t i = 0;
+#ifdef CLUSTER_USE_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 nearPlane = _mm_set1_ps(mNear);
+    const __m128 xScale = _mm_set1_ps(mXScale);
+    const __m128 yScale = _mm_set1_ps(mYScale);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 plusOne = _mm_set1_ps(1.0f);
+    for (; i < padded; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(&mViewX[i]);
+        __m128 py = _mm_loadu_ps(&mViewY[i]);
+        __m128 pz = _mm_loadu_ps(&mViewZ[i]);
+        __m128 r = _mm_loadu_ps(&mRadius[i]);
+
+        // ビュー変換
+        __m128 vx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][0]), px), _mm_mul_ps(_mm_set1_ps(m[0][1]), py)),
+                               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][2]), pz), _mm_set1_ps(m[0][3])));
+        __m128 vy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[1][0]), px), _mm_mul_ps(_mm_set1_ps(m[1][1]), py)),
+                               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[1][2]), pz), _mm_set1_ps(m[1][3])));
+        __m128 vz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[2][0]), px), _mm_mul_ps(_mm_set1_ps(m[2][1]), py)),
+                               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[2][2]), pz), _mm_set1_ps(m[2][3])));
+        _mm_storeu_ps(&mViewX[i], vx);
+        _mm_storeu_ps(&mViewY[i], vy);
+        _mm_storeu_ps(&mViewZ[i], vz);
+
+        // 球を囲む箱の投影範囲（分子が負なら手前、正なら奥の面で割ると外側になる）
+        __m128 zMin = _mm_sub_ps(vz, r);
+        __m128 zMax = _mm_add_ps(vz, r);
+        __m128 loX = _mm_sub_ps(vx, r);
+        __m128 hiX = _mm_add_ps(vx, r);
+        __m128 loY = _mm_sub_ps(vy, r);
+        __m128 hiY = _mm_add_ps(vy, r);
+        __m128 ndcMinX = _mm_div_ps(_mm_mul_ps(xScale, loX), Select(_mm_cmplt_ps(loX, zero), zMin, zMax));
+        __m128 ndcMaxX = _mm_div_ps(_mm_mul_ps(xScale, hiX), Select(_mm_cmpgt_ps(hiX, zero), zMin, zMax));
+        __m128 ndcMinY = _mm_div_ps(_mm_mul_ps(yScale, loY), Select(_mm_cmplt_ps(loY, zero), zMin, zMax));
+        __m128 ndcMaxY = _mm_div_ps(_mm_mul_ps(yScale, hiY), Select(_mm_cmpgt_ps(hiY, zero), zMin, zMax));
+
+        // 近接面をまたぐ場合は画面全体
+        __m128 crossNear = _mm_cmplt_ps(zMin, nearPlane);
+        _mm_storeu_ps(&mNdcMinX[i], Select(crossNear, minusOne, ndcMinX));
+        _mm_storeu_ps(&mNdcMaxX[i], Select(crossNear, plusOne, ndcMaxX));
+        _mm_storeu_ps(&mNdcMinY[i], Select(crossNear, minusOne, ndcMinY));
+        _mm_storeu_ps(&mNdcMaxY[i], Select(crossNear, plusOne, ndcMaxY));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float px = mViewX[i], py = mViewY[i], pz = mViewZ[i], r = mRadius[i];
+        float vx = m[0][0]*px + m[0][1]*py + m[0][2]*pz + m[0][3];
+        float vy = m[1][0]*px + m[1][1]*py + m[1][2]*pz + m[1][3];
+        float vz = m[2][0]*px + m[2][1]*py + m[2][2]*pz + m[2][3];
+        mViewX[i] = vx;
+        mViewY[i] = vy;
+        mViewZ[i] = vz;
+
+        float zMin = vz - r;
+        float zMax = vz + r;
+        if (zMin < mNear)
+        {
+            mNdcMinX[i] = mNdcMinY[i] = -1.0f;
+            mNdcMaxX[i] = mNdcMaxY[i] = 1.0f;
+            continue;
+        }
+        mNdcMinX[i] = mXScale * (vx - r) / (vx - r < 0.0f ? zMin : zMax);
+        mNdcMaxX[i] = mXScale * (vx + r) / (vx + r > 0.0f ? zMin : zMax);
+        mNdcMinY[i] = mYScale * (vy - r) / (vy - r < 0.0f ? zMin : zMax);
+        mNdcMaxY[i] = mYScale * (vy + r) / (vy + r > 0.0f ? zMin : zMax);
+    }
+
+    // 視錐台外の光源を除き、タイル、スライス番号に変換
+    mVisibleLights.clear();
+    mBounds.clear();
+    auto toTile = [](float ndc, int tiles) {
+        int tile = static_cast<int>(floorf((ndc * 0.5f + 0.5f) * tiles));
+        return std::max(0, std::min(tile, tiles - 1));
+    };
+    for (i = 0; i < count; i++)
+    {
+        float zMin = mViewZ[i] - mRadius[i];
+        float zMax = mViewZ[i] + mRadius[i];
+        if (zMax < mNear || zMin > mFar) continue;
+        if (mNdcMaxX[i] < -1.0f || mNdcMinX[i] > 1.0f) continue;
+        if (mNdcMaxY[i] < -1.0f || mNdcMinY[i] > 1.0f) continue;
+
+        LightBounds bounds;
+        bounds.minX = toTile(mNdcMinX[i], mTilesX);
+        bounds.maxX = toTile(mNdcMaxX[i], mTilesX);
+        bounds.minY = toTile(mNdcMinY[i], mTilesY);
+        bounds.maxY = toTile(mNdcMaxY[i], mTilesY);
+        bounds.minZ = GetSlice(zMin);
+        bounds.maxZ = GetSlice(zMax);
+        mVisibleLights.emplace_back(static_cast<uint32_t>(i));
+        mBounds.emplace_back(bounds);
+    }
+}
+
+// 担当するZスライスのクラスタに光源を割り当てる
+void ClusteredLighting::AssignSlices(size_t beginSlice, size_t endSlice)
+{
+    const int tilesPerSlice = mTilesX * mTilesY;
+    for (size_t slice = beginSlice; slice < endSlice; slice++)
+    {
+        const int z = static_cast<int>(slice);
+        std::vector<uint32_t>* clusters = &mClusterLights[z * tilesPerSlice];
+        for (int c = 0; c < tilesPerSlice; c++) clusters[c].clear();
+
+        for (size_t v = 0; v < mBounds.size(); v++)
+        {
+            const LightBounds& b = mBounds[v];
+            if (z < b.minZ || z > b.maxZ) continue;
+            for (int y = b.minY; y <= b.maxY; y++)
+            {
+                for (int x = b.minX; x <= b.maxX; x++)
+                {
+                    // 視錐台内の光源番号（転送する光源データの並び）
+                    clusters[y * mTilesX + x].emplace_back(static_cast<uint32_t>(v));
+                }
+            }
+        }
+    }
+}
+
+void ClusteredLighting::Upload(const std::vector<Light>& lights)
+{
+    // 視錐台内の光源のみ転送
+    mLightData.resize(std::max<size_t>(mVisibleLights.size(), 1) * LIGHT_FLOATS);
+    for (size_t v = 0; v < mVisibleLights.size(); v++)
+    {
+        PackLight(lights[mVisibleLights[v]], &mLightData[v * LIGHT_FLOATS]);
+    }
+    if (mIndexData.empty()) mIndexData.emplace_back(0);
+
+    // 再確保してから書き込む（前フレームの描画を待たない）
+    auto upload = [](GLuint buffer, const void* data, size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    };
+    upload(mLightBuffer, mLightData.data(), mLightData.size() * sizeof(float));
+    upload(mGridBuffer, mGridData.data(), mGridData.size() * sizeof(uint32_t));
+    upload(mIndexBuffer, mIndexData.data(), mIndexData.size() * sizeof(uint32_t));
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::PackLight(const Light& light, float* outData)
+{
+    // 位置、半径
+    outData[0] = light.position.x;
+    outData[1] = light.position.y;
+    outData[2] = light.position.z;
+    outData[3] = light.radius;
+    // 色、照射角（点光源は範囲外の値）
+    outData[4] = light.color.x;
+    outData[5] = light.color.y;
+    outData[6] = light.color.z;
+    outData[7] = light.type == SPOT ? light.outerCos : POINT_LIGHT_CONE;
+    // 向き、減衰開始角
+    outData[8] = light.direction.x;
+    outData[9] = light.direction.y;
+    outData[10] = light.direction.z;
+    outData[11] = light.innerCos;
+}
+
+int ClusteredLighting::GetSlice(float viewZ) const
+{
+    if (viewZ <= mNear) return 0;
+    int slice = static_cast<int>(logf(viewZ) * mSliceScale + mSliceBias);
+    return std::max(0, std::min(slice, mSlices - 1));
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+
+// クラスタードライティングクラス
+// *視錐台をタイル(X,Y)と指数分割した奥行き(Z)のクラスタに分け、各クラスタに影響する光源をCPUで割り当てる
+// *光源データ、クラスタごとの光源リストはテクスチャバッファでシェーダに渡す（GL3.3のためSSBOは使わない）
+// *シェーダは自身のクラスタの光源だけをループするため、光源数が増えても物体ごとのリストは不要
+class ClusteredLighting
+{
+public:
+    // 光源タイプ
+    enum LightType
+    {
+        POINT, // 点光源
+        SPOT,  // スポットライト
+        LIGHT_TYPE_COUNT
+    };
+
+    // 光源（ワールド座標）
+    struct Light
+    {
+        LightType type;
+        Vector3 position;   // 位置
+        float radius;       // 影響半径（半径で減衰が0になる）
+        Vector3 color;      // 色
+        Vector3 direction;  // 向き（スポットライトのみ）
+        float innerCos;     // 減衰開始角のcos（スポットライトのみ）
+        float outerCos;     // 照射角のcos（スポットライトのみ）
+    };
+
+    // 割当状況
+    struct Stats
+    {
+        int lightCount;         // 光源数
+        int visibleLightCount;  // 視錐台内の光源数
+        int indexCount;         // 光源リストの合計数
+        int maxLightsPerCluster;// クラスタ内の最大光源数
+        float assignMs;         // 割当処理時間
+    };
+
+    ClusteredLighting(int tilesX = 16, int tilesY = 9, int slices = 24);
+    ~ClusteredLighting();
+
+    bool Initialize(); // GLバッファの作成
+    void Shutdown();
+
+    // 光源をクラスタに割り当て、GPUに転送する
+    void Update(const std::vector<Light>& lights,
+                const Matrix4& view, const Matrix4& projection,
+                float screenWidth, float screenHeight,
+                class JobSystem* jobSystem);
+
+    // テクスチャバッファのバインド（firstUnitから3ユニット使用）
+    void Bind(int firstUnit) const;
+
+    // シェーダに渡す光源データ（vec4*3: 位置と半径、色と照射角、向きと減衰開始角）
+    static const int LIGHT_FLOATS = 12;
+    static void PackLight(const Light& light, float* outData);
+
+private:
+    // クラスタに含まれる光源の範囲
+    struct LightBounds
+    {
+        int minX, maxX;
+        int minY, maxY;
+        int minZ, maxZ;
+    };
+
+    void ComputeLightBounds(const std::vector<Light>& lights, const Matrix4& view); // ビュー空間の範囲（SIMD）
+    void AssignSlices(size_t beginSlice, size_t endSlice);  // Zスライス単位の割当（スレッドごと）
+    void Upload(const std::vector<Light>& lights);          // GPUへ転送
+    int GetSlice(float viewZ) const;
+
+    // クラスタ分割数
+    int mTilesX;
+    int mTilesY;
+    int mSlices;
+
+    // 現在のフレームの視錐台パラメータ
+    float mNear;
+    float mFar;
+    float mXScale;
+    float mYScale;
+    float mSliceScale; // log(z) * scale + bias = スライス番号
+    float mSliceBias;
+    float mViewZRow[4]; // ビュー行列のZ行（シェーダで奥行きを求める）
+    float mTileWidth;
+    float mTileHeight;
+
+    // ビュー空間の光源（SoA、SIMDで4つずつ処理）
+    std::vector<float> mViewX;
+    std::vector<float> mViewY;
+    std::vector<float> mViewZ;
+    std::vector<float> mRadius;
+    std::vector<float> mNdcMinX; // 画面上の範囲（正規化デバイス座標）
+    std::vector<float> mNdcMaxX;
+    std::vector<float> mNdcMinY;
+    std::vector<float> mNdcMaxY;
+    std::vector<LightBounds> mBounds;
+    std::vector<uint32_t> mVisibleLights; // 視錐台内の光源番号
+
+    // クラスタごとの光源リスト（容量を使い回す）
+    std::vector<std::vector<uint32_t>> mClusterLights;
+    std::vector<uint32_t> mGridData;   // クラスタごとの(開始位置, 数)
+    std::vector<uint32_t> mIndexData;  // 光源番号リスト
+    std::vector<float> mLightData;     // 光源データ（1光源につきvec4*3）
+
+    // テクスチャバッファ
+    GLuint mLightBuffer;
+    GLuint mLightTexture;
+    GLuint mGridBuffer;
+    GLuint mGridTexture;
+    GLuint mIndexBuffer;
+    GLuint mIndexTexture;
+
+    Stats mStats;
+
+public:
+    const Stats& GetStats() const { return mStats; }
+    int GetTilesX() const { return mTilesX; }
+    int GetTilesY() const { return mTilesY; }
+    int GetSlices() const { return mSlices; }
+    float GetTileWidth() const { return mTileWidth; }
+    float GetTileHeight() const { return mTileHeight; }
+    float GetSliceScale() const { return mSliceScale; }
+    float GetSliceBias() const { return mSliceBias; }
+    const float* GetViewZRow() const { return mViewZRow; }
+
+};
@@ -0,0 +1,281 @@
+#include "DDSFile.h"
+#include <SDL.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "FileSystem.h"
+
+namespace
+{
+    // DDSヘッダ定義
+    const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+    const uint32_t DDSD_CAPS        = 0x1;
+    const uint32_t DDSD_HEIGHT      = 0x2;
+    const uint32_t DDSD_WIDTH       = 0x4;
+    const uint32_t DDSD_PIXELFORMAT = 0x1000;
+    const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    const uint32_t DDSD_LINEARSIZE  = 0x80000;
+    const uint32_t DDPF_FOURCC      = 0x4;
+    const uint32_t DDSCAPS_COMPLEX  = 0x8;
+    const uint32_t DDSCAPS_TEXTURE  = 0x1000;
+    const uint32_t DDSCAPS_MIPMAP   = 0x400000;
+
+    // DX10拡張ヘッダのDXGIフォーマット
+    const uint32_t DXGI_FORMAT_BC1_UNORM = 71;
+    const uint32_t DXGI_FORMAT_BC3_UNORM = 77;
+    const uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+
+    uint32_t MakeFourCC(char a, char b, char c, char d)
+    {
+        return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8)
+             | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+    }
+
+    struct DDSPixelFormat
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t rgbBitCount;
+        uint32_t rBitMask;
+        uint32_t gBitMask;
+        uint32_t bBitMask;
+        uint32_t aBitMask;
+    };
+
+    struct DDSHeader
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        DDSPixelFormat pixelFormat;
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+
+    struct DDSHeaderDX10
+    {
+        uint32_t dxgiFormat;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+
+    // メモリ上のデータを先頭から順に読む
+    struct MemoryReader
+    {
+        const unsigned char* data;
+        size_t size;
+        size_t position;
+
+        bool Read(void* out, size_t bytes)
+        {
+            if (bytes > size - position) return false;
+            std::memcpy(out, data + position, bytes);
+            position += bytes;
+            return true;
+        }
+    };
+}
+
+DDSFile::DDSFile()
+:mFormat(TextureCodec::BC1)
+{}
+
+DDSFile::~DDSFile()
+{}
+
+bool DDSFile::Load(const std::string& filePath)
+{
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        SDL_Log("Failed open dds.");
+        return false;
+    }
+    std::vector<unsigned char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file)
+    {
+        SDL_Log("Failed read dds.");
+        return false;
+    }
+    return Load(data.data(), data.size());
+}
+
+bool DDSFile::Load(const unsigned char* data, size_t size)
+{
+    MemoryReader reader = { data, size, 0 };
+
+    // ヘッダ読込
+    uint32_t magic = 0;
+    DDSHeader header;
+    if (!reader.Read(&magic, sizeof(magic)) || !reader.Read(&header, sizeof(header))
+        || magic != DDS_MAGIC || header.size != sizeof(DDSHeader))
+    {
+        SDL_Log("Invalid dds header.");
+        return false;
+    }
+
+    // フォーマット判定
+    uint32_t fourCC = header.pixelFormat.fourCC;
+    if (!(header.pixelFormat.flags & DDPF_FOURCC))
+    {
+        SDL_Log("Unsupported dds format.");
+        return false;
+    }
+    if (fourCC == MakeFourCC('D', 'X', 'T', '1'))
+    {
+        mFormat = TextureCodec::BC1;
+    }
+    else if (fourCC == MakeFourCC('D', 'X', 'T', '5'))
+    {
+        mFormat = TextureCodec::BC3;
+    }
+    else if (fourCC == MakeFourCC('D', 'X', '1', '0'))
+    {
+        DDSHeaderDX10 headerDX10 = {};
+        if (!reader.Read(&headerDX10, sizeof(headerDX10)))
+        {
+            SDL_Log("Invalid dds header.");
+            return false;
+        }
+        switch (headerDX10.dxgiFormat)
+        {
+            case DXGI_FORMAT_BC1_UNORM: mFormat = TextureCodec::BC1; break;
+            case DXGI_FORMAT_BC3_UNORM: mFormat = TextureCodec::BC3; break;
+            case DXGI_FORMAT_BC7_UNORM: mFormat = TextureCodec::BC7; break;
+            default:
+                SDL_Log("Unsupported dds dxgi format.");
+                return false;
+        }
+    }
+    else
+    {
+        SDL_Log("Unsupported dds fourcc.");
+        return false;
+    }
+
+    // ミップマップ読込
+    int mipCount = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? header.mipMapCount : 1;
+    int width = header.width;
+    int height = header.height;
+    mMips.clear();
+    for (int i = 0; i < mipCount; i++)
+    {
+        TextureCodec::MipLevel mip;
+        mip.width = width;
+        mip.height = height;
+        mip.data.resize(TextureCodec::GetImageBytes(mFormat, width, height));
+        if (!reader.Read(mip.data.data(), mip.data.size()))
+        {
+            SDL_Log("Failed read dds mip level.");
+            return false;
+        }
+        mMips.emplace_back(std::move(mip));
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return true;
+}
+
+bool DDSFile::Save(const std::string& filePath) const
+{
+    if (mMips.empty()) return false;
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        SDL_Log("Failed open dds for write.");
+        return false;
+    }
+
+    // ヘッダ作成
+    DDSHeader header = {};
+    header.size = sizeof(DDSHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+    header.height = GetHeight();
+    header.width = GetWidth();
+    header.pitchOrLinearSize = mMips[0].data.size();
+    header.mipMapCount = mMips.size();
+    header.pixelFormat.size = sizeof(DDSPixelFormat);
+    header.pixelFormat.flags = DDPF_FOURCC;
+    header.caps = DDSCAPS_TEXTURE;
+    if (mMips.size() > 1)
+    {
+        header.flags |= DDSD_MIPMAPCOUNT;
+        header.caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+
+    // BC1/BC3は互換性の高いFourCC、それ以外はDX10拡張ヘッダで出力
+    DDSHeaderDX10 headerDX10 = {};
+    bool useDX10 = false;
+    switch (mFormat)
+    {
+        case TextureCodec::BC1:
+            header.pixelFormat.fourCC = MakeFourCC('D', 'X', 'T', '1');
+            break;
+        case TextureCodec::BC3:
+            header.pixelFormat.fourCC = MakeFourCC('D', 'X', 'T', '5');
+            break;
+        case TextureCodec::BC7:
+            header.pixelFormat.fourCC = MakeFourCC('D', 'X', '1', '0');
+            headerDX10.dxgiFormat = DXGI_FORMAT_BC7_UNORM;
+            headerDX10.resourceDimension = 3; // TEXTURE2D
+            headerDX10.arraySize = 1;
+            useDX10 = true;
+            break;
+        default:
+            SDL_Log("Unsupported dds format for write.");
+            return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (useDX10)
+    {
+        file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+    }
+    for (const auto& mip : mMips)
+    {
+        file.write(reinterpret_cast<const char*>(mip.data.data()), mip.data.size());
+    }
+    return static_cast<bool>(file);
+}
+
+void DDSFile::Create(TextureCodec::Format format, const std::vector<TextureCodec::MipLevel>& rgbaMips)
+{
+    // BC7のエンコードは未対応のためBC1で代替する
+    mFormat = format == TextureCodec::BC3 ? TextureCodec::BC3 : TextureCodec::BC1;
+    mMips.clear();
+    for (const auto& src : rgbaMips)
+    {
+        TextureCodec::MipLevel mip;
+        mip.width = src.width;
+        mip.height = src.height;
+        if (mFormat == TextureCodec::BC3)
+        {
+            TextureCodec::CompressBC3(src.data.data(), src.width, src.height, mip.data);
+        }
+        else
+        {
+            TextureCodec::CompressBC1(src.data.data(), src.width, src.height, mip.data);
+        }
+        mMips.emplace_back(std::move(mip));
+    }
+}
+
+std::string DDSFile::GetCookedPath(const std::string& filePath)
+{
+    return FileSystem::ReplaceExtension(filePath, ".dds");
+}
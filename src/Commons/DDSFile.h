@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "TextureCodec.h"
+
+// DDSファイルクラス
+// *ブロック圧縮テクスチャとミップマップをまとめて読み書きする
+// *DXT1/DXT5のFourCC、およびDX10拡張ヘッダのBC1/BC3/BC7に対応
+class DDSFile
+{
+public:
+    DDSFile();
+    ~DDSFile();
+
+    bool Load(const std::string& filePath);
+    bool Load(const unsigned char* data, size_t size); // メモリ上のファイル（アセットパックなど）
+    bool Save(const std::string& filePath) const;
+
+    // RGBA8画像から圧縮データを作成する
+    void Create(TextureCodec::Format format, const std::vector<TextureCodec::MipLevel>& rgbaMips);
+
+    // 変換済テクスチャのパスを取得（拡張子を.ddsに置き換える）
+    static std::string GetCookedPath(const std::string& filePath);
+
+private:
+    TextureCodec::Format mFormat;                 // ピクセルフォーマット
+    std::vector<TextureCodec::MipLevel> mMips;    // ミップマップ（圧縮済）
+
+public:
+    TextureCodec::Format GetFormat() const { return mFormat; }
+    const std::vector<TextureCodec::MipLevel>& GetMips() const { return mMips; }
+    int GetWidth() const { return mMips.empty() ? 0 : mMips[0].width; }
+    int GetHeight() const { return mMips.empty() ? 0 : mMips[0].height; }
+
+};
@@ -0,0 +1,195 @@
+#include "DeferredShading.h"
+#include <SDL.h>
+#include <cmath>
+#include "Shader.h"
+#include "Renderer.h"
+#include "../Game.h"
+#include "../Actors/Camera.h"
+
+DeferredShading::DeferredShading()
+:mDirLightShader(nullptr)
+,mLightVolumeShader(nullptr)
+,mEmptyVertexArray(0)
+,mSphereVertexArray(0)
+,mSphereVertexBuffer(0)
+,mSphereIndexBuffer(0)
+,mInstanceBuffer(0)
+,mSphereIndexCount(0)
+,mLightVolumeCount(0)
+{}
+
+DeferredShading::~DeferredShading()
+{}
+
+bool DeferredShading::Initialize(Game* game)
+{
+    // ライティング用シェーダ（並列にコンパイル）
+    mDirLightShader = new Shader("Deferred/FullscreenVert.glsl", "Deferred/DirLightFrag.glsl");
+    mLightVolumeShader = new Shader("Deferred/LightVolumeVert.glsl", "Deferred/LightVolumeFrag.glsl");
+    bool success = mDirLightShader->BeginLoad(game) && mLightVolumeShader->BeginLoad(game);
+    success = mDirLightShader->FinishLoad() && success;
+    success = mLightVolumeShader->FinishLoad() && success;
+    if (!success)
+    {
+        SDL_Log("Failed load deferred shaders.");
+        return false;
+    }
+
+    glGenVertexArrays(1, &mEmptyVertexArray);
+    CreateSphere(8, 12);
+    return true;
+}
+
+void DeferredShading::Shutdown()
+{
+    if (mDirLightShader)
+    {
+        mDirLightShader->Unload();
+        delete mDirLightShader;
+        mDirLightShader = nullptr;
+    }
+    if (mLightVolumeShader)
+    {
+        mLightVolumeShader->Unload();
+        delete mLightVolumeShader;
+        mLightVolumeShader = nullptr;
+    }
+
+    GLuint buffers[] = { mSphereVertexBuffer, mSphereIndexBuffer, mInstanceBuffer };
+    glDeleteBuffers(3, buffers);
+    GLuint vertexArrays[] = { mSphereVertexArray, mEmptyVertexArray };
+    glDeleteVertexArrays(2, vertexArrays);
+}
+
+void DeferredShading::DrawLighting(const Renderer* renderer, const std::vector<ClusteredLighting::Light>& lights,
+                                   const GBuffer& gbuffer)
+{
+    const Matrix4 viewProjection = renderer->GetProjectionMatrix() * renderer->GetViewMatrix();
+    const Matrix4 invViewProjection = viewProjection.Invert();
+    const Vector3& cameraPos = renderer->GetCamera()->GetPosition();
+
+    // 深度は参照しない（Gバッファの深度で判定する）
+    // 平行光源、環境光（画面全体）
+    mDirLightShader->SetActive();
+    BindGBuffer(mDirLightShader, gbuffer, invViewProjection);
+    mDirLightShader->SetVectorUniform(mDirLightShader->UNIFORM_CAMERA_POS, cameraPos);
+    mDirLightShader->SetVectorUniform(mDirLightShader->UNIFORM_AMBIENT_COLOR, renderer->GetAmbientLight());
+    mDirLightShader->SetVectorUniform(mDirLightShader->UNIFORM_DIR_LIGHT_DIRECTION, renderer->GetDirLightDirection());
+    mDirLightShader->SetVectorUniform(mDirLightShader->UNIFORM_DIR_LIGHT_DIFFUSE_COLOR, renderer->GetDirLightDiffuseColor());
+    mDirLightShader->SetVectorUniform(mDirLightShader->UNIFORM_DIR_LIGHT_SPEC_COLOR, renderer->GetDirLightSpecColor());
+    mDirLightShader->SetShadowUniform(renderer);
+    glBindVertexArray(mEmptyVertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // 点光源、スポットライト（ライトボリュームを加算合成）
+    mLightVolumeCount = static_cast<int>(lights.size());
+    if (!lights.empty())
+    {
+        mInstanceData.resize(lights.size() * ClusteredLighting::LIGHT_FLOATS);
+        for (size_t i = 0; i < lights.size(); i++)
+        {
+            ClusteredLighting::PackLight(lights[i], &mInstanceData[i * ClusteredLighting::LIGHT_FLOATS]);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, mInstanceData.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, mInstanceData.size() * sizeof(float), mInstanceData.data());
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        // 裏面を描画して、カメラがボリューム内にある場合も1回だけ処理する
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_FRONT);
+
+        mLightVolumeShader->SetActive();
+        BindGBuffer(mLightVolumeShader, gbuffer, invViewProjection);
+        mLightVolumeShader->SetViewProjectionUniform(viewProjection);
+        mLightVolumeShader->SetVectorUniform(mLightVolumeShader->UNIFORM_CAMERA_POS, cameraPos);
+        glUniform2f(glGetUniformLocation(mLightVolumeShader->GetProgram(), "uScreenSize"),
+                    static_cast<float>(gbuffer.width), static_cast<float>(gbuffer.height));
+        glBindVertexArray(mSphereVertexArray);
+        glDrawElementsInstanced(GL_TRIANGLES, mSphereIndexCount, GL_UNSIGNED_INT, nullptr,
+                                static_cast<GLsizei>(lights.size()));
+
+        glCullFace(GL_BACK);
+        glDisable(GL_CULL_FACE);
+        glDisable(GL_BLEND);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+std::vector<Shader*> DeferredShading::GetShaders() const
+{
+    std::vector<Shader*> shaders;
+    if (mDirLightShader) shaders.emplace_back(mDirLightShader);
+    if (mLightVolumeShader) shaders.emplace_back(mLightVolumeShader);
+    return shaders;
+}
+
+void DeferredShading::CreateSphere(int stacks, int slices)
+{
+    // 多面体が球を内包するよう、面の中心までの距離が1になるように拡大する
+    float scale = 1.0f / (cosf(Math::Pi / stacks) * cosf(Math::Pi / slices));
+
+    std::vector<float> vertices;
+    for (int i = 0; i <= stacks; i++)
+    {
+        float phi = Math::Pi * i / stacks;
+        for (int j = 0; j <= slices; j++)
+        {
+            float theta = 2.0f * Math::Pi * j / slices;
+            vertices.emplace_back(sinf(phi) * cosf(theta) * scale);
+            vertices.emplace_back(cosf(phi) * scale);
+            vertices.emplace_back(sinf(phi) * sinf(theta) * scale);
+        }
+    }
+    std::vector<unsigned int> indices;
+    for (int i = 0; i < stacks; i++)
+    {
+        for (int j = 0; j < slices; j++)
+        {
+            unsigned int a = i * (slices + 1) + j;
+            unsigned int b = a + slices + 1;
+            // 外側から見て画面上で反時計回り（左手座標系）
+            indices.insert(indices.end(), { a, b, a + 1, b, b + 1, a + 1 });
+        }
+    }
+    mSphereIndexCount = static_cast<int>(indices.size());
+
+    glGenVertexArrays(1, &mSphereVertexArray);
+    glBindVertexArray(mSphereVertexArray);
+    glGenBuffers(1, &mSphereVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mSphereVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &mSphereIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mSphereIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    // 頂点属性0: 位置(x,y,z)
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0);
+
+    // 頂点属性1〜3: 光源データ（インスタンスごと）
+    glGenBuffers(1, &mInstanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+    for (int i = 0; i < 3; i++)
+    {
+        glEnableVertexAttribArray(1 + i);
+        glVertexAttribPointer(1 + i, 4, GL_FLOAT, GL_FALSE, sizeof(float) * ClusteredLighting::LIGHT_FLOATS,
+                              reinterpret_cast<void*>(sizeof(float) * 4 * i));
+        glVertexAttribDivisor(1 + i, 1);
+    }
+    glBindVertexArray(0);
+}
+
+void DeferredShading::BindGBuffer(Shader* shader, const GBuffer& gbuffer, const Matrix4& invViewProjection)
+{
+    const GLuint textures[] = { gbuffer.albedo, gbuffer.normal, gbuffer.depth };
+    const char* names[] = { "uGAlbedo", "uGNormal", "uGDepth" };
+    for (int i = 0; i < 3; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + GBUFFER_TEXTURE_UNIT + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        shader->SetIntUniform(names[i], GBUFFER_TEXTURE_UNIT + i);
+    }
+    shader->SetMatrixUniform("uInvViewProjection", invViewProjection);
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include "ClusteredLighting.h"
+
+// ディファードシェーディングクラス
+// *ジオメトリパスでアルベド、法線、深度をGバッファ（MRT）に書き込み、
+//  ライティングはスクリーン空間で平行光源パスとライトボリュームで行う
+// *ライティングの計算量が重なり描画の回数ではなく画素数で決まる
+// *Gバッファのテクスチャはフレームグラフの一時テクスチャ（後段のパスと実体を共有する）
+class DeferredShading
+{
+public:
+    // Gバッファ
+    struct GBuffer
+    {
+        GLuint albedo; // RGBA8
+        GLuint normal; // RGBA16F（法線、反射モデル）
+        GLuint depth;  // 深度24bit
+        int width;
+        int height;
+    };
+    static const GLenum ALBEDO_FORMAT = GL_RGBA8;
+    static const GLenum NORMAL_FORMAT = GL_RGBA16F;
+    static const GLenum DEPTH_FORMAT = GL_DEPTH_COMPONENT24;
+
+    DeferredShading();
+    ~DeferredShading();
+
+    bool Initialize(class Game* game);
+    void Shutdown();
+
+    // ライティングパス（現在のフレームバッファに出力、深度テスト・ブレンド無しの状態で呼ぶ）
+    void DrawLighting(const class Renderer* renderer, const std::vector<ClusteredLighting::Light>& lights,
+                      const GBuffer& gbuffer);
+
+    // ホットリロード対象のシェーダ
+    std::vector<class Shader*> GetShaders() const;
+
+    // Gバッファのテクスチャユニット（光源用テクスチャバッファと重ならない位置）
+    static const int GBUFFER_TEXTURE_UNIT = 4;
+
+private:
+    void CreateSphere(int stacks, int slices); // ライトボリューム用の単位球
+    void BindGBuffer(class Shader* shader, const GBuffer& gbuffer, const Matrix4& invViewProjection);
+
+    // ライティング用シェーダ
+    class Shader* mDirLightShader;    // 平行光源、環境光
+    class Shader* mLightVolumeShader; // 点光源、スポットライト
+
+    // 画面全体の描画用（頂点バッファ無し）
+    GLuint mEmptyVertexArray;
+
+    // ライトボリューム（単位球 + 光源ごとのインスタンスデータ）
+    GLuint mSphereVertexArray;
+    GLuint mSphereVertexBuffer;
+    GLuint mSphereIndexBuffer;
+    GLuint mInstanceBuffer;
+    int mSphereIndexCount;
+    std::vector<float> mInstanceData;
+
+    int mLightVolumeCount; // 今フレームのライトボリューム数
+
+public:
+    int GetLightVolumeCount() const { return mLightVolumeCount; }
+
+};
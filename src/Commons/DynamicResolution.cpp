@@ -0,0 +1,115 @@
+#include "DynamicResolution.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution(float budgetMs, float minScale, float maxScale)
+:mQueryIndex(0)
+,mIsEnabled(true)
+,mBudgetMs(budgetMs)
+,mMinScale(minScale)
+,mMaxScale(maxScale)
+,mScale(maxScale)
+,mAverageGpuMs(0.0f)
+,mLastGpuMs(0.0f)
+,mCooldownFrames(0)
+,mChangeCount(0)
+{
+    for (int i = 0; i < QUERY_COUNT; i++)
+    {
+        mBeginQueries[i] = 0;
+        mEndQueries[i] = 0;
+        mIsIssued[i] = false;
+    }
+}
+
+DynamicResolution::~DynamicResolution()
+{}
+
+bool DynamicResolution::Initialize()
+{
+    glGenQueries(QUERY_COUNT, mBeginQueries);
+    glGenQueries(QUERY_COUNT, mEndQueries);
+    return true;
+}
+
+void DynamicResolution::Shutdown()
+{
+    glDeleteQueries(QUERY_COUNT, mBeginQueries);
+    glDeleteQueries(QUERY_COUNT, mEndQueries);
+}
+
+void DynamicResolution::BeginFrame()
+{
+    // これから使うクエリは3フレーム前のもの（結果が出ていれば読む）
+    if (mIsIssued[mQueryIndex])
+    {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(mEndQueries[mQueryIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(mBeginQueries[mQueryIndex], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(mEndQueries[mQueryIndex], GL_QUERY_RESULT, &end);
+            UpdateScale(static_cast<float>((end - begin) / 1.0e6));
+        }
+        // 間に合わなかった結果は捨てる（待つとGPUと同期してしまう）
+        mIsIssued[mQueryIndex] = false;
+    }
+    glQueryCounter(mBeginQueries[mQueryIndex], GL_TIMESTAMP);
+}
+
+void DynamicResolution::EndFrame()
+{
+    glQueryCounter(mEndQueries[mQueryIndex], GL_TIMESTAMP);
+    mIsIssued[mQueryIndex] = true;
+    mQueryIndex = (mQueryIndex + 1) % QUERY_COUNT;
+}
+
+// 倍率の更新
+// *描画時間はおおむね画素数（倍率の2乗）に比例するとして、予算に収まる倍率を求める
+void DynamicResolution::UpdateScale(float gpuMs)
+{
+    mLastGpuMs = gpuMs;
+    mAverageGpuMs = mAverageGpuMs > 0.0f ? mAverageGpuMs * 0.9f + gpuMs * 0.1f : gpuMs;
+    if (!mIsEnabled) return;
+    if (mCooldownFrames > 0)
+    {
+        mCooldownFrames--;
+        return;
+    }
+
+    float target = mScale;
+    if (mAverageGpuMs > mBudgetMs)
+    {
+        // 超過分は一度に下げる（最低1段階）
+        target = std::min(mScale - SCALE_STEP, mScale * sqrtf(mBudgetMs / mAverageGpuMs));
+    }
+    else if (mAverageGpuMs < mBudgetMs * 0.7f)
+    {
+        // 上げる場合は1段階ずつ（上げすぎて超過と往復しないように）
+        target = mScale + SCALE_STEP;
+    }
+    target = floorf(target / SCALE_STEP + 0.5f) * SCALE_STEP;
+    target = std::max(mMinScale, std::min(mMaxScale, target));
+    if (fabsf(target - mScale) < SCALE_STEP * 0.5f) return;
+
+    SDL_Log("dynamic resolution: %.0f%% -> %.0f%% (gpu %.2f ms, budget %.2f ms)",
+            mScale * 100.0f, target * 100.0f, mAverageGpuMs, mBudgetMs);
+    mScale = target;
+    mChangeCount++;
+    mCooldownFrames = COOLDOWN_FRAMES;
+    // 倍率を変えた後の時間で判断し直す
+    mAverageGpuMs = 0.0f;
+}
+
+int DynamicResolution::GetRenderWidth(int outputWidth) const
+{
+    return std::max(1, static_cast<int>(outputWidth * GetScale() + 0.5f));
+}
+
+int DynamicResolution::GetRenderHeight(int outputHeight) const
+{
+    return std::max(1, static_cast<int>(outputHeight * GetScale() + 0.5f));
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <GL/glew.h>
+
+// 動的解像度クラス
+// *GPUのフレーム時間をタイムスタンプのクエリで計測し、予算を超えたら内部解像度を下げ、余裕があれば戻す
+// *クエリの結果は数フレーム遅れて読む（GPUの完了を待たない）
+// *解像度は一定の刻みに丸め、変更後しばらくは変えない（一時テクスチャの作り直しと揺れを抑える）
+class DynamicResolution
+{
+public:
+    DynamicResolution(float budgetMs, float minScale, float maxScale);
+    ~DynamicResolution();
+
+    bool Initialize();
+    void Shutdown();
+
+    // フレームのGPU時間の計測（描画の前後で呼ぶ）
+    void BeginFrame();
+    void EndFrame();
+
+    // 出力の大きさに倍率を掛けた内部解像度
+    int GetRenderWidth(int outputWidth) const;
+    int GetRenderHeight(int outputHeight) const;
+
+private:
+    void UpdateScale(float gpuMs);
+
+    static const int QUERY_COUNT = 3; // 結果を待たないよう3フレーム分を順に使う
+    GLuint mBeginQueries[QUERY_COUNT];
+    GLuint mEndQueries[QUERY_COUNT];
+    bool mIsIssued[QUERY_COUNT];
+    int mQueryIndex;
+
+    bool mIsEnabled;
+    float mBudgetMs;      // GPUのフレーム時間の予算
+    float mMinScale;      // 倍率の範囲（縦横それぞれ）
+    float mMaxScale;
+    float mScale;         // 現在の倍率
+    float mAverageGpuMs;  // GPU時間の移動平均
+    float mLastGpuMs;     // 最後に読んだGPU時間
+    int mCooldownFrames;  // 次に倍率を変えられるまでのフレーム数
+    int mChangeCount;     // 倍率を変えた回数
+
+public:
+    void SetEnabled(bool enable) { mIsEnabled = enable; }
+    bool IsEnabled() const { return mIsEnabled; }
+    void SetBudgetMs(float budgetMs) { mBudgetMs = budgetMs; }
+    float GetBudgetMs() const { return mBudgetMs; }
+    // 無効の場合は最大の倍率
+    float GetScale() const { return mIsEnabled ? mScale : mMaxScale; }
+    float GetAverageGpuMs() const { return mAverageGpuMs; }
+    float GetLastGpuMs() const { return mLastGpuMs; }
+    int GetChangeCount() const { return mChangeCount; }
+
+    static constexpr float SCALE_STEP = 0.05f; // 倍率の刻み
+    static const int COOLDOWN_FRAMES = 30;
+
+};
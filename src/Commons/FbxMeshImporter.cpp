@@ -0,0 +1,490 @@
+#include "FbxMeshImporter.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include "MeshFile.h"
+#include "MeshImport.h"
+
+namespace
+{
+    // ポリゴンのマテリアル番号（ノードのマテリアルの番号）
+    int GetPolygonMaterial(FbxMesh* mesh, int polIndex)
+    {
+        FbxGeometryElementMaterial* element = mesh->GetElementMaterial();
+        if (!element) return 0;
+        FbxLayerElementArrayTemplateInt& indexArray = element->GetIndexArray();
+        switch (element->GetMappingMode())
+        {
+            case FbxGeometryElement::eByPolygon:
+                return polIndex < indexArray.GetCount() ? indexArray.GetAt(polIndex) : 0;
+            case FbxGeometryElement::eAllSame:
+                return indexArray.GetCount() > 0 ? indexArray.GetAt(0) : 0;
+            default:
+                return 0;
+        }
+    }
+
+    // マテリアルの拡散反射のテクスチャ名（無ければ既定のテクスチャ）
+    std::string GetTextureFileName(FbxSurfaceMaterial* material)
+    {
+        if (material)
+        {
+            FbxProperty property = material->FindProperty(FbxSurfaceMaterial::sDiffuse);
+            FbxFileTexture* fileTexture = property.GetSrcObject<FbxFileTexture>(0);
+            if (fileTexture) return std::string(FbxPathUtils::GetFileName(fileTexture->GetFileName()));
+        }
+        return "default_tex.png";
+    }
+
+    // FBXの行列（行ベクトル、平行移動が4行目）を列ベクトルの行列に変換
+    Matrix4 ToMatrix4(const FbxAMatrix& fbxMatrix)
+    {
+        Matrix4 result;
+        for (int i = 0; i < 4; i++)
+        {
+            for (int j = 0; j < 4; j++) result.matrix[i][j] = static_cast<float>(fbxMatrix.Get(j, i));
+        }
+        return result;
+    }
+
+    // メッシュのスキン（無ければnullptr）
+    FbxSkin* GetSkin(FbxMesh* mesh)
+    {
+        if (mesh->GetDeformerCount(FbxDeformer::eSkin) == 0) return nullptr;
+        return static_cast<FbxSkin*>(mesh->GetDeformer(0, FbxDeformer::eSkin));
+    }
+
+    // メモリ上のFBXを読むストリーム（アセットパック内のファイル用）
+    class MemoryStream : public FbxStream
+    {
+    public:
+        MemoryStream(const unsigned char* data, size_t size, int readerId)
+        :mData(data)
+        ,mSize(size)
+        ,mPosition(0)
+        ,mReaderId(readerId)
+        ,mIsOpen(false)
+        {}
+
+        EState GetState() override { return mIsOpen ? eOpen : eClosed; }
+        bool Open(void*) override { mIsOpen = true; mPosition = 0; return true; }
+        bool Close() override { mIsOpen = false; return true; }
+        bool Flush() override { return true; }
+        size_t Write(const void*, FbxUInt64) override { return 0; }
+        size_t Read(void* data, FbxUInt64 size) const override
+        {
+            size_t count = static_cast<size_t>(std::min<FbxUInt64>(size, mSize - mPosition));
+            std::memcpy(data, mData + mPosition, count);
+            mPosition += count;
+            return count;
+        }
+        int GetReaderID() const override { return mReaderId; }
+        int GetWriterID() const override { return -1; }
+        void Seek(const FbxInt64& offset, const FbxFile::ESeekPos& seekPos) override
+        {
+            FbxInt64 base = 0;
+            if (seekPos == FbxFile::eCurrent) base = static_cast<FbxInt64>(mPosition);
+            else if (seekPos == FbxFile::eEnd) base = static_cast<FbxInt64>(mSize);
+            SetPosition(base + offset);
+        }
+        FbxInt64 GetPosition() const override { return static_cast<FbxInt64>(mPosition); }
+        void SetPosition(FbxInt64 position) override
+        {
+            mPosition = static_cast<size_t>(std::max<FbxInt64>(0, std::min<FbxInt64>(position, mSize)));
+        }
+        int GetError() const override { return 0; }
+        void ClearError() override {}
+
+    private:
+        const unsigned char* mData;
+        size_t mSize;
+        mutable size_t mPosition; // Readがconstのため
+        int mReaderId;
+        bool mIsOpen;
+    };
+}
+
+FbxMeshImporter::FbxMeshImporter()
+{}
+
+FbxMeshImporter::~FbxMeshImporter()
+{}
+
+bool FbxMeshImporter::Import(const std::string& filePath, const unsigned char* data, size_t size, MeshFile& outMeshFile)
+{
+    outMeshFile.Clear();
+    mJointNodes.clear();
+
+    // マネージャーの初期化
+    FbxManager* manager = FbxManager::Create();
+
+    // インポーターの初期化
+    // メモリ上にあればストリームから読み込む（無ければSDKが直接開く）
+    const int readerId = manager->GetIOPluginRegistry()->FindReaderIDByExtension("fbx");
+    MemoryStream stream(data, size, readerId);
+    FbxImporter* importer = FbxImporter::Create(manager, "");
+    const bool isInitialized = data
+        ? importer->Initialize(&stream, nullptr, readerId, manager->GetIOSettings())
+        : importer->Initialize(filePath.c_str(), -1, manager->GetIOSettings());
+    if (!isInitialized)
+    {
+        SDL_Log("failed fbx initialize importer. (%s)", filePath.c_str());
+        manager->Destroy();
+        return false;
+    }
+
+    // シーンの作成
+    FbxScene* scene = FbxScene::Create(manager, "");
+    importer->Import(scene);
+    importer->Destroy();
+
+    // 三角ポリゴンへのコンバート
+    FbxGeometryConverter geometryConverter(manager);
+    if (!geometryConverter.Triangulate(scene, true))
+    {
+        SDL_Log("failed fbx convert triangle. (%s)", filePath.c_str());
+        manager->Destroy();
+        return false;
+    }
+
+    // メッシュ取得
+    int meshCount = scene->GetSrcObjectCount<FbxMesh>();
+    if (meshCount == 0)
+    {
+        SDL_Log("failed fbx scene get mesh. (%s)", filePath.c_str());
+        manager->Destroy();
+        return false;
+    }
+
+    // 全てのメッシュの頂点を1つの配列に、インデックスをマテリアルごとの配列に読み込む
+    // *最初のメッシュのノードを基準とし、以降のメッシュはノードの位置関係を保って変換する
+    FbxNode* baseNode = scene->GetSrcObject<FbxMesh>(0)->GetNode();
+    FbxAMatrix baseGlobal;
+    if (baseNode) baseGlobal = baseNode->EvaluateGlobalTransform();
+    FbxAMatrix baseInverse = baseGlobal.Inverse();
+    LoadSkeleton(scene, baseGlobal, outMeshFile);
+    std::vector<float>& vertexData = outMeshFile.mVertices;   // 位置、法線、UV座標の8要素ずつ
+    std::vector<unsigned char>& skinData = outMeshFile.mSkins; // ボーン番号、重みの8バイトずつ（スキンがある場合）
+    std::vector<FbxSurfaceMaterial*> fbxMaterials;             // マテリアル表の元（nullptrはマテリアル無し）
+    std::vector<std::vector<unsigned int>> materialIndices;    // マテリアルごとのインデックス
+    for (int meshIndex = 0; meshIndex < meshCount; meshIndex++)
+    {
+        FbxMesh* mesh = scene->GetSrcObject<FbxMesh>(meshIndex);
+        FbxNode* node = mesh->GetNode();
+        bool isTransformed = meshIndex > 0 && baseNode && node;
+        FbxAMatrix transform;
+        if (isTransformed) transform = baseInverse * node->EvaluateGlobalTransform();
+
+        // UVセット名の取得
+        FbxStringList uvSetNameList;
+        mesh->GetUVSetNames(uvSetNameList);
+        const char* uvSetName = uvSetNameList.GetCount() > 0 ? uvSetNameList.GetStringAt(0) : nullptr;
+
+        // 位置座標の読込
+        std::vector<float> controlPoints;
+        for (int i = 0; i < mesh->GetControlPointsCount(); i++)
+        {
+            FbxVector4 point = mesh->GetControlPointAt(i);
+            if (isTransformed) point = transform.MultT(point);
+            controlPoints.push_back(point[0]);
+            controlPoints.push_back(point[1]);
+            controlPoints.push_back(point[2]);
+        }
+
+        // ポリゴンの頂点ごとの法線、UV座標の読込
+        std::vector<MeshImport::PolygonVertex> polygonVertices;
+        int polCount = mesh->GetPolygonCount();
+        for (int polIndex = 0; polIndex < polCount; polIndex++)
+        {
+            int polVertexCount = mesh->GetPolygonSize(polIndex);
+            for (int polVertexIndex = 0; polVertexIndex < polVertexCount; polVertexIndex++)
+            {
+                MeshImport::PolygonVertex polygonVertex;
+                polygonVertex.controlPoint = mesh->GetPolygonVertex(polIndex, polVertexIndex);
+
+                // 法線座標の取得（回転のみ適用する）
+                FbxVector4 normalVec4;
+                mesh->GetPolygonVertexNormal(polIndex, polVertexIndex, normalVec4);
+                if (isTransformed) normalVec4 = transform.MultR(normalVec4);
+                polygonVertex.normal[0] = normalVec4[0];
+                polygonVertex.normal[1] = normalVec4[1];
+                polygonVertex.normal[2] = normalVec4[2];
+
+                // UV座標の取得
+                FbxVector2 uvVec2;
+                uvVec2[0] = 0.0;
+                uvVec2[1] = 0.0;
+                bool isUnMapped;
+                if (uvSetName) mesh->GetPolygonVertexUV(polIndex, polVertexIndex, uvSetName, uvVec2, isUnMapped);
+                polygonVertex.uv[0] = uvVec2[0];
+                polygonVertex.uv[1] = uvVec2[1];
+                polygonVertices.push_back(polygonVertex);
+            }
+        }
+
+        // 法線、UV座標の異なる頂点を分割
+        std::vector<std::vector<float>> vertexList;
+        std::vector<int> vertexIndexList;
+        MeshImport::SplitVertices(controlPoints, polygonVertices, vertexList, vertexIndexList);
+
+        // 頂点の追加（ポリゴンから参照されない位置は法線、UV座標を0とする）
+        unsigned int baseVertex = static_cast<unsigned int>(vertexData.size() / MeshFile::VERTEX_FLOATS);
+        for (auto& vertex : vertexList)
+        {
+            vertex.resize(MeshFile::VERTEX_FLOATS, 0.0f);
+            vertex[7] = -vertex[7]; // V座標は反転させる
+            vertexData.insert(vertexData.end(), vertex.begin(), vertex.end());
+        }
+
+        // 頂点のボーン番号、重み（分割した頂点は元の制御点の値を使う）
+        if (outMeshFile.HasSkin())
+        {
+            std::vector<unsigned char> weights;
+            LoadSkinWeights(mesh, weights);
+            std::vector<int> vertexControlPoints(vertexList.size());
+            for (size_t i = 0; i < vertexControlPoints.size(); i++) vertexControlPoints[i] = static_cast<int>(i);
+            for (size_t i = 0; i < polygonVertices.size(); i++)
+            {
+                vertexControlPoints[vertexIndexList[i]] = polygonVertices[i].controlPoint;
+            }
+            for (int controlPoint : vertexControlPoints)
+            {
+                const unsigned char* weight = &weights[controlPoint * MeshFile::SKIN_BYTES];
+                skinData.insert(skinData.end(), weight, weight + MeshFile::SKIN_BYTES);
+            }
+        }
+
+        // ポリゴンをマテリアルごとのインデックスに振り分ける
+        int polVertexOffset = 0;
+        for (int polIndex = 0; polIndex < polCount; polIndex++)
+        {
+            int polVertexCount = mesh->GetPolygonSize(polIndex);
+            FbxSurfaceMaterial* fbxMaterial = node ? node->GetMaterial(GetPolygonMaterial(mesh, polIndex)) : nullptr;
+            auto iter = std::find(fbxMaterials.begin(), fbxMaterials.end(), fbxMaterial);
+            size_t material = iter - fbxMaterials.begin();
+            if (iter == fbxMaterials.end())
+            {
+                fbxMaterials.emplace_back(fbxMaterial);
+                materialIndices.emplace_back();
+            }
+            // 三角形分割済だが、多角形が残っていても扇状に分割する
+            auto& indices = materialIndices[material];
+            for (int i = 1; i + 1 < polVertexCount; i++)
+            {
+                indices.push_back(baseVertex + vertexIndexList[polVertexOffset]);
+                indices.push_back(baseVertex + vertexIndexList[polVertexOffset + i]);
+                indices.push_back(baseVertex + vertexIndexList[polVertexOffset + i + 1]);
+            }
+            polVertexOffset += polVertexCount;
+        }
+    }
+
+    // マテリアル表の作成（テクスチャはファイル名のみ）
+    for (auto fbxMaterial : fbxMaterials)
+    {
+        MeshFile::Material material;
+        material.name = fbxMaterial ? fbxMaterial->GetName() : "default";
+        material.textureFileName = GetTextureFileName(fbxMaterial);
+        outMeshFile.mMaterials.emplace_back(material);
+    }
+
+    // インデックスをマテリアルの番号順に並べ、それぞれをサブメッシュとする
+    for (size_t material = 0; material < materialIndices.size(); material++)
+    {
+        const auto& indices = materialIndices[material];
+        if (indices.empty()) continue;
+        MeshFile::SubMesh subMesh;
+        subMesh.firstIndex = static_cast<uint32_t>(outMeshFile.mIndices.size());
+        subMesh.indexCount = static_cast<uint32_t>(indices.size());
+        subMesh.material = static_cast<uint32_t>(material);
+        outMeshFile.mIndices.insert(outMeshFile.mIndices.end(), indices.begin(), indices.end());
+        outMeshFile.mSubMeshes.emplace_back(subMesh);
+    }
+
+    // アニメーションスタックの読込
+    if (outMeshFile.HasSkin()) LoadAnimations(scene, baseInverse, outMeshFile);
+
+    // マネージャー、シーンの破棄
+    scene->Destroy();
+    manager->Destroy();
+
+    return true;
+}
+
+// スケルトンの読込
+// *スキンのクラスタのリンク先と、その祖先のノードを関節とする（親を先に追加する）
+// *関節のモデル座標は基準のノードからの相対とするため、バインド時の逆行列に基準のノードの行列を掛けておく
+//  （バインド時のポーズでは全ての関節のパレットが単位行列になる）
+void FbxMeshImporter::LoadSkeleton(FbxScene* scene, const FbxAMatrix& baseGlobal, MeshFile& outMeshFile)
+{
+    auto& joints = outMeshFile.mJoints;
+    std::vector<FbxAMatrix> bindPoses; // 関節のバインド時のグローバル行列
+    FbxNode* rootNode = scene->GetRootNode();
+    std::function<int(FbxNode*)> addJoint = [&](FbxNode* node) {
+        auto iter = std::find(mJointNodes.begin(), mJointNodes.end(), node);
+        if (iter != mJointNodes.end()) return static_cast<int>(iter - mJointNodes.begin());
+        FbxNode* parentNode = node->GetParent();
+        int parent = parentNode && parentNode != rootNode ? addJoint(parentNode) : -1;
+        mJointNodes.emplace_back(node);
+        bindPoses.emplace_back(node->EvaluateGlobalTransform());
+        MeshFile::Joint joint;
+        joint.name = node->GetName();
+        joint.parent = parent;
+        joints.emplace_back(joint);
+        return static_cast<int>(joints.size()) - 1;
+    };
+
+    int meshCount = scene->GetSrcObjectCount<FbxMesh>();
+    for (int meshIndex = 0; meshIndex < meshCount; meshIndex++)
+    {
+        FbxSkin* skin = GetSkin(scene->GetSrcObject<FbxMesh>(meshIndex));
+        if (!skin) continue;
+        for (int i = 0; i < skin->GetClusterCount(); i++)
+        {
+            FbxCluster* cluster = skin->GetCluster(i);
+            if (!cluster->GetLink()) continue;
+            int joint = addJoint(cluster->GetLink());
+            // クラスタのバインド時の行列を優先する
+            cluster->GetTransformLinkMatrix(bindPoses[joint]);
+        }
+    }
+    if (joints.empty()) return;
+
+    // スキンの無いメッシュのための動かない関節
+    mJointNodes.emplace_back(nullptr);
+    bindPoses.emplace_back(baseGlobal);
+    MeshFile::Joint rigidJoint;
+    rigidJoint.parent = -1;
+    joints.emplace_back(rigidJoint);
+    if (static_cast<int>(joints.size()) > MAX_JOINTS)
+    {
+        SDL_Log("skeleton has too many joints (%d), skin ignored.", static_cast<int>(joints.size()));
+        joints.clear();
+        mJointNodes.clear();
+        return;
+    }
+    for (size_t joint = 0; joint < joints.size(); joint++)
+    {
+        joints[joint].inverseBindPose = ToMatrix4(bindPoses[joint].Inverse() * baseGlobal);
+    }
+}
+
+// 制御点ごとのボーン番号、重みの読込
+// *重みの大きい4つを残して合計が255になるよう量子化する
+void FbxMeshImporter::LoadSkinWeights(FbxMesh* mesh, std::vector<unsigned char>& outWeights) const
+{
+    const int controlPointCount = mesh->GetControlPointsCount();
+    std::vector<std::vector<std::pair<float, int>>> influences(controlPointCount); // (重み, 関節)
+    FbxSkin* skin = GetSkin(mesh);
+    if (skin)
+    {
+        for (int i = 0; i < skin->GetClusterCount(); i++)
+        {
+            FbxCluster* cluster = skin->GetCluster(i);
+            auto iter = std::find(mJointNodes.begin(), mJointNodes.end(), cluster->GetLink());
+            if (!cluster->GetLink() || iter == mJointNodes.end()) continue;
+            int joint = static_cast<int>(iter - mJointNodes.begin());
+            const int* indices = cluster->GetControlPointIndices();
+            const double* weights = cluster->GetControlPointWeights();
+            for (int j = 0; j < cluster->GetControlPointIndicesCount(); j++)
+            {
+                if (indices[j] < controlPointCount && weights[j] > 0.0)
+                {
+                    influences[indices[j]].emplace_back(static_cast<float>(weights[j]), joint);
+                }
+            }
+        }
+    }
+
+    // スキンの無い、または重みの無い制御点はノードか祖先の関節に固定する
+    int rigidJoint = static_cast<int>(mJointNodes.size()) - 1;
+    for (FbxNode* node = mesh->GetNode(); node; node = node->GetParent())
+    {
+        auto iter = std::find(mJointNodes.begin(), mJointNodes.end(), node);
+        if (iter != mJointNodes.end())
+        {
+            rigidJoint = static_cast<int>(iter - mJointNodes.begin());
+            break;
+        }
+    }
+
+    outWeights.assign(controlPointCount * MeshFile::SKIN_BYTES, 0);
+    for (int controlPoint = 0; controlPoint < controlPointCount; controlPoint++)
+    {
+        auto& influence = influences[controlPoint];
+        unsigned char* out = &outWeights[controlPoint * MeshFile::SKIN_BYTES];
+        if (influence.empty())
+        {
+            out[0] = static_cast<unsigned char>(rigidJoint);
+            out[4] = 255;
+            continue;
+        }
+        std::sort(influence.begin(), influence.end(), std::greater<std::pair<float, int>>());
+        if (influence.size() > 4) influence.resize(4);
+        float total = 0.0f;
+        for (const auto& pair : influence) total += pair.first;
+        int quantizedTotal = 0;
+        for (size_t i = 0; i < influence.size(); i++)
+        {
+            out[i] = static_cast<unsigned char>(influence[i].second);
+            out[4 + i] = static_cast<unsigned char>(lroundf(influence[i].first / total * 255.0f));
+            quantizedTotal += out[4 + i];
+        }
+        // 丸めの誤差は最も重みの大きいボーンで吸収する
+        out[4] = static_cast<unsigned char>(std::max(0, std::min(255, out[4] + 255 - quantizedTotal)));
+    }
+}
+
+// アニメーションスタックの読込
+// *一定間隔で関節のローカル変換をサンプリングする（量子化はクリップの作成時に行う）
+//  親の無い関節は基準のノードからの相対の変換とする
+void FbxMeshImporter::LoadAnimations(FbxScene* scene, const FbxAMatrix& baseInverse, MeshFile& outMeshFile)
+{
+    const int jointCount = static_cast<int>(mJointNodes.size());
+    int stackCount = scene->GetSrcObjectCount<FbxAnimStack>();
+    for (int stackIndex = 0; stackIndex < stackCount; stackIndex++)
+    {
+        FbxAnimStack* stack = scene->GetSrcObject<FbxAnimStack>(stackIndex);
+        scene->SetCurrentAnimationStack(stack);
+        FbxTimeSpan span = stack->GetLocalTimeSpan();
+        double start = span.GetStart().GetSecondDouble();
+        double stop = span.GetStop().GetSecondDouble();
+        int frameCount = std::max(2, static_cast<int>(std::ceil((stop - start) * ANIMATION_SAMPLE_RATE)) + 1);
+
+        MeshFile::Animation animation;
+        animation.name = stack->GetName();
+        animation.frameCount = frameCount;
+        animation.sampleRate = ANIMATION_SAMPLE_RATE;
+        animation.keys.resize(static_cast<size_t>(frameCount) * jointCount);
+        for (int frame = 0; frame < frameCount; frame++)
+        {
+            FbxTime time;
+            time.SetSecondDouble(std::min(stop, start + frame / static_cast<double>(ANIMATION_SAMPLE_RATE)));
+            for (int joint = 0; joint < jointCount; joint++)
+            {
+                AnimationClip::Key& key = animation.keys[static_cast<size_t>(frame) * jointCount + joint];
+                FbxNode* node = mJointNodes[joint];
+                if (!node)
+                {
+                    key.translation = Math::VEC3_ZERO;
+                    key.scale = Vector3(1.0f, 1.0f, 1.0f);
+                    continue;
+                }
+                FbxAMatrix local = outMeshFile.mJoints[joint].parent < 0
+                                 ? baseInverse * node->EvaluateGlobalTransform(time)
+                                 : node->EvaluateLocalTransform(time);
+                FbxVector4 translation = local.GetT();
+                FbxQuaternion rotation = local.GetQ();
+                FbxVector4 scale = local.GetS();
+                key.rotation = Quaternion(static_cast<float>(rotation[0]), static_cast<float>(rotation[1]),
+                                          static_cast<float>(rotation[2]), static_cast<float>(rotation[3]));
+                key.translation = Vector3(static_cast<float>(translation[0]), static_cast<float>(translation[1]),
+                                          static_cast<float>(translation[2]));
+                key.scale = Vector3(static_cast<float>(scale[0]), static_cast<float>(scale[1]), static_cast<float>(scale[2]));
+            }
+        }
+        outMeshFile.mAnimations.emplace_back(animation);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fbxsdk.h>
+
+// FBXメッシュ読込クラス
+// *FBXファイル内の全てのメッシュを読み込み、1つの頂点・インデックスの範囲にまとめてMeshFileを作成する
+//  2つ目以降のメッシュは最初のメッシュのノードからの相対位置に変換する（メッシュが1つなら従来と同じ座標）
+// *ポリゴンのマテリアルごとにインデックスを並べ、マテリアル1つにつきサブメッシュを1つ作る
+// *スキンを持つメッシュがあれば、スケルトン、頂点ごとの4ボーンの重み、アニメーションスタックも読み込む
+//  スキンの無いメッシュは自身のノードか祖先の関節に固定する（関節の無いメッシュは動かない関節に割り当てる）
+// *GLを使わないため、ゲーム（変換済メッシュが無い場合）と変換ツールの両方から使う
+// *読込ごとにFBXマネージャーを作成するため、別のインスタンスなら複数のスレッドで同時に読み込める
+class FbxMeshImporter
+{
+public:
+    FbxMeshImporter();
+    ~FbxMeshImporter();
+
+    // 読込（dataがnullptrならファイルを直接開き、あればメモリ上のFBXを読む）
+    bool Import(const std::string& filePath, const unsigned char* data, size_t size, class MeshFile& outMeshFile);
+
+    // アニメーションのサンプリング間隔（1秒あたりのフレーム数）
+    static constexpr float ANIMATION_SAMPLE_RATE = 30.0f;
+    // スキンの関節数の上限（Shader::MAX_SKIN_BONESと同じ、頂点のボーン番号は8bit）
+    static const int MAX_JOINTS = 256;
+
+private:
+    // スキン、アニメーションの読込（座標は最初のメッシュのノードを基準とする）
+    void LoadSkeleton(FbxScene* scene, const FbxAMatrix& baseGlobal, class MeshFile& outMeshFile);
+    // 制御点ごとのボーン番号4つと重み4つ（8バイトずつ）
+    void LoadSkinWeights(FbxMesh* mesh, std::vector<unsigned char>& outWeights) const;
+    void LoadAnimations(FbxScene* scene, const FbxAMatrix& baseInverse, class MeshFile& outMeshFile);
+
+    std::vector<FbxNode*> mJointNodes; // 関節のノード（nullptrは動かない関節）
+
+};
@@ -0,0 +1,267 @@
+#include "FileSystem.h"
+#include <SDL.h>
+#include <algorithm>
+#include <fstream>
+#include <sys/stat.h>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <dirent.h>
+#endif
+#include "AssetPack.h"
+#include "JobSystem.h"
+
+namespace
+{
+    void ListFilesRecursive(const std::string& rootPath, const std::string& relativePath,
+                            std::vector<std::string>& outPaths)
+    {
+        const std::string dirPath = rootPath + relativePath;
+#ifdef _WIN32
+        WIN32_FIND_DATAA data;
+        HANDLE handle = FindFirstFileA((dirPath + "*").c_str(), &data);
+        if (handle == INVALID_HANDLE_VALUE) return;
+        do
+        {
+            const std::string name = data.cFileName;
+            if (name == "." || name == "..") continue;
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            {
+                ListFilesRecursive(rootPath, relativePath + name + "/", outPaths);
+            }
+            else
+            {
+                outPaths.emplace_back(relativePath + name);
+            }
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+#else
+        DIR* dir = opendir(dirPath.c_str());
+        if (!dir) return;
+        while (dirent* entry = readdir(dir))
+        {
+            const std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            struct stat status;
+            if (stat((dirPath + name).c_str(), &status) != 0) continue;
+            if (S_ISDIR(status.st_mode))
+            {
+                ListFilesRecursive(rootPath, relativePath + name + "/", outPaths);
+            }
+            else if (S_ISREG(status.st_mode))
+            {
+                outPaths.emplace_back(relativePath + name);
+            }
+        }
+        closedir(dir);
+#endif
+    }
+}
+
+FileSystem::FileSystem()
+#ifdef NDEBUG
+:mIsLooseOverride(false)
+#else
+:mIsLooseOverride(true)
+#endif
+,mPackReadCount(0)
+,mMappedReadCount(0)
+,mLooseReadCount(0)
+,mDecompressedBytes(0)
+{}
+
+FileSystem::~FileSystem()
+{
+    UnmountAll();
+}
+
+bool FileSystem::Mount(const std::string& packPath, const std::string& mountPoint)
+{
+    AssetPack* pack = new AssetPack();
+    if (!pack->Open(packPath))
+    {
+        delete pack;
+        return false;
+    }
+    MountPoint point;
+    point.path = NormalizePath(mountPoint);
+    point.pack = pack;
+    uint64_t packSize = 0;
+    point.packTime = 0;
+    GetFileStatus(packPath, packSize, point.packTime);
+    mMountPoints.emplace_back(point);
+    SDL_Log("mounted asset pack: %s -> %s (%d entries, %.2f MB)", packPath.c_str(), mountPoint.c_str(),
+            pack->GetEntryCount(), pack->GetSize() / (1024.0f * 1024.0f));
+    return true;
+}
+
+void FileSystem::UnmountAll()
+{
+    for (auto& point : mMountPoints) delete point.pack;
+    mMountPoints.clear();
+}
+
+bool FileSystem::FindEntry(const std::string& path, const AssetPack*& outPack, int& outEntry) const
+{
+    if (mMountPoints.empty()) return false;
+    const std::string normalized = NormalizePath(path);
+    for (auto iter = mMountPoints.rbegin(); iter != mMountPoints.rend(); ++iter)
+    {
+        if (normalized.compare(0, iter->path.size(), iter->path) != 0) continue;
+        int entry = iter->pack->FindEntry(normalized.substr(iter->path.size()));
+        if (entry < 0) continue;
+        // パックより後に更新された個別のファイルがあれば、そちらを読ませる
+        uint64_t looseSize = 0;
+        int64_t looseTime = 0;
+        if (mIsLooseOverride && GetFileStatus(path, looseSize, looseTime) && looseTime > iter->packTime) return false;
+        outPack = iter->pack;
+        outEntry = entry;
+        return true;
+    }
+    return false;
+}
+
+// ファイルの読込
+// *パックの非圧縮のエントリはマップした領域を指すだけ、圧縮されていれば展開する
+bool FileSystem::ReadFile(const std::string& path, File& outFile, JobSystem* jobSystem) const
+{
+    const AssetPack* pack = nullptr;
+    int entry = -1;
+    if (!FindEntry(path, pack, entry))
+    {
+        if (!ReadLooseFile(path, outFile)) return false;
+        mLooseReadCount++;
+        return true;
+    }
+
+    mPackReadCount++;
+    outFile.mBuffer.clear();
+    outFile.mSize = static_cast<size_t>(pack->GetEntry(entry).size);
+    outFile.mData = pack->GetMappedData(entry);
+    if (outFile.mData)
+    {
+        mMappedReadCount++;
+        return true;
+    }
+    outFile.mBuffer.resize(outFile.mSize);
+    if (!pack->Decompress(entry, outFile.mBuffer.data(), jobSystem))
+    {
+        SDL_Log("Failed decompress asset pack entry. (%s)", path.c_str());
+        outFile.mBuffer.clear();
+        outFile.mSize = 0;
+        return false;
+    }
+    outFile.mData = outFile.mBuffer.data();
+    mDecompressedBytes += outFile.mSize;
+    return true;
+}
+
+bool FileSystem::ReadText(const std::string& path, std::string& outText) const
+{
+    File file;
+    if (!ReadFile(path, file)) return false;
+    outText.assign(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+    return true;
+}
+
+bool FileSystem::Exists(const std::string& path) const
+{
+    if (IsPacked(path)) return true;
+    std::ifstream file(path, std::ios::binary);
+    return file.is_open();
+}
+
+bool FileSystem::IsPacked(const std::string& path) const
+{
+    const AssetPack* pack = nullptr;
+    int entry = -1;
+    return FindEntry(path, pack, entry);
+}
+
+void FileSystem::Prefetch(const std::string& path) const
+{
+    const AssetPack* pack = nullptr;
+    int entry = -1;
+    if (FindEntry(path, pack, entry)) pack->Prefetch(entry);
+}
+
+bool FileSystem::ReadLooseFile(const std::string& filePath, File& outFile)
+{
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    outFile.mBuffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(outFile.mBuffer.data()), outFile.mBuffer.size());
+    if (!file) return false;
+    outFile.mData = outFile.mBuffer.data();
+    outFile.mSize = outFile.mBuffer.size();
+    return true;
+}
+
+void FileSystem::ListFiles(const std::string& rootPath, std::vector<std::string>& outPaths)
+{
+    outPaths.clear();
+    std::string root = NormalizePath(rootPath);
+    if (!root.empty() && root.back() != '/') root += '/';
+    ListFilesRecursive(root, "", outPaths);
+    std::sort(outPaths.begin(), outPaths.end());
+}
+
+bool FileSystem::GetFileStatus(const std::string& filePath, uint64_t& outSize, int64_t& outModifiedTime)
+{
+#ifdef _WIN32
+    struct _stat64 status;
+    if (_stat64(filePath.c_str(), &status) != 0) return false;
+#else
+    struct stat status;
+    if (stat(filePath.c_str(), &status) != 0) return false;
+#endif
+    // 同じ秒の中の更新も区別できるよう、取れる環境ではナノ秒単位にする
+    outSize = static_cast<uint64_t>(status.st_size);
+#if defined(__linux__)
+    outModifiedTime = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    outModifiedTime = static_cast<int64_t>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+    outModifiedTime = static_cast<int64_t>(status.st_mtime);
+#endif
+    return true;
+}
+
+void FileSystem::MakeDirectory(const std::string& dirPath)
+{
+#ifdef _WIN32
+    _mkdir(dirPath.c_str());
+#else
+    mkdir(dirPath.c_str(), 0755);
+#endif
+}
+
+std::string FileSystem::NormalizePath(const std::string& path)
+{
+    std::string normalized = path;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    return normalized;
+}
+
+std::string FileSystem::ReplaceExtension(const std::string& path, const std::string& extension)
+{
+    // 拡張子の'.'はファイル名の中だけを探す（ディレクトリ名の'.'は拡張子ではない）
+    std::string::size_type slash = path.find_last_of("/\\");
+    std::string::size_type dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return path + extension;
+    return path.substr(0, dot) + extension;
+}
+
+FileSystem::Stats FileSystem::GetStats() const
+{
+    Stats stats;
+    stats.mountCount = static_cast<int>(mMountPoints.size());
+    stats.packReadCount = mPackReadCount;
+    stats.mappedReadCount = mMappedReadCount;
+    stats.looseReadCount = mLooseReadCount;
+    stats.decompressedBytes = mDecompressedBytes;
+    return stats;
+}
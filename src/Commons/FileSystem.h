@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ファイルシステムクラス（仮想ファイルシステム）
+// *アセットの読込はここを通す。マウントしたアセットパックにあればパックから、無ければ個別のファイルから読む
+//  （開発中はパックを作らずに個別のファイルをそのまま使える）
+// *マウントポイント（"../Assets/"など）で始まるパスは、残りの部分をパック内のパスとして探す
+//  後からマウントしたパックを優先する
+// *開発中（NDEBUG無し）はパックの作成後に更新された個別のファイルをパックより優先する
+//  （シェーダのホットリロードなどで編集した内容を、パックを作り直さずに読めるように）
+// *パック内の非圧縮のエントリはマップした領域をそのまま返し、コピーしない
+// *読込は複数のスレッドから同時に呼べる（マウント、アンマウントはメインスレッドで読込の無い時に行う）
+class FileSystem
+{
+public:
+    // 読み込んだファイル
+    // *データはマップした領域か、自身のバッファを指す（マップした領域はアンマウントまで有効）
+    class File
+    {
+    public:
+        File()
+        :mData(nullptr)
+        ,mSize(0)
+        {}
+        File(File&&) = default;
+        File& operator=(File&&) = default;
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+
+    private:
+        friend class FileSystem;
+        const unsigned char* mData;
+        size_t mSize;
+        std::vector<unsigned char> mBuffer; // 展開、個別のファイルの読込先
+
+    public:
+        const unsigned char* GetData() const { return mData; }
+        size_t GetSize() const { return mSize; }
+        bool IsMapped() const { return mData && mBuffer.empty(); } // マップした領域を直接指しているか？
+
+    };
+
+    // 読込の集計（累計）
+    struct Stats
+    {
+        int mountCount;          // マウント中のパック数
+        int packReadCount;       // パックからの読込
+        int mappedReadCount;     // そのうちコピー無しの読込
+        int looseReadCount;      // 個別のファイルからの読込
+        uint64_t decompressedBytes; // 展開したバイト数
+    };
+
+    FileSystem();
+    ~FileSystem();
+
+    // パックのマウント（パックが無ければfalse）
+    bool Mount(const std::string& packPath, const std::string& mountPoint);
+    void UnmountAll();
+    // パックより新しい個別のファイルを優先するか（開発中は既定で有効）
+    void SetLooseOverride(bool isLooseOverride) { mIsLooseOverride = isLooseOverride; }
+
+    // ファイル全体の読込（jobSystemがあれば圧縮されたブロックを並列に展開する、ワーカーからはnullptrで呼ぶ）
+    bool ReadFile(const std::string& path, File& outFile, class JobSystem* jobSystem = nullptr) const;
+    bool ReadText(const std::string& path, std::string& outText) const;
+    bool Exists(const std::string& path) const;
+    bool IsPacked(const std::string& path) const;
+    // パック内のファイルをOSに先読みさせる（個別のファイルは何もしない）
+    void Prefetch(const std::string& path) const;
+
+    // 個別のファイルの読込（パックを使わない）
+    static bool ReadLooseFile(const std::string& filePath, File& outFile);
+    // ディレクトリ以下のファイルを再帰的に列挙（rootPathからの相対パス、区切りは'/'、パス順）
+    static void ListFiles(const std::string& rootPath, std::vector<std::string>& outPaths);
+    // 個別のファイルのサイズと更新時刻（無ければfalse、時刻は比較にのみ使う）
+    static bool GetFileStatus(const std::string& filePath, uint64_t& outSize, int64_t& outModifiedTime);
+    // ディレクトリの作成（既にある場合は何もしない）
+    static void MakeDirectory(const std::string& dirPath);
+    // パスの区切りを'/'に揃える
+    static std::string NormalizePath(const std::string& path);
+    // 拡張子の付け替え（extensionは'.'込み、拡張子が無ければ末尾に付ける）
+    static std::string ReplaceExtension(const std::string& path, const std::string& extension);
+
+private:
+    struct MountPoint
+    {
+        std::string path; // 正規化したマウントポイント
+        class AssetPack* pack;
+        int64_t packTime; // パックの更新時刻（個別のファイルとの比較用）
+    };
+
+    // パックのエントリを探す（後からマウントした順に）
+    bool FindEntry(const std::string& path, const class AssetPack*& outPack, int& outEntry) const;
+
+    std::vector<MountPoint> mMountPoints;
+    bool mIsLooseOverride;
+
+    mutable std::atomic<int> mPackReadCount;
+    mutable std::atomic<int> mMappedReadCount;
+    mutable std::atomic<int> mLooseReadCount;
+    mutable std::atomic<uint64_t> mDecompressedBytes;
+
+public:
+    Stats GetStats() const;
+
+};
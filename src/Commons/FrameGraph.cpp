@@ -0,0 +1,642 @@
+#include "FrameGraph.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include "Profiler.h"
+#include "GpuProfiler.h"
+
+namespace
+{
+    const char* GetFormatName(GLenum format)
+    {
+        switch (format)
+        {
+            case GL_RGBA8: return "RGBA8";
+            case GL_RGBA16F: return "RGBA16F";
+            case GL_RGBA32F: return "RGBA32F";
+            case GL_R11F_G11F_B10F: return "R11G11B10F";
+            case GL_RG16F: return "RG16F";
+            case GL_R16F: return "R16F";
+            case GL_R8: return "R8";
+            case GL_DEPTH_COMPONENT24: return "D24";
+            case GL_DEPTH_COMPONENT32F: return "D32F";
+            default: return "unknown";
+        }
+    }
+
+    bool IsSameDesc(const FrameGraph::TextureDesc& a, const FrameGraph::TextureDesc& b)
+    {
+        return a.width == b.width && a.height == b.height && a.format == b.format;
+    }
+}
+
+bool FrameGraph::RenderState::operator==(const RenderState& other) const
+{
+    return depthTest == other.depthTest && depthWrite == other.depthWrite && depthFunc == other.depthFunc
+        && blend == other.blend && cullBack == other.cullBack;
+}
+
+FrameGraph::RenderState FrameGraph::RenderState::Opaque()
+{
+    RenderState state;
+    state.depthTest = true;
+    state.depthWrite = true;
+    state.depthFunc = GL_LESS;
+    state.blend = BLEND_NONE;
+    state.cullBack = false;
+    return state;
+}
+
+FrameGraph::RenderState FrameGraph::RenderState::Overlay()
+{
+    RenderState state = Opaque();
+    state.depthTest = false;
+    state.depthWrite = false;
+    state.blend = BLEND_ALPHA;
+    return state;
+}
+
+FrameGraph::RenderState FrameGraph::RenderState::Screen()
+{
+    RenderState state = Opaque();
+    state.depthTest = false;
+    state.depthWrite = false;
+    return state;
+}
+
+FrameGraph::Handle FrameGraph::PassBuilder::Create(const std::string& name, const TextureDesc& desc)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.isImported = false;
+    resource.isOutput = false;
+    resource.frameBuffer = NO_FRAME_BUFFER;
+    resource.texture = 0;
+    resource.physical = -1;
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    mGraph->mResources.emplace_back(resource);
+    return static_cast<Handle>(mGraph->mResources.size()) - 1;
+}
+
+FrameGraph::Handle FrameGraph::PassBuilder::Read(Handle resource)
+{
+    if (resource < 0 || resource >= static_cast<Handle>(mGraph->mResources.size())) return INVALID_HANDLE;
+    auto& reads = mGraph->mPasses[mPass].reads;
+    if (std::find(reads.begin(), reads.end(), resource) == reads.end()) reads.emplace_back(resource);
+    return resource;
+}
+
+FrameGraph::Handle FrameGraph::PassBuilder::Write(Handle resource)
+{
+    if (resource < 0 || resource >= static_cast<Handle>(mGraph->mResources.size())) return INVALID_HANDLE;
+    auto& writes = mGraph->mPasses[mPass].writes;
+    if (std::find(writes.begin(), writes.end(), resource) == writes.end()) writes.emplace_back(resource);
+    return resource;
+}
+
+void FrameGraph::PassBuilder::SetClear(bool color, bool depth, const Vector3& clearColor, float clearAlpha)
+{
+    Pass& pass = mGraph->mPasses[mPass];
+    pass.clearColor = color;
+    pass.clearDepth = depth;
+    pass.clearColorValue = clearColor;
+    pass.clearAlpha = clearAlpha;
+}
+
+void FrameGraph::PassBuilder::SetRenderState(const RenderState& state)
+{
+    mGraph->mPasses[mPass].state = state;
+    mGraph->mPasses[mPass].hasState = true;
+}
+
+void FrameGraph::PassBuilder::SetSideEffect()
+{
+    mGraph->mPasses[mPass].hasSideEffect = true;
+}
+
+FrameGraph::FrameGraph()
+:mIsCompiled(false)
+,mCurrentState(RenderState::Opaque())
+,mIsStateValid(false)
+,mCurrentFrameBuffer(0)
+,mIsFrameBufferValid(false)
+,mCurrentPass(0)
+,mStats()
+{}
+
+FrameGraph::~FrameGraph()
+{}
+
+void FrameGraph::Shutdown()
+{
+    for (auto& physical : mPhysicals)
+    {
+        glDeleteTextures(1, &physical.texture);
+    }
+    mPhysicals.clear();
+    for (auto& target : mRenderTargets)
+    {
+        target.second.Destroy();
+    }
+    mRenderTargets.clear();
+    Reset();
+}
+
+void FrameGraph::Reset()
+{
+    mResources.clear();
+    mPasses.clear();
+    mIsCompiled = false;
+}
+
+FrameGraph::Handle FrameGraph::Import(const std::string& name, int width, int height,
+                                      GLuint frameBuffer, GLuint texture, bool isOutput)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc.width = width;
+    resource.desc.height = height;
+    resource.desc.format = GL_NONE;
+    resource.isImported = true;
+    resource.isOutput = isOutput;
+    resource.frameBuffer = frameBuffer;
+    resource.texture = texture;
+    resource.physical = -1;
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    mResources.emplace_back(resource);
+    return static_cast<Handle>(mResources.size()) - 1;
+}
+
+void FrameGraph::AddPass(const std::string& name, const SetupFunc& setup, const ExecuteFunc& execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.state = RenderState::Opaque();
+    pass.hasState = false;
+    pass.clearColor = false;
+    pass.clearDepth = false;
+    pass.clearColorValue = Math::VEC3_ZERO;
+    pass.clearAlpha = 1.0f;
+    pass.hasSideEffect = false;
+    pass.isCulled = false;
+    pass.execute = execute;
+    pass.hasTarget = false;
+    mPasses.emplace_back(pass);
+
+    PassBuilder builder(this, static_cast<int>(mPasses.size()) - 1);
+    setup(builder);
+}
+
+// コンパイル
+void FrameGraph::Compile()
+{
+    Stats prev = mStats;
+    mStats = Stats();
+    // 実行時の集計は前回のExecuteの値を残す（Dumpで参照する）
+    mStats.stateChanges = prev.stateChanges;
+    mStats.skippedStates = prev.skippedStates;
+    mStats.frameBufferBinds = prev.frameBufferBinds;
+    mStats.passCount = static_cast<int>(mPasses.size());
+
+    CullPasses();
+
+    // 除外されなかったパスから寿命を求める
+    for (int i = 0; i < static_cast<int>(mPasses.size()); i++)
+    {
+        const Pass& pass = mPasses[i];
+        if (pass.isCulled) continue;
+        auto use = [&](Handle handle) {
+            Resource& resource = mResources[handle];
+            if (resource.firstPass < 0) resource.firstPass = i;
+            resource.lastPass = i;
+        };
+        for (auto handle : pass.reads) use(handle);
+        for (auto handle : pass.writes) use(handle);
+    }
+
+    AllocateTextures();
+    ResolveFrameBuffers();
+    mIsCompiled = true;
+}
+
+// パスの除外
+// *後ろのパスから順に、出力リソースか後で読まれるリソースに書き込むパスだけを残す
+void FrameGraph::CullPasses()
+{
+    std::vector<bool> isNeeded(mResources.size(), false);
+    for (int i = static_cast<int>(mPasses.size()) - 1; i >= 0; i--)
+    {
+        Pass& pass = mPasses[i];
+        bool isUsed = pass.hasSideEffect;
+        for (auto handle : pass.writes)
+        {
+            if (mResources[handle].isOutput || isNeeded[handle]) isUsed = true;
+        }
+        pass.isCulled = !isUsed;
+        if (pass.isCulled)
+        {
+            mStats.culledPassCount++;
+            continue;
+        }
+        for (auto handle : pass.reads) isNeeded[handle] = true;
+    }
+}
+
+// 一時テクスチャの実体の割り当て
+// *使い始めの早い順に、同じ形式で寿命が終わっている実体があれば共有する
+void FrameGraph::AllocateTextures()
+{
+    for (auto& physical : mPhysicals) physical.lastPass = -2;
+
+    std::vector<Handle> transients;
+    for (int i = 0; i < static_cast<int>(mResources.size()); i++)
+    {
+        if (!mResources[i].isImported && mResources[i].firstPass >= 0) transients.emplace_back(i);
+    }
+    std::stable_sort(transients.begin(), transients.end(), [this](Handle a, Handle b) {
+        return mResources[a].firstPass < mResources[b].firstPass;
+    });
+
+    for (auto handle : transients)
+    {
+        Resource& resource = mResources[handle];
+        size_t bytes = static_cast<size_t>(resource.desc.width) * resource.desc.height
+                     * GetBytesPerPixel(resource.desc.format);
+        mStats.transientCount++;
+        mStats.transientBytes += bytes;
+
+        int found = -1;
+        for (int i = 0; i < static_cast<int>(mPhysicals.size()); i++)
+        {
+            const PhysicalTexture& physical = mPhysicals[i];
+            if (physical.lastPass < resource.firstPass && IsSameDesc(physical.desc, resource.desc))
+            {
+                found = i;
+                break;
+            }
+        }
+        if (found < 0)
+        {
+            PhysicalTexture physical;
+            physical.desc = resource.desc;
+            physical.lastPass = -2;
+            physical.unusedFrameCount = 0;
+
+            bool isDepth = IsDepthFormat(resource.desc.format);
+            GLenum filter = isDepth ? GL_NEAREST : GL_LINEAR;
+            glGenTextures(1, &physical.texture);
+            glBindTexture(GL_TEXTURE_2D, physical.texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, resource.desc.format, resource.desc.width, resource.desc.height, 0,
+                         isDepth ? GL_DEPTH_COMPONENT : GL_RGBA, isDepth ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            mPhysicals.emplace_back(physical);
+            found = static_cast<int>(mPhysicals.size()) - 1;
+        }
+        PhysicalTexture& physical = mPhysicals[found];
+        // 初めて使う実体のみ容量に数える
+        if (physical.lastPass == -2) mStats.physicalBytes += bytes;
+        physical.lastPass = resource.lastPass;
+        physical.unusedFrameCount = 0;
+        resource.physical = found;
+        resource.texture = physical.texture;
+    }
+
+    ReleaseUnusedTextures();
+    for (const auto& physical : mPhysicals)
+    {
+        if (physical.lastPass != -2) mStats.physicalCount++;
+    }
+}
+
+// 長く使われていない実体の破棄
+void FrameGraph::ReleaseUnusedTextures()
+{
+    for (size_t i = 0; i < mPhysicals.size(); )
+    {
+        PhysicalTexture& physical = mPhysicals[i];
+        if (physical.lastPass != -2 || ++physical.unusedFrameCount <= MAX_UNUSED_FRAMES)
+        {
+            i++;
+            continue;
+        }
+        // この実体をアタッチしていたレンダーターゲットも破棄
+        for (auto iter = mRenderTargets.begin(); iter != mRenderTargets.end(); )
+        {
+            if (iter->second.IsAttached(physical.texture))
+            {
+                iter->second.Destroy();
+                iter = mRenderTargets.erase(iter);
+            }
+            else ++iter;
+        }
+        glDeleteTextures(1, &physical.texture);
+        // 末尾と入れ替えて削除し、割り当て済リソースの番号を付け直す
+        int last = static_cast<int>(mPhysicals.size()) - 1;
+        if (static_cast<int>(i) != last)
+        {
+            mPhysicals[i] = mPhysicals[last];
+            for (auto& resource : mResources)
+            {
+                if (resource.physical == last) resource.physical = static_cast<int>(i);
+            }
+        }
+        mPhysicals.pop_back();
+    }
+}
+
+// パスの描画先の決定
+void FrameGraph::ResolveFrameBuffers()
+{
+    for (auto& pass : mPasses)
+    {
+        if (pass.isCulled) continue;
+        pass.hasTarget = false;
+
+        std::vector<GLuint> colors;
+        GLuint depth = 0;
+        int width = 0;
+        int height = 0;
+        for (auto handle : pass.writes)
+        {
+            const Resource& resource = mResources[handle];
+            if (resource.isImported)
+            {
+                // 外部のフレームバッファに描画する場合は一時テクスチャと組み合わせない
+                if (resource.frameBuffer != NO_FRAME_BUFFER)
+                {
+                    pass.hasTarget = true;
+                    pass.target = RenderTarget::External(resource.frameBuffer, resource.desc.width, resource.desc.height);
+                }
+                colors.clear();
+                depth = 0;
+                break;
+            }
+            if (IsDepthFormat(resource.desc.format)) depth = resource.texture;
+            else colors.emplace_back(resource.texture);
+            width = resource.desc.width;
+            height = resource.desc.height;
+        }
+        if (!colors.empty() || depth)
+        {
+            pass.hasTarget = true;
+            pass.target = GetRenderTarget(colors, depth, width, height);
+        }
+    }
+}
+
+// アタッチメントの組み合わせからレンダーターゲットを取得（無ければ作成）
+const RenderTarget& FrameGraph::GetRenderTarget(const std::vector<GLuint>& colors, GLuint depth, int width, int height)
+{
+    std::vector<GLuint> key = colors;
+    key.emplace_back(depth);
+    auto iter = mRenderTargets.find(key);
+    if (iter != mRenderTargets.end()) return iter->second;
+
+    RenderTarget target;
+    target.Create(colors, depth, width, height);
+    // バインドを変更したため、次の実行では必ずバインドし直す
+    mIsFrameBufferValid = false;
+    return mRenderTargets.emplace(key, target).first->second;
+}
+
+// 実行
+void FrameGraph::Execute(Profiler* profiler, GpuProfiler* gpuProfiler)
+{
+    if (!mIsCompiled) Compile();
+    mStats.stateChanges = 0;
+    mStats.skippedStates = 0;
+    mStats.frameBufferBinds = 0;
+    // フレームの間に外部で変更されている可能性があるため、最初のパスで全て設定する
+    mIsStateValid = false;
+    mIsFrameBufferValid = false;
+
+    for (mCurrentPass = 0; mCurrentPass < static_cast<int>(mPasses.size()); mCurrentPass++)
+    {
+        const Pass& pass = mPasses[mCurrentPass];
+        if (pass.isCulled) continue;
+        ProfileScope scope(profiler, pass.name.c_str());
+        if (gpuProfiler) gpuProfiler->BeginPass(pass.name.c_str());
+
+        if (pass.hasTarget)
+        {
+            if (!mIsFrameBufferValid || mCurrentFrameBuffer != pass.target.GetFrameBuffer())
+            {
+                pass.target.Bind();
+                mCurrentFrameBuffer = pass.target.GetFrameBuffer();
+                mIsFrameBufferValid = true;
+                mStats.frameBufferBinds++;
+            }
+
+            if (pass.clearColor || pass.clearDepth)
+            {
+                // 深度のクリアは書き込みが有効である必要がある
+                if (pass.clearDepth && (!mIsStateValid || !mCurrentState.depthWrite))
+                {
+                    glDepthMask(GL_TRUE);
+                    mCurrentState.depthWrite = true;
+                    mStats.stateChanges++;
+                }
+                GLbitfield mask = 0;
+                if (pass.clearColor)
+                {
+                    const Vector3& color = pass.clearColorValue;
+                    glClearColor(color.x, color.y, color.z, pass.clearAlpha);
+                    mask |= GL_COLOR_BUFFER_BIT;
+                }
+                if (pass.clearDepth) mask |= GL_DEPTH_BUFFER_BIT;
+                glClear(mask);
+            }
+        }
+
+        if (pass.hasState) ApplyRenderState(pass.state);
+        pass.execute(*this);
+
+        // 自分でバインドするパスの後は、現在のフレームバッファが分からない
+        if (!pass.hasTarget) mIsFrameBufferValid = false;
+        if (gpuProfiler) gpuProfiler->EndPass();
+    }
+    mCurrentPass = 0;
+
+    // グラフの外の描画（スワップなど）のため既定のフレームバッファに戻す
+    if (!mIsFrameBufferValid || mCurrentFrameBuffer != 0)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        mCurrentFrameBuffer = 0;
+        mIsFrameBufferValid = true;
+    }
+    mIsCompiled = false;
+}
+
+// 描画ステートの差分の設定
+void FrameGraph::ApplyRenderState(const RenderState& state)
+{
+    const bool isValid = mIsStateValid;
+    auto changed = [&](bool isSame) {
+        if (isValid && isSame)
+        {
+            mStats.skippedStates++;
+            return false;
+        }
+        mStats.stateChanges++;
+        return true;
+    };
+
+    if (changed(mCurrentState.depthTest == state.depthTest))
+    {
+        if (state.depthTest) glEnable(GL_DEPTH_TEST);
+        else glDisable(GL_DEPTH_TEST);
+    }
+    if (changed(mCurrentState.depthWrite == state.depthWrite))
+    {
+        glDepthMask(state.depthWrite ? GL_TRUE : GL_FALSE);
+    }
+    if (changed(mCurrentState.depthFunc == state.depthFunc))
+    {
+        glDepthFunc(state.depthFunc);
+    }
+    if (changed(mCurrentState.blend == state.blend))
+    {
+        switch (state.blend)
+        {
+            case BLEND_ALPHA:
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                break;
+            case BLEND_ADDITIVE:
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_ONE, GL_ONE);
+                break;
+            default:
+                glDisable(GL_BLEND);
+                break;
+        }
+    }
+    if (changed(mCurrentState.cullBack == state.cullBack))
+    {
+        if (state.cullBack)
+        {
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_BACK);
+        }
+        else glDisable(GL_CULL_FACE);
+    }
+    mCurrentState = state;
+    mIsStateValid = true;
+}
+
+GLuint FrameGraph::GetTexture(Handle resource) const
+{
+    if (resource < 0 || resource >= static_cast<Handle>(mResources.size())) return 0;
+    return mResources[resource].texture;
+}
+
+const FrameGraph::TextureDesc& FrameGraph::GetDesc(Handle resource) const
+{
+    return mResources[resource].desc;
+}
+
+// コンパイル結果の出力
+std::string FrameGraph::Dump() const
+{
+    std::string text;
+    char line[256];
+    const float mb = 1024.0f * 1024.0f;
+    snprintf(line, sizeof(line), "frame graph: %d passes (%d culled), %d transient textures -> %d physical, "
+             "%.2f MB (%.2f MB without aliasing)\n",
+             mStats.passCount, mStats.culledPassCount, mStats.transientCount, mStats.physicalCount,
+             mStats.physicalBytes / mb, mStats.transientBytes / mb);
+    text += line;
+    snprintf(line, sizeof(line), "  last execute: %d state changes (%d skipped), %d frame buffer binds\n",
+             mStats.stateChanges, mStats.skippedStates, mStats.frameBufferBinds);
+    text += line;
+
+    auto names = [this](const std::vector<Handle>& handles) {
+        std::string list;
+        for (auto handle : handles)
+        {
+            if (!list.empty()) list += ", ";
+            list += mResources[handle].name;
+        }
+        return list.empty() ? std::string("-") : list;
+    };
+    for (size_t i = 0; i < mPasses.size(); i++)
+    {
+        const Pass& pass = mPasses[i];
+        snprintf(line, sizeof(line), "  [%d] %s%s%s\n", static_cast<int>(i), pass.name.c_str(),
+                 pass.isCulled ? " (culled)" : "", pass.hasSideEffect ? " (side effect)" : "");
+        text += line;
+        text += "      reads : " + names(pass.reads) + "\n";
+        text += "      writes: " + names(pass.writes) + "\n";
+        if (pass.isCulled) continue;
+        std::string target = !pass.hasTarget ? std::string("own")
+                           : "fbo " + std::to_string(pass.target.GetFrameBuffer()) + " "
+                             + std::to_string(pass.target.GetWidth()) + "x" + std::to_string(pass.target.GetHeight());
+        if (pass.clearColor || pass.clearDepth)
+        {
+            target += std::string(" clear:") + (pass.clearColor ? "color" : "") + (pass.clearDepth ? "+depth" : "");
+        }
+        text += "      target: " + target + "\n";
+        if (pass.hasState)
+        {
+            const char* blends[] = { "none", "alpha", "additive" };
+            snprintf(line, sizeof(line), "      state : depth %s%s, blend %s, cull %s\n",
+                     pass.state.depthTest ? "test" : "off", pass.state.depthWrite ? "+write" : "",
+                     blends[pass.state.blend], pass.state.cullBack ? "back" : "off");
+            text += line;
+        }
+    }
+
+    text += "  resources:\n";
+    for (const auto& resource : mResources)
+    {
+        if (resource.isImported)
+        {
+            snprintf(line, sizeof(line), "    %-12s imported%s", resource.name.c_str(),
+                     resource.isOutput ? " (output)" : "");
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "    %-12s %dx%d %s", resource.name.c_str(),
+                     resource.desc.width, resource.desc.height, GetFormatName(resource.desc.format));
+        }
+        text += line;
+        if (resource.firstPass < 0)
+        {
+            text += ", unused\n";
+            continue;
+        }
+        snprintf(line, sizeof(line), ", passes %d-%d", resource.firstPass, resource.lastPass);
+        text += line;
+        if (resource.physical >= 0)
+        {
+            snprintf(line, sizeof(line), ", physical #%d", resource.physical);
+            text += line;
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+int FrameGraph::GetBytesPerPixel(GLenum format)
+{
+    switch (format)
+    {
+        case GL_R8: return 1;
+        case GL_R16F: return 2;
+        case GL_RGBA16F: return 8;
+        case GL_RGBA32F: return 16;
+        default: return 4; // RGBA8, R11G11B10F, RG16F, 深度
+    }
+}
+
+bool FrameGraph::IsDepthFormat(GLenum format)
+{
+    return format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F;
+}
@@ -0,0 +1,202 @@
+#pragma once
+#include <GL/glew.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "Math.h"
+#include "RenderTarget.h"
+
+// フレームグラフクラス
+// *パスは読み込む・書き込むリソースを宣言し、実行内容は関数で渡す（毎フレーム構築し直す）
+// *コンパイルで結果が使われないパスを除外し、一時テクスチャは寿命が重ならないもの同士で実体を共有する
+// *パスごとに宣言した描画ステートは直前のパスとの差分だけを設定する
+//  （パスの中で変更したステートは、パスの終わりまでに宣言した値に戻すこと）
+class FrameGraph
+{
+public:
+    typedef int Handle; // リソース（-1は無効）
+    static const Handle INVALID_HANDLE = -1;
+
+    // 一時テクスチャの形式
+    struct TextureDesc
+    {
+        int width;
+        int height;
+        GLenum format; // 内部形式（GL_RGBA8, GL_RGBA16F, GL_DEPTH_COMPONENT24など）
+    };
+
+    // ブレンド
+    enum BlendMode
+    {
+        BLEND_NONE,
+        BLEND_ALPHA,    // アルファブレンド
+        BLEND_ADDITIVE, // 加算
+    };
+
+    // パスの描画ステート
+    struct RenderState
+    {
+        bool depthTest;
+        bool depthWrite;
+        GLenum depthFunc;
+        BlendMode blend;
+        bool cullBack; // 裏面カリング
+
+        bool operator==(const RenderState& other) const;
+        static RenderState Opaque();  // 深度テスト、書き込み有り、ブレンド無し
+        static RenderState Overlay(); // 深度無し、アルファブレンド
+        static RenderState Screen();  // 深度無し、ブレンド無し（画面全体の描画）
+    };
+
+    // パスの宣言
+    class PassBuilder
+    {
+    public:
+        // 一時テクスチャを作成する（実体はコンパイル時に割り当て）
+        Handle Create(const std::string& name, const TextureDesc& desc);
+        // 読み込み（テクスチャとして参照する）
+        Handle Read(Handle resource);
+        // 書き込み（描画先、カラーは宣言順にアタッチメント0, 1...、深度形式は深度アタッチメント）
+        Handle Write(Handle resource);
+        // 書き込み先のクリア
+        void SetClear(bool color, bool depth, const Vector3& clearColor = Math::VEC3_ZERO, float clearAlpha = 1.0f);
+        void SetRenderState(const RenderState& state);
+        // 結果が参照されなくても除外しない
+        void SetSideEffect();
+
+    private:
+        friend class FrameGraph;
+        PassBuilder(FrameGraph* graph, int pass) :mGraph(graph), mPass(pass) {}
+        FrameGraph* mGraph;
+        int mPass;
+    };
+
+    typedef std::function<void(PassBuilder&)> SetupFunc;
+    typedef std::function<void(const FrameGraph&)> ExecuteFunc;
+
+    // コンパイル結果の集計
+    struct Stats
+    {
+        int passCount;         // 宣言されたパス数
+        int culledPassCount;   // 除外したパス数
+        int transientCount;    // 一時テクスチャ数
+        int physicalCount;     // 割り当てたテクスチャの実体数
+        size_t transientBytes; // 一時テクスチャを全て別に確保した場合の容量
+        size_t physicalBytes;  // 実際に割り当てた容量
+        int stateChanges;      // 設定した描画ステートの項目数
+        int skippedStates;     // 直前と同じため省略した項目数
+        int frameBufferBinds;  // フレームバッファの切替数
+    };
+
+    FrameGraph();
+    ~FrameGraph();
+
+    void Shutdown(); // 確保したテクスチャ、フレームバッファを破棄
+
+    // 新しいフレームの構築を始める（前フレームのパス、リソースを破棄。テクスチャの実体は使い回す）
+    void Reset();
+
+    // 外部のリソースを登録する
+    // *frameBufferはこのリソースへ描画する時にバインドする（0は既定のフレームバッファ）
+    //  NO_FRAME_BUFFERの場合はパスが自分でバインドする
+    // *isOutputがtrueなら書き込むパスは常に実行する（バックバッファなど）
+    Handle Import(const std::string& name, int width, int height, GLuint frameBuffer, GLuint texture, bool isOutput);
+    static const GLuint NO_FRAME_BUFFER = 0xFFFFFFFF;
+
+    // パスの追加（setupはその場で呼ばれる）
+    void AddPass(const std::string& name, const SetupFunc& setup, const ExecuteFunc& execute);
+
+    // 除外、寿命の計算、テクスチャの実体の割り当て
+    void Compile();
+
+    // 除外されなかったパスを宣言順に実行する（profiler、gpuProfilerがあればパスごとにCPU、GPU時間を計測）
+    void Execute(class Profiler* profiler, class GpuProfiler* gpuProfiler = nullptr);
+
+    // コンパイル結果の出力
+    std::string Dump() const;
+
+    // 実行中に参照する
+    GLuint GetTexture(Handle resource) const;
+    const TextureDesc& GetDesc(Handle resource) const;
+    const RenderTarget& GetCurrentTarget() const { return mPasses[mCurrentPass].target; }
+    GLuint GetCurrentFrameBuffer() const { return GetCurrentTarget().GetFrameBuffer(); }
+
+    // テクスチャ形式の1画素のバイト数
+    static int GetBytesPerPixel(GLenum format);
+    static bool IsDepthFormat(GLenum format);
+
+private:
+    // リソース
+    struct Resource
+    {
+        std::string name;
+        TextureDesc desc;
+        bool isImported;
+        bool isOutput;
+        GLuint frameBuffer; // 外部のみ
+        GLuint texture;     // 外部は登録時、一時はコンパイルで割り当て
+        int physical;       // 一時テクスチャの実体（mPhysicalsの番号）
+        int firstPass;      // 寿命（除外されなかったパスの範囲）
+        int lastPass;
+    };
+
+    // パス
+    struct Pass
+    {
+        std::string name;
+        std::vector<Handle> reads;
+        std::vector<Handle> writes;
+        RenderState state;
+        bool hasState;      // 描画ステートを宣言したか？（無ければ設定しない）
+        bool clearColor;
+        bool clearDepth;
+        Vector3 clearColorValue;
+        float clearAlpha;
+        bool hasSideEffect;
+        bool isCulled;
+        ExecuteFunc execute;
+        bool hasTarget;      // 描画先をバインドするか？（falseならパスが自分でバインドする）
+        RenderTarget target; // 描画先（コンパイルで決定）
+    };
+
+    // テクスチャの実体（フレームをまたいで使い回す）
+    struct PhysicalTexture
+    {
+        TextureDesc desc;
+        GLuint texture;
+        int lastPass;         // 今フレームで割り当てたリソースの最後の使用パス
+        int unusedFrameCount; // 使われなかった連続フレーム数
+    };
+
+    void CullPasses();
+    void AllocateTextures();
+    void ResolveFrameBuffers();
+    const RenderTarget& GetRenderTarget(const std::vector<GLuint>& colors, GLuint depth, int width, int height);
+    void ReleaseUnusedTextures();
+    void ApplyRenderState(const RenderState& state);
+
+    std::vector<Resource> mResources;
+    std::vector<Pass> mPasses;
+    std::vector<PhysicalTexture> mPhysicals;
+    // アタッチメントの組み合わせ（カラー..., 深度） -> レンダーターゲット
+    std::map<std::vector<GLuint>, RenderTarget> mRenderTargets;
+    bool mIsCompiled;
+
+    // 現在のGLステート（最初のパスでは全て設定する）
+    RenderState mCurrentState;
+    bool mIsStateValid;
+    GLuint mCurrentFrameBuffer;
+    bool mIsFrameBufferValid;
+    int mCurrentPass; // 実行中のパス
+
+    Stats mStats;
+
+    // この数のフレームの間使われなかった実体は破棄する（解像度の変更など）
+    static const int MAX_UNUSED_FRAMES = 60;
+
+public:
+    const Stats& GetStats() const { return mStats; }
+    int GetPassCount() const { return static_cast<int>(mPasses.size()); }
+
+};
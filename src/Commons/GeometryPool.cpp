@@ -0,0 +1,461 @@
+#include "GeometryPool.h"
+#include <SDL.h>
+#include <algorithm>
+
+GeometryPool::RangeAllocator::RangeAllocator()
+:mCapacity(0)
+,mFreeCount(0)
+{}
+
+void GeometryPool::RangeAllocator::Reset(unsigned int capacity, unsigned int usedPrefix)
+{
+    mFreeRanges.clear();
+    mCapacity = capacity;
+    mFreeCount = capacity - usedPrefix;
+    if (mFreeCount > 0)
+    {
+        Range range;
+        range.offset = usedPrefix;
+        range.count = mFreeCount;
+        mFreeRanges.emplace_back(range);
+    }
+}
+
+bool GeometryPool::RangeAllocator::Allocate(unsigned int count, unsigned int& outOffset)
+{
+    for (size_t i = 0; i < mFreeRanges.size(); i++)
+    {
+        Range& range = mFreeRanges[i];
+        if (range.count < count) continue;
+        outOffset = range.offset;
+        range.offset += count;
+        range.count -= count;
+        if (range.count == 0) mFreeRanges.erase(mFreeRanges.begin() + i);
+        mFreeCount -= count;
+        return true;
+    }
+    return false;
+}
+
+void GeometryPool::RangeAllocator::Free(unsigned int offset, unsigned int count)
+{
+    if (count == 0) return;
+    // 位置順を保って挿入し、前後の空きと結合する
+    auto iter = std::lower_bound(mFreeRanges.begin(), mFreeRanges.end(), offset,
+                                 [](const Range& range, unsigned int value) { return range.offset < value; });
+    Range range;
+    range.offset = offset;
+    range.count = count;
+    iter = mFreeRanges.insert(iter, range);
+    auto next = iter + 1;
+    if (next != mFreeRanges.end() && iter->offset + iter->count == next->offset)
+    {
+        iter->count += next->count;
+        mFreeRanges.erase(next);
+    }
+    if (iter != mFreeRanges.begin())
+    {
+        auto prev = iter - 1;
+        if (prev->offset + prev->count == iter->offset)
+        {
+            prev->count += iter->count;
+            mFreeRanges.erase(iter);
+        }
+    }
+    mFreeCount += count;
+}
+
+bool GeometryPool::RangeAllocator::CanAllocate(unsigned int count) const
+{
+    for (auto& range : mFreeRanges)
+    {
+        if (range.count >= count) return true;
+    }
+    return false;
+}
+
+GeometryPool::GeometryPool(unsigned int vertexCapacity, unsigned int indexCapacity)
+:mVertexBuffer(0)
+,mPositionBuffer(0)
+,mSkinBuffer(0)
+,mIndexBuffer(0)
+,mVertexArrays{0, 0, 0}
+,mInstanceBuffer(0)
+,mInstanceSource(0)
+,mIndirectBuffer(0)
+,mIsMultiDrawSupported(false)
+,mDefragmentCount(0)
+,mGrowCount(0)
+,mLayoutVersion(0)
+{
+    mVertexAllocator.Reset(vertexCapacity, 0);
+    mIndexAllocator.Reset(indexCapacity, 0);
+}
+
+GeometryPool::~GeometryPool()
+{}
+
+bool GeometryPool::Initialize()
+{
+    // 命令ごとのインスタンス番号（baseInstance）が必要
+    mIsMultiDrawSupported = GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance;
+    if (!mIsMultiDrawSupported)
+    {
+        SDL_Log("Multi draw indirect is not available, drawing meshes one by one.");
+    }
+
+    glGenVertexArrays(FORMAT_COUNT, mVertexArrays);
+    glGenBuffers(1, &mInstanceBuffer);
+    if (mIsMultiDrawSupported) glGenBuffers(1, &mIndirectBuffer);
+
+    // 空のバッファを作成（容量はコンストラクタで指定済）
+    Rebuild(mVertexAllocator.GetCapacity(), mIndexAllocator.GetCapacity());
+    mDefragmentCount = 0;
+    return true;
+}
+
+void GeometryPool::Shutdown()
+{
+    glDeleteBuffers(1, &mVertexBuffer);
+    glDeleteBuffers(1, &mPositionBuffer);
+    glDeleteBuffers(1, &mSkinBuffer);
+    glDeleteBuffers(1, &mIndexBuffer);
+    glDeleteBuffers(1, &mInstanceBuffer);
+    if (mIndirectBuffer) glDeleteBuffers(1, &mIndirectBuffer);
+    glDeleteVertexArrays(FORMAT_COUNT, mVertexArrays);
+    mVertexBuffer = mPositionBuffer = mSkinBuffer = mIndexBuffer = mInstanceBuffer = mIndirectBuffer = 0;
+    mEntries.clear();
+    mFreeHandles.clear();
+}
+
+// 割り当て、転送
+int GeometryPool::Allocate(const float* vertices, unsigned int numVertices,
+                           const unsigned int* indices, unsigned int numIndices, const unsigned char* skin)
+{
+    // 連続した空きが無い場合、空きの合計が足りていれば詰め、足りなければ拡張する
+    if (!mVertexAllocator.CanAllocate(numVertices) || !mIndexAllocator.CanAllocate(numIndices))
+    {
+        unsigned int vertexCapacity = mVertexAllocator.GetCapacity();
+        unsigned int indexCapacity = mIndexAllocator.GetCapacity();
+        bool isGrow = false;
+        if (mVertexAllocator.GetFreeCount() < numVertices)
+        {
+            vertexCapacity = std::max(vertexCapacity * 2, mVertexAllocator.GetUsedCount() + numVertices);
+            isGrow = true;
+        }
+        if (mIndexAllocator.GetFreeCount() < numIndices)
+        {
+            indexCapacity = std::max(indexCapacity * 2, mIndexAllocator.GetUsedCount() + numIndices);
+            isGrow = true;
+        }
+        Rebuild(vertexCapacity, indexCapacity);
+        if (isGrow) mGrowCount++;
+        else mDefragmentCount++;
+    }
+
+    Entry entry;
+    entry.vertexCount = numVertices;
+    entry.indexCount = numIndices;
+    entry.isUsed = true;
+    if (!mVertexAllocator.Allocate(numVertices, entry.vertexOffset)) return -1;
+    if (!mIndexAllocator.Allocate(numIndices, entry.indexOffset))
+    {
+        mVertexAllocator.Free(entry.vertexOffset, numVertices);
+        return -1;
+    }
+
+    // 転送（頂点配列のバインドを変えないようコピー用のターゲットを使う）
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mVertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, entry.vertexOffset * VERTEX_FLOATS * sizeof(float),
+                    numVertices * VERTEX_FLOATS * sizeof(float), vertices);
+    std::vector<float> positions(numVertices * POSITION_FLOATS);
+    for (unsigned int i = 0; i < numVertices; i++)
+    {
+        for (int j = 0; j < POSITION_FLOATS; j++)
+        {
+            positions[i * POSITION_FLOATS + j] = vertices[i * VERTEX_FLOATS + j];
+        }
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mPositionBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, entry.vertexOffset * POSITION_FLOATS * sizeof(float),
+                    positions.size() * sizeof(float), positions.data());
+    if (skin)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mSkinBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, entry.vertexOffset * SKIN_BYTES, numVertices * SKIN_BYTES, skin);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mIndexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, entry.indexOffset * sizeof(unsigned int),
+                    numIndices * sizeof(unsigned int), indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    int handle = static_cast<int>(mEntries.size());
+    if (!mFreeHandles.empty())
+    {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+        mEntries[handle] = entry;
+    }
+    else
+    {
+        mEntries.emplace_back(entry);
+    }
+    return handle;
+}
+
+void GeometryPool::Free(int handle)
+{
+    if (handle < 0 || handle >= static_cast<int>(mEntries.size())) return;
+    Entry& entry = mEntries[handle];
+    if (!entry.isUsed) return;
+    mVertexAllocator.Free(entry.vertexOffset, entry.vertexCount);
+    mIndexAllocator.Free(entry.indexOffset, entry.indexCount);
+    entry.isUsed = false;
+    mFreeHandles.emplace_back(handle);
+}
+
+void GeometryPool::Defragment()
+{
+    if (mVertexAllocator.GetFreeRangeCount() <= 1 && mIndexAllocator.GetFreeRangeCount() <= 1) return;
+    Rebuild(mVertexAllocator.GetCapacity(), mIndexAllocator.GetCapacity());
+    mDefragmentCount++;
+}
+
+// バッファの作り直し
+// *GPU上でコピーするため、CPU側に頂点を残さなくてよい
+void GeometryPool::Rebuild(unsigned int vertexCapacity, unsigned int indexCapacity)
+{
+    GLuint vertexBuffer = 0;
+    GLuint positionBuffer = 0;
+    GLuint skinBuffer = 0;
+    GLuint indexBuffer = 0;
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * VERTEX_FLOATS * sizeof(float), nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &positionBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, positionBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * POSITION_FLOATS * sizeof(float), nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &skinBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, skinBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * SKIN_BYTES, nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+    // 割り当て中の領域を元の位置順に詰める
+    auto copy = [](GLuint source, GLuint destination, unsigned int from, unsigned int to, unsigned int count, size_t stride) {
+        if (count == 0) return;
+        glBindBuffer(GL_COPY_READ_BUFFER, source);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from * stride, to * stride, count * stride);
+    };
+    std::vector<Entry*> used;
+    for (auto& entry : mEntries)
+    {
+        if (entry.isUsed) used.emplace_back(&entry);
+    }
+    std::sort(used.begin(), used.end(), [](const Entry* a, const Entry* b) { return a->vertexOffset < b->vertexOffset; });
+    unsigned int vertexOffset = 0;
+    for (auto entry : used)
+    {
+        if (mVertexBuffer)
+        {
+            copy(mVertexBuffer, vertexBuffer, entry->vertexOffset, vertexOffset, entry->vertexCount,
+                 VERTEX_FLOATS * sizeof(float));
+            copy(mPositionBuffer, positionBuffer, entry->vertexOffset, vertexOffset, entry->vertexCount,
+                 POSITION_FLOATS * sizeof(float));
+            copy(mSkinBuffer, skinBuffer, entry->vertexOffset, vertexOffset, entry->vertexCount, SKIN_BYTES);
+        }
+        entry->vertexOffset = vertexOffset;
+        vertexOffset += entry->vertexCount;
+    }
+    std::sort(used.begin(), used.end(), [](const Entry* a, const Entry* b) { return a->indexOffset < b->indexOffset; });
+    unsigned int indexOffset = 0;
+    for (auto entry : used)
+    {
+        // インデックスは先頭頂点からの相対値のため、そのままコピーできる
+        if (mIndexBuffer)
+        {
+            copy(mIndexBuffer, indexBuffer, entry->indexOffset, indexOffset, entry->indexCount, sizeof(unsigned int));
+        }
+        entry->indexOffset = indexOffset;
+        indexOffset += entry->indexCount;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &mVertexBuffer);
+    glDeleteBuffers(1, &mPositionBuffer);
+    glDeleteBuffers(1, &mSkinBuffer);
+    glDeleteBuffers(1, &mIndexBuffer);
+    mVertexBuffer = vertexBuffer;
+    mPositionBuffer = positionBuffer;
+    mSkinBuffer = skinBuffer;
+    mIndexBuffer = indexBuffer;
+    mVertexAllocator.Reset(vertexCapacity, vertexOffset);
+    mIndexAllocator.Reset(indexCapacity, indexOffset);
+    mLayoutVersion++;
+    SetupVertexArrays();
+}
+
+// 頂点配列の設定（バッファを作り直した時も呼ぶ）
+void GeometryPool::SetupVertexArrays()
+{
+    for (int format = 0; format < FORMAT_COUNT; format++)
+    {
+        glBindVertexArray(mVertexArrays[format]);
+        if (format == FORMAT_POSITION)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, mPositionBuffer);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * POSITION_FLOATS, 0);
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+            // 頂点属性0: 位置(x,y,z)
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * VERTEX_FLOATS, 0);
+            // 頂点属性1: 法線(x,y,z)
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * VERTEX_FLOATS,
+                                  reinterpret_cast<void*>(sizeof(float) * 3));
+            // 頂点属性2: u,v
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * VERTEX_FLOATS,
+                                  reinterpret_cast<void*>(sizeof(float) * 6));
+        }
+        if (format == FORMAT_SKINNED)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, mSkinBuffer);
+            // 頂点属性7: ボーン番号（整数のまま）
+            glEnableVertexAttribArray(SKIN_BONES_ATTRIBUTE);
+            glVertexAttribIPointer(SKIN_BONES_ATTRIBUTE, 4, GL_UNSIGNED_BYTE, SKIN_BYTES, 0);
+            // 頂点属性8: ボーンの重み（0〜1に正規化）
+            glEnableVertexAttribArray(SKIN_WEIGHTS_ATTRIBUTE);
+            glVertexAttribPointer(SKIN_WEIGHTS_ATTRIBUTE, 4, GL_UNSIGNED_BYTE, GL_TRUE, SKIN_BYTES,
+                                  reinterpret_cast<void*>(4));
+        }
+        // 頂点属性3〜6: インスタンスのワールド行列（行優先のまま、シェーダで転置する）
+        glBindBuffer(GL_ARRAY_BUFFER, mInstanceSource ? mInstanceSource : mInstanceBuffer);
+        for (int i = 0; i < 4; i++)
+        {
+            glEnableVertexAttribArray(INSTANCE_ATTRIBUTE + i);
+            glVertexAttribPointer(INSTANCE_ATTRIBUTE + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4),
+                                  reinterpret_cast<void*>(sizeof(float) * 4 * i));
+            glVertexAttribDivisor(INSTANCE_ATTRIBUTE + i, 1);
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryPool::SetInstanceSource(GLuint buffer)
+{
+    if (buffer == mInstanceSource) return;
+    mInstanceSource = buffer;
+    SetupVertexArrays();
+}
+
+void GeometryPool::Bind(VertexFormat format) const
+{
+    glBindVertexArray(mVertexArrays[format]);
+}
+
+void GeometryPool::Draw(int handle) const
+{
+    Draw(handle, 0, mEntries[handle].indexCount);
+}
+void GeometryPool::Draw(int handle, unsigned int firstIndex, unsigned int indexCount) const
+{
+    const Entry& entry = mEntries[handle];
+    glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+                             reinterpret_cast<void*>((entry.indexOffset + firstIndex) * sizeof(unsigned int)),
+                             static_cast<GLint>(entry.vertexOffset));
+}
+
+void GeometryPool::ClearDraws()
+{
+    mInstances.clear();
+    mCommands.clear();
+}
+
+int GeometryPool::AddInstance(const Matrix4& world)
+{
+    mInstances.emplace_back(world);
+    return static_cast<int>(mInstances.size()) - 1;
+}
+
+GeometryPool::DrawCommand GeometryPool::GetDrawCommand(int handle) const
+{
+    return GetDrawCommand(handle, 0, mEntries[handle].indexCount);
+}
+GeometryPool::DrawCommand GeometryPool::GetDrawCommand(int handle, unsigned int firstIndex, unsigned int indexCount) const
+{
+    const Entry& entry = mEntries[handle];
+    DrawCommand command;
+    command.count = indexCount;
+    command.instanceCount = 0;
+    command.firstIndex = entry.indexOffset + firstIndex;
+    command.baseVertex = static_cast<GLint>(entry.vertexOffset);
+    command.baseInstance = 0;
+    return command;
+}
+
+int GeometryPool::AddDraw(int handle, int instance)
+{
+    return AddDraw(handle, instance, 0, mEntries[handle].indexCount);
+}
+int GeometryPool::AddDraw(int handle, int instance, unsigned int firstIndex, unsigned int indexCount)
+{
+    DrawCommand command = GetDrawCommand(handle, firstIndex, indexCount);
+    command.instanceCount = 1;
+    command.baseInstance = static_cast<GLuint>(instance);
+    mCommands.emplace_back(command);
+    return static_cast<int>(mCommands.size()) - 1;
+}
+
+// 描画リストの転送
+// *毎フレーム書き換えるため、確保し直して（古い内容は破棄）GPUの読み込みを待たない
+void GeometryPool::UploadDraws()
+{
+    if (mInstances.empty()) return;
+    glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, mInstances.size() * sizeof(Matrix4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, mInstances.size() * sizeof(Matrix4), mInstances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (mIsMultiDrawSupported && !mCommands.empty())
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, mCommands.size() * sizeof(DrawCommand), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, mCommands.size() * sizeof(DrawCommand), mCommands.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+}
+
+void GeometryPool::MultiDraw(VertexFormat format, int first, int count) const
+{
+    if (!mIsMultiDrawSupported || count <= 0) return;
+    glBindVertexArray(mVertexArrays[format]);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                reinterpret_cast<void*>(first * sizeof(DrawCommand)), count, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+GeometryPool::Stats GeometryPool::GetStats() const
+{
+    Stats stats = {};
+    stats.meshCount = static_cast<int>(mEntries.size() - mFreeHandles.size());
+    stats.vertexCapacity = mVertexAllocator.GetCapacity();
+    stats.usedVertices = mVertexAllocator.GetUsedCount();
+    stats.indexCapacity = mIndexAllocator.GetCapacity();
+    stats.usedIndices = mIndexAllocator.GetUsedCount();
+    stats.freeRangeCount = mVertexAllocator.GetFreeRangeCount() + mIndexAllocator.GetFreeRangeCount();
+    stats.defragmentCount = mDefragmentCount;
+    stats.growCount = mGrowCount;
+    stats.gpuBytes = stats.vertexCapacity * ((VERTEX_FLOATS + POSITION_FLOATS) * sizeof(float) + SKIN_BYTES)
+                   + stats.indexCapacity * sizeof(unsigned int);
+    return stats;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include "Math.h"
+
+// ジオメトリプールクラス
+// *全てのメッシュの頂点、インデックスを共有の大きなバッファに割り当てる（メッシュごとのバッファ、頂点配列を作らない）
+// *頂点形式ごとに頂点配列は1つ（通常、位置のみ）で、メッシュを切り替えても頂点配列を切り替えない
+// *インデックスはメッシュの先頭頂点からの相対値で持ち、ベース頂点を指定して描画する（断片化の解消で頂点を移動できる）
+// *描画リストから間接描画の命令（DrawElementsIndirectCommand）を作り、まとめて1回で描画する
+//  ワールド行列はインスタンスの頂点属性（3〜6）で渡し、命令のbaseInstanceで参照する
+// *スキニング用のボーン番号と重みは別のバッファに持ち、スキンを持つメッシュのみ転送する
+class GeometryPool
+{
+public:
+    // 頂点形式
+    enum VertexFormat
+    {
+        FORMAT_STANDARD, // 位置、法線、UV
+        FORMAT_POSITION, // 位置のみ（深度のみの描画用）
+        FORMAT_SKINNED,  // 位置、法線、UV、ボーン番号、ボーンの重み（スキンを持つメッシュのみ）
+        FORMAT_COUNT,
+    };
+
+    // 間接描画の命令（GLの定義と同じ並び）
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // 使用状況
+    struct Stats
+    {
+        int meshCount;             // 割り当て中のメッシュ数
+        unsigned int vertexCapacity;
+        unsigned int usedVertices;
+        unsigned int indexCapacity;
+        unsigned int usedIndices;
+        int freeRangeCount;        // 空き領域の数（断片化の目安）
+        int defragmentCount;       // 断片化の解消の回数（累計）
+        int growCount;             // 拡張の回数（累計）
+        size_t gpuBytes;           // バッファの合計バイト数
+    };
+
+    GeometryPool(unsigned int vertexCapacity, unsigned int indexCapacity);
+    ~GeometryPool();
+
+    bool Initialize();
+    void Shutdown();
+
+    // 割り当て、転送（verticesは位置、法線、UVの8要素、失敗時は-1）
+    // *空きが足りない場合は断片化を解消し、それでも足りなければバッファを拡張する
+    // *skinはボーン番号4つ、重み4つ（0〜255）の8バイト（スキンが無ければnullptr）
+    int Allocate(const float* vertices, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices,
+                 const unsigned char* skin = nullptr);
+    void Free(int handle);
+
+    // 割り当て中の領域を先頭に詰める（ハンドルはそのまま使える）
+    void Defragment();
+
+    // 頂点配列のバインド
+    void Bind(VertexFormat format) const;
+    // 1メッシュの描画（Bind済の頂点配列で描画）
+    void Draw(int handle) const;
+    // メッシュの一部（サブメッシュ）の描画（firstIndexはメッシュの先頭からのインデックスの位置）
+    void Draw(int handle, unsigned int firstIndex, unsigned int indexCount) const;
+
+    // 描画リスト（毎フレーム作り直す）
+    void ClearDraws();
+    int AddInstance(const Matrix4& world);  // インスタンス（ワールド行列）を追加して番号を返す
+    int AddDraw(int handle, int instance);  // 命令を追加して番号を返す
+    int AddDraw(int handle, int instance, unsigned int firstIndex, unsigned int indexCount); // サブメッシュの命令
+    void UploadDraws();                     // 命令とワールド行列を転送
+    // 命令[first, first + count)をまとめて描画する
+    void MultiDraw(VertexFormat format, int first, int count) const;
+    // インスタンスのワールド行列を読むバッファの切替（0で描画リストのワールド行列）
+    // *GPUカリングでは常駐するワールド行列のバッファを命令のbaseInstanceで直接参照する
+    void SetInstanceSource(GLuint buffer);
+
+private:
+    // 範囲の割り当て（空き領域を先頭からの位置順に持ち、解放時に隣接する空きと結合する）
+    class RangeAllocator
+    {
+    public:
+        RangeAllocator();
+        void Reset(unsigned int capacity, unsigned int usedPrefix); // 先頭usedPrefixを使用中として初期化
+        bool Allocate(unsigned int count, unsigned int& outOffset); // 最初に収まる空きから割り当てる
+        void Free(unsigned int offset, unsigned int count);
+        bool CanAllocate(unsigned int count) const;
+
+    private:
+        struct Range
+        {
+            unsigned int offset;
+            unsigned int count;
+        };
+        std::vector<Range> mFreeRanges;
+        unsigned int mCapacity;
+        unsigned int mFreeCount;
+
+    public:
+        unsigned int GetCapacity() const { return mCapacity; }
+        unsigned int GetFreeCount() const { return mFreeCount; }
+        unsigned int GetUsedCount() const { return mCapacity - mFreeCount; }
+        int GetFreeRangeCount() const { return static_cast<int>(mFreeRanges.size()); }
+    };
+
+    // 割り当て済の領域
+    struct Entry
+    {
+        unsigned int vertexOffset;
+        unsigned int vertexCount;
+        unsigned int indexOffset;
+        unsigned int indexCount;
+        bool isUsed;
+    };
+
+    // 指定の容量のバッファを作り直し、割り当て中の領域を先頭から詰めてコピーする
+    void Rebuild(unsigned int vertexCapacity, unsigned int indexCapacity);
+    void SetupVertexArrays();
+
+    std::vector<Entry> mEntries;
+    std::vector<int> mFreeHandles; // 再利用するハンドル
+    RangeAllocator mVertexAllocator;
+    RangeAllocator mIndexAllocator;
+
+    GLuint mVertexBuffer;    // 位置、法線、UV
+    GLuint mPositionBuffer;  // 位置のみ（頂点番号はmVertexBufferと同じ）
+    GLuint mSkinBuffer;      // ボーン番号、重み（頂点番号はmVertexBufferと同じ）
+    GLuint mIndexBuffer;
+    GLuint mVertexArrays[FORMAT_COUNT];
+    GLuint mInstanceBuffer;  // ワールド行列（描画リストの分）
+    GLuint mInstanceSource;  // 頂点配列が参照するワールド行列のバッファ（0ならmInstanceBuffer）
+    GLuint mIndirectBuffer;  // 間接描画の命令
+
+    std::vector<Matrix4> mInstances;
+    std::vector<DrawCommand> mCommands;
+    bool mIsMultiDrawSupported;
+    int mDefragmentCount;
+    int mGrowCount;
+    int mLayoutVersion;      // バッファを作り直すたびに増える（メッシュの位置が変わる）
+
+public:
+    Stats GetStats() const;
+    unsigned int GetIndexCount(int handle) const { return mEntries[handle].indexCount; }
+    // メッシュ1つを描画する命令（instanceCount、baseInstanceは0）
+    DrawCommand GetDrawCommand(int handle) const;
+    DrawCommand GetDrawCommand(int handle, unsigned int firstIndex, unsigned int indexCount) const;
+    int GetLayoutVersion() const { return mLayoutVersion; }
+    // 間接描画（baseInstance付き）に対応しているか？
+    bool IsMultiDrawSupported() const { return mIsMultiDrawSupported; }
+    int GetDrawCount() const { return static_cast<int>(mCommands.size()); }
+
+    // 1頂点のfloat数
+    static const int VERTEX_FLOATS = 8;   // 位置(xyz), 法線(xyz), u, v
+    static const int POSITION_FLOATS = 3; // 位置(xyz)
+    static const int SKIN_BYTES = 8;      // ボーン番号(4), 重み(4)
+    // インスタンスのワールド行列の頂点属性（4つのvec4を使う）
+    static const int INSTANCE_ATTRIBUTE = 3;
+    // ボーン番号、重みの頂点属性
+    static const int SKIN_BONES_ATTRIBUTE = 7;
+    static const int SKIN_WEIGHTS_ATTRIBUTE = 8;
+
+};
@@ -0,0 +1,384 @@
+#include "GpuCulling.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include "Shader.h"
+#include "GeometryPool.h"
+#include "HiZBuffer.h"
+
+namespace
+{
+    // 命令1つのGLuint数
+    const int COMMAND_UINTS = sizeof(GeometryPool::DrawCommand) / sizeof(GLuint);
+}
+
+GpuCulling::GpuCulling()
+:mShader(nullptr)
+,mIsSupported(false)
+,mIsDrawCountSupported(false)
+,mObjectCount(0)
+,mCapacity(0)
+,mDirtyBegin(0)
+,mDirtyEnd(0)
+,mLayoutVersion(-1)
+,mIsLayoutChanged(false)
+,mPool(nullptr)
+,mObjectBuffer(0)
+,mTransformBuffer(0)
+,mBatchBuffer(0)
+,mCommandBuffer(0)
+,mCountBuffer(0)
+,mHiZBuffer(0)
+,mStats()
+{}
+
+GpuCulling::~GpuCulling()
+{}
+
+bool GpuCulling::Initialize(Game* game)
+{
+    // コンピュートシェーダ、SSBOが無ければCPUで判定する描画のみ
+    if (!GLEW_ARB_compute_shader || !GLEW_ARB_shader_storage_buffer_object)
+    {
+        SDL_Log("Compute shader is not available, GPU culling disabled.");
+        return false;
+    }
+    mShader = new Shader("Culling/CullComp.glsl");
+    if (!mShader->Load(game))
+    {
+        SDL_Log("Failed load culling shader, GPU culling disabled.");
+        delete mShader;
+        mShader = nullptr;
+        return false;
+    }
+    mIsDrawCountSupported = GLEW_ARB_indirect_parameters;
+
+    GLuint buffers[6];
+    glGenBuffers(6, buffers);
+    mObjectBuffer = buffers[0];
+    mTransformBuffer = buffers[1];
+    mBatchBuffer = buffers[2];
+    mCommandBuffer = buffers[3];
+    mCountBuffer = buffers[4];
+    mHiZBuffer = buffers[5];
+    mIsSupported = true;
+    Reserve(1024);
+    return true;
+}
+
+void GpuCulling::Shutdown()
+{
+    if (mShader)
+    {
+        mShader->Unload();
+        delete mShader;
+        mShader = nullptr;
+    }
+    if (mObjectBuffer)
+    {
+        GLuint buffers[] = { mObjectBuffer, mTransformBuffer, mBatchBuffer, mCommandBuffer, mCountBuffer, mHiZBuffer };
+        glDeleteBuffers(6, buffers);
+    }
+    mObjectBuffer = mTransformBuffer = mBatchBuffer = mCommandBuffer = mCountBuffer = mHiZBuffer = 0;
+    mIsSupported = false;
+}
+
+// オブジェクトの同期
+void GpuCulling::BeginObjects(const GeometryPool& pool)
+{
+    // メッシュの配置が変わった場合は全て転送し直す
+    mPool = &pool;
+    mIsLayoutChanged = mLayoutVersion != pool.GetLayoutVersion();
+    mLayoutVersion = pool.GetLayoutVersion();
+    mObjectCount = 0;
+    mDirtyBegin = static_cast<int>(mDescs.size());
+    mDirtyEnd = 0;
+    mStats = Stats();
+}
+
+void GpuCulling::SetObject(const ObjectDesc& desc, const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world)
+{
+    int index = mObjectCount++;
+    if (index >= static_cast<int>(mDescs.size()))
+    {
+        mDescs.resize(index + 1);
+        mObjects.resize(index + 1);
+        mTransforms.resize(index + 1);
+    }
+    else
+    {
+        // 同じオブジェクトで行列もメッシュの配置も変わっていなければ何もしない
+        const ObjectDesc& prev = mDescs[index];
+        if (prev.owner == desc.owner && prev.version == desc.version && prev.geometry == desc.geometry
+            && prev.firstIndex == desc.firstIndex && prev.indexCount == desc.indexCount && prev.batch == desc.batch && !mIsLayoutChanged)
+        {
+            return;
+        }
+    }
+    mDescs[index] = desc;
+    GeometryPool::DrawCommand command = mPool->GetDrawCommand(desc.geometry, desc.firstIndex, desc.indexCount);
+    GpuObject& object = mObjects[index];
+    object.indexCount = command.count;
+    object.firstIndex = command.firstIndex;
+    object.baseVertex = command.baseVertex;
+    object.batch = static_cast<GLuint>(desc.batch);
+    object.boxMin[0] = boxMin.x;
+    object.boxMin[1] = boxMin.y;
+    object.boxMin[2] = boxMin.z;
+    object.boxMin[3] = 1.0f;
+    object.boxMax[0] = boxMax.x;
+    object.boxMax[1] = boxMax.y;
+    object.boxMax[2] = boxMax.z;
+    object.boxMax[3] = 1.0f;
+    mTransforms[index] = world;
+    MarkDirty(index);
+}
+
+void GpuCulling::MarkDirty(int index)
+{
+    mDirtyBegin = std::min(mDirtyBegin, index);
+    mDirtyEnd = std::max(mDirtyEnd, index + 1);
+}
+
+void GpuCulling::EndObjects(int batchCount)
+{
+    if (!mIsSupported) return;
+    // 減った分は次に設定された時に必ず転送する
+    for (size_t i = mObjectCount; i < mDescs.size(); i++)
+    {
+        mDescs[i].owner = nullptr;
+    }
+    Reserve(mObjectCount);
+
+    // 変更のあった範囲のみ転送
+    if (mDirtyBegin < mDirtyEnd)
+    {
+        int count = mDirtyEnd - mDirtyBegin;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mObjectBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, mDirtyBegin * sizeof(GpuObject), count * sizeof(GpuObject),
+                        &mObjects[mDirtyBegin]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mTransformBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, mDirtyBegin * sizeof(Matrix4), count * sizeof(Matrix4),
+                        &mTransforms[mDirtyBegin]);
+        mStats.uploadedCount = count;
+    }
+
+    // まとまりごとの命令の領域（オブジェクト数の分）
+    mBatchCounts.assign(batchCount, 0);
+    for (int i = 0; i < mObjectCount; i++)
+    {
+        mBatchCounts[mObjects[i].batch]++;
+    }
+    mBatchOffsets.resize(batchCount);
+    GLuint offset = 0;
+    for (int i = 0; i < batchCount; i++)
+    {
+        mBatchOffsets[i] = offset;
+        offset += mBatchCounts[i];
+    }
+    if (batchCount > 0)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBatchBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, batchCount * sizeof(GLuint), mBatchOffsets.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCountBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, batchCount * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    mStats.objectCount = mObjectCount;
+    mStats.batchCount = batchCount;
+}
+
+// バッファの容量の確保
+void GpuCulling::Reserve(int objectCount)
+{
+    if (objectCount <= mCapacity) return;
+    mCapacity = std::max(objectCount, mCapacity * 2);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mObjectBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, mCapacity * sizeof(GpuObject), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mTransformBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, mCapacity * sizeof(Matrix4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCommandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, mCapacity * sizeof(GeometryPool::DrawCommand), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    mZeros.assign(mCapacity * COMMAND_UINTS, 0);
+    // 作り直したため設定済の分も全て転送する
+    if (mObjectCount > 0)
+    {
+        MarkDirty(0);
+        MarkDirty(mObjectCount - 1);
+    }
+}
+
+// 判定、命令の書き込み
+void GpuCulling::Cull(const Matrix4& viewProjection, const HiZBuffer* hiz)
+{
+    if (!mIsSupported || mObjectCount == 0 || mStats.batchCount == 0) return;
+
+    // 命令数を0にする（命令数を使えない場合は見えなかった分を空の命令にするため命令も0にする）
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCountBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, mStats.batchCount * sizeof(GLuint), mZeros.data());
+    if (!mIsDrawCountSupported)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCommandBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, mObjectCount * sizeof(GeometryPool::DrawCommand), mZeros.data());
+    }
+
+    // 階層Zの全段を1つのバッファに並べる
+    int levelCount = 0;
+    GLint levels[MAX_HIZ_LEVELS * 3] = {};
+    if (hiz && hiz->GetLevelCount() > 0)
+    {
+        levelCount = std::min(hiz->GetLevelCount(), static_cast<int>(MAX_HIZ_LEVELS));
+        mHiZData.clear();
+        for (int i = 0; i < levelCount; i++)
+        {
+            int size = hiz->GetLevelWidth(i) * hiz->GetLevelHeight(i);
+            levels[i * 3 + 0] = hiz->GetLevelWidth(i);
+            levels[i * 3 + 1] = hiz->GetLevelHeight(i);
+            levels[i * 3 + 2] = static_cast<GLint>(mHiZData.size());
+            mHiZData.insert(mHiZData.end(), hiz->GetLevelDepth(i), hiz->GetLevelDepth(i) + size);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mHiZBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, mHiZData.size() * sizeof(float), mHiZData.data(), GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    mStats.isHiZ = levelCount > 0;
+
+    mShader->SetActive();
+    mShader->SetMatrixUniform("uViewProjection", viewProjection);
+    glUniform1ui(glGetUniformLocation(mShader->GetProgram(), "uObjectCount"), static_cast<GLuint>(mObjectCount));
+    mShader->SetIntUniform("uHiZLevelCount", levelCount);
+    if (levelCount > 0)
+    {
+        mShader->SetMatrixUniform("uHiZViewProjection", hiz->GetViewProjection());
+        glUniform3iv(glGetUniformLocation(mShader->GetProgram(), "uHiZLevels"), levelCount, levels);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mObjectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, mTransformBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, mBatchBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, mCommandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, mCountBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, mHiZBuffer);
+    glDispatchCompute((mObjectCount + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+    // 書き込んだ命令、命令数を間接描画で読む
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+// まとまりの描画
+void GpuCulling::DrawBatch(int batch) const
+{
+    if (!mIsSupported || mBatchCounts[batch] == 0) return;
+    const void* offset = reinterpret_cast<const void*>(mBatchOffsets[batch] * sizeof(GeometryPool::DrawCommand));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandBuffer);
+    if (mIsDrawCountSupported)
+    {
+        // 命令数はGPU上の値（最大はまとまりのオブジェクト数）
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, mCountBuffer);
+        glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, offset, batch * sizeof(GLuint),
+                                            mBatchCounts[batch], 0);
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+    }
+    else
+    {
+        // 見えなかった分は空の命令
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset, mBatchCounts[batch], 0);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+// ボックスが視錐台と交わるか？
+// *コンピュートシェーダと同じく、いずれかの面の外側に8頂点とも入っていれば見えない
+bool GpuCulling::IsBoxVisible(const Matrix4& m, const Vector3& boxMin, const Vector3& boxMax, float margin)
+{
+    int outside[6] = {};
+    for (int i = 0; i < 8; i++)
+    {
+        float x = (i & 1) ? boxMax.x : boxMin.x;
+        float y = (i & 2) ? boxMax.y : boxMin.y;
+        float z = (i & 4) ? boxMax.z : boxMin.z;
+        float cx = m.matrix[0][0]*x + m.matrix[0][1]*y + m.matrix[0][2]*z + m.matrix[0][3];
+        float cy = m.matrix[1][0]*x + m.matrix[1][1]*y + m.matrix[1][2]*z + m.matrix[1][3];
+        float cz = m.matrix[2][0]*x + m.matrix[2][1]*y + m.matrix[2][2]*z + m.matrix[2][3];
+        float cw = m.matrix[3][0]*x + m.matrix[3][1]*y + m.matrix[3][2]*z + m.matrix[3][3];
+        float limit = -margin * fabsf(cw);
+        if (cw + cx < limit) outside[0]++;
+        if (cw - cx < limit) outside[1]++;
+        if (cw + cy < limit) outside[2]++;
+        if (cw - cy < limit) outside[3]++;
+        if (cw + cz < limit) outside[4]++;
+        if (cw - cz < limit) outside[5]++;
+    }
+    for (int count : outside)
+    {
+        if (count == 8) return false;
+    }
+    return true;
+}
+
+// CPUでの参照実装
+void GpuCulling::CullReference(const Matrix4& viewProjection, const HiZBuffer* hiz, float margin,
+                               std::vector<std::vector<int>>& outVisible) const
+{
+    outVisible.assign(mBatchCounts.size(), std::vector<int>());
+    for (int i = 0; i < mObjectCount; i++)
+    {
+        const GpuObject& object = mObjects[i];
+        Vector3 boxMin(object.boxMin[0], object.boxMin[1], object.boxMin[2]);
+        Vector3 boxMax(object.boxMax[0], object.boxMax[1], object.boxMax[2]);
+        if (!IsBoxVisible(viewProjection * mTransforms[i], boxMin, boxMax, margin)) continue;
+        if (hiz && hiz->GetLevelCount() > 0 && hiz->IsBoxOccluded(boxMin, boxMax, mTransforms[i])) continue;
+        outVisible[object.batch].emplace_back(i);
+    }
+}
+
+// GPUの結果の検証
+int GpuCulling::Validate(const Matrix4& viewProjection, const HiZBuffer* hiz)
+{
+    if (!mIsSupported || mObjectCount == 0 || mStats.batchCount == 0) return 0;
+    // GPUの結果を読み戻す（書き込みの完了を待つ）
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    std::vector<GLuint> counts(mStats.batchCount);
+    std::vector<GLuint> commands(mObjectCount * COMMAND_UINTS);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCountBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, counts.size() * sizeof(GLuint), counts.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCommandBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commands.size() * sizeof(GLuint), commands.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // 境界上のものを除くため、視錐台を広げた結果と狭めた結果の両方と比べる
+    const float margin = 1.0e-4f;
+    std::vector<std::vector<int>> loose;
+    std::vector<std::vector<int>> tight;
+    CullReference(viewProjection, hiz, margin, loose);
+    CullReference(viewProjection, hiz, -margin, tight);
+
+    int mismatchCount = 0;
+    for (int batch = 0; batch < mStats.batchCount; batch++)
+    {
+        // 書き込み順は不定のためオブジェクト番号順に並べる
+        std::vector<int> visible;
+        GLuint count = std::min(counts[batch], mBatchCounts[batch]);
+        for (GLuint i = 0; i < count; i++)
+        {
+            visible.emplace_back(static_cast<int>(commands[(mBatchOffsets[batch] + i) * COMMAND_UINTS + 4]));
+        }
+        std::sort(visible.begin(), visible.end());
+        // 見えると判定したが、広げても見えない
+        for (int index : visible)
+        {
+            if (!std::binary_search(loose[batch].begin(), loose[batch].end(), index)) mismatchCount++;
+        }
+        // 見えないと判定したが、狭めても見える
+        for (int index : tight[batch])
+        {
+            if (!std::binary_search(visible.begin(), visible.end(), index)) mismatchCount++;
+        }
+        if (counts[batch] > mBatchCounts[batch]) mismatchCount += counts[batch] - mBatchCounts[batch];
+    }
+    if (mismatchCount > 0)
+    {
+        SDL_Log("gpu culling: %d objects differ from the CPU reference", mismatchCount);
+    }
+    return mismatchCount;
+}
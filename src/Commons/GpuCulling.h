@@ -0,0 +1,121 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include "Math.h"
+
+// GPUカリングクラス
+// *オブジェクト（メッシュコンポーネント）の境界ボックスとワールド行列をGPUに常駐させ、変更のあった範囲のみ転送する
+// *コンピュートシェーダで視錐台（有効なら階層Zも）を判定し、見えるものだけを間接描画の命令に詰めて書き込む
+//  命令の領域はまとまり（シェーダ、テクスチャ）ごとに確保し、まとまりごとの命令数も書き込む
+// *命令数はARB_indirect_parametersがあれば描画時にGPU上の値を使い、無ければ空の命令（0で埋める）を含めて描画する
+// *ワールド行列のバッファはそのままインスタンスの頂点属性として読む（命令のbaseInstanceがオブジェクト番号）
+// *同じ判定をCPUで行う参照実装を持ち、GPUの結果と比較できる
+class GpuCulling
+{
+public:
+    // オブジェクトの識別情報（前フレームと同じなら転送しない）
+    struct ObjectDesc
+    {
+        const void* owner;    // 同じ番号のオブジェクトが入れ替わったかの判定用
+        unsigned int version; // ワールド変換座標の更新番号
+        int geometry;         // ジオメトリプールのハンドル
+        unsigned int firstIndex; // メッシュ内の描画範囲（サブメッシュ）
+        unsigned int indexCount;
+        int batch;            // 描画のまとまりの番号
+    };
+
+    // 今フレームの集計
+    struct Stats
+    {
+        int objectCount;   // オブジェクト数
+        int batchCount;    // まとまりの数
+        int uploadedCount; // 転送したオブジェクト数
+        bool isHiZ;        // 階層Zでも判定したか？
+    };
+
+    GpuCulling();
+    ~GpuCulling();
+
+    bool Initialize(class Game* game);
+    void Shutdown();
+
+    // オブジェクトの同期（毎フレーム、全てのオブジェクトを同じ順に設定する）
+    void BeginObjects(const class GeometryPool& pool);
+    void SetObject(const ObjectDesc& desc, const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world);
+    void EndObjects(int batchCount); // 変更のあった範囲を転送し、まとまりごとの命令の領域を割り当てる
+
+    // 判定して命令を書き込む（hizは使わない場合nullptr）
+    void Cull(const Matrix4& viewProjection, const class HiZBuffer* hiz);
+    // まとまりの描画（ジオメトリプールの頂点配列をバインドしておく）
+    void DrawBatch(int batch) const;
+
+    // CPUでの参照実装（まとまりごとに見えるオブジェクトの番号を昇順で返す）
+    // *marginは視錐台の各面を|w|に対する割合で外側に広げる（負なら内側に狭める）
+    void CullReference(const Matrix4& viewProjection, const class HiZBuffer* hiz, float margin,
+                       std::vector<std::vector<int>>& outVisible) const;
+    // GPUの結果を読み戻して参照実装と比較し、不一致のオブジェクト数を返す
+    // *GPUの完了を待つため検証用（境界上で判定が分かれるものは数えない）
+    int Validate(const Matrix4& viewProjection, const class HiZBuffer* hiz);
+
+    // ボックスが視錐台と交わるか？（ローカル座標のAABB、ワールドビュー射影行列）
+    static bool IsBoxVisible(const Matrix4& worldViewProjection, const Vector3& boxMin, const Vector3& boxMax,
+                             float margin = 0.0f);
+
+private:
+    // GPU上のオブジェクト（std430、コンピュートシェーダと同じ並び）
+    struct GpuObject
+    {
+        GLuint indexCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint batch;
+        float boxMin[4];
+        float boxMax[4];
+    };
+
+    void Reserve(int objectCount); // バッファの容量の確保（足りなければ作り直して全て転送）
+    void MarkDirty(int index);
+
+    class Shader* mShader;
+    bool mIsSupported;          // コンピュートシェーダ、SSBOに対応しているか？
+    bool mIsDrawCountSupported; // 描画時にGPU上の命令数を使えるか？
+
+    // CPU側の写し
+    std::vector<ObjectDesc> mDescs;
+    std::vector<GpuObject> mObjects;
+    std::vector<Matrix4> mTransforms;
+    std::vector<GLuint> mBatchOffsets;  // まとまりごとの命令の先頭
+    std::vector<GLuint> mBatchCounts;   // まとまりごとのオブジェクト数（命令の領域の大きさ）
+    std::vector<GLuint> mZeros;         // 命令数、命令のクリア用
+    std::vector<float> mHiZData;        // 階層Zの全段（転送用、容量を使い回す）
+    int mObjectCount;
+    int mCapacity;
+    int mDirtyBegin;                    // 転送が必要な範囲
+    int mDirtyEnd;
+    int mLayoutVersion;                 // ジオメトリプールの配置（変わったら全て転送）
+    bool mIsLayoutChanged;
+    const class GeometryPool* mPool;    // 同期中のジオメトリプール
+
+    GLuint mObjectBuffer;
+    GLuint mTransformBuffer;  // ワールド行列（インスタンスの頂点属性としても使う）
+    GLuint mBatchBuffer;      // まとまりごとの命令の先頭
+    GLuint mCommandBuffer;    // 間接描画の命令
+    GLuint mCountBuffer;      // まとまりごとの命令数
+    GLuint mHiZBuffer;        // 階層Zの全段
+
+    Stats mStats;
+
+public:
+    bool IsSupported() const { return mIsSupported; }
+    bool IsDrawCountSupported() const { return mIsDrawCountSupported; }
+    class Shader* GetShader() const { return mShader; }
+    GLuint GetTransformBuffer() const { return mTransformBuffer; }
+    int GetBatchOffset(int batch) const { return static_cast<int>(mBatchOffsets[batch]); }
+    const Stats& GetStats() const { return mStats; }
+
+    // コンピュートシェーダのワークグループの大きさ
+    static const int GROUP_SIZE = 64;
+    // 階層Zの最大の段数
+    static const int MAX_HIZ_LEVELS = 16;
+
+};
@@ -0,0 +1,225 @@
+#include "GpuProfiler.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+
+GpuProfiler::GpuProfiler()
+:mFrameIndex(0)
+,mFrameNumber(0)
+,mPassDepth(0)
+,mIsTimerEnabled(false)
+,mIsMarkerEnabled(false)
+,mLastFrameMs(0.0f)
+,mReadFrameCount(0)
+,mDroppedFrameCount(0)
+{
+    for (auto& frame : mFrames)
+    {
+        frame.usedCount = 0;
+        frame.frameNumber = 0;
+        frame.isIssued = false;
+    }
+}
+
+GpuProfiler::~GpuProfiler()
+{}
+
+bool GpuProfiler::Initialize()
+{
+    // カウンタのビット数が0の環境では経過時間を計測できない
+    GLint bits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &bits);
+    mIsTimerEnabled = bits > 0;
+    mIsMarkerEnabled = GLEW_KHR_debug;
+    if (!mIsTimerEnabled)
+    {
+        SDL_Log("GPU timer query is not available, GPU profiling disabled.");
+    }
+    return mIsTimerEnabled;
+}
+
+void GpuProfiler::Shutdown()
+{
+    for (auto& frame : mFrames)
+    {
+        if (!frame.queries.empty())
+        {
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+        }
+        frame.queries.clear();
+        frame.passIndices.clear();
+        frame.isIssued = false;
+    }
+}
+
+void GpuProfiler::BeginFrame()
+{
+    mPassDepth = 0;
+    if (!mIsTimerEnabled) return;
+
+    // これから使うのは3フレーム前のクエリ（結果が出ていれば読む）
+    mFrameIndex = (mFrameIndex + 1) % FRAME_COUNT;
+    Frame& frame = mFrames[mFrameIndex];
+    if (frame.isIssued)
+    {
+        // クエリは発行順に完了するため、最後のものが読めれば全て読める
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(frame.queries[frame.usedCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            ReadFrame(frame);
+        }
+        else
+        {
+            // 間に合わなかった結果は捨てる（待つとGPUと同期してしまう）
+            mDroppedFrameCount++;
+        }
+        frame.isIssued = false;
+    }
+    frame.usedCount = 0;
+    frame.passIndices.clear();
+    frame.frameNumber = mFrameNumber;
+}
+
+void GpuProfiler::EndFrame()
+{
+    if (!mIsTimerEnabled) return;
+    Frame& frame = mFrames[mFrameIndex];
+    frame.isIssued = frame.usedCount > 0;
+    mFrameNumber++;
+}
+
+void GpuProfiler::BeginPass(const char* name)
+{
+    PushMarker(name);
+    if (!mIsTimerEnabled || mPassDepth++ > 0) return;
+
+    Frame& frame = mFrames[mFrameIndex];
+    if (frame.usedCount == static_cast<int>(frame.queries.size()))
+    {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        frame.queries.emplace_back(query);
+    }
+    frame.passIndices.emplace_back(FindPass(name));
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.usedCount++]);
+}
+
+void GpuProfiler::EndPass()
+{
+    if (mIsTimerEnabled && mPassDepth > 0 && --mPassDepth == 0)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+    PopMarker();
+}
+
+void GpuProfiler::PushMarker(const char* name)
+{
+    if (!mIsMarkerEnabled) return;
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+void GpuProfiler::PopMarker()
+{
+    if (!mIsMarkerEnabled) return;
+    glPopDebugGroup();
+}
+
+// 結果の読み込み
+void GpuProfiler::ReadFrame(Frame& frame)
+{
+    double frameMs = 0.0;
+    for (int i = 0; i < frame.usedCount; i++)
+    {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+        const float ms = static_cast<float>(elapsed / 1.0e6);
+        PassStats& pass = mPasses[frame.passIndices[i]];
+        pass.lastMs = ms;
+        pass.minMs = pass.sampleCount > 0 ? std::min(pass.minMs, ms) : ms;
+        pass.maxMs = pass.sampleCount > 0 ? std::max(pass.maxMs, ms) : ms;
+        pass.totalMs += ms;
+        pass.sampleCount++;
+        frameMs += ms;
+
+        if (mRecords.size() >= MAX_RECORDS)
+        {
+            mRecords.erase(mRecords.begin(), mRecords.begin() + MAX_RECORDS / 2);
+        }
+        Record record;
+        record.frameNumber = frame.frameNumber;
+        record.passIndex = frame.passIndices[i];
+        record.gpuMs = ms;
+        mRecords.emplace_back(record);
+    }
+    mLastFrameMs = static_cast<float>(frameMs);
+    mReadFrameCount++;
+}
+
+void GpuProfiler::LogStats(const char* label)
+{
+    if (mReadFrameCount == 0) return;
+    double frameMs = 0.0;
+    for (auto& pass : mPasses)
+    {
+        frameMs += pass.totalMs;
+    }
+    SDL_Log("gpu profile [%s]: %d frames (%d dropped), %.3f ms/frame", label, mReadFrameCount, mDroppedFrameCount,
+            frameMs / mReadFrameCount);
+    for (auto& pass : mPasses)
+    {
+        if (pass.sampleCount == 0) continue;
+        SDL_Log("  %-16s %8.3f ms (min %.3f, max %.3f)", pass.name.c_str(), pass.totalMs / pass.sampleCount,
+                pass.minMs, pass.maxMs);
+        pass.totalMs = 0.0;
+        pass.sampleCount = 0;
+    }
+    mReadFrameCount = 0;
+    mDroppedFrameCount = 0;
+}
+
+bool GpuProfiler::WriteCsv(const std::string& filePath) const
+{
+    FILE* file = fopen(filePath.c_str(), "w");
+    if (!file)
+    {
+        SDL_Log("Failed write GPU profile: %s", filePath.c_str());
+        return false;
+    }
+    fprintf(file, "frame,pass,gpu_ms\n");
+    for (auto& record : mRecords)
+    {
+        fprintf(file, "%lld,%s,%.4f\n", record.frameNumber, mPasses[record.passIndex].name.c_str(), record.gpuMs);
+    }
+    fclose(file);
+    SDL_Log("gpu profile: %d rows written to %s", static_cast<int>(mRecords.size()), filePath.c_str());
+    return true;
+}
+
+float GpuProfiler::GetPassMs(const char* name) const
+{
+    for (auto& pass : mPasses)
+    {
+        if (pass.name == name) return pass.lastMs;
+    }
+    return 0.0f;
+}
+
+// 名前で検索（無ければ追加、パス数は少ないため線形探索）
+size_t GpuProfiler::FindPass(const char* name)
+{
+    for (size_t i = 0; i < mPasses.size(); i++)
+    {
+        if (mPasses[i].name == name) return i;
+    }
+    PassStats pass;
+    pass.name = name;
+    pass.lastMs = 0.0f;
+    pass.minMs = 0.0f;
+    pass.maxMs = 0.0f;
+    pass.totalMs = 0.0;
+    pass.sampleCount = 0;
+    mPasses.emplace_back(pass);
+    return mPasses.size() - 1;
+}
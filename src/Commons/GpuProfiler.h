@@ -0,0 +1,115 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+// GPUプロファイラクラス
+// *描画パスごとのGPU時間を経過時間のクエリ（GL_TIME_ELAPSED）で計測する
+// *クエリは3フレーム分を順に使い、結果は数フレーム遅れて読む（間に合わなかったフレームは捨て、GPUの完了を待たない）
+// *マーカーはKHR_debugのデバッググループとして発行する（RenderDocなどのキャプチャでパスや描画のまとまりが見える）
+// *経過時間のクエリは入れ子にできないため、計測するのは一番外側のパスのみ
+class GpuProfiler
+{
+public:
+    // パスごとの集計値
+    struct PassStats
+    {
+        std::string name;
+        float lastMs;       // 最後に読んだ時間
+        float minMs;        // 前回出力からの最小、最大
+        float maxMs;
+        double totalMs;     // 前回出力からの合計
+        int sampleCount;    // 前回出力からの計測数
+    };
+
+    GpuProfiler();
+    ~GpuProfiler();
+
+    bool Initialize();
+    void Shutdown();
+
+    // フレームの区切り（描画の前後で呼ぶ）
+    void BeginFrame();
+    void EndFrame();
+
+    // パスの計測（マーカーも発行する）
+    void BeginPass(const char* name);
+    void EndPass();
+
+    // 描画のまとまりのマーカー（計測はしない）
+    void PushMarker(const char* name);
+    void PopMarker();
+
+    // 前回出力からの平均を出力してリセット
+    void LogStats(const char* label);
+
+    // 読み戻した結果の履歴をCSVで出力（frame,pass,gpu_ms）
+    bool WriteCsv(const std::string& filePath) const;
+
+    // 最後に読んだ時間（計測していないパスは0）
+    float GetPassMs(const char* name) const;
+
+private:
+    // 1フレーム分のクエリ
+    struct Frame
+    {
+        std::vector<GLuint> queries;     // 確保済のクエリ（使い回す）
+        std::vector<size_t> passIndices; // 各クエリのパス
+        int usedCount;                   // 今回使った数
+        long long frameNumber;           // 発行したフレームの番号
+        bool isIssued;                   // 結果が未読か？
+    };
+    // CSVの1行
+    struct Record
+    {
+        long long frameNumber;
+        size_t passIndex;
+        float gpuMs;
+    };
+
+    void ReadFrame(Frame& frame);
+    size_t FindPass(const char* name);
+
+    static const int FRAME_COUNT = 3;
+    Frame mFrames[FRAME_COUNT];
+    int mFrameIndex;
+    long long mFrameNumber;
+
+    std::vector<PassStats> mPasses;
+    std::vector<Record> mRecords;
+    int mPassDepth;        // 入れ子のパスの深さ
+    bool mIsTimerEnabled;  // 経過時間のクエリに対応しているか？
+    bool mIsMarkerEnabled; // デバッググループを発行するか？
+    float mLastFrameMs;    // 最後に読んだフレームのパスの合計
+    int mReadFrameCount;   // 前回出力から読んだフレーム数
+    int mDroppedFrameCount; // 前回出力から結果が間に合わず捨てたフレーム数
+
+public:
+    const std::vector<PassStats>& GetPassStats() const { return mPasses; }
+    float GetLastFrameMs() const { return mLastFrameMs; }
+    bool IsTimerEnabled() const { return mIsTimerEnabled; }
+    void SetMarkerEnabled(bool enable) { mIsMarkerEnabled = enable && GLEW_KHR_debug; }
+    bool IsMarkerEnabled() const { return mIsMarkerEnabled; }
+
+    // CSVに残す行数の上限（超えたら古い方の半分を捨てる）
+    static const size_t MAX_RECORDS = 100000;
+
+};
+
+// スコープ内を描画のまとまりのマーカーで囲む
+class GpuMarkerScope
+{
+public:
+    GpuMarkerScope(GpuProfiler* profiler, const char* name)
+    :mProfiler(profiler)
+    {
+        if (mProfiler) mProfiler->PushMarker(name);
+    }
+    ~GpuMarkerScope()
+    {
+        if (mProfiler) mProfiler->PopMarker();
+    }
+
+private:
+    GpuProfiler* mProfiler;
+};
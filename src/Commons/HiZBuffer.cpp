@@ -0,0 +1,201 @@
+#include "HiZBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+HiZBuffer::HiZBuffer()
+{}
+
+HiZBuffer::~HiZBuffer()
+{}
+
+void HiZBuffer::Resize(int width, int height)
+{
+    mLevels.clear();
+    Level level;
+    level.width = std::max(1, width);
+    level.height = std::max(1, height);
+    level.depth.assign(level.width * level.height, 1.0f);
+    mLevels.emplace_back(level);
+}
+
+void HiZBuffer::Clear()
+{
+    if (mLevels.empty()) return;
+    std::fill(mLevels[0].depth.begin(), mLevels[0].depth.end(), 1.0f);
+}
+
+// 深度バッファの縮小
+void HiZBuffer::SetDepth(const float* depth, int width, int height)
+{
+    if (mLevels.empty()) return;
+    Level& base = mLevels[0];
+    for (int y = 0; y < base.height; y++)
+    {
+        // この画素が覆う元の行の範囲（端数は切り上げて含める）
+        int srcY0 = y * height / base.height;
+        int srcY1 = std::max(srcY0 + 1, ((y + 1) * height + base.height - 1) / base.height);
+        for (int x = 0; x < base.width; x++)
+        {
+            int srcX0 = x * width / base.width;
+            int srcX1 = std::max(srcX0 + 1, ((x + 1) * width + base.width - 1) / base.width);
+            float farthest = 0.0f;
+            for (int sy = srcY0; sy < std::min(srcY1, height); sy++)
+            {
+                const float* row = depth + sy * width;
+                for (int sx = srcX0; sx < std::min(srcX1, width); sx++)
+                {
+                    farthest = std::max(farthest, row[sx]);
+                }
+            }
+            base.depth[y * base.width + x] = farthest;
+        }
+    }
+}
+
+// 遮蔽物のラスタライズ
+void HiZBuffer::RasterizeTriangles(const float* positions, int positionStride,
+                                   const unsigned int* indices, int indexCount,
+                                   const Matrix4& worldViewProjection)
+{
+    if (mLevels.empty()) return;
+    Level& base = mLevels[0];
+    const Matrix4& m = worldViewProjection;
+
+    for (int i = 0; i + 2 < indexCount; i += 3)
+    {
+        // クリップ座標からウィンドウ座標（x, y: 画素、z: 深度）に変換
+        float sx[3], sy[3], sz[3];
+        bool isClipped = false;
+        for (int j = 0; j < 3; j++)
+        {
+            const float* p = positions + indices[i + j] * positionStride;
+            float cx = m.matrix[0][0]*p[0] + m.matrix[0][1]*p[1] + m.matrix[0][2]*p[2] + m.matrix[0][3];
+            float cy = m.matrix[1][0]*p[0] + m.matrix[1][1]*p[1] + m.matrix[1][2]*p[2] + m.matrix[1][3];
+            float cz = m.matrix[2][0]*p[0] + m.matrix[2][1]*p[1] + m.matrix[2][2]*p[2] + m.matrix[2][3];
+            float cw = m.matrix[3][0]*p[0] + m.matrix[3][1]*p[1] + m.matrix[3][2]*p[2] + m.matrix[3][3];
+            if (cw <= 0.0f || cz < -cw)
+            {
+                isClipped = true;
+                break;
+            }
+            sx[j] = (cx / cw * 0.5f + 0.5f) * base.width;
+            sy[j] = (cy / cw * 0.5f + 0.5f) * base.height;
+            sz[j] = cz / cw * 0.5f + 0.5f;
+        }
+        if (isClipped) continue;
+
+        float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+        if (fabsf(area) < 1e-6f) continue;
+        float invArea = 1.0f / area;
+
+        int minX = std::max(0, static_cast<int>(floorf(std::min(sx[0], std::min(sx[1], sx[2])))));
+        int maxX = std::min(base.width - 1, static_cast<int>(ceilf(std::max(sx[0], std::max(sx[1], sx[2])))));
+        int minY = std::max(0, static_cast<int>(floorf(std::min(sy[0], std::min(sy[1], sy[2])))));
+        int maxY = std::min(base.height - 1, static_cast<int>(ceilf(std::max(sy[0], std::max(sy[1], sy[2])))));
+
+        for (int y = minY; y <= maxY; y++)
+        {
+            float py = y + 0.5f;
+            for (int x = minX; x <= maxX; x++)
+            {
+                // 画素中心の重心座標（面積で割るため表裏どちらの向きでも正になる）
+                float px = x + 0.5f;
+                float w0 = ((sx[2] - sx[1]) * (py - sy[1]) - (sy[2] - sy[1]) * (px - sx[1])) * invArea;
+                float w1 = ((sx[0] - sx[2]) * (py - sy[2]) - (sy[0] - sy[2]) * (px - sx[2])) * invArea;
+                float w2 = 1.0f - w0 - w1;
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+                // z/wは画面上で線形に補間できる
+                float depth = w0 * sz[0] + w1 * sz[1] + w2 * sz[2];
+                if (depth > 1.0f) continue;
+                float& dst = base.depth[y * base.width + x];
+                if (depth < dst) dst = depth;
+            }
+        }
+    }
+}
+
+// 階層の作成
+void HiZBuffer::BuildPyramid()
+{
+    if (mLevels.empty()) return;
+    mLevels.resize(1);
+    while (mLevels.back().width > 1 || mLevels.back().height > 1)
+    {
+        const Level& src = mLevels.back();
+        Level dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.depth.resize(dst.width * dst.height);
+        for (int y = 0; y < dst.height; y++)
+        {
+            // 奇数の場合は端の画素を重複して読む
+            int y0 = y * 2;
+            int y1 = std::min(y0 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; x++)
+            {
+                int x0 = x * 2;
+                int x1 = std::min(x0 + 1, src.width - 1);
+                float farthest = std::max(std::max(src.depth[y0 * src.width + x0], src.depth[y0 * src.width + x1]),
+                                          std::max(src.depth[y1 * src.width + x0], src.depth[y1 * src.width + x1]));
+                dst.depth[y * dst.width + x] = farthest;
+            }
+        }
+        // srcが無効になるため作成後に追加する
+        mLevels.emplace_back(std::move(dst));
+    }
+}
+
+// ボックスの遮蔽判定
+bool HiZBuffer::IsBoxOccluded(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world) const
+{
+    if (mLevels.empty()) return false;
+    const Matrix4 m = mViewProjection * world;
+
+    // 8頂点を投影して画面上の矩形と最も手前の深度を求める
+    float minX = 1.0f, maxX = -1.0f, minY = 1.0f, maxY = -1.0f;
+    float nearest = 1.0f;
+    for (int i = 0; i < 8; i++)
+    {
+        float x = (i & 1) ? boxMax.x : boxMin.x;
+        float y = (i & 2) ? boxMax.y : boxMin.y;
+        float z = (i & 4) ? boxMax.z : boxMin.z;
+        float cx = m.matrix[0][0]*x + m.matrix[0][1]*y + m.matrix[0][2]*z + m.matrix[0][3];
+        float cy = m.matrix[1][0]*x + m.matrix[1][1]*y + m.matrix[1][2]*z + m.matrix[1][3];
+        float cz = m.matrix[2][0]*x + m.matrix[2][1]*y + m.matrix[2][2]*z + m.matrix[2][3];
+        float cw = m.matrix[3][0]*x + m.matrix[3][1]*y + m.matrix[3][2]*z + m.matrix[3][3];
+        // ニアクリップ面より手前にはみ出す
+        if (cw <= 0.0f || cz < -cw) return false;
+        float invW = 1.0f / cw;
+        minX = std::min(minX, cx * invW);
+        maxX = std::max(maxX, cx * invW);
+        minY = std::min(minY, cy * invW);
+        maxY = std::max(maxY, cy * invW);
+        nearest = std::min(nearest, cz * invW * 0.5f + 0.5f);
+    }
+    // 画面外の部分は深度が無いため判定しない
+    if (minX < -1.0f || maxX > 1.0f || minY < -1.0f || maxY > 1.0f) return false;
+
+    const Level& base = mLevels[0];
+    int x0 = std::min(base.width - 1, static_cast<int>((minX * 0.5f + 0.5f) * base.width));
+    int x1 = std::min(base.width - 1, static_cast<int>((maxX * 0.5f + 0.5f) * base.width));
+    int y0 = std::min(base.height - 1, static_cast<int>((minY * 0.5f + 0.5f) * base.height));
+    int y1 = std::min(base.height - 1, static_cast<int>((maxY * 0.5f + 0.5f) * base.height));
+
+    // 矩形が2x2画素以内に収まる段を選ぶ
+    int level = 0;
+    while (level < static_cast<int>(mLevels.size()) - 1
+           && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+    {
+        level++;
+    }
+    const Level& hiz = mLevels[level];
+    float farthest = 0.0f;
+    for (int y = y0 >> level; y <= (y1 >> level); y++)
+    {
+        for (int x = x0 >> level; x <= (x1 >> level); x++)
+        {
+            farthest = std::max(farthest, hiz.depth[y * hiz.width + x]);
+        }
+    }
+    return nearest > farthest;
+}
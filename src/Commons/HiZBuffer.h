@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include "Math.h"
+
+// 階層Zバッファクラス
+// *各段は1つ下の段の2x2画素のうち最も奥の深度を持つ（遮蔽判定が保守的になる）
+// *深度は前フレームの深度バッファの読み戻し、またはCPUでラスタライズした遮蔽物から作る
+// *GLに依存しないため、GPU無しでも判定を確認できる
+// *深度はウィンドウ座標（0〜1）、行は画面の下から上の順（glReadPixelsと同じ）
+class HiZBuffer
+{
+public:
+    HiZBuffer();
+    ~HiZBuffer();
+
+    void Resize(int width, int height); // 最下段の解像度
+    void Clear(); // 最下段を最も奥の深度（1.0）で埋める
+
+    // 深度バッファ（任意の解像度）を最下段に縮小して設定
+    // *各画素が覆う範囲の最も奥の深度を採用する
+    void SetDepth(const float* depth, int width, int height);
+
+    // 遮蔽物の三角形をラスタライズして最下段に書き込む（手前の深度を残す）
+    // *ニアクリップ面をまたぐ三角形は遮蔽物として使わない
+    void RasterizeTriangles(const float* positions, int positionStride,
+                            const unsigned int* indices, int indexCount,
+                            const Matrix4& worldViewProjection);
+
+    // 最下段から上の段を作る
+    void BuildPyramid();
+
+    // ボックスが遮蔽されているか？（ローカル座標のAABB、ワールド変換座標）
+    // *深度を作成した時のビュー射影行列で判定する
+    // *画面外にはみ出す、カメラに接するなど判定できない場合は遮蔽されていない
+    bool IsBoxOccluded(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world) const;
+
+private:
+    struct Level
+    {
+        int width;
+        int height;
+        std::vector<float> depth;
+    };
+    std::vector<Level> mLevels;
+    Matrix4 mViewProjection; // 深度を作成した時のビュー射影行列
+
+public:
+    void SetViewProjection(const Matrix4& viewProjection) { mViewProjection = viewProjection; }
+    const Matrix4& GetViewProjection() const { return mViewProjection; }
+    int GetWidth() const { return mLevels.empty() ? 0 : mLevels[0].width; }
+    int GetHeight() const { return mLevels.empty() ? 0 : mLevels[0].height; }
+    int GetLevelCount() const { return static_cast<int>(mLevels.size()); }
+    const float* GetLevelDepth(int level) const { return mLevels[level].depth.data(); }
+    int GetLevelWidth(int level) const { return mLevels[level].width; }
+    int GetLevelHeight(int level) const { return mLevels[level].height; }
+
+};
@@ -0,0 +1,168 @@
+#include "InputSystem.h"
+#include <algorithm>
+#include "../Actors/Actor.h"
+
+InputSystem::InputSystem()
+:mPerfFrequency(SDL_GetPerformanceFrequency())
+{
+    for (int i = 0; i < ACTION_COUNT; i++)
+    {
+        mHeld[i] = false;
+    }
+
+    // デフォルトのキー割り当て
+    BindAction(MOVE_LEFT, SDL_SCANCODE_A);
+    BindAction(MOVE_RIGHT, SDL_SCANCODE_D);
+    BindAction(MOVE_UP, SDL_SCANCODE_W);
+    BindAction(MOVE_DOWN, SDL_SCANCODE_S);
+    BindAction(MOVE_FORWARD, SDL_SCANCODE_UP);
+    BindAction(MOVE_BACK, SDL_SCANCODE_DOWN);
+    BindAction(QUIT, SDL_SCANCODE_ESCAPE);
+    BindAction(TOGGLE_RENDER_PATH, SDL_SCANCODE_F2);
+    BindAction(TOGGLE_DEPTH_PREPASS, SDL_SCANCODE_F3);
+    BindAction(CYCLE_OCCLUSION_MODE, SDL_SCANCODE_F4);
+    BindAction(CYCLE_SHADOW_QUALITY, SDL_SCANCODE_F5);
+    BindAction(DUMP_FRAME_GRAPH, SDL_SCANCODE_F6);
+    BindAction(TOGGLE_DYNAMIC_RESOLUTION, SDL_SCANCODE_F7);
+    BindAction(CYCLE_POST_QUALITY, SDL_SCANCODE_F8);
+    BindAction(DUMP_GPU_PROFILE, SDL_SCANCODE_F9);
+    BindAction(TOGGLE_MULTI_DRAW, SDL_SCANCODE_F10);
+    BindAction(TOGGLE_GPU_CULLING, SDL_SCANCODE_F11);
+    BindAction(SAVE_SCENE, SDL_SCANCODE_F12);
+}
+
+InputSystem::~InputSystem()
+{}
+
+// キー割り当て・解除
+void InputSystem::BindAction(Action action, SDL_Scancode scancode)
+{
+    mBindings[action].emplace_back(scancode);
+}
+void InputSystem::UnbindAction(Action action)
+{
+    mBindings[action].clear();
+    mHeld[action] = false;
+}
+
+// SDLイベントをアクションに変換してキューに追加
+void InputSystem::ProcessEvent(const SDL_Event& event)
+{
+    if (event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) return;
+    // キーリピートは無視する
+    if (event.key.repeat) return;
+
+    Action action;
+    if (!FindAction(event.key.keysym.scancode, action)) return;
+
+    InputEvent inputEvent;
+    inputEvent.action = action;
+    inputEvent.type = event.type == SDL_KEYDOWN ? PRESSED : RELEASED;
+    inputEvent.timestamp = SDL_GetPerformanceCounter();
+    mEvents.emplace_back(inputEvent);
+}
+
+// 押下状態の更新
+void InputSystem::Update()
+{
+    const Uint8* state = SDL_GetKeyboardState(NULL);
+    for (int i = 0; i < ACTION_COUNT; i++)
+    {
+        bool held = false;
+        for (auto scancode : mBindings[i])
+        {
+            if (state[scancode])
+            {
+                held = true;
+                break;
+            }
+        }
+        mHeld[i] = held;
+    }
+}
+
+// 購読アクタへの通知
+// *入力が無いフレームでは呼び出しを行わない
+void InputSystem::Dispatch()
+{
+    bool hasInput = !mEvents.empty();
+    for (int i = 0; i < ACTION_COUNT && !hasInput; i++)
+    {
+        hasInput = mHeld[i];
+    }
+    if (!hasInput) return;
+
+    for (auto actor : mSubscribers)
+    {
+        if (actor->GetState() == Actor::EActive)
+        {
+            actor->ProcessInput(this);
+        }
+    }
+}
+
+void InputSystem::ClearEvents()
+{
+    mEvents.clear();
+}
+
+// 購読アクタ追加・削除処理
+void InputSystem::AddSubscriber(Actor* actor)
+{
+    mSubscribers.emplace_back(actor);
+}
+void InputSystem::RemoveSubscriber(Actor* actor)
+{
+    auto iter = std::find(mSubscribers.begin(), mSubscribers.end(), actor);
+    if (iter != mSubscribers.end())
+    {
+        mSubscribers.erase(iter);
+    }
+}
+
+bool InputSystem::IsActionHeld(Action action) const
+{
+    return mHeld[action];
+}
+
+bool InputSystem::WasActionPressed(Action action) const
+{
+    for (const auto& event : mEvents)
+    {
+        if (event.action == action && event.type == PRESSED) return true;
+    }
+    return false;
+}
+
+bool InputSystem::WasActionReleased(Action action) const
+{
+    for (const auto& event : mEvents)
+    {
+        if (event.action == action && event.type == RELEASED) return true;
+    }
+    return false;
+}
+
+// 入力検知から現在までの経過時間(ms)
+float InputSystem::GetLatencyMs(const InputEvent& event) const
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    return static_cast<float>(now - event.timestamp) * 1000.0f / static_cast<float>(mPerfFrequency);
+}
+
+// スキャンコードに割り当てられたアクションを検索
+bool InputSystem::FindAction(SDL_Scancode scancode, Action& outAction) const
+{
+    for (int i = 0; i < ACTION_COUNT; i++)
+    {
+        for (auto bound : mBindings[i])
+        {
+            if (bound == scancode)
+            {
+                outAction = static_cast<Action>(i);
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <SDL.h>
+#include <vector>
+
+// 入力管理クラス
+// *キー入力をアクションに変換し、購読しているアクタにのみ通知する
+class InputSystem
+{
+public:
+    // アクション
+    enum Action
+    {
+        MOVE_LEFT,     // 左移動
+        MOVE_RIGHT,    // 右移動
+        MOVE_UP,       // 上移動
+        MOVE_DOWN,     // 下移動
+        MOVE_FORWARD,  // 前進
+        MOVE_BACK,     // 後退
+        QUIT,          // 終了
+        TOGGLE_RENDER_PATH, // 描画方式の切替（フォワード、ディファード）
+        TOGGLE_DEPTH_PREPASS, // 深度プリパスの切替
+        CYCLE_OCCLUSION_MODE, // オクルージョンカリングの方式の切替
+        CYCLE_SHADOW_QUALITY, // 影の品質の切替
+        DUMP_FRAME_GRAPH,     // 描画パスの構成の出力
+        TOGGLE_DYNAMIC_RESOLUTION, // 動的解像度の切替
+        CYCLE_POST_QUALITY,   // ポストプロセスの品質の切替
+        DUMP_GPU_PROFILE,     // パスごとのGPU時間の出力
+        TOGGLE_MULTI_DRAW,    // 間接描画でまとめて描画するかの切替
+        TOGGLE_GPU_CULLING,   // GPUカリングの切替
+        SAVE_SCENE,           // シーンファイルの保存
+        ACTION_COUNT,
+    };
+
+    // イベント種別
+    enum EventType
+    {
+        PRESSED,  // 押された
+        RELEASED, // 離された
+    };
+
+    // 入力イベント
+    struct InputEvent
+    {
+        Action action;    // アクション
+        EventType type;   // イベント種別
+        Uint64 timestamp; // 検知した時刻（パフォーマンスカウンタ）
+    };
+
+    InputSystem();
+    ~InputSystem();
+
+    void BindAction(Action action, SDL_Scancode scancode);   // キー割り当て
+    void UnbindAction(Action action);                        // キー割り当て解除
+    void ProcessEvent(const SDL_Event& event);               // SDLイベントをキューに追加
+    void Update();                                           // 押下状態の更新
+    void Dispatch();                                         // 購読アクタへの通知
+    void ClearEvents();                                      // イベントキューのクリア
+
+    void AddSubscriber(class Actor* actor);    // 購読アクタ追加
+    void RemoveSubscriber(class Actor* actor); // 購読アクタ削除
+
+    bool IsActionHeld(Action action) const;                  // 押下中か？
+    bool WasActionPressed(Action action) const;              // 今フレームで押されたか？
+    bool WasActionReleased(Action action) const;             // 今フレームで離されたか？
+    float GetLatencyMs(const InputEvent& event) const;       // 検知から現在までの経過時間(ms)
+
+private:
+    bool FindAction(SDL_Scancode scancode, Action& outAction) const;
+
+    std::vector<SDL_Scancode> mBindings[ACTION_COUNT]; // アクションごとのキー割り当て
+    bool mHeld[ACTION_COUNT];                          // アクションごとの押下状態
+    std::vector<InputEvent> mEvents;                   // 今フレームのイベントキュー
+    std::vector<class Actor*> mSubscribers;            // 購読中のアクタリスト
+    Uint64 mPerfFrequency;                             // パフォーマンスカウンタの周波数
+
+public:
+    const std::vector<InputEvent>& GetEvents() const { return mEvents; }
+
+};
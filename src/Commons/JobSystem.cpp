@@ -0,0 +1,109 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem::JobSystem(int workerCount)
+:mBatch(nullptr)
+,mBatchId(0)
+,mActiveWorkers(0)
+,mIsRunning(true)
+{
+    if (workerCount < 0)
+    {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(0, cores - 1);
+    }
+    for (int i = 0; i < workerCount; i++)
+    {
+        mWorkers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsRunning = false;
+    }
+    mWakeCondition.notify_all();
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t minBatch, const RangeFunc& func)
+{
+    if (count == 0) return;
+
+    // 分割しても効果が無い場合はそのまま処理
+    size_t threadCount = mWorkers.size() + 1;
+    if (mWorkers.empty() || count <= minBatch)
+    {
+        func(0, count);
+        return;
+    }
+
+    // スレッド数の数倍に分割して、処理時間の偏りを吸収する
+    Batch batch;
+    batch.func = &func;
+    batch.count = count;
+    batch.batchSize = std::max(std::max<size_t>(minBatch, 1), (count + threadCount * 4 - 1) / (threadCount * 4));
+    batch.next = 0;
+    batch.finished = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBatch = &batch;
+        mBatchId++;
+    }
+    mWakeCondition.notify_all();
+
+    // 呼出元スレッドも処理する
+    RunBatch(&batch);
+
+    // 全ての範囲が処理され、参加中のワーカーが抜けるまで待つ
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [&batch, this] {
+        return batch.finished.load() == batch.count && mActiveWorkers == 0;
+    });
+    mBatch = nullptr;
+}
+
+void JobSystem::WorkerLoop()
+{
+    unsigned int lastBatchId = 0;
+    while (true)
+    {
+        Batch* batch = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWakeCondition.wait(lock, [this, lastBatchId] {
+                return !mIsRunning || (mBatch && mBatchId != lastBatchId);
+            });
+            if (!mIsRunning) return;
+            batch = mBatch;
+            lastBatchId = mBatchId;
+            mActiveWorkers++;
+        }
+
+        RunBatch(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mActiveWorkers--;
+        }
+        mDoneCondition.notify_all();
+    }
+}
+
+void JobSystem::RunBatch(Batch* batch)
+{
+    while (true)
+    {
+        size_t begin = batch->next.fetch_add(batch->batchSize);
+        if (begin >= batch->count) break;
+        size_t end = std::min(begin + batch->batchSize, batch->count);
+        (*batch->func)(begin, end);
+        batch->finished.fetch_add(end - begin);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ジョブシステムクラス
+// *起動時にワーカースレッドを作成しておき、毎フレームのスレッド生成を避ける
+// *ParallelForは範囲を分割してワーカーと呼出元スレッドで処理し、全て終わるまで待つ
+class JobSystem
+{
+public:
+    typedef std::function<void(size_t begin, size_t end)> RangeFunc; // [begin, end)を処理する
+
+    JobSystem(int workerCount = -1); // -1: 論理コア数 - 1
+    ~JobSystem();
+
+    // 範囲を分割して並列に処理する（minBatch未満には分割しない）
+    void ParallelFor(size_t count, size_t minBatch, const RangeFunc& func);
+
+private:
+    // 1回のParallelFor呼出
+    struct Batch
+    {
+        const RangeFunc* func;
+        size_t count;
+        size_t batchSize;
+        std::atomic<size_t> next;     // 次に処理する開始位置
+        std::atomic<size_t> finished; // 処理済の件数
+    };
+
+    void WorkerLoop();
+    static void RunBatch(Batch* batch);
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mWakeCondition; // ワーカーを起こす
+    std::condition_variable mDoneCondition; // 呼出元に完了を通知
+    Batch* mBatch;         // 処理中のバッチ（無ければnullptr）
+    unsigned int mBatchId; // バッチ番号（ワーカーの二重参加防止）
+    int mActiveWorkers;    // バッチを処理中のワーカー数
+    bool mIsRunning;
+
+public:
+    int GetWorkerCount() const { return static_cast<int>(mWorkers.size()); }
+    int GetThreadCount() const { return static_cast<int>(mWorkers.size()) + 1; } // 呼出元を含む
+
+};
@@ -0,0 +1,157 @@
+#include "Lz4Codec.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const size_t MIN_MATCH = 4;      // 一致の最小長
+    const size_t LAST_LITERALS = 5;  // 末尾は必ずリテラル
+    const size_t MATCH_MARGIN = 12;  // 最後の一致は末尾からこれ以上前で始まる
+    const size_t MAX_OFFSET = 65535; // 一致の距離の上限（2バイト）
+    const int HASH_BITS = 14;
+
+    inline uint32_t Read32(const unsigned char* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t Hash(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // 15以上の長さの続き（255ずつ）
+    inline unsigned char* WriteLength(unsigned char* out, size_t length)
+    {
+        while (length >= 255)
+        {
+            *out++ = 255;
+            length -= 255;
+        }
+        *out++ = static_cast<unsigned char>(length);
+        return out;
+    }
+
+    inline bool ReadLength(const unsigned char*& in, const unsigned char* end, size_t& length)
+    {
+        unsigned char value;
+        do
+        {
+            if (in >= end) return false;
+            value = *in++;
+            length += value;
+        } while (value == 255);
+        return true;
+    }
+
+    // リテラルと一致（matchLengthが0ならリテラルのみの最後のシーケンス）
+    unsigned char* WriteSequence(unsigned char* out, const unsigned char* literals, size_t literalLength,
+                                 size_t offset, size_t matchLength)
+    {
+        unsigned char* token = out++;
+        *token = static_cast<unsigned char>((literalLength >= 15 ? 15 : literalLength) << 4);
+        if (literalLength >= 15) out = WriteLength(out, literalLength - 15);
+        std::memcpy(out, literals, literalLength);
+        out += literalLength;
+        if (matchLength == 0) return out;
+
+        *out++ = static_cast<unsigned char>(offset & 0xff);
+        *out++ = static_cast<unsigned char>(offset >> 8);
+        size_t length = matchLength - MIN_MATCH;
+        *token |= static_cast<unsigned char>(length >= 15 ? 15 : length);
+        if (length >= 15) out = WriteLength(out, length - 15);
+        return out;
+    }
+}
+
+size_t Lz4Codec::GetMaxCompressedBytes(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t Lz4Codec::Compress(const unsigned char* src, size_t size, unsigned char* out)
+{
+    unsigned char* const outStart = out;
+    size_t anchor = 0;
+    if (size >= MATCH_MARGIN + 1)
+    {
+        // 位置+1を入れる（0は未登録）
+        std::vector<uint32_t> table(1 << HASH_BITS, 0);
+        const size_t matchLimit = size - LAST_LITERALS;
+        const size_t searchEnd = size - MATCH_MARGIN;
+        size_t pos = 0;
+        while (pos <= searchEnd)
+        {
+            const uint32_t sequence = Read32(src + pos);
+            uint32_t& slot = table[Hash(sequence)];
+            const size_t candidate = slot;
+            slot = static_cast<uint32_t>(pos + 1);
+            if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || Read32(src + candidate - 1) != sequence)
+            {
+                pos++;
+                continue;
+            }
+
+            // 一致を前後に伸ばす
+            size_t match = candidate - 1;
+            size_t length = MIN_MATCH;
+            while (pos + length < matchLimit && src[match + length] == src[pos + length]) length++;
+            while (pos > anchor && match > 0 && src[pos - 1] == src[match - 1])
+            {
+                pos--;
+                match--;
+                length++;
+            }
+            out = WriteSequence(out, src + anchor, pos - anchor, pos - match, length);
+            pos += length;
+            anchor = pos;
+        }
+    }
+    out = WriteSequence(out, src + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(out - outStart);
+}
+
+bool Lz4Codec::Decompress(const unsigned char* src, size_t srcSize, unsigned char* out, size_t outSize)
+{
+    const unsigned char* in = src;
+    const unsigned char* const inEnd = src + srcSize;
+    size_t written = 0;
+    while (in < inEnd)
+    {
+        const unsigned char token = *in++;
+
+        // リテラル
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(in, inEnd, literalLength)) return false;
+        if (literalLength > static_cast<size_t>(inEnd - in) || literalLength > outSize - written) return false;
+        std::memcpy(out + written, in, literalLength);
+        in += literalLength;
+        written += literalLength;
+        if (in == inEnd) break; // 最後のシーケンス
+
+        // 一致（距離が長さより短い場合は重なるため1バイトずつコピー）
+        if (inEnd - in < 2) return false;
+        const size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > written) return false;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(in, inEnd, matchLength)) return false;
+        matchLength += MIN_MATCH;
+        if (matchLength > outSize - written) return false;
+        unsigned char* dest = out + written;
+        const unsigned char* match = dest - offset;
+        if (offset >= matchLength)
+        {
+            std::memcpy(dest, match, matchLength);
+        }
+        else
+        {
+            for (size_t i = 0; i < matchLength; i++) dest[i] = match[i];
+        }
+        written += matchLength;
+    }
+    return written == outSize;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+
+// LZ4ブロック形式の圧縮処理をまとめたライブラリ
+// *外部ライブラリを使わずに、LZ4のブロック形式（フレーム形式のヘッダ無し）を読み書きする
+// *圧縮はハッシュ表による貪欲法（速度優先、圧縮率は高くない）、展開は入力・出力の範囲を検査する
+// *アセットパックのブロックごとの圧縮に使う（ブロックは独立しているため並列に展開できる）
+namespace Lz4Codec
+{
+    // 圧縮後の最大バイト数（圧縮できないデータでもこの容量があれば足りる）
+    size_t GetMaxCompressedBytes(size_t size);
+
+    // 圧縮（outは GetMaxCompressedBytes(size) 以上の容量が必要）
+    // *圧縮後のバイト数を返す
+    size_t Compress(const unsigned char* src, size_t size, unsigned char* out);
+
+    // 展開（展開後のバイト数がoutSizeと一致しなければfalse）
+    bool Decompress(const unsigned char* src, size_t srcSize, unsigned char* out, size_t outSize);
+}
@@ -1,13 +1,23 @@
 #include "Mesh.h"
 #include <SDL.h>
-#include <iostream>
-#include <vector>
+#include <algorithm>
+#include <cmath>
 #include "../Game.h"
-#include "VertexArray.h"
+#include "Animation.h"
+#include "FbxMeshImporter.h"
+#include "FileSystem.h"
+#include "GeometryPool.h"
+#include "MeshFile.h"
 
 Mesh::Mesh()
-:mVertexArray(nullptr)
-,mTexture(nullptr)
+:mGeometryPool(nullptr)
+,mGeometry(-1)
+,mNumVertices(0)
+,mNumIndices(0)
+,mRadius(0.0f)
+,mBoxMin(Math::VEC3_ZERO)
+,mBoxMax(Math::VEC3_ZERO)
+,mSkeleton(nullptr)
 {}
 
 Mesh::~Mesh()
@@ -15,219 +25,160 @@ Mesh::~Mesh()
 
 bool Mesh::Load(const std::string &filePath, Game* game)
 {
-    // マネージャーの初期化
-    FbxManager* manager = FbxManager::Create();
-
-    // インポーターの初期化
-    FbxImporter* importer = FbxImporter::Create(manager, "");
-    if (!importer->Initialize(filePath.c_str(), -1, manager->GetIOSettings()))
+    // 変換済メッシュ（AssetBuilderで作成）があれば読み込み、無ければFBXを読み込む
+    // *アセットパックにあればメモリから読み込む（個別のFBXはSDKが直接開く）
+    FileSystem* fileSystem = game->GetFileSystem();
+    FileSystem::File file;
+    MeshFile meshFile;
+    const std::string cookedPath = MeshFile::GetCookedPath(filePath);
+    if (fileSystem->Exists(cookedPath))
     {
-        SDL_Log("failed fbx initialize importer.");
-        return false;
+        if (!fileSystem->ReadFile(cookedPath, file, game->GetJobSystem())
+            || !meshFile.Load(file.GetData(), file.GetSize()))
+        {
+            SDL_Log("failed load cooked mesh: %s", cookedPath.c_str());
+            return false;
+        }
     }
-
-    // シーンの作成
-    FbxScene* scene = FbxScene::Create(manager, "");
-    importer->Import(scene);
-    importer->Destroy();
-
-    // 三角ポリゴンへのコンバート
-    FbxGeometryConverter geometryConverter(manager);
-    if (!geometryConverter.Triangulate(scene, true))
+    else
     {
-        SDL_Log("failed fbx convert triangle.");
-        return false;
+        const bool isPacked = fileSystem->IsPacked(filePath);
+        if (isPacked && !fileSystem->ReadFile(filePath, file, game->GetJobSystem()))
+        {
+            SDL_Log("failed read fbx from asset pack.");
+            return false;
+        }
+        FbxMeshImporter importer;
+        if (!importer.Import(filePath, file.GetData(), file.GetSize(), meshFile)) return false;
     }
+    return Create(filePath, meshFile, game);
+}
 
-    // メッシュ取得
-    FbxMesh* mesh = scene->GetSrcObject<FbxMesh>();
-    if (!mesh)
+// 読み込んだメッシュからGPUのジオメトリ、マテリアル、スケルトンを作成する
+bool Mesh::Create(const std::string& filePath, const MeshFile& meshFile, Game* game)
+{
+    // マテリアル表の作成、テクスチャの読込
+    Renderer* renderer = game->GetRenderer();
+    for (const auto& fileMaterial : meshFile.GetMaterials())
     {
-        SDL_Log("failed fbx scene get mesh.");
-        return false;
+        Material material;
+        material.name = fileMaterial.name;
+        material.textureId = renderer->InternTexture(game->GetAssetsPath() + fileMaterial.textureFileName);
+        material.texture = renderer->GetTexture(material.textureId);
+        mMaterials.emplace_back(material);
     }
 
-    // テクスチャの読込
-    // ＊現在の実装だと１つしか読み込めない
-    std::string fileName = "default_tex.png";
-    int materialCount = scene->GetMaterialCount();
-    if (materialCount > 0)
+    // 頂点座標配列の作成
+    int vertexCount = meshFile.GetVertexCount();
+    const float* vertices = meshFile.GetVertices().data();
+    mPositions.resize(vertexCount * 3);
+    if (vertexCount > 0)
     {
-        // マテリアル取得
-        FbxSurfaceMaterial* material = scene->GetMaterial(0);
-        FbxProperty property = material->FindProperty(FbxSurfaceMaterial::sDiffuse);
-        int textureCount = property.GetSrcObjectCount();
-        if (textureCount > 0)
-        {
-            // テクスチャ名取得
-            FbxFileTexture* fileTexture = scene->GetSrcObject<FbxFileTexture>(0);
-            fileName = FbxPathUtils::GetFileName(fileTexture->GetFileName());
-        }
+        mBoxMin = Vector3(vertices[0], vertices[1], vertices[2]);
+        mBoxMax = mBoxMin;
     }
-    mTexture = game->GetRenderer()->GetTexture(game->GetAssetsPath() + fileName);
-
-    // UVセット名の取得
-    FbxStringList uvSetNameList;
-    mesh->GetUVSetNames(uvSetNameList);
-    const char* uvSetName = uvSetNameList.GetStringAt(0);
-
-    // 頂点座標の読込
-    std::vector<std::vector<float>> vertexList;
-    for (int i = 0; i < mesh->GetControlPointsCount(); i++)
+    for (int i = 0; i < vertexCount; i++)
     {
-        FbxVector4 point = mesh->GetControlPointAt(i);
-        std::vector<float> vertex;
-        vertex.push_back(point[0]);
-        vertex.push_back(point[1]);
-        vertex.push_back(point[2]);
-        vertexList.push_back(vertex);
+        const float* vertex = &vertices[i*8];
+        // 境界球の半径
+        float length = sqrtf(vertex[0]*vertex[0] + vertex[1]*vertex[1] + vertex[2]*vertex[2]);
+        if (length > mRadius) mRadius = length;
+        // 境界ボックス
+        mBoxMin = Vector3(std::min(mBoxMin.x, vertex[0]), std::min(mBoxMin.y, vertex[1]), std::min(mBoxMin.z, vertex[2]));
+        mBoxMax = Vector3(std::max(mBoxMax.x, vertex[0]), std::max(mBoxMax.y, vertex[1]), std::max(mBoxMax.z, vertex[2]));
+        mPositions[i*3+0] = vertex[0];
+        mPositions[i*3+1] = vertex[1];
+        mPositions[i*3+2] = vertex[2];
     }
 
-    // インデックス座標の読込
-    std::vector<int> vertexIndexList;
-    std::vector<std::vector<int>> newVertexIndexList;
-    // ポリゴンごとにループ
-    int polCount = mesh->GetPolygonCount();
-    for (int polIndex = 0; polIndex < polCount; polIndex++)
+    // サブメッシュの作成（マテリアルの番号順、境界ボックスを求める）
+    mIndices = meshFile.GetIndices();
+    for (const auto& fileSubMesh : meshFile.GetSubMeshes())
     {
-        // 頂点ごとにループ
-        int polVertexCount = mesh->GetPolygonSize(polIndex);
-        for (int polVertexIndex = 0; polVertexIndex < polVertexCount; polVertexIndex++)
+        if (fileSubMesh.indexCount == 0) continue;
+        SubMesh subMesh;
+        subMesh.firstIndex = fileSubMesh.firstIndex;
+        subMesh.indexCount = fileSubMesh.indexCount;
+        subMesh.material = static_cast<int>(fileSubMesh.material);
+        const float* first = &vertices[mIndices[subMesh.firstIndex] * 8];
+        subMesh.boxMin = Vector3(first[0], first[1], first[2]);
+        subMesh.boxMax = subMesh.boxMin;
+        for (unsigned int i = subMesh.firstIndex; i < subMesh.firstIndex + subMesh.indexCount; i++)
         {
-            // 頂点インデックスの取得
-            int vertexIndex = mesh->GetPolygonVertex(polIndex, polVertexIndex);
-            std::vector<float> vertex = vertexList[vertexIndex];
-
-            // 法線座標の取得
-            FbxVector4 normalVec4;
-            mesh->GetPolygonVertexNormal(polIndex, polVertexIndex, normalVec4);
-
-            // UV座標の取得
-            FbxVector2 uvVec2;
-            bool isUnMapped;
-            mesh->GetPolygonVertexUV(polIndex, polVertexIndex, uvSetName, uvVec2, isUnMapped);
-
-            if (vertex.size() == 3)
-            {
-                // 法線座標とUV座標が未設定の場合、頂点情報に付与して設定
-                std::vector<float> vertexInfo = CreateVertexInfo(vertex, normalVec4, uvVec2);
-                vertexList[vertexIndex] = vertexInfo;
-            }
-            else if (!IsEqualNormalUV(vertex, normalVec4, uvVec2))
-            {
-                // ＊同一頂点インデックスの中で法線座標かUV座標が異なる場合、
-                // 新たな頂点インデックスとして作成する
-
-                // 新たな頂点インデックスとして作成済かどうか？
-                bool isNewVertexCreated = false;
-                for (int i = 0; i < newVertexIndexList.size(); i++)
-                {
-                    int oldIndex = newVertexIndexList[i][0];
-                    int newIndex = newVertexIndexList[i][1];
-                    if (oldIndex == vertexIndex
-                        && IsEqualNormalUV(vertexList[newIndex], normalVec4, uvVec2))
-                    {
-                        isNewVertexCreated = true;
-                        vertexIndex = newIndex;
-                        break;
-                    }
-                }
-                // 作成済でない場合
-                if (!isNewVertexCreated)
-                {
-                    // 新たな頂点インデックスとして作成
-                    std::vector<float> vertexInfo = CreateVertexInfo(vertex, normalVec4, uvVec2);
-                    vertexList.push_back(vertexInfo);
-                    // 作成したインデックス情報を設定
-                    int newIndex = vertexList.size() - 1;
-                    std::vector<int> newVertexIndex;
-                    newVertexIndex.push_back(vertexIndex); // old index
-                    newVertexIndex.push_back(newIndex);    // new index
-                    newVertexIndexList.push_back(newVertexIndex);
-                    vertexIndex = newIndex;
-                }
-            }
-            // インデックスバッファを追加
-            vertexIndexList.push_back(vertexIndex);
+            const float* vertex = &vertices[mIndices[i] * 8];
+            subMesh.boxMin = Vector3(std::min(subMesh.boxMin.x, vertex[0]), std::min(subMesh.boxMin.y, vertex[1]),
+                                     std::min(subMesh.boxMin.z, vertex[2]));
+            subMesh.boxMax = Vector3(std::max(subMesh.boxMax.x, vertex[0]), std::max(subMesh.boxMax.y, vertex[1]),
+                                     std::max(subMesh.boxMax.z, vertex[2]));
         }
+        mSubMeshes.emplace_back(subMesh);
     }
+    int indexCount = static_cast<int>(mIndices.size());
 
-    // 頂点座標配列の作成
-    int vertexCount = vertexList.size();
-    float* vertices;
-    vertices = (float*) malloc(sizeof(float) * vertexCount * 8);
-    for (int i = 0; i < vertexCount; i++)
+    // スケルトンの作成
+    if (meshFile.HasSkin())
     {
-        auto vertex = vertexList[i];
-        // 位置座標
-        vertices[i*8+0] = vertex[0];
-        vertices[i*8+1] = vertex[1];
-        vertices[i*8+2] = vertex[2];
-        // 法線座標
-        vertices[i*8+3] = vertex[3];
-        vertices[i*8+4] = vertex[4];
-        vertices[i*8+5] = vertex[5];
-        // UV座標
-        vertices[i*8+6] = vertex[6];
-        vertices[i*8+7] = -vertex[7]; // V座標は反転させる
+        mSkeleton = new Skeleton();
+        for (const auto& joint : meshFile.GetJoints())
+        {
+            mSkeleton->AddJoint(joint.name, joint.parent, joint.inverseBindPose);
+        }
     }
 
-    // インデックスバッファ配列の作成
-    int indexCount = vertexIndexList.size();
-    unsigned int* indices = (unsigned int*)malloc(sizeof(unsigned int) * indexCount);
-    for (int i = 0; i < indexCount; i++)
+    // ジオメトリプールへの割り当て（GPUへ転送したら配列は不要）
+    mGeometryPool = renderer->GetGeometryPool();
+    mGeometry = mGeometryPool->Allocate(vertices, vertexCount, mIndices.data(), indexCount,
+                                        mSkeleton ? meshFile.GetSkins().data() : nullptr);
+    mNumVertices = vertexCount;
+    mNumIndices = indexCount;
+    if (mGeometry < 0)
     {
-        auto vertexIndex = vertexIndexList[i];
-        indices[i] = vertexIndex; // new
+        SDL_Log("failed allocate mesh geometry: %s", filePath.c_str());
+        return false;
     }
 
-    // 頂点クラスの初期化
-    mVertexArray = new VertexArray(vertices, vertexCount, indices, indexCount);
-
-    // マネージャー、シーンの破棄
-    scene->Destroy();
-    manager->Destroy();
+    // アニメーションクリップの作成（キーを量子化する）
+    const int jointCount = mSkeleton ? mSkeleton->GetJointCount() : 0;
+    for (const auto& animation : meshFile.GetAnimations())
+    {
+        AnimationClip* clip = new AnimationClip();
+        clip->Build(animation.name, jointCount, animation.frameCount, animation.sampleRate, animation.keys);
+        mAnimations.emplace_back(clip);
+    }
 
     return true;
 }
 
-// 頂点情報作成処理
-std::vector<float> Mesh::CreateVertexInfo(const std::vector<float>& vertex, const FbxVector4& normalVec4,
-                         const FbxVector2& uvVec2)
-{
-    std::vector<float> vertexInfo;
-    // 位置座標
-    vertexInfo.push_back(vertex[0]);
-    vertexInfo.push_back(vertex[1]);
-    vertexInfo.push_back(vertex[2]);
-    // 法線座標
-    vertexInfo.push_back(normalVec4[0]);
-    vertexInfo.push_back(normalVec4[1]);
-    vertexInfo.push_back(normalVec4[2]);
-    // UV座標
-    vertexInfo.push_back(uvVec2[0]);
-    vertexInfo.push_back(uvVec2[1]);
-    return vertexInfo;
-}
-
-// vertexInfoに法線、UV座標が設定済かどうか？
-bool Mesh::IsEqualNormalUV(const std::vector<float> vertexInfo,
-                           const FbxVector4 &normalVec4, const FbxVector2 &uvVec2)
+void Mesh::Unload()
 {
-    return fabs(vertexInfo[3] - normalVec4[0]) < FLT_EPSILON
-            && fabs(vertexInfo[4] - normalVec4[1]) < FLT_EPSILON
-            && fabs(vertexInfo[5] - normalVec4[2]) < FLT_EPSILON
-            && fabs(vertexInfo[6] - uvVec2[0]) < FLT_EPSILON
-            && fabs(vertexInfo[7] - uvVec2[1]) < FLT_EPSILON;
+    if (mGeometryPool && mGeometry >= 0) mGeometryPool->Free(mGeometry);
+    mGeometry = -1;
+    mPositions.clear();
+    mPositions.shrink_to_fit();
+    mIndices.clear();
+    mIndices.shrink_to_fit();
+    mSubMeshes.clear();
+    mMaterials.clear();
+    for (auto animation : mAnimations) delete animation;
+    mAnimations.clear();
+    delete mSkeleton;
+    mSkeleton = nullptr;
 }
 
-void Mesh::Unload()
+int Mesh::FindAnimation(const std::string& name) const
 {
-    delete mVertexArray;
-    mVertexArray = nullptr;
+    for (size_t i = 0; i < mAnimations.size(); i++)
+    {
+        if (mAnimations[i]->GetName() == name) return static_cast<int>(i);
+    }
+    return -1;
 }
 
-Texture* Mesh::GetTexture()
+size_t Mesh::GetGpuBytes() const
 {
-    return mTexture;
+    // 共有バッファのうち、このメッシュが使っている分
+    if (mGeometry < 0) return 0;
+    return mNumVertices * (GeometryPool::VERTEX_FLOATS + GeometryPool::POSITION_FLOATS) * sizeof(float)
+           + mNumVertices * (mSkeleton ? GeometryPool::SKIN_BYTES : 0)
+           + mNumIndices * sizeof(unsigned int);
 }
@@ -1,31 +1,77 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <fbxsdk.h>
+#include "Math.h"
+#include "ResourceCache.h"
 
 // モデルクラス
+// *FBXファイル内の全てのメッシュを1つの頂点・インデックスの範囲にまとめて読み込む（FbxMeshImporter）
+//  変換済メッシュ（.mesh）があればFBX SDKを使わずにそちらを読む
+// *ポリゴンのマテリアルごとにインデックスを並べ、マテリアル1つにつきサブメッシュを1つ作る
+//  サブメッシュはマテリアルの番号順のため、メッシュ内ではテクスチャの切替がマテリアルの数だけで済む
+// *スキンを持つメッシュがあれば、スケルトン、頂点ごとの4ボーンの重み、アニメーションスタックも読み込む
 class Mesh {
 public:
+    // マテリアル
+    struct Material
+    {
+        std::string name;
+        class Texture* texture; // 拡散反射のテクスチャ（無ければ既定のテクスチャ）
+        ResourceId textureId;   // テクスチャのID（参照カウント用）
+    };
+
+    // サブメッシュ（同じマテリアルのポリゴンの範囲）
+    struct SubMesh
+    {
+        unsigned int firstIndex; // メッシュの先頭からのインデックスの位置
+        unsigned int indexCount;
+        int material;            // マテリアルの番号
+        Vector3 boxMin;          // 境界ボックス（ローカル座標）
+        Vector3 boxMax;
+    };
+
     Mesh();
     ~Mesh();
 
     bool Load(const std::string& fileName, class Game* game);
     void Unload();
 
-    class Texture* GetTexture();
-
 private:
-    // 読み込んだモデル情報
-    class VertexArray* mVertexArray; // 頂点座標
-    class Texture* mTexture;         // テクスチャ
+    // 読み込んだメッシュからジオメトリ、マテリアル、スケルトン、アニメーションを作成する
+    bool Create(const std::string& filePath, const class MeshFile& meshFile, class Game* game);
 
-    // 頂点情報の編集で使用
-    std::vector<float> CreateVertexInfo(const std::vector<float>& vertex,
-                       const FbxVector4& normalVec4, const FbxVector2& uvVec2);
-    bool IsEqualNormalUV(const std::vector<float> vertexInfo,
-                         const FbxVector4& normalVec4, const FbxVector2& uvVec2);
+    // 読み込んだモデル情報
+    class GeometryPool* mGeometryPool; // 頂点、インデックスの割り当て先
+    int mGeometry;                     // ジオメトリプールのハンドル
+    unsigned int mNumVertices;
+    unsigned int mNumIndices;
+    std::vector<Material> mMaterials; // マテリアル表
+    std::vector<SubMesh> mSubMeshes;  // マテリアルの番号順
+    float mRadius;                   // 原点からの最大距離（境界球の半径）
+    Vector3 mBoxMin;                 // 境界ボックス（ローカル座標）
+    Vector3 mBoxMax;
+    // CPU側の位置座標、インデックス（遮蔽物のソフトウェアラスタライズ用）
+    std::vector<float> mPositions;
+    std::vector<unsigned int> mIndices;
+    // スケルトン、アニメーション（スキンが無ければnullptr、空）
+    class Skeleton* mSkeleton;
+    std::vector<class AnimationClip*> mAnimations;
 
 public:
-    class VertexArray* GetVertexArray() { return mVertexArray; }
+    int GetGeometry() const { return mGeometry; }
+    unsigned int GetNumIndices() const { return mNumIndices; }
+    float GetRadius() const { return mRadius; }
+    const Vector3& GetBoxMin() const { return mBoxMin; }
+    const Vector3& GetBoxMax() const { return mBoxMax; }
+    const std::vector<float>& GetPositions() const { return mPositions; }
+    const std::vector<unsigned int>& GetIndices() const { return mIndices; }
+    const std::vector<Material>& GetMaterials() const { return mMaterials; }
+    const std::vector<SubMesh>& GetSubMeshes() const { return mSubMeshes; }
+    int GetSubMeshCount() const { return static_cast<int>(mSubMeshes.size()); }
+    class Texture* GetSubMeshTexture(int subMesh) const { return mMaterials[mSubMeshes[subMesh].material].texture; }
+    size_t GetGpuBytes() const; // 頂点・インデックスバッファのバイト数
+    const class Skeleton* GetSkeleton() const { return mSkeleton; }
+    const std::vector<class AnimationClip*>& GetAnimations() const { return mAnimations; }
+    int FindAnimation(const std::string& name) const; // 見つからなければ-1
 
 };
@@ -0,0 +1,287 @@
+#include "MeshFile.h"
+#include <SDL.h>
+#include <cstring>
+#include <fstream>
+#include "FileSystem.h"
+
+namespace
+{
+    // ファイルのヘッダ
+    // *ヘッダの後に頂点、スキン、インデックス、サブメッシュ、マテリアル、関節、アニメーション、キーの配列、
+    //  文字列テーブルの順に並べる
+    const uint32_t MESH_MAGIC = 0x4853454D; // "MESH"
+    const uint32_t MESH_VERSION = 1;
+
+    struct MeshHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t hasSkin;
+        uint32_t indexCount;
+        uint32_t subMeshCount;
+        uint32_t materialCount;
+        uint32_t jointCount;
+        uint32_t animationCount;
+        uint32_t keyCount;
+        uint32_t stringBytes;
+    };
+
+    struct MaterialRecord
+    {
+        uint32_t nameOffset;
+        uint32_t textureOffset;
+    };
+
+    struct JointRecord
+    {
+        uint32_t nameOffset;
+        int32_t parent;
+        float inverseBindPose[16];
+    };
+
+    struct AnimationRecord
+    {
+        uint32_t nameOffset;
+        uint32_t frameCount;
+        float sampleRate;
+        uint32_t firstKey;
+    };
+
+    // メモリ上のデータを先頭から順に読む
+    struct MemoryReader
+    {
+        const unsigned char* data;
+        size_t size;
+        size_t position;
+
+        bool Read(void* out, size_t bytes)
+        {
+            if (bytes > size - position) return false;
+            std::memcpy(out, data + position, bytes);
+            position += bytes;
+            return true;
+        }
+        template <class T>
+        bool ReadArray(std::vector<T>& out, uint32_t count)
+        {
+            if (static_cast<uint64_t>(count) * sizeof(T) > size - position) return false;
+            out.resize(count);
+            return Read(out.data(), out.size() * sizeof(T));
+        }
+    };
+
+    // 文字列テーブルへの追加（先頭からの位置を返す）
+    uint32_t AddString(std::vector<char>& strings, const std::string& text)
+    {
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), text.begin(), text.end());
+        strings.push_back('\0');
+        return offset;
+    }
+
+    template <class T>
+    void WriteArray(std::ofstream& file, const std::vector<T>& values)
+    {
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+}
+
+MeshFile::MeshFile()
+{}
+
+MeshFile::~MeshFile()
+{}
+
+void MeshFile::Clear()
+{
+    mVertices.clear();
+    mSkins.clear();
+    mIndices.clear();
+    mSubMeshes.clear();
+    mMaterials.clear();
+    mJoints.clear();
+    mAnimations.clear();
+}
+
+bool MeshFile::Load(const std::string& filePath)
+{
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        SDL_Log("Failed open mesh file. (%s)", filePath.c_str());
+        return false;
+    }
+    std::vector<unsigned char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file || !Load(data.data(), data.size()))
+    {
+        SDL_Log("Invalid mesh file. (%s)", filePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// メモリ上のファイルの読込
+// *配列の範囲、インデックス、文字列の位置を確認し、壊れたファイルは読み込まない
+bool MeshFile::Load(const unsigned char* data, size_t size)
+{
+    Clear();
+    MemoryReader reader = { data, size, 0 };
+    MeshHeader header;
+    if (!reader.Read(&header, sizeof(header)) || header.magic != MESH_MAGIC || header.version != MESH_VERSION)
+    {
+        return false;
+    }
+
+    std::vector<MaterialRecord> materials;
+    std::vector<JointRecord> joints;
+    std::vector<AnimationRecord> animations;
+    std::vector<AnimationClip::Key> keys;
+    std::vector<char> strings;
+    const uint64_t vertexFloats = static_cast<uint64_t>(header.vertexCount) * VERTEX_FLOATS;
+    const uint64_t skinBytes = header.hasSkin ? static_cast<uint64_t>(header.vertexCount) * SKIN_BYTES : 0;
+    bool isValid = vertexFloats <= UINT32_MAX && skinBytes <= UINT32_MAX
+        && reader.ReadArray(mVertices, static_cast<uint32_t>(vertexFloats))
+        && reader.ReadArray(mSkins, static_cast<uint32_t>(skinBytes))
+        && reader.ReadArray(mIndices, header.indexCount)
+        && reader.ReadArray(mSubMeshes, header.subMeshCount)
+        && reader.ReadArray(materials, header.materialCount)
+        && reader.ReadArray(joints, header.jointCount)
+        && reader.ReadArray(animations, header.animationCount)
+        && reader.ReadArray(keys, header.keyCount)
+        && reader.ReadArray(strings, header.stringBytes)
+        && reader.position == size
+        && (strings.empty() || strings.back() == '\0');
+
+    // 範囲の確認
+    isValid = isValid && (header.hasSkin != 0) == (header.jointCount > 0);
+    for (unsigned int index : mIndices) isValid = isValid && index < header.vertexCount;
+    for (size_t i = 0; i < mSkins.size(); i += SKIN_BYTES)
+    {
+        for (int bone = 0; bone < 4; bone++) isValid = isValid && mSkins[i + bone] < header.jointCount;
+    }
+    for (const auto& subMesh : mSubMeshes)
+    {
+        isValid = isValid && subMesh.material < header.materialCount
+            && static_cast<uint64_t>(subMesh.firstIndex) + subMesh.indexCount <= header.indexCount;
+    }
+    for (const auto& material : materials)
+    {
+        isValid = isValid && material.nameOffset < header.stringBytes && material.textureOffset < header.stringBytes;
+    }
+    for (size_t i = 0; i < joints.size(); i++)
+    {
+        isValid = isValid && joints[i].nameOffset < header.stringBytes && joints[i].parent < static_cast<int32_t>(i);
+    }
+    for (const auto& animation : animations)
+    {
+        isValid = isValid && animation.nameOffset < header.stringBytes && animation.frameCount >= 2
+            && static_cast<uint64_t>(animation.firstKey) + static_cast<uint64_t>(animation.frameCount) * header.jointCount
+               <= header.keyCount;
+    }
+    if (!isValid)
+    {
+        Clear();
+        return false;
+    }
+
+    // 文字列、キーを展開
+    for (const auto& material : materials)
+    {
+        Material out;
+        out.name = &strings[material.nameOffset];
+        out.textureFileName = &strings[material.textureOffset];
+        mMaterials.emplace_back(out);
+    }
+    for (const auto& joint : joints)
+    {
+        Joint out;
+        out.name = &strings[joint.nameOffset];
+        out.parent = joint.parent;
+        std::memcpy(out.inverseBindPose.matrix, joint.inverseBindPose, sizeof(joint.inverseBindPose));
+        mJoints.emplace_back(out);
+    }
+    for (const auto& animation : animations)
+    {
+        Animation out;
+        out.name = &strings[animation.nameOffset];
+        out.frameCount = static_cast<int>(animation.frameCount);
+        out.sampleRate = animation.sampleRate;
+        auto first = keys.begin() + animation.firstKey;
+        out.keys.assign(first, first + static_cast<size_t>(animation.frameCount) * header.jointCount);
+        mAnimations.emplace_back(out);
+    }
+    return true;
+}
+
+bool MeshFile::Save(const std::string& filePath) const
+{
+    std::vector<char> strings;
+    std::vector<MaterialRecord> materials;
+    for (const auto& material : mMaterials)
+    {
+        MaterialRecord record;
+        record.nameOffset = AddString(strings, material.name);
+        record.textureOffset = AddString(strings, material.textureFileName);
+        materials.emplace_back(record);
+    }
+    std::vector<JointRecord> joints;
+    for (const auto& joint : mJoints)
+    {
+        JointRecord record;
+        record.nameOffset = AddString(strings, joint.name);
+        record.parent = joint.parent;
+        std::memcpy(record.inverseBindPose, joint.inverseBindPose.matrix, sizeof(record.inverseBindPose));
+        joints.emplace_back(record);
+    }
+    std::vector<AnimationRecord> animations;
+    std::vector<AnimationClip::Key> keys;
+    for (const auto& animation : mAnimations)
+    {
+        AnimationRecord record;
+        record.nameOffset = AddString(strings, animation.name);
+        record.frameCount = static_cast<uint32_t>(animation.frameCount);
+        record.sampleRate = animation.sampleRate;
+        record.firstKey = static_cast<uint32_t>(keys.size());
+        keys.insert(keys.end(), animation.keys.begin(), animation.keys.end());
+        animations.emplace_back(record);
+    }
+
+    MeshHeader header;
+    header.magic = MESH_MAGIC;
+    header.version = MESH_VERSION;
+    header.vertexCount = static_cast<uint32_t>(GetVertexCount());
+    header.hasSkin = mSkins.empty() ? 0 : 1;
+    header.indexCount = static_cast<uint32_t>(mIndices.size());
+    header.subMeshCount = static_cast<uint32_t>(mSubMeshes.size());
+    header.materialCount = static_cast<uint32_t>(materials.size());
+    header.jointCount = static_cast<uint32_t>(joints.size());
+    header.animationCount = static_cast<uint32_t>(animations.size());
+    header.keyCount = static_cast<uint32_t>(keys.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        SDL_Log("Failed open mesh file for write. (%s)", filePath.c_str());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteArray(file, mVertices);
+    WriteArray(file, mSkins);
+    WriteArray(file, mIndices);
+    WriteArray(file, mSubMeshes);
+    WriteArray(file, materials);
+    WriteArray(file, joints);
+    WriteArray(file, animations);
+    WriteArray(file, keys);
+    WriteArray(file, strings);
+    return static_cast<bool>(file);
+}
+
+std::string MeshFile::GetCookedPath(const std::string& filePath)
+{
+    return FileSystem::ReplaceExtension(filePath, ".mesh");
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Animation.h"
+
+// 変換済メッシュファイルクラス
+// *FBXから取り出した頂点、マテリアルごとのインデックス、スケルトン、アニメーションのキーをそのまま保存する
+//  （読込時にFBX SDKでシーンを解析せず、配列を読むだけで済む）
+// *テクスチャはファイル名のみ持つ（アセットパスからの相対、テクスチャの変換はDDSFileで別に行う）
+// *GL、FBX SDKに依存しないため、変換ツールでも使える
+class MeshFile
+{
+public:
+    // マテリアル
+    struct Material
+    {
+        std::string name;
+        std::string textureFileName; // 拡散反射のテクスチャ（無ければ既定のテクスチャ）
+    };
+
+    // サブメッシュ（マテリアルの番号順、インデックスはメッシュの先頭から）
+    struct SubMesh
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t material;
+    };
+
+    // 関節（親が子より前に並ぶ）
+    struct Joint
+    {
+        std::string name;
+        int parent;
+        Matrix4 inverseBindPose;
+    };
+
+    // アニメーション（フレームごとに関節数分のキー、量子化前）
+    struct Animation
+    {
+        std::string name;
+        int frameCount;
+        float sampleRate;
+        std::vector<AnimationClip::Key> keys;
+    };
+
+    MeshFile();
+    ~MeshFile();
+
+    bool Load(const std::string& filePath);
+    bool Load(const unsigned char* data, size_t size); // メモリ上のファイル（アセットパックなど）
+    bool Save(const std::string& filePath) const;
+    void Clear();
+
+    // 変換済メッシュのパスを取得（拡張子を.meshに置き換える）
+    static std::string GetCookedPath(const std::string& filePath);
+
+    // 頂点のfloat数（位置(xyz), 法線(xyz), u, v、GeometryPool::VERTEX_FLOATSと同じ）
+    static const int VERTEX_FLOATS = 8;
+    // 頂点のスキンのバイト数（ボーン番号(4), 重み(4)、GeometryPool::SKIN_BYTESと同じ）
+    static const int SKIN_BYTES = 8;
+
+private:
+    friend class FbxMeshImporter; // FBXからの変換で配列を直接作成する
+
+    std::vector<float> mVertices;      // VERTEX_FLOATSずつ
+    std::vector<unsigned char> mSkins; // SKIN_BYTESずつ（スキンが無ければ空）
+    std::vector<unsigned int> mIndices;
+    std::vector<SubMesh> mSubMeshes;
+    std::vector<Material> mMaterials;
+    std::vector<Joint> mJoints;        // スキンが無ければ空
+    std::vector<Animation> mAnimations;
+
+public:
+    const std::vector<float>& GetVertices() const { return mVertices; }
+    const std::vector<unsigned char>& GetSkins() const { return mSkins; }
+    const std::vector<unsigned int>& GetIndices() const { return mIndices; }
+    const std::vector<SubMesh>& GetSubMeshes() const { return mSubMeshes; }
+    const std::vector<Material>& GetMaterials() const { return mMaterials; }
+    const std::vector<Joint>& GetJoints() const { return mJoints; }
+    const std::vector<Animation>& GetAnimations() const { return mAnimations; }
+    int GetVertexCount() const { return static_cast<int>(mVertices.size() / VERTEX_FLOATS); }
+    bool HasSkin() const { return !mJoints.empty(); }
+
+};
@@ -0,0 +1,102 @@
+#include "MeshImport.h"
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // 頂点情報作成処理
+    std::vector<float> CreateVertexInfo(const std::vector<float>& vertex, const MeshImport::PolygonVertex& polygonVertex)
+    {
+        std::vector<float> vertexInfo;
+        // 位置座標
+        vertexInfo.push_back(vertex[0]);
+        vertexInfo.push_back(vertex[1]);
+        vertexInfo.push_back(vertex[2]);
+        // 法線座標
+        vertexInfo.push_back(polygonVertex.normal[0]);
+        vertexInfo.push_back(polygonVertex.normal[1]);
+        vertexInfo.push_back(polygonVertex.normal[2]);
+        // UV座標
+        vertexInfo.push_back(polygonVertex.uv[0]);
+        vertexInfo.push_back(polygonVertex.uv[1]);
+        return vertexInfo;
+    }
+
+    // vertexInfoに法線、UV座標が設定済かどうか？
+    bool IsEqualNormalUV(const std::vector<float> vertexInfo, const MeshImport::PolygonVertex& polygonVertex)
+    {
+        return fabs(vertexInfo[3] - polygonVertex.normal[0]) < FLT_EPSILON
+                && fabs(vertexInfo[4] - polygonVertex.normal[1]) < FLT_EPSILON
+                && fabs(vertexInfo[5] - polygonVertex.normal[2]) < FLT_EPSILON
+                && fabs(vertexInfo[6] - polygonVertex.uv[0]) < FLT_EPSILON
+                && fabs(vertexInfo[7] - polygonVertex.uv[1]) < FLT_EPSILON;
+    }
+}
+
+// 頂点の分割
+void MeshImport::SplitVertices(const std::vector<float>& controlPoints, const std::vector<PolygonVertex>& polygonVertices,
+                               std::vector<std::vector<float>>& vertexList, std::vector<int>& indexList)
+{
+    // 頂点座標の読込
+    vertexList.clear();
+    for (size_t i = 0; i + 2 < controlPoints.size(); i += 3)
+    {
+        std::vector<float> vertex;
+        vertex.push_back(controlPoints[i + 0]);
+        vertex.push_back(controlPoints[i + 1]);
+        vertex.push_back(controlPoints[i + 2]);
+        vertexList.push_back(vertex);
+    }
+
+    // インデックス座標の作成
+    indexList.clear();
+    std::vector<std::vector<int>> newVertexIndexList;
+    for (auto& polygonVertex : polygonVertices)
+    {
+        int vertexIndex = polygonVertex.controlPoint;
+        std::vector<float> vertex = vertexList[vertexIndex];
+
+        if (vertex.size() == 3)
+        {
+            // 法線座標とUV座標が未設定の場合、頂点情報に付与して設定
+            std::vector<float> vertexInfo = CreateVertexInfo(vertex, polygonVertex);
+            vertexList[vertexIndex] = vertexInfo;
+        }
+        else if (!IsEqualNormalUV(vertex, polygonVertex))
+        {
+            // ＊同一頂点インデックスの中で法線座標かUV座標が異なる場合、
+            // 新たな頂点インデックスとして作成する
+
+            // 新たな頂点インデックスとして作成済かどうか？
+            bool isNewVertexCreated = false;
+            for (int i = 0; i < newVertexIndexList.size(); i++)
+            {
+                int oldIndex = newVertexIndexList[i][0];
+                int newIndex = newVertexIndexList[i][1];
+                if (oldIndex == vertexIndex
+                    && IsEqualNormalUV(vertexList[newIndex], polygonVertex))
+                {
+                    isNewVertexCreated = true;
+                    vertexIndex = newIndex;
+                    break;
+                }
+            }
+            // 作成済でない場合
+            if (!isNewVertexCreated)
+            {
+                // 新たな頂点インデックスとして作成
+                std::vector<float> vertexInfo = CreateVertexInfo(vertex, polygonVertex);
+                vertexList.push_back(vertexInfo);
+                // 作成したインデックス情報を設定
+                int newIndex = vertexList.size() - 1;
+                std::vector<int> newVertexIndex;
+                newVertexIndex.push_back(vertexIndex); // old index
+                newVertexIndex.push_back(newIndex);    // new index
+                newVertexIndexList.push_back(newVertexIndex);
+                vertexIndex = newIndex;
+            }
+        }
+        // インデックスバッファを追加
+        indexList.push_back(vertexIndex);
+    }
+}
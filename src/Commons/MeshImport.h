@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+
+// メッシュ読込の頂点処理をまとめたライブラリ
+// *FBX SDKに依存しない形の入力（位置とポリゴンの頂点ごとの法線・UV）から頂点とインデックスを作成する
+// *FBX SDKの無い環境でも合成メッシュで計測、検証できる
+namespace MeshImport
+{
+    // ポリゴンの頂点
+    struct PolygonVertex
+    {
+        int controlPoint; // 位置（コントロールポイント）のインデックス
+        float normal[3];  // 法線
+        float uv[2];      // UV座標（反転前）
+    };
+
+    // 頂点の分割
+    // *同じ位置で法線かUV座標が異なるポリゴンの頂点は、新たな頂点として末尾に追加する
+    // *controlPointsは位置（x, y, z）の配列、vertexListは位置のみの頂点から始まり、参照された頂点は法線とUV座標が付く
+    void SplitVertices(const std::vector<float>& controlPoints, const std::vector<PolygonVertex>& polygonVertices,
+                       std::vector<std::vector<float>>& vertexList, std::vector<int>& indexList);
+}
@@ -0,0 +1,277 @@
+#include "OcclusionCulling.h"
+#include <SDL.h>
+#include "Shader.h"
+
+OcclusionCulling::OcclusionCulling(int hizWidth, int hizHeight)
+:mMode(HIZ)
+,mHiZWidth(hizWidth)
+,mHiZHeight(hizHeight)
+,mScreenWidth(0)
+,mScreenHeight(0)
+,mReadbackIndex(0)
+,mHiZAge(MAX_HIZ_AGE + 1)
+,mBoxVertexArray(0)
+,mBoxVertexBuffer(0)
+,mBoxIndexBuffer(0)
+,mSavedDepthFunc(GL_LESS)
+,mSavedDepthMask(GL_TRUE)
+,mIsConditional(false)
+,mStats()
+{
+    for (auto& readback : mReadbacks)
+    {
+        readback.pixelBuffer = 0;
+        readback.fence = nullptr;
+        readback.width = 0;
+        readback.height = 0;
+    }
+}
+
+OcclusionCulling::~OcclusionCulling()
+{}
+
+bool OcclusionCulling::Initialize(int screenWidth, int screenHeight)
+{
+    mScreenWidth = screenWidth;
+    mScreenHeight = screenHeight;
+    mHiZ.Resize(mHiZWidth, mHiZHeight);
+
+    // 深度の読み戻し先
+    for (auto& readback : mReadbacks)
+    {
+        glGenBuffers(1, &readback.pixelBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, mScreenWidth * mScreenHeight * sizeof(float), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    CreateBox();
+    return true;
+}
+
+void OcclusionCulling::Shutdown()
+{
+    for (auto& readback : mReadbacks)
+    {
+        if (readback.fence) glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+        glDeleteBuffers(1, &readback.pixelBuffer);
+        readback.pixelBuffer = 0;
+    }
+    if (!mQueries.empty()) glDeleteQueries(static_cast<GLsizei>(mQueries.size()), mQueries.data());
+    mQueries.clear();
+    glDeleteBuffers(1, &mBoxVertexBuffer);
+    glDeleteBuffers(1, &mBoxIndexBuffer);
+    glDeleteVertexArrays(1, &mBoxVertexArray);
+}
+
+// 階層Zの用意
+void OcclusionCulling::BeginFrame(const Matrix4& viewProjection, const std::vector<Occluder>& occluders)
+{
+    mStats = Stats();
+    switch (mMode)
+    {
+        case HIZ:
+            // 新しい読み戻しが無ければ前の階層Zを使い続ける（古すぎる場合は使わない）
+            mHiZAge++;
+            ReadBackDepth();
+            mStats.isHiZValid = mHiZAge <= MAX_HIZ_AGE;
+            break;
+        case SOFTWARE:
+            mHiZ.Clear();
+            for (const auto& occluder : occluders)
+            {
+                mHiZ.RasterizeTriangles(occluder.positions->data(), 3,
+                                        occluder.indices->data(), static_cast<int>(occluder.indices->size()),
+                                        viewProjection * occluder.world);
+            }
+            mHiZ.BuildPyramid();
+            mHiZ.SetViewProjection(viewProjection);
+            mStats.isHiZValid = true;
+            // 読み戻した階層Zは上書きしたため、HIZに戻した時は読み直す
+            mHiZAge = MAX_HIZ_AGE + 1;
+            break;
+        default:
+            break;
+    }
+}
+
+bool OcclusionCulling::IsOccluded(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world)
+{
+    if (mMode == OFF || !mStats.isHiZValid) return false;
+    mStats.testedCount++;
+    bool isOccluded = mHiZ.IsBoxOccluded(boxMin, boxMax, world);
+    if (isOccluded) mStats.occludedCount++;
+    return isOccluded;
+}
+
+// 深度の読み戻し
+// *ピクセルバッファへの転送のみ発行し、完了は次フレーム以降にフェンスで確認する
+void OcclusionCulling::CaptureDepth(GLuint frameBuffer, int width, int height, const Matrix4& viewProjection)
+{
+    if (mMode != HIZ || width > mScreenWidth || height > mScreenHeight) return;
+    Readback& readback = mReadbacks[mReadbackIndex];
+    // 前回の読み戻しが終わっていない場合は今フレームは発行しない
+    if (readback.fence) return;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+    glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.viewProjection = viewProjection;
+    readback.width = width;
+    readback.height = height;
+    mReadbackIndex = (mReadbackIndex + 1) % READBACK_COUNT;
+}
+
+void OcclusionCulling::ReadBackDepth()
+{
+    // 古い順に確認し、完了しているものを反映する（後のものが上書きする）
+    for (int i = 0; i < READBACK_COUNT; i++)
+    {
+        Readback& readback = mReadbacks[(mReadbackIndex + i) % READBACK_COUNT];
+        if (!readback.fence) continue;
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+        const float* depth = static_cast<const float*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.width * readback.height * sizeof(float), GL_MAP_READ_BIT));
+        if (depth)
+        {
+            mHiZ.SetDepth(depth, readback.width, readback.height);
+            mHiZ.BuildPyramid();
+            mHiZ.SetViewProjection(readback.viewProjection);
+            mHiZAge = 0;
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
+
+// 条件付き描画の開始
+void OcclusionCulling::BeginConditionalDraw(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world,
+                                            Shader* depthShader, const Matrix4& viewProjection)
+{
+    // ニアクリップ面にかかるボックスは見えているものとして扱う（階層Zの判定と同じ）
+    mIsConditional = !IsCrossingNearPlane(boxMin, boxMax, world, viewProjection);
+    if (!mIsConditional)
+    {
+        mStats.nearCount++;
+        return;
+    }
+
+    if (mStats.queryCount >= static_cast<int>(mQueries.size()))
+    {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        mQueries.emplace_back(query);
+    }
+    GLuint query = mQueries[mStats.queryCount++];
+
+    // ボックスは深度テストのみ（カラー、深度は書き込まない）
+    glGetIntegerv(GL_DEPTH_FUNC, &mSavedDepthFunc);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &mSavedDepthMask);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDepthFunc(GL_LEQUAL);
+
+    // 単位立方体(-1〜1)をAABBに合わせる
+    Vector3 center = 0.5f * (boxMin + boxMax);
+    Vector3 extent = 0.5f * (boxMax - boxMin);
+    Matrix4 boxWorld = world;
+    boxWorld *= Matrix4::CreateTranslation(center.x, center.y, center.z);
+    boxWorld *= Matrix4::CreateScale(extent.x, extent.y, extent.z);
+    depthShader->SetActive();
+    depthShader->SetViewProjectionUniform(viewProjection);
+    depthShader->SetWorldTransformUniform(boxWorld);
+
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+    glBindVertexArray(mBoxVertexArray);
+    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(mSavedDepthMask);
+    glDepthFunc(mSavedDepthFunc);
+
+    // 結果はGPU側で待つ（CPUは止まらない）
+    glBeginConditionalRender(query, GL_QUERY_WAIT);
+}
+
+void OcclusionCulling::EndConditionalDraw()
+{
+    if (mIsConditional) glEndConditionalRender();
+    mIsConditional = false;
+}
+
+// ボックスがニアクリップ面にかかるか？
+// *カメラがボックスの中にあれば、いずれかの頂点がカメラの後ろ(w <= 0)になる
+bool OcclusionCulling::IsCrossingNearPlane(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world,
+                                           const Matrix4& viewProjection)
+{
+    const Matrix4 m = viewProjection * world;
+    // 少し広げて、ニアクリップ面のすぐ近くにあるものも含める
+    const Vector3 margin = 0.05f * (boxMax - boxMin) + Vector3(0.01f, 0.01f, 0.01f);
+    const Vector3 expandedMin = boxMin - margin;
+    const Vector3 expandedMax = boxMax + margin;
+    for (int i = 0; i < 8; i++)
+    {
+        float x = (i & 1) ? expandedMax.x : expandedMin.x;
+        float y = (i & 2) ? expandedMax.y : expandedMin.y;
+        float z = (i & 4) ? expandedMax.z : expandedMin.z;
+        float cz = m.matrix[2][0]*x + m.matrix[2][1]*y + m.matrix[2][2]*z + m.matrix[2][3];
+        float cw = m.matrix[3][0]*x + m.matrix[3][1]*y + m.matrix[3][2]*z + m.matrix[3][3];
+        if (cw <= 0.0f || cz < -cw) return true;
+    }
+    return false;
+}
+
+void OcclusionCulling::CreateBox()
+{
+    const float vertices[] = {
+        -1.0f, -1.0f, -1.0f,
+         1.0f, -1.0f, -1.0f,
+        -1.0f,  1.0f, -1.0f,
+         1.0f,  1.0f, -1.0f,
+        -1.0f, -1.0f,  1.0f,
+         1.0f, -1.0f,  1.0f,
+        -1.0f,  1.0f,  1.0f,
+         1.0f,  1.0f,  1.0f,
+    };
+    const unsigned int indices[] = {
+        0, 2, 1, 1, 2, 3, // -z
+        4, 5, 6, 5, 7, 6, // +z
+        0, 1, 4, 1, 5, 4, // -y
+        2, 6, 3, 3, 6, 7, // +y
+        0, 4, 2, 2, 4, 6, // -x
+        1, 3, 5, 3, 7, 5, // +x
+    };
+    glGenVertexArrays(1, &mBoxVertexArray);
+    glBindVertexArray(mBoxVertexArray);
+    glGenBuffers(1, &mBoxVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mBoxVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glGenBuffers(1, &mBoxIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mBoxIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0);
+    glBindVertexArray(0);
+}
+
+const char* OcclusionCulling::GetModeName(Mode mode)
+{
+    switch (mode)
+    {
+        case OFF: return "off";
+        case HIZ: return "hi-z";
+        case SOFTWARE: return "software";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include "Math.h"
+#include "HiZBuffer.h"
+
+// オクルージョンカリングクラス
+// *HIZ     : 前フレームの深度バッファを非同期に読み戻して階層Zを作り、CPUでボックスを判定する
+//            （読み戻しが間に合わない間は、ボックスの問い合わせによる条件付き描画で代用する）
+// *SOFTWARE: 遮蔽物に指定したメッシュをCPUでラスタライズして階層Zを作る（GPUの読み戻し不要）
+class OcclusionCulling
+{
+public:
+    enum Mode
+    {
+        OFF,      // カリングしない
+        HIZ,      // 前フレームの深度から作った階層Z
+        SOFTWARE, // 遮蔽物のソフトウェアラスタライズ
+        MODE_COUNT,
+    };
+
+    // 遮蔽物（SOFTWARE用）
+    struct Occluder
+    {
+        const std::vector<float>* positions;      // 位置座標(xyz)
+        const std::vector<unsigned int>* indices; // インデックス
+        Matrix4 world;                            // ワールド変換座標
+    };
+
+    // 今フレームの集計
+    struct Stats
+    {
+        int testedCount;   // 判定したボックス数
+        int occludedCount; // 遮蔽されていたボックス数
+        int queryCount;    // 条件付き描画の問い合わせ数
+        int nearCount;     // ニアクリップ面にかかり問い合わせずに描画した数
+        bool isHiZValid;   // 階層Zで判定したか？
+    };
+
+    OcclusionCulling(int hizWidth, int hizHeight);
+    ~OcclusionCulling();
+
+    bool Initialize(int screenWidth, int screenHeight);
+    void Shutdown();
+
+    // フレーム先頭で判定に使う階層Zを用意する
+    void BeginFrame(const Matrix4& viewProjection, const std::vector<Occluder>& occluders);
+
+    // ボックスが遮蔽されているか？（ローカル座標のAABB、ワールド変換座標）
+    bool IsOccluded(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world);
+
+    // 描画済の深度を読み戻す（HIZ、不透明描画の後に呼ぶ）
+    // *大きさは初期化時の画面サイズ以下（動的解像度で縮小した描画先）
+    void CaptureDepth(GLuint frameBuffer, int width, int height, const Matrix4& viewProjection);
+
+    // 問い合わせによる条件付き描画
+    // *ボックスを深度テストのみで描画し、1画素でも通れば間にある描画を行う
+    // *depthShaderは位置座標のみの頂点シェーダ（uWorldTransform, uViewProjection）
+    // *ボックスがニアクリップ面にかかる（カメラが中か近くにある）場合は問い合わせずにそのまま描画する
+    //  （手前の面が切り取られ、奥の面は自身の深度で隠れるため、問い合わせると見えているのに消える）
+    void BeginConditionalDraw(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world,
+                              class Shader* depthShader, const Matrix4& viewProjection);
+    void EndConditionalDraw();
+
+private:
+    void ReadBackDepth(); // 完了した読み戻しから階層Zを作る
+    // ボックスがニアクリップ面にかかるか？（少し広げたボックスで判定する）
+    static bool IsCrossingNearPlane(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& world,
+                                    const Matrix4& viewProjection);
+    void CreateBox();     // 問い合わせ用の単位立方体
+
+    Mode mMode;
+    HiZBuffer mHiZ;
+    int mHiZWidth;
+    int mHiZHeight;
+    int mScreenWidth;
+    int mScreenHeight;
+
+    // 深度の読み戻し（GPUを待たないよう2つを交互に使う）
+    static const int READBACK_COUNT = 2;
+    struct Readback
+    {
+        GLuint pixelBuffer;
+        GLsync fence;           // 読み戻しの完了待ち（未発行ならnullptr）
+        int width;              // 読み戻した深度の大きさ
+        int height;
+        Matrix4 viewProjection; // 読み戻した深度のビュー射影行列
+    };
+    Readback mReadbacks[READBACK_COUNT];
+    int mReadbackIndex;         // 次に使う読み戻し
+    int mHiZAge;                // 階層Zを作ってからのフレーム数
+
+    // 条件付き描画用
+    std::vector<GLuint> mQueries;
+    GLuint mBoxVertexArray;
+    GLuint mBoxVertexBuffer;
+    GLuint mBoxIndexBuffer;
+    GLint mSavedDepthFunc;       // ボックス描画前の深度テスト
+    GLboolean mSavedDepthMask;   // ボックス描画前の深度書き込み
+    bool mIsConditional;         // 条件付き描画中か？（問い合わせずに描画する場合はfalse）
+
+    Stats mStats;
+
+public:
+    void SetMode(Mode mode) { mMode = mode; }
+    Mode GetMode() const { return mMode; }
+    const Stats& GetStats() const { return mStats; }
+    // 階層Zが無く、条件付き描画で代用するか？
+    bool IsQueryFallback() const { return mMode == HIZ && !mStats.isHiZValid; }
+    const HiZBuffer& GetHiZ() const { return mHiZ; }
+    static const char* GetModeName(Mode mode);
+
+    // この数より古い階層Zは使わない
+    static const int MAX_HIZ_AGE = 3;
+
+};
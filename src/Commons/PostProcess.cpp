@@ -0,0 +1,172 @@
+#include "PostProcess.h"
+#include <SDL.h>
+#include <algorithm>
+#include "Shader.h"
+#include "../Game.h"
+
+PostProcess::PostProcess()
+:mBloomExtractShader(nullptr)
+,mBlurShader(nullptr)
+,mTonemapShader(nullptr)
+,mFxaaShader(nullptr)
+,mCopyShader(nullptr)
+,mEmptyVertexArray(0)
+,mQuality(QUALITY_HIGH)
+,mExposure(1.0f)
+,mBloomThreshold(1.0f)
+,mBloomIntensity(0.5f)
+{}
+
+PostProcess::~PostProcess()
+{}
+
+bool PostProcess::Initialize(Game* game)
+{
+    // 並列にコンパイル
+    const char* vert = "Deferred/FullscreenVert.glsl";
+    mBloomExtractShader = new Shader(vert, "Post/BloomExtractFrag.glsl");
+    mBlurShader = new Shader(vert, "Post/BlurFrag.glsl");
+    mTonemapShader = new Shader(vert, "Post/TonemapFrag.glsl");
+    mFxaaShader = new Shader(vert, "Post/FxaaFrag.glsl");
+    mCopyShader = new Shader(vert, "Post/CopyFrag.glsl");
+    bool success = true;
+    for (auto shader : GetShaders())
+    {
+        success = shader->BeginLoad(game) && success;
+    }
+    for (auto shader : GetShaders())
+    {
+        success = shader->FinishLoad() && success;
+    }
+    if (!success)
+    {
+        SDL_Log("Failed load post process shaders.");
+        return false;
+    }
+
+    glGenVertexArrays(1, &mEmptyVertexArray);
+    return true;
+}
+
+void PostProcess::Shutdown()
+{
+    for (auto shader : GetShaders())
+    {
+        shader->Unload();
+        delete shader;
+    }
+    mBloomExtractShader = nullptr;
+    mBlurShader = nullptr;
+    mTonemapShader = nullptr;
+    mFxaaShader = nullptr;
+    mCopyShader = nullptr;
+    glDeleteVertexArrays(1, &mEmptyVertexArray);
+    mEmptyVertexArray = 0;
+}
+
+// パスの追加
+void PostProcess::AddPasses(FrameGraph& graph, FrameGraph::Handle sceneColor, FrameGraph::Handle output)
+{
+    const FrameGraph::TextureDesc scene = graph.GetDesc(sceneColor);
+    const FrameGraph::TextureDesc half = { std::max(1, scene.width / 2), std::max(1, scene.height / 2), GL_RGBA16F };
+    const bool isBloom = mQuality == QUALITY_HIGH;
+
+    // ブルーム（トーンマップが読まない場合は除外される）
+    FrameGraph::Handle bright = FrameGraph::INVALID_HANDLE;
+    FrameGraph::Handle blurX = FrameGraph::INVALID_HANDLE;
+    FrameGraph::Handle blurY = FrameGraph::INVALID_HANDLE;
+    graph.AddPass("BloomExtract",
+        [&](FrameGraph::PassBuilder& builder) {
+            builder.Read(sceneColor);
+            bright = builder.Write(builder.Create("BloomBright", half));
+            builder.SetRenderState(FrameGraph::RenderState::Screen());
+        },
+        [this, sceneColor, scene](const FrameGraph& graph) {
+            mBloomExtractShader->SetActive();
+            mBloomExtractShader->SetFloatUniform("uThreshold", mBloomThreshold);
+            DrawFullscreen(mBloomExtractShader, graph.GetTexture(sceneColor), scene.width, scene.height);
+        });
+    auto addBlur = [&](const char* name, const char* target, FrameGraph::Handle source, float x, float y) {
+        FrameGraph::Handle result = FrameGraph::INVALID_HANDLE;
+        graph.AddPass(name,
+            [&](FrameGraph::PassBuilder& builder) {
+                builder.Read(source);
+                result = builder.Write(builder.Create(target, half));
+                builder.SetRenderState(FrameGraph::RenderState::Screen());
+            },
+            [this, source, half, x, y](const FrameGraph& graph) {
+                mBlurShader->SetActive();
+                glUniform2f(glGetUniformLocation(mBlurShader->GetProgram(), "uDirection"), x, y);
+                DrawFullscreen(mBlurShader, graph.GetTexture(source), half.width, half.height);
+            });
+        return result;
+    };
+    blurX = addBlur("BloomBlurX", "BloomBlurX", bright, 1.0f, 0.0f);
+    blurY = addBlur("BloomBlurY", "BloomBlurY", blurX, 0.0f, 1.0f);
+
+    // トーンマップ（内部解像度のまま）
+    FrameGraph::Handle ldr = FrameGraph::INVALID_HANDLE;
+    graph.AddPass("Tonemap",
+        [&](FrameGraph::PassBuilder& builder) {
+            builder.Read(sceneColor);
+            if (isBloom) builder.Read(blurY);
+            ldr = builder.Write(builder.Create("LDRColor", { scene.width, scene.height, GL_RGBA8 }));
+            builder.SetRenderState(FrameGraph::RenderState::Screen());
+        },
+        [this, sceneColor, blurY, isBloom, scene](const FrameGraph& graph) {
+            mTonemapShader->SetActive();
+            mTonemapShader->SetFloatUniform("uExposure", mExposure);
+            mTonemapShader->SetFloatUniform("uBloomIntensity", isBloom ? mBloomIntensity : 0.0f);
+            mTonemapShader->SetIntUniform("uBloom", 1);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, isBloom ? graph.GetTexture(blurY) : 0);
+            DrawFullscreen(mTonemapShader, graph.GetTexture(sceneColor), scene.width, scene.height);
+        });
+
+    // アンチエイリアス、出力の解像度へ拡大
+    Shader* finalShader = mQuality == QUALITY_LOW ? mCopyShader : mFxaaShader;
+    graph.AddPass(mQuality == QUALITY_LOW ? "Upscale" : "FXAA",
+        [&](FrameGraph::PassBuilder& builder) {
+            builder.Read(ldr);
+            builder.Write(output);
+            builder.SetRenderState(FrameGraph::RenderState::Screen());
+        },
+        [this, finalShader, ldr, scene](const FrameGraph& graph) {
+            finalShader->SetActive();
+            DrawFullscreen(finalShader, graph.GetTexture(ldr), scene.width, scene.height);
+        });
+}
+
+void PostProcess::DrawFullscreen(Shader* shader, GLuint source, int sourceWidth, int sourceHeight)
+{
+    shader->SetActive();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source);
+    shader->SetIntUniform("uSource", 0);
+    glUniform2f(glGetUniformLocation(shader->GetProgram(), "uInvSourceSize"),
+                1.0f / sourceWidth, 1.0f / sourceHeight);
+    glBindVertexArray(mEmptyVertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+std::vector<Shader*> PostProcess::GetShaders() const
+{
+    std::vector<Shader*> shaders;
+    Shader* all[] = { mBloomExtractShader, mBlurShader, mTonemapShader, mFxaaShader, mCopyShader };
+    for (auto shader : all)
+    {
+        if (shader) shaders.emplace_back(shader);
+    }
+    return shaders;
+}
+
+const char* PostProcess::GetQualityName(Quality quality)
+{
+    switch (quality)
+    {
+        case QUALITY_HIGH: return "bloom+fxaa";
+        case QUALITY_MEDIUM: return "fxaa";
+        case QUALITY_LOW: return "tonemap";
+        default: return "unknown";
+    }
+}
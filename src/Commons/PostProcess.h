@@ -0,0 +1,61 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include "FrameGraph.h"
+
+// ポストプロセスクラス
+// *HDRのシーンカラーからブルーム（輝度抽出 -> 縮小バッファでガウスぼかし）、トーンマップ、FXAAを行う
+// *各段はフレームグラフのパスとして追加する（ブルームを切ると抽出・ぼかしのパスは除外される）
+// *最後の段で内部解像度から出力の解像度へ拡大する（動的解像度）
+class PostProcess
+{
+public:
+    // 品質
+    enum Quality
+    {
+        QUALITY_HIGH,   // ブルーム + FXAA
+        QUALITY_MEDIUM, // FXAAのみ
+        QUALITY_LOW,    // トーンマップのみ
+        QUALITY_COUNT,
+    };
+
+    PostProcess();
+    ~PostProcess();
+
+    bool Initialize(class Game* game);
+    void Shutdown();
+
+    // パスの追加（sceneColorはHDR、outputは出力の大きさで描画する）
+    void AddPasses(FrameGraph& graph, FrameGraph::Handle sceneColor, FrameGraph::Handle output);
+
+    // ホットリロード対象のシェーダ
+    std::vector<class Shader*> GetShaders() const;
+
+    static const char* GetQualityName(Quality quality);
+
+private:
+    // 画面全体の三角形を描画（sourceをユニット0にバインド）
+    void DrawFullscreen(class Shader* shader, GLuint source, int sourceWidth, int sourceHeight);
+
+    class Shader* mBloomExtractShader; // 輝度抽出、縮小
+    class Shader* mBlurShader;         // 1方向のガウスぼかし
+    class Shader* mTonemapShader;      // ブルームの合成、トーンマップ
+    class Shader* mFxaaShader;         // アンチエイリアス、拡大
+    class Shader* mCopyShader;         // 拡大のみ
+    GLuint mEmptyVertexArray;
+
+    Quality mQuality;
+    float mExposure;       // 露出
+    float mBloomThreshold; // ブルームの輝度のしきい値
+    float mBloomIntensity; // ブルームの強さ
+
+public:
+    void SetQuality(Quality quality) { mQuality = quality; }
+    Quality GetQuality() const { return mQuality; }
+    void SetExposure(float exposure) { mExposure = exposure; }
+    void SetBloom(float threshold, float intensity) { mBloomThreshold = threshold; mBloomIntensity = intensity; }
+
+    // トーンマップ前のシーンカラーの形式
+    static const GLenum SCENE_COLOR_FORMAT = GL_RGBA16F;
+
+};
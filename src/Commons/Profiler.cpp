@@ -0,0 +1,108 @@
+#include "Profiler.h"
+
+Profiler::Profiler()
+:mFrameStartCounter(0)
+,mFrameMs(0.0)
+,mTotalFrameMs(0.0)
+,mFrameCount(0)
+{}
+
+Profiler::~Profiler()
+{}
+
+void Profiler::BeginFrame()
+{
+    // 今フレームの値をクリア（項目は残して使い回す）
+    for (auto& stage : mStages) stage.frameValue = 0.0;
+    for (auto& counter : mCounters) counter.frameValue = 0.0;
+    mOpenStages.clear();
+    mFrameStartCounter = SDL_GetPerformanceCounter();
+}
+
+void Profiler::EndFrame()
+{
+    mFrameMs = (SDL_GetPerformanceCounter() - mFrameStartCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+    mTotalFrameMs += mFrameMs;
+    for (auto& stage : mStages) stage.totalValue += stage.frameValue;
+    for (auto& counter : mCounters) counter.totalValue += counter.frameValue;
+    mFrameCount++;
+}
+
+void Profiler::BeginStage(const char* name)
+{
+    OpenStage open;
+    Entry& entry = FindEntry(mStages, name);
+    open.index = &entry - mStages.data();
+    open.startCounter = SDL_GetPerformanceCounter();
+    mOpenStages.emplace_back(open);
+}
+
+void Profiler::EndStage()
+{
+    if (mOpenStages.empty()) return;
+    const OpenStage& open = mOpenStages.back();
+    mStages[open.index].frameValue += (SDL_GetPerformanceCounter() - open.startCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+    mOpenStages.pop_back();
+}
+
+void Profiler::AddCounter(const char* name, long long value)
+{
+    FindEntry(mCounters, name).frameValue += static_cast<double>(value);
+}
+
+void Profiler::LogStats(const char* label)
+{
+    if (mFrameCount == 0) return;
+    double frames = static_cast<double>(mFrameCount);
+    SDL_Log("profile [%s]: %d frames, %.3f ms/frame", label, mFrameCount, mTotalFrameMs / frames);
+    for (auto& stage : mStages)
+    {
+        if (stage.totalValue <= 0.0) continue;
+        SDL_Log("  %-16s %8.3f ms", stage.name.c_str(), stage.totalValue / frames);
+        stage.totalValue = 0.0;
+    }
+    for (auto& counter : mCounters)
+    {
+        if (counter.totalValue <= 0.0) continue;
+        SDL_Log("  %-16s %10.1f /frame", counter.name.c_str(), counter.totalValue / frames);
+        counter.totalValue = 0.0;
+    }
+    mTotalFrameMs = 0.0;
+    mFrameCount = 0;
+}
+
+float Profiler::GetStageMs(const char* name) const
+{
+    const Entry* entry = FindEntry(mStages, name);
+    return entry ? static_cast<float>(entry->frameValue) : 0.0f;
+}
+
+long long Profiler::GetCounter(const char* name) const
+{
+    const Entry* entry = FindEntry(mCounters, name);
+    return entry ? static_cast<long long>(entry->frameValue) : 0;
+}
+
+// 名前で検索（無ければ追加、項目数は少ないため線形探索）
+Profiler::Entry& Profiler::FindEntry(std::vector<Entry>& entries, const char* name)
+{
+    for (auto& entry : entries)
+    {
+        if (entry.name == name) return entry;
+    }
+    Entry entry;
+    entry.name = name;
+    entry.frameValue = 0.0;
+    entry.totalValue = 0.0;
+    entries.emplace_back(entry);
+    return entries.back();
+}
+
+const Profiler::Entry* Profiler::FindEntry(const std::vector<Entry>& entries, const char* name) const
+{
+    for (auto& entry : entries)
+    {
+        if (entry.name == name) return &entry;
+    }
+    return nullptr;
+}
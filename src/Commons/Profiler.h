@@ -0,0 +1,81 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+// プロファイラクラス
+// *描画の段階（ステージ）ごとのCPU時間と、描画数などのカウンタをフレーム単位で集計する
+// *LogStatsで前回出力からの平均を出力してリセットする（描画方式の比較など）
+class Profiler
+{
+public:
+    Profiler();
+    ~Profiler();
+
+    void BeginFrame();
+    void EndFrame();
+
+    // ステージの計測（入れ子可）
+    void BeginStage(const char* name);
+    void EndStage();
+
+    // カウンタの加算（今フレームの値）
+    void AddCounter(const char* name, long long value);
+
+    // 前回出力からの平均を出力してリセット
+    void LogStats(const char* label);
+
+    // 今フレームの値
+    float GetStageMs(const char* name) const;
+    long long GetCounter(const char* name) const;
+
+private:
+    // ステージ、カウンタの集計値
+    struct Entry
+    {
+        std::string name;
+        double frameValue; // 今フレームの値（ステージはミリ秒）
+        double totalValue; // 前回出力からの合計
+    };
+    Entry& FindEntry(std::vector<Entry>& entries, const char* name);
+    const Entry* FindEntry(const std::vector<Entry>& entries, const char* name) const;
+
+    std::vector<Entry> mStages;
+    std::vector<Entry> mCounters;
+
+    // 計測中のステージ（入れ子のためスタック）
+    struct OpenStage
+    {
+        size_t index;
+        Uint64 startCounter;
+    };
+    std::vector<OpenStage> mOpenStages;
+
+    Uint64 mFrameStartCounter;
+    double mFrameMs;      // 今フレームの時間
+    double mTotalFrameMs; // 前回出力からの合計
+    int mFrameCount;      // 前回出力からのフレーム数
+
+public:
+    int GetFrameCount() const { return mFrameCount; }
+    float GetFrameMs() const { return static_cast<float>(mFrameMs); }
+
+};
+
+// スコープ内をステージとして計測する
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler* profiler, const char* name)
+    :mProfiler(profiler)
+    {
+        if (mProfiler) mProfiler->BeginStage(name);
+    }
+    ~ProfileScope()
+    {
+        if (mProfiler) mProfiler->EndStage();
+    }
+
+private:
+    Profiler* mProfiler;
+};
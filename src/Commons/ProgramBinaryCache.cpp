@@ -0,0 +1,178 @@
+#include "ProgramBinaryCache.h"
+#include <SDL.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    // キャッシュファイルのヘッダ
+    const uint32_t CACHE_MAGIC = 0x48435250; // "PRCH"
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;         // 衝突検出用に再度保存
+        uint32_t format;      // バイナリフォーマット
+        uint32_t length;      // バイナリ長
+    };
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& cacheDir)
+:mCacheDir(cacheDir)
+,mIsSupported(false)
+,mHitCount(0)
+,mMissCount(0)
+{}
+
+ProgramBinaryCache::~ProgramBinaryCache()
+{}
+
+void ProgramBinaryCache::Initialize()
+{
+    // ドライバが変わった場合にキャッシュを無効にするため、識別文字列を保持
+    const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    mDriverString = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+
+    // バイナリフォーマットが1つ以上あれば対応
+    GLint formatCount = 0;
+    if (GLEW_ARB_get_program_binary)
+    {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    }
+    mIsSupported = formatCount > 0;
+    if (!mIsSupported)
+    {
+        SDL_Log("Program binary is not supported, shader cache disabled.");
+        return;
+    }
+
+    // 保存先ディレクトリの作成（既にある場合は何もしない）
+#ifdef _WIN32
+    _mkdir(mCacheDir.c_str());
+#else
+    mkdir(mCacheDir.c_str(), 0755);
+#endif
+}
+
+uint64_t ProgramBinaryCache::ComputeKey(const std::string& vertSource,
+                                        const std::string& fragSource,
+                                        const std::string& defines) const
+{
+    // 各部分の前に長さを混ぜる（部分の境界をまたいで文字列が移動しても同じキーにならないように）
+    uint64_t key = 14695981039346656037ULL;
+    for (const std::string* part : { &mDriverString, &defines, &vertSource, &fragSource })
+    {
+        key = Hash(std::to_string(part->size()) + ":", key);
+        key = Hash(*part, key);
+    }
+    return key;
+}
+
+bool ProgramBinaryCache::Load(uint64_t key, GLuint program)
+{
+    if (!mIsSupported) return false;
+
+    std::string filePath = GetFilePath(key);
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        mMissCount++;
+        return false;
+    }
+    const std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    // ヘッダとバイナリの読込
+    // *バイナリ長はファイルの残りサイズを超えていれば破損として扱う
+    CacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    bool isValid = file && header.magic == CACHE_MAGIC && header.version == CACHE_VERSION && header.key == key
+                   && static_cast<std::streamoff>(header.length) <= fileSize - static_cast<std::streamoff>(sizeof(header));
+    std::vector<char> binary;
+    if (isValid)
+    {
+        binary.resize(header.length);
+        file.read(binary.data(), binary.size());
+        isValid = static_cast<bool>(file);
+    }
+    file.close();
+
+    // プログラムに復元してリンク状態を確認
+    if (isValid)
+    {
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        isValid = status == GL_TRUE;
+    }
+
+    // 破損やドライバ側での拒否はキャッシュを削除してコンパイルに戻す
+    if (!isValid)
+    {
+        SDL_Log("Invalid program binary cache, recompile.");
+        std::remove(filePath.c_str());
+        mMissCount++;
+        return false;
+    }
+    mHitCount++;
+    return true;
+}
+
+void ProgramBinaryCache::Save(uint64_t key, GLuint program)
+{
+    if (!mIsSupported) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return;
+
+    CacheHeader header;
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = static_cast<uint32_t>(written);
+
+    std::ofstream file(GetFilePath(key), std::ios::binary);
+    if (!file.is_open())
+    {
+        SDL_Log("Failed open program binary cache for write.");
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), written);
+}
+
+uint64_t ProgramBinaryCache::Hash(const std::string& str, uint64_t seed)
+{
+    uint64_t hash = seed;
+    for (unsigned char c : str)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string ProgramBinaryCache::GetFilePath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return mCacheDir + name;
+}
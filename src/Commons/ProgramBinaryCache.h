@@ -0,0 +1,44 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+// シェーダプログラムバイナリのキャッシュクラス
+// *リンク済プログラムをglGetProgramBinaryでディスクに保存し、次回起動時はコンパイルを省略する
+// *キーはソース、define、ドライバ文字列のハッシュのため、いずれかが変われば自動的に無効となる
+class ProgramBinaryCache
+{
+public:
+    ProgramBinaryCache(const std::string& cacheDir);
+    ~ProgramBinaryCache();
+
+    void Initialize(); // ドライバ情報の取得、対応状況の確認（GL初期化後に呼ぶ）
+
+    // キャッシュキーの計算
+    uint64_t ComputeKey(const std::string& vertSource,
+                        const std::string& fragSource,
+                        const std::string& defines) const;
+
+    // キャッシュからプログラムを復元（失敗時はキャッシュを削除してfalse）
+    bool Load(uint64_t key, GLuint program);
+    // リンク済プログラムをキャッシュに保存
+    void Save(uint64_t key, GLuint program);
+
+    // 文字列のハッシュ（FNV-1a 64bit）
+    static uint64_t Hash(const std::string& str, uint64_t seed = 14695981039346656037ULL);
+
+private:
+    std::string GetFilePath(uint64_t key) const;
+
+    std::string mCacheDir;     // 保存先ディレクトリ
+    std::string mDriverString; // ベンダ、レンダラ、バージョン
+    bool mIsSupported;         // プログラムバイナリに対応しているか？
+    int mHitCount;             // キャッシュヒット数
+    int mMissCount;            // キャッシュミス数
+
+public:
+    bool IsSupported() const { return mIsSupported; }
+    int GetHitCount() const { return mHitCount; }
+    int GetMissCount() const { return mMissCount; }
+
+};
@@ -0,0 +1,80 @@
+#include "RenderTarget.h"
+#include <SDL.h>
+#include <algorithm>
+
+RenderTarget::RenderTarget()
+:mFrameBuffer(0)
+,mDepth(0)
+,mWidth(0)
+,mHeight(0)
+{}
+
+RenderTarget::~RenderTarget()
+{}
+
+bool RenderTarget::Create(const std::vector<GLuint>& colors, GLuint depth, int width, int height)
+{
+    mColors = colors;
+    mDepth = depth;
+    mWidth = width;
+    mHeight = height;
+
+    glGenFramebuffers(1, &mFrameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffer);
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < mColors.size(); i++)
+    {
+        GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, mColors[i], 0);
+        drawBuffers.emplace_back(attachment);
+    }
+    if (mDepth) glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, mDepth, 0);
+    if (drawBuffers.empty())
+    {
+        // 深度のみ
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    else
+    {
+        glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
+
+    bool isComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!isComplete)
+    {
+        SDL_Log("Failed create render target. (%dx%d, %d colors)", mWidth, mHeight, static_cast<int>(mColors.size()));
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::Destroy()
+{
+    if (mFrameBuffer) glDeleteFramebuffers(1, &mFrameBuffer);
+    mFrameBuffer = 0;
+    mColors.clear();
+    mDepth = 0;
+}
+
+void RenderTarget::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffer);
+    glViewport(0, 0, mWidth, mHeight);
+}
+
+RenderTarget RenderTarget::External(GLuint frameBuffer, int width, int height)
+{
+    RenderTarget target;
+    target.mFrameBuffer = frameBuffer;
+    target.mWidth = width;
+    target.mHeight = height;
+    return target;
+}
+
+bool RenderTarget::IsAttached(GLuint texture) const
+{
+    if (!texture) return false;
+    return mDepth == texture || std::find(mColors.begin(), mColors.end(), texture) != mColors.end();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+
+// レンダーターゲットクラス
+// *フレームバッファと、カラー（複数可）・深度のアタッチメントの組
+// *テクスチャは所有しない（フレームグラフの一時テクスチャを割り当て直して使い回すため）
+// *既定のフレームバッファや外部で作成したフレームバッファはExternalで包む（Destroyしない）
+class RenderTarget
+{
+public:
+    RenderTarget();
+    ~RenderTarget();
+
+    // カラーは宣言順にアタッチメント0, 1...（空なら深度のみ）、depthは0で深度無し
+    bool Create(const std::vector<GLuint>& colors, GLuint depth, int width, int height);
+    void Destroy();
+
+    // バインドしてビューポートを全体に合わせる
+    void Bind() const;
+
+    // 外部のフレームバッファ（0は既定のフレームバッファ）
+    static RenderTarget External(GLuint frameBuffer, int width, int height);
+
+    // テクスチャを参照しているか？
+    bool IsAttached(GLuint texture) const;
+
+private:
+    GLuint mFrameBuffer;
+    std::vector<GLuint> mColors;
+    GLuint mDepth;
+    int mWidth;
+    int mHeight;
+
+public:
+    GLuint GetFrameBuffer() const { return mFrameBuffer; }
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+    int GetColorCount() const { return static_cast<int>(mColors.size()); }
+
+};
@@ -6,9 +6,54 @@
 #include "../Commons/VertexArray.h"
 #include "../Commons/Texture.h"
 #include "../Commons/Mesh.h"
+#include "../Commons/TextureStreamer.h"
+#include "../Commons/ProgramBinaryCache.h"
+#include "../Commons/ShaderWatcher.h"
+#include "../Components/LightComponent.h"
+#include "../Commons/DeferredShading.h"
+#include "../Commons/Profiler.h"
+#include "../Commons/GpuProfiler.h"
+#include "../Commons/OcclusionCulling.h"
+#include "../Commons/CascadedShadowMap.h"
+#include "../Commons/FrameGraph.h"
+#include "../Commons/DynamicResolution.h"
+#include "../Commons/GeometryPool.h"
+#include "../Commons/Skinning.h"
+#include "../Commons/GpuCulling.h"
+#include "../Commons/JobSystem.h"
+#include "../Commons/FileSystem.h"
 
 Renderer::Renderer(class Game *game)
 :mGame(game)
+,mTextureStreamer(nullptr)
+,mProgramBinaryCache(nullptr)
+,mShaderWatcher(nullptr)
+,mClusteredLighting(nullptr)
+,mDeferredShading(nullptr)
+,mProfiler(nullptr)
+,mGpuProfiler(nullptr)
+,mOcclusionCulling(nullptr)
+,mShadowMap(nullptr)
+,mFrameGraph(nullptr)
+,mPostProcess(nullptr)
+,mDynamicResolution(nullptr)
+,mGeometryPool(nullptr)
+,mGpuCulling(nullptr)
+,mSkinning(nullptr)
+,mRenderWidth(0)
+,mRenderHeight(0)
+,mRenderPath(FORWARD)
+,mIsDepthPrePass(true)
+,mDepthOnlyShader(nullptr)
+,mDepthOnlyInstancedShader(nullptr)
+,mDepthOnlySkinnedShader(nullptr)
+,mIsMultiDraw(true)
+,mIsGpuCulling(false)
+,mIsGpuCullingValidation(false)
+,mGpuCullingMismatchCount(0)
+,mOverdrawQueries{0, 0}
+,mOverdrawQueryIndex(0)
+,mIsOverdrawQueryIssued{false, false}
 ,mWindow(nullptr)
 ,mAmbientLight(Math::VEC3_ZERO)
 ,mDirLightDirection(Math::VEC3_ZERO)
@@ -16,6 +61,12 @@ Renderer::Renderer(class Game *game)
 ,mDirLightSpecColor(Math::VEC3_ZERO)
 ,m2DSpriteShader(nullptr)
 ,m2DSpriteVertexArray(nullptr)
+,mDepthDrawCount(0)
+,mMultiDrawCalls(0)
+,mTextureCache(nullptr)
+,mMeshCache(nullptr)
+,mShaderCache(nullptr)
+,mShaderIds(1 << Shader::FEATURE_COUNT, INVALID_RESOURCE_ID)
 {}
 
 Renderer::~Renderer()
@@ -35,6 +86,93 @@ bool Renderer::Initialize()
     if (glewInit() != GLEW_OK) return false;
     glGetError();
 
+    // シェーダバイナリキャッシュ
+    mProgramBinaryCache = new ProgramBinaryCache(mGame->GetShaderCachePath());
+    mProgramBinaryCache->Initialize();
+    // 並列コンパイルに対応していればドライバに任せる
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    // シェーダファイルの変更監視（未対応の環境ではリロードしない）
+    mShaderWatcher = new ShaderWatcher(mGame->GetShaderPath());
+    mShaderWatcher->Initialize();
+
+    // クラスタードライティング（16x9タイル、24スライス）
+    mClusteredLighting = new ClusteredLighting(16, 9, 24);
+    mClusteredLighting->Initialize();
+    // 描画ステージの計測
+    mProfiler = new Profiler();
+    glGenQueries(2, mOverdrawQueries);
+    // パスごとのGPU時間（経過時間のクエリに未対応ならマーカーのみ）
+    mGpuProfiler = new GpuProfiler();
+    mGpuProfiler->Initialize();
+
+    // オクルージョンカリング（階層Zは画面の1/4の解像度）
+    mOcclusionCulling = new OcclusionCulling(mGame->ScreenWidth / 4, mGame->ScreenHeight / 4);
+    mOcclusionCulling->Initialize(mGame->ScreenWidth, mGame->ScreenHeight);
+
+    // カスケードシャドウマップ（2048x2048、4分割）
+    mShadowMap = new CascadedShadowMap(2048, 4);
+    if (!mShadowMap->Initialize())
+    {
+        SDL_Log("Failed initialize shadow map, shadows disabled.");
+    }
+
+    // 描画パスの構成（Gバッファなどの一時テクスチャを管理）
+    mFrameGraph = new FrameGraph();
+    // 動的解像度（GPU時間の予算14ms、縦横50%〜100%）
+    mDynamicResolution = new DynamicResolution(14.0f, 0.5f, 1.0f);
+    mDynamicResolution->Initialize();
+    mRenderWidth = static_cast<int>(mGame->ScreenWidth);
+    mRenderHeight = static_cast<int>(mGame->ScreenHeight);
+
+    // 全メッシュの共有バッファ（頂点256K、インデックス1M、足りなければ拡張）
+    mGeometryPool = new GeometryPool(256 * 1024, 1024 * 1024);
+    mGeometryPool->Initialize();
+    // GPUカリング（シェーダはLoadDataで読み込む）
+    mGpuCulling = new GpuCulling();
+    // スキニングのボーン行列パレット
+    mSkinning = new Skinning();
+    mSkinning->Initialize();
+
+    // テクスチャストリーミング（VRAM予算256MB、異方性フィルタ8x）
+    mTextureStreamer = new TextureStreamer(256 * 1024 * 1024);
+    mTextureStreamer->SetAnisotropy(8.0f);
+
+    // リソースキャッシュ作成
+    // *予算を超えた分は参照されていないものから破棄される
+    mTextureCache = new ResourceCache<Texture>(
+        [this](const std::string& filePath) { return LoadTexture(filePath); },
+        [this](Texture* texture) {
+            mTextureStreamer->RemoveTexture(texture);
+            texture->Unload();
+            delete texture;
+        },
+        [](const Texture* texture) { return texture->GetMipChainBytes(0); },
+        512 * 1024 * 1024);
+    mMeshCache = new ResourceCache<Mesh>(
+        [this](const std::string& filePath) { return LoadMesh(filePath); },
+        [this](Mesh* mesh) {
+            // メッシュのマテリアルが参照していたテクスチャを解放
+            for (auto& material : mesh->GetMaterials())
+            {
+                if (material.texture) mTextureCache->Release(material.textureId);
+            }
+            mesh->Unload();
+            delete mesh;
+        },
+        [](const Mesh* mesh) { return mesh->GetGpuBytes(); },
+        256 * 1024 * 1024);
+    mShaderCache = new ResourceCache<Shader>(
+        [this](const std::string& key) { return LoadShader(static_cast<unsigned int>(std::stoul(key))); },
+        [](Shader* shader) {
+            shader->Unload();
+            delete shader;
+        },
+        [](const Shader*) { return static_cast<size_t>(0); },
+        0);
+
     return true;
 }
 
@@ -63,14 +201,19 @@ bool Renderer::InitSDL()
     SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
 
     // OpenGLウィンドウの作成
+    // *ヘッドレスでは表示しない
+    Uint32 windowFlags = SDL_WINDOW_OPENGL;
+    if (mGame->IsHeadless()) windowFlags |= SDL_WINDOW_HIDDEN;
     mWindow = SDL_CreateWindow("OpenGLTest",
                                100, 100,mGame->ScreenWidth, mGame->ScreenHeight,
-                               SDL_WINDOW_OPENGL);
+                               windowFlags);
     if (!mWindow) return false;
 
     // OpenGLコンテキストの作成
     mContext = SDL_GL_CreateContext(mWindow);
     if (!mContext) return false;
+    // ヘッドレスでは垂直同期を待たない（描画時間を計測するため）
+    if (mGame->IsHeadless()) SDL_GL_SetSwapInterval(0);
 
     return true;
 }
@@ -92,12 +235,65 @@ bool Renderer::LoadData()
     mDirLightDiffuseColor = Vector3(0.8f, 0.9f, 1.0f);
     mDirLightSpecColor = Vector3(0.8f, 0.8f, 0.8f);
 
-    // 2DSprite用シェーダ作成
-    m2DSpriteShader = new Shader(Shader::ShaderType::SPRITE);
-    if (!m2DSpriteShader->Load(mGame))
+    // 全シェーダのコンパイル
+    if (!PreloadShaders())
+    {
+        return false;
+    }
+
+    // 2DSprite用シェーダ取得
+    m2DSpriteShader = GetShader(Shader::ShaderType::SPRITE);
+    if (!m2DSpriteShader)
     {
         return false;
     }
+    mShaderCache->AddRef(m2DSpriteShader);
+
+    // 深度プリパス用シェーダ取得
+    mDepthOnlyShader = new Shader("DepthOnlyVert.glsl", "DepthOnlyFrag.glsl");
+    if (!mDepthOnlyShader->Load(mGame))
+    {
+        SDL_Log("Failed load depth only shader, depth pre-pass disabled.");
+        delete mDepthOnlyShader;
+        mDepthOnlyShader = nullptr;
+        mIsDepthPrePass = false;
+    }
+    // まとめて描画する場合の深度プリパス用シェーダ（失敗した場合はメッシュごとに描画）
+    mDepthOnlyInstancedShader = new Shader("DepthOnlyVert.glsl", "DepthOnlyFrag.glsl", Shader::FEATURE_INSTANCING);
+    if (!mDepthOnlyShader || !mDepthOnlyInstancedShader->Load(mGame))
+    {
+        delete mDepthOnlyInstancedShader;
+        mDepthOnlyInstancedShader = nullptr;
+    }
+    // スキンを持つメッシュの深度用シェーダ（失敗した場合は深度プリパス、影に描画しない）
+    mDepthOnlySkinnedShader = new Shader("DepthOnlyVert.glsl", "DepthOnlyFrag.glsl", Shader::FEATURE_SKINNING);
+    if (!mDepthOnlyShader || !mDepthOnlySkinnedShader->Load(mGame))
+    {
+        delete mDepthOnlySkinnedShader;
+        mDepthOnlySkinnedShader = nullptr;
+    }
+    // GPUカリング（コンピュートシェーダに未対応ならCPUで判定する描画のみ）
+    mGpuCulling->Initialize(mGame);
+
+    // ディファード描画用Gバッファ（失敗した場合はフォワードのみ）
+    mDeferredShading = new DeferredShading();
+    if (!mDeferredShading->Initialize(mGame))
+    {
+        SDL_Log("Failed initialize deferred shading, forward only.");
+        mDeferredShading->Shutdown();
+        delete mDeferredShading;
+        mDeferredShading = nullptr;
+    }
+
+    // ポストプロセス（失敗した場合は等倍で直接画面に描画）
+    mPostProcess = new PostProcess();
+    if (!mPostProcess->Initialize(mGame))
+    {
+        SDL_Log("Failed initialize post process, rendering directly to the screen.");
+        mPostProcess->Shutdown();
+        delete mPostProcess;
+        mPostProcess = nullptr;
+    }
 
     // 2DSprite用頂点クラス作成（三角ポリゴン＊２）
     float vertices[] = {
@@ -120,68 +316,900 @@ bool Renderer::LoadData()
 
 void Renderer::Draw()
 {
-    // 背景色をクリア
-    glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    mProfiler->BeginFrame();
 
-    // Zバッファ有効、アルファブレンド無効
-    glEnable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
+    // シェーダが変更されていれば差し替える（フレーム先頭で行うため描画途中で変わらない）
+    if (mShaderWatcher->Poll())
+    {
+        ReloadShaders();
+    }
+    // 前フレームの描画要求からテクスチャの常駐状況を更新
+    mTextureStreamer->Update();
+    // 予算を超えた未参照リソースを破棄
+    mMeshCache->Trim();
+    mTextureCache->Trim();
 
-    // メッシュ描画
-    for (auto meshComp : mMeshComps)
+    // 今フレームの光源
+    mLights.clear();
+    for (auto lightComp : mLightComps)
+    {
+        mLights.emplace_back(lightComp->GetLight());
+    }
+
+    // 描画するメッシュ（遮蔽されていないものを手前から順に、GPUカリングでは判定をGPUで行う）
+    BeginOcclusion();
+    if (IsGpuCullingActive())
+    {
+        SyncGpuCulling();
+    }
+    else
     {
-        meshComp->Draw();
+        SortOpaqueDraws();
+        BuildMultiDraws();
     }
+    // スキンを持つメッシュのポーズ評価、パレットの転送（影、深度プリパスより前）
+    {
+        ProfileScope scope(mProfiler, "Skinning");
+        mSkinning->Update(mGame->GetJobSystem());
+        mSkinning->Bind(SKIN_TEXTURE_UNIT);
+    }
+    // インスタンスのワールド行列（GPUカリングでは常駐するワールド行列を直接参照する）
+    mGeometryPool->SetInstanceSource(IsGpuCullingActive() ? mGpuCulling->GetTransformBuffer() : 0);
 
-    // Zバッファ無効、アルファブレンド有効
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // 内部解像度（ポストプロセスが無い場合は拡大できないため等倍）
+    mRenderWidth = static_cast<int>(mGame->ScreenWidth);
+    mRenderHeight = static_cast<int>(mGame->ScreenHeight);
+    if (mPostProcess)
+    {
+        mRenderWidth = mDynamicResolution->GetRenderWidth(mRenderWidth);
+        mRenderHeight = mDynamicResolution->GetRenderHeight(mRenderHeight);
+    }
+
+    // 描画パスの構築、実行
+    {
+        ProfileScope scope(mProfiler, "GraphCompile");
+        BuildFrameGraph();
+        mFrameGraph->Compile();
+    }
+    mDynamicResolution->BeginFrame();
+    mGpuProfiler->BeginFrame();
+    mFrameGraph->Execute(mProfiler, mGpuProfiler);
+    mGpuProfiler->EndFrame();
+    mDynamicResolution->EndFrame();
 
-    // スプライト描画
-    m2DSpriteShader->SetActive();
-    m2DSpriteShader->SetViewProjectionUniform(m2DViewProjection);
-    m2DSpriteVertexArray->SetActive();
-    for (auto sprite : mSpriteComps)
+    mProfiler->AddCounter("MeshDraws", static_cast<long long>(mOpaqueDraws.size()));
+    mProfiler->AddCounter("SpriteDraws", static_cast<long long>(mSpriteComps.size()));
+    mProfiler->AddCounter("MultiDrawCalls", mMultiDrawCalls);
+    mProfiler->AddCounter("SkinnedMeshes", mSkinning->GetStats().meshCount);
+    if (IsGpuCullingActive())
     {
-        sprite->Draw(m2DSpriteShader);
+        mProfiler->AddCounter("GpuCullObjects", mGpuCulling->GetStats().objectCount);
+        mProfiler->AddCounter("GpuCullUploads", mGpuCulling->GetStats().uploadedCount);
     }
+    const auto& occlusion = mOcclusionCulling->GetStats();
+    mProfiler->AddCounter("OcclusionTested", occlusion.testedCount);
+    mProfiler->AddCounter("OcclusionCulled", occlusion.occludedCount);
+    mProfiler->AddCounter("OcclusionQueries", occlusion.queryCount);
+    mProfiler->AddCounter("OcclusionNearDraws", occlusion.nearCount);
+    mProfiler->AddCounter("Lights", static_cast<long long>(mLights.size()));
+    mProfiler->AddCounter("StateChanges", mFrameGraph->GetStats().stateChanges);
+    mProfiler->AddCounter("RenderScalePercent", static_cast<long long>(mRenderWidth * 100 / mGame->ScreenWidth));
+    mProfiler->AddCounter("GpuFrameUs", static_cast<long long>(mDynamicResolution->GetLastGpuMs() * 1000.0f));
+    mProfiler->AddCounter("GpuPassesUs", static_cast<long long>(mGpuProfiler->GetLastFrameMs() * 1000.0f));
 
     // バックバッファとスワップ(ダブルバッファ)
-    SDL_GL_SwapWindow(mWindow);
+    {
+        ProfileScope scope(mProfiler, "Swap");
+        SDL_GL_SwapWindow(mWindow);
+    }
+    mProfiler->EndFrame();
+}
+
+// 描画パスの構築
+// *パスは宣言順に実行され、結果が画面に届かないパス（影無しの時の影など）は除外される
+void Renderer::BuildFrameGraph()
+{
+    FrameGraph& graph = *mFrameGraph;
+    graph.Reset();
+    const int width = mRenderWidth;
+    const int height = mRenderHeight;
+    const Vector3 clearColor(0.2f, 0.2f, 0.2f);
+
+    // 外部のリソース（パスが自分で描画先を扱うものはNO_FRAME_BUFFER）
+    FrameGraph::Handle backBuffer = graph.Import("BackBuffer", static_cast<int>(mGame->ScreenWidth),
+                                                 static_cast<int>(mGame->ScreenHeight), 0, 0, true);
+    FrameGraph::Handle shadowMap = graph.Import("ShadowMap", mShadowMap->GetResolution(), mShadowMap->GetResolution(),
+                                                FrameGraph::NO_FRAME_BUFFER, mShadowMap->GetTexture(), false);
+    FrameGraph::Handle lightClusters = graph.Import("LightClusters", 0, 0, FrameGraph::NO_FRAME_BUFFER, 0, false);
+    FrameGraph::Handle drawCommands = graph.Import("DrawCommands", 0, 0, FrameGraph::NO_FRAME_BUFFER, 0, false);
+    const bool isGpuCulling = IsGpuCullingActive();
+    const bool isShadow = mDepthOnlyShader && mShadowMap->GetCascadeCount() > 0;
+    // シーンの描画先（ポストプロセスが有ればHDRの一時テクスチャ）
+    FrameGraph::Handle sceneColor = backBuffer;
+    auto writeSceneColor = [&](FrameGraph::PassBuilder& builder, bool isDepth) {
+        if (!mPostProcess)
+        {
+            builder.Write(backBuffer);
+            return;
+        }
+        sceneColor = builder.Write(builder.Create("SceneColor", { width, height, PostProcess::SCENE_COLOR_FORMAT }));
+        if (isDepth) builder.Write(builder.Create("SceneDepth", { width, height, GL_DEPTH_COMPONENT24 }));
+    };
+
+    // 影（遮蔽されたメッシュも影は落とすため、カリング前の全メッシュが対象）
+    graph.AddPass("ShadowPass",
+        [&](FrameGraph::PassBuilder& builder) {
+            builder.Write(shadowMap);
+            builder.SetRenderState(FrameGraph::RenderState::Opaque());
+        },
+        [this](const FrameGraph&) { DrawShadows(); });
+
+    // GPUカリング（不透明メッシュの間接描画の命令を書き込む）
+    if (isGpuCulling)
+    {
+        graph.AddPass("GpuCulling",
+            [&](FrameGraph::PassBuilder& builder) { builder.Write(drawCommands); },
+            [this](const FrameGraph&) { CullOnGpu(); });
+    }
+
+    if (mRenderPath == DEFERRED && mDeferredShading)
+    {
+        // ジオメトリパスでGバッファに書き込み、ライティングは画面上の画素単位で行う
+        FrameGraph::Handle albedo = FrameGraph::INVALID_HANDLE;
+        FrameGraph::Handle normal = FrameGraph::INVALID_HANDLE;
+        FrameGraph::Handle depth = FrameGraph::INVALID_HANDLE;
+        graph.AddPass("GeometryPass",
+            [&](FrameGraph::PassBuilder& builder) {
+                if (isGpuCulling) builder.Read(drawCommands);
+                albedo = builder.Write(builder.Create("GAlbedo", { width, height, DeferredShading::ALBEDO_FORMAT }));
+                normal = builder.Write(builder.Create("GNormal", { width, height, DeferredShading::NORMAL_FORMAT }));
+                depth = builder.Write(builder.Create("GDepth", { width, height, DeferredShading::DEPTH_FORMAT }));
+                // アルベド、法線は0（反射モデル無し）、深度は最遠でクリア
+                builder.SetClear(true, true, Math::VEC3_ZERO, 0.0f);
+                builder.SetRenderState(FrameGraph::RenderState::Opaque());
+            },
+            [this](const FrameGraph& graph) {
+                DrawOpaqueDraws(true);
+                // 次フレームの階層Z用に深度を読み戻す
+                const RenderTarget& target = graph.GetCurrentTarget();
+                mOcclusionCulling->CaptureDepth(target.GetFrameBuffer(), target.GetWidth(), target.GetHeight(),
+                                                mProjectionMatrix * mViewMatrix);
+            });
+        graph.AddPass("LightingPass",
+            [&](FrameGraph::PassBuilder& builder) {
+                builder.Read(albedo);
+                builder.Read(normal);
+                builder.Read(depth);
+                if (isShadow) builder.Read(shadowMap);
+                writeSceneColor(builder, false);
+                builder.SetClear(true, true, clearColor);
+                builder.SetRenderState(FrameGraph::RenderState::Screen());
+            },
+            [this, albedo, normal, depth, width, height](const FrameGraph& graph) {
+                DeferredShading::GBuffer gbuffer;
+                gbuffer.albedo = graph.GetTexture(albedo);
+                gbuffer.normal = graph.GetTexture(normal);
+                gbuffer.depth = graph.GetTexture(depth);
+                gbuffer.width = width;
+                gbuffer.height = height;
+                mDeferredShading->DrawLighting(this, mLights, gbuffer);
+                mProfiler->AddCounter("LightVolumes", mDeferredShading->GetLightVolumeCount());
+            });
+    }
+    else
+    {
+        // 光源をクラスタに割り当て、メッシュごとに全ての光源を計算する
+        graph.AddPass("LightAssign",
+            [&](FrameGraph::PassBuilder& builder) { builder.Write(lightClusters); },
+            [this](const FrameGraph&) {
+                mClusteredLighting->Update(mLights, mViewMatrix, mProjectionMatrix,
+                                           mRenderWidth, mRenderHeight, mGame->GetJobSystem());
+                mClusteredLighting->Bind(LIGHT_TEXTURE_UNIT);
+                mProfiler->AddCounter("ClusterIndices", mClusteredLighting->GetStats().indexCount);
+            });
+        graph.AddPass("ForwardPass",
+            [&](FrameGraph::PassBuilder& builder) {
+                builder.Read(lightClusters);
+                if (isShadow) builder.Read(shadowMap);
+                if (isGpuCulling) builder.Read(drawCommands);
+                writeSceneColor(builder, true);
+                builder.SetClear(true, true, clearColor);
+                builder.SetRenderState(FrameGraph::RenderState::Opaque());
+            },
+            [this](const FrameGraph&) { DrawForward(); });
+    }
+
+    // ポストプロセス（画面の大きさへの拡大を含む）
+    if (mPostProcess) mPostProcess->AddPasses(graph, sceneColor, backBuffer);
+
+    // スプライト（Zバッファ無効、アルファブレンド有効、等倍の画面に描画）
+    graph.AddPass("Sprites",
+        [&](FrameGraph::PassBuilder& builder) {
+            builder.Read(backBuffer);
+            builder.Write(backBuffer);
+            builder.SetRenderState(FrameGraph::RenderState::Overlay());
+        },
+        [this](const FrameGraph&) {
+            m2DSpriteShader->SetActive();
+            m2DSpriteShader->SetViewProjectionUniform(m2DViewProjection);
+            m2DSpriteVertexArray->SetActive();
+            for (auto sprite : mSpriteComps)
+            {
+                sprite->Draw(m2DSpriteShader);
+            }
+        });
+}
+
+// 描画パスの構成の出力
+void Renderer::DumpFrameGraph() const
+{
+    SDL_Log("%s", mFrameGraph->Dump().c_str());
+}
+
+// フォワード描画
+// *光源の割り当て済のクラスタを参照し、メッシュごとに全ての光源を計算する
+void Renderer::DrawForward()
+{
+    // 深度プリパス後は深度が一致する画素のみシェーディングする
+    bool isPrePass = mIsDepthPrePass && mDepthOnlyShader;
+    if (isPrePass)
+    {
+        GpuMarkerScope marker(mGpuProfiler, "DepthPrePass");
+        DrawDepthPrePass();
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    DrawOpaqueDraws(false);
+
+    // パスの描画ステートに戻す
+    if (isPrePass)
+    {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+    // 次フレームの階層Z用に深度を読み戻す
+    const RenderTarget& target = mFrameGraph->GetCurrentTarget();
+    mOcclusionCulling->CaptureDepth(target.GetFrameBuffer(), target.GetWidth(), target.GetHeight(),
+                                    mProjectionMatrix * mViewMatrix);
+}
+
+// 不透明メッシュの描画
+void Renderer::DrawOpaqueDraws(bool isGBuffer)
+{
+    // 条件付き描画の問い合わせと画素数の計測は同時に行えない
+    // *GPUカリングは階層Zが無ければ視錐台のみで判定する（条件付き描画は行わない）
+    bool isConditional = mOcclusionCulling->IsQueryFallback() && mDepthOnlyShader && !IsGpuCullingActive();
+    GpuMarkerScope marker(mGpuProfiler, isGBuffer ? "OpaqueGBuffer" : "Opaque");
+    if (!isConditional) BeginOverdrawQuery();
+    if (IsMultiDrawActive() || IsGpuCullingActive())
+    {
+        DrawMultiDrawBatches(isGBuffer);
+        // スキンを持つメッシュはパレットの位置がメッシュごとに異なるため個別に描画する
+        for (auto& draw : mOpaqueDraws)
+        {
+            if (!draw.mesh->IsSkinned()) continue;
+            if (isGBuffer) draw.mesh->DrawGBuffer();
+            else draw.mesh->Draw();
+        }
+        EndOverdrawQuery();
+        return;
+    }
+    Matrix4 viewProjection = mProjectionMatrix * mViewMatrix;
+    for (auto& draw : mOpaqueDraws)
+    {
+        Mesh* mesh = draw.mesh->GetMesh();
+        if (isConditional && mesh)
+        {
+            mOcclusionCulling->BeginConditionalDraw(mesh->GetBoxMin(), mesh->GetBoxMax(),
+                                                    draw.mesh->GetActor()->GetWorldTransform(),
+                                                    mDepthOnlyShader, viewProjection);
+        }
+        if (isGBuffer) draw.mesh->DrawGBuffer();
+        else draw.mesh->Draw();
+        if (isConditional && mesh) mOcclusionCulling->EndConditionalDraw();
+    }
+    if (!isConditional) EndOverdrawQuery();
+}
+
+// 間接描画を使うか？
+// *条件付き描画はメッシュごとに問い合わせるため、まとめて描画できない
+bool Renderer::IsMultiDrawActive() const
+{
+    return mIsMultiDraw && mGeometryPool->IsMultiDrawSupported() && mDepthOnlyInstancedShader
+           && !mOcclusionCulling->IsQueryFallback();
+}
+
+// 間接描画の命令の作成
+// *描画ごとにワールド行列をインスタンスとして1つ追加し、深度プリパス用（手前から順、メッシュ全体）と
+//  カラーパス用（サブメッシュごとにシェーダ、テクスチャでまとめた順）の2通りの命令で参照する
+void Renderer::BuildMultiDraws()
+{
+    mMultiDrawCalls = 0;
+    mMultiDrawBatches.clear();
+    mDepthDrawCount = 0;
+    if (!IsMultiDrawActive()) return;
+
+    ProfileScope scope(mProfiler, "BuildMultiDraws");
+    mGeometryPool->ClearDraws();
+    mMultiDrawOrder.clear();
+    for (int i = 0; i < static_cast<int>(mOpaqueDraws.size()); i++)
+    {
+        // インスタンス番号は描画の番号と同じ
+        MeshComponent* meshComp = mOpaqueDraws[i].mesh;
+        mGeometryPool->AddInstance(meshComp->GetActor()->GetWorldTransform());
+        Mesh* mesh = meshComp->GetMesh();
+        if (!mesh || meshComp->IsSkinned()) continue;
+        mGeometryPool->AddDraw(mesh->GetGeometry(), i);
+        mDepthDrawCount++;
+        if (!meshComp->GetShader()) continue;
+        for (int subMesh = 0; subMesh < mesh->GetSubMeshCount(); subMesh++)
+        {
+            MultiDrawItem item;
+            item.draw = i;
+            item.subMesh = subMesh;
+            mMultiDrawOrder.emplace_back(item);
+        }
+        // 画面上のサイズをストリーミングに通知
+        meshComp->RequestTextureStreaming();
+    }
+
+    // シェーダ、テクスチャの順に並べる（同じまとまりの中は手前から順のまま）
+    std::stable_sort(mMultiDrawOrder.begin(), mMultiDrawOrder.end(), [this](const MultiDrawItem& a, const MultiDrawItem& b) {
+        MeshComponent* meshA = mOpaqueDraws[a.draw].mesh;
+        MeshComponent* meshB = mOpaqueDraws[b.draw].mesh;
+        unsigned int featuresA = meshA->GetShader()->GetFeatures();
+        unsigned int featuresB = meshB->GetShader()->GetFeatures();
+        if (featuresA != featuresB) return featuresA < featuresB;
+        return meshA->GetMesh()->GetSubMeshTexture(a.subMesh) < meshB->GetMesh()->GetSubMeshTexture(b.subMesh);
+    });
+    for (const MultiDrawItem& item : mMultiDrawOrder)
+    {
+        MeshComponent* meshComp = mOpaqueDraws[item.draw].mesh;
+        Mesh* mesh = meshComp->GetMesh();
+        unsigned int features = meshComp->GetShader()->GetFeatures();
+        Texture* texture = mesh->GetSubMeshTexture(item.subMesh);
+        const Mesh::SubMesh& subMesh = mesh->GetSubMeshes()[item.subMesh];
+        int command = mGeometryPool->AddDraw(mesh->GetGeometry(), item.draw, subMesh.firstIndex, subMesh.indexCount);
+        if (mMultiDrawBatches.empty() || mMultiDrawBatches.back().features != features
+            || mMultiDrawBatches.back().texture != texture)
+        {
+            MultiDrawBatch batch;
+            batch.features = features;
+            batch.texture = texture;
+            batch.first = command;
+            batch.count = 0;
+            mMultiDrawBatches.emplace_back(batch);
+        }
+        mMultiDrawBatches.back().count++;
+    }
+    mGeometryPool->UploadDraws();
+}
+
+// まとまりごとの間接描画
+// *シェーダ、テクスチャの切替はまとまりの数だけで、メッシュごとのuniformの設定、頂点配列の切替は無い
+void Renderer::DrawMultiDrawBatches(bool isGBuffer)
+{
+    Matrix4 viewProjection = mProjectionMatrix * mViewMatrix;
+    const bool isGpuCulling = IsGpuCullingActive();
+    for (int i = 0; i < static_cast<int>(mMultiDrawBatches.size()); i++)
+    {
+        const MultiDrawBatch& batch = mMultiDrawBatches[i];
+        unsigned int features = batch.features | Shader::FEATURE_INSTANCING;
+        if (isGBuffer) features |= Shader::FEATURE_GBUFFER;
+        // インスタンス描画版は初回に取得して保持する
+        Shader* shader = nullptr;
+        auto iter = mInstancedShaders.find(features);
+        if (iter != mInstancedShaders.end())
+        {
+            shader = iter->second;
+        }
+        else
+        {
+            shader = GetShader(features);
+            if (shader) mShaderCache->AddRef(shader);
+            mInstancedShaders.emplace(features, shader);
+        }
+        if (!shader) continue;
+
+        shader->SetActive();
+        shader->SetViewProjectionUniform(viewProjection);
+        shader->SetLightingUniform(this);
+        if (batch.texture) batch.texture->SetActive();
+        if (isGpuCulling)
+        {
+            mGeometryPool->Bind(GeometryPool::FORMAT_STANDARD);
+            mGpuCulling->DrawBatch(i);
+        }
+        else
+        {
+            mGeometryPool->MultiDraw(GeometryPool::FORMAT_STANDARD, batch.first, batch.count);
+        }
+        mMultiDrawCalls++;
+    }
+}
+
+// GPUカリングを使うか？
+bool Renderer::IsGpuCullingActive() const
+{
+    return mIsGpuCulling && mGpuCulling->IsSupported() && mGeometryPool->IsMultiDrawSupported()
+           && mDepthOnlyInstancedShader;
+}
+
+// GPUカリングのオブジェクトの同期
+// *行列が変わっていないメッシュは転送しない（判定、命令の作成はGPUで行う）
+// *サブメッシュごとに1オブジェクトとし、サブメッシュの境界ボックスで判定する
+// *まとまりは最初に現れた順に番号を付けるため、メッシュの並びが同じなら毎フレーム同じ
+// *スキンを持つメッシュはオブジェクトにせず、個別に描画する（境界はバインド時のポーズで判定する）
+void Renderer::SyncGpuCulling()
+{
+    ProfileScope scope(mProfiler, "GpuCullSync");
+    mOpaqueDraws.clear();
+    mMultiDrawBatches.clear();
+    mMultiDrawCalls = 0;
+    mGpuCulling->BeginObjects(*mGeometryPool);
+    for (auto meshComp : mMeshComps)
+    {
+        Mesh* mesh = meshComp->GetMesh();
+        Shader* shader = meshComp->GetShader();
+        if (!mesh || !shader) continue;
+        if (meshComp->IsSkinned())
+        {
+            if (!mOcclusionCulling->IsOccluded(mesh->GetBoxMin(), mesh->GetBoxMax(),
+                                               meshComp->GetActor()->GetWorldTransform()))
+            {
+                OpaqueDraw draw;
+                draw.depth = 0.0f;
+                draw.mesh = meshComp;
+                mOpaqueDraws.emplace_back(draw);
+            }
+            continue;
+        }
+
+        Actor* actor = meshComp->GetActor();
+        unsigned int features = shader->GetFeatures();
+        for (int subMesh = 0; subMesh < mesh->GetSubMeshCount(); subMesh++)
+        {
+            // まとまりは数が少ないため線形に探す
+            Texture* texture = mesh->GetSubMeshTexture(subMesh);
+            int batch = 0;
+            int batchCount = static_cast<int>(mMultiDrawBatches.size());
+            while (batch < batchCount && (mMultiDrawBatches[batch].features != features
+                                          || mMultiDrawBatches[batch].texture != texture))
+            {
+                batch++;
+            }
+            if (batch == batchCount)
+            {
+                MultiDrawBatch newBatch;
+                newBatch.features = features;
+                newBatch.texture = texture;
+                newBatch.first = 0;
+                newBatch.count = 0;
+                mMultiDrawBatches.emplace_back(newBatch);
+            }
+            mMultiDrawBatches[batch].count++;
+
+            const Mesh::SubMesh& range = mesh->GetSubMeshes()[subMesh];
+            GpuCulling::ObjectDesc desc;
+            desc.owner = meshComp;
+            desc.version = actor->GetTransformVersion();
+            desc.geometry = mesh->GetGeometry();
+            desc.firstIndex = range.firstIndex;
+            desc.indexCount = range.indexCount;
+            desc.batch = batch;
+            mGpuCulling->SetObject(desc, range.boxMin, range.boxMax, actor->GetWorldTransform());
+        }
+        // 見えるかどうかはGPUで判定するため、全てのメッシュについて通知する
+        meshComp->RequestTextureStreaming();
+    }
+    mGpuCulling->EndObjects(static_cast<int>(mMultiDrawBatches.size()));
+    for (int i = 0; i < static_cast<int>(mMultiDrawBatches.size()); i++)
+    {
+        mMultiDrawBatches[i].first = mGpuCulling->GetBatchOffset(i);
+    }
+}
+
+// GPUカリングの実行
+void Renderer::CullOnGpu()
+{
+    // 階層Zが有効なら遮蔽判定も行う
+    const HiZBuffer* hiz = nullptr;
+    if (mOcclusionCulling->GetMode() != OcclusionCulling::OFF && mOcclusionCulling->GetStats().isHiZValid)
+    {
+        hiz = &mOcclusionCulling->GetHiZ();
+    }
+    Matrix4 viewProjection = mProjectionMatrix * mViewMatrix;
+    mGpuCulling->Cull(viewProjection, hiz);
+    if (mIsGpuCullingValidation)
+    {
+        mGpuCullingMismatchCount += mGpuCulling->Validate(viewProjection, hiz);
+    }
+}
+
+// 遮蔽判定の準備
+void Renderer::BeginOcclusion()
+{
+    ProfileScope scope(mProfiler, "OcclusionCull");
+    mOccluders.clear();
+    if (mOcclusionCulling->GetMode() == OcclusionCulling::SOFTWARE)
+    {
+        for (auto meshComp : mMeshComps)
+        {
+            Mesh* mesh = meshComp->GetMesh();
+            if (!meshComp->IsOccluder() || !mesh) continue;
+            OcclusionCulling::Occluder occluder;
+            occluder.positions = &mesh->GetPositions();
+            occluder.indices = &mesh->GetIndices();
+            occluder.world = meshComp->GetActor()->GetWorldTransform();
+            mOccluders.emplace_back(occluder);
+        }
+    }
+    mOcclusionCulling->BeginFrame(mProjectionMatrix * mViewMatrix, mOccluders);
+}
+
+// 不透明メッシュのソート
+// *遮蔽されているメッシュは除外する
+// *手前から描画することで、奥のメッシュのフラグメントが深度テストで早期に棄却される
+void Renderer::SortOpaqueDraws()
+{
+    ProfileScope scope(mProfiler, "Sort");
+    const Matrix4& v = mViewMatrix;
+    mOpaqueDraws.clear();
+    for (auto meshComp : mMeshComps)
+    {
+        Mesh* mesh = meshComp->GetMesh();
+        if (mesh && mOcclusionCulling->IsOccluded(mesh->GetBoxMin(), mesh->GetBoxMax(),
+                                                  meshComp->GetActor()->GetWorldTransform()))
+        {
+            continue;
+        }
+        const Vector3 pos = meshComp->GetActor()->GetWorldPosition();
+        OpaqueDraw draw;
+        draw.depth = v.matrix[2][0]*pos.x + v.matrix[2][1]*pos.y + v.matrix[2][2]*pos.z + v.matrix[2][3];
+        draw.mesh = meshComp;
+        mOpaqueDraws.emplace_back(draw);
+    }
+    std::sort(mOpaqueDraws.begin(), mOpaqueDraws.end(), [](const OpaqueDraw& a, const OpaqueDraw& b) {
+        return a.depth < b.depth;
+    });
+}
+
+// 平行光源のシャドウマップ描画
+void Renderer::DrawShadows()
+{
+    if (!mDepthOnlyShader) return;
+    mShadowMap->Update(mViewMatrix, mProjectionMatrix, mDirLightDirection);
+    mShadowMap->Draw(mMeshComps, mDepthOnlyShader);
+    mShadowMap->Bind(SHADOW_TEXTURE_UNIT);
+    mProfiler->AddCounter("ShadowCasters", mShadowMap->GetCasterCount());
+}
+
+// 影の品質の変更
+void Renderer::SetShadowQuality(int resolution, int cascadeCount)
+{
+    LogProfileStats();
+    mShadowMap->SetQuality(resolution, cascadeCount);
+    SDL_Log("shadow quality: %dx%d, %d cascades", mShadowMap->GetResolution(), mShadowMap->GetResolution(),
+            mShadowMap->GetCascadeCount());
+}
+
+// 深度プリパス
+// *位置座標のみの頂点配列で深度だけを書き込む（カラーは書き込まない）
+void Renderer::DrawDepthPrePass()
+{
+    ProfileScope scope(mProfiler, "DepthPrePass");
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    if (IsGpuCullingActive())
+    {
+        // まとまりごとに描画（GPUで判定するため手前から順にはならない）
+        mDepthOnlyInstancedShader->SetActive();
+        mDepthOnlyInstancedShader->SetViewProjectionUniform(mProjectionMatrix * mViewMatrix);
+        mGeometryPool->Bind(GeometryPool::FORMAT_POSITION);
+        for (int i = 0; i < static_cast<int>(mMultiDrawBatches.size()); i++)
+        {
+            mGpuCulling->DrawBatch(i);
+            mMultiDrawCalls++;
+        }
+        DrawSkinnedDepth();
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        return;
+    }
+    if (IsMultiDrawActive())
+    {
+        // 手前から順の命令をまとめて描画
+        mDepthOnlyInstancedShader->SetActive();
+        mDepthOnlyInstancedShader->SetViewProjectionUniform(mProjectionMatrix * mViewMatrix);
+        mGeometryPool->MultiDraw(GeometryPool::FORMAT_POSITION, 0, mDepthDrawCount);
+        mMultiDrawCalls++;
+        DrawSkinnedDepth();
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        return;
+    }
+    Matrix4 viewProjection = mProjectionMatrix * mViewMatrix;
+    mDepthOnlyShader->SetActive();
+    mDepthOnlyShader->SetViewProjectionUniform(viewProjection);
+    for (auto& draw : mOpaqueDraws)
+    {
+        draw.mesh->DrawDepth(mDepthOnlyShader, viewProjection);
+    }
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+// スキンを持つメッシュの深度描画（まとめて描画した後に個別に描画する）
+void Renderer::DrawSkinnedDepth()
+{
+    Matrix4 viewProjection = mProjectionMatrix * mViewMatrix;
+    mDepthOnlyShader->SetActive();
+    mDepthOnlyShader->SetViewProjectionUniform(viewProjection);
+    for (auto& draw : mOpaqueDraws)
+    {
+        if (draw.mesh->IsSkinned()) draw.mesh->DrawDepth(mDepthOnlyShader, viewProjection);
+    }
+}
+
+// 描画画素数の計測
+// *結果の待ちで停止しないよう、前フレームのクエリの結果を読む
+void Renderer::BeginOverdrawQuery()
+{
+    int prev = 1 - mOverdrawQueryIndex;
+    if (mIsOverdrawQueryIssued[prev])
+    {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(mOverdrawQueries[prev], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint samples = 0;
+            glGetQueryObjectuiv(mOverdrawQueries[prev], GL_QUERY_RESULT, &samples);
+            long long pixels = static_cast<long long>(mRenderWidth) * mRenderHeight;
+            mProfiler->AddCounter("ShadedSamples", samples);
+            // 画面の画素数に対する割合（100で画面全体を1回）
+            mProfiler->AddCounter("OverdrawPercent", samples * 100LL / pixels);
+            mIsOverdrawQueryIssued[prev] = false;
+        }
+    }
+    glBeginQuery(GL_SAMPLES_PASSED, mOverdrawQueries[mOverdrawQueryIndex]);
+}
+void Renderer::EndOverdrawQuery()
+{
+    glEndQuery(GL_SAMPLES_PASSED);
+    mIsOverdrawQueryIssued[mOverdrawQueryIndex] = true;
+    mOverdrawQueryIndex = 1 - mOverdrawQueryIndex;
+}
+
+// 描画方式の切替
+void Renderer::SetRenderPath(RenderPath path)
+{
+    if (path == DEFERRED && !mDeferredShading)
+    {
+        SDL_Log("Deferred shading is not available.");
+        return;
+    }
+    if (path == mRenderPath) return;
+    // 切替前の方式の平均を出力して比較できるようにする
+    LogProfileStats();
+    mRenderPath = path;
+    SDL_Log("render path: %s", GetRenderPathName(mRenderPath));
+}
+
+// ポストプロセスの品質の変更
+void Renderer::SetPostQuality(PostProcess::Quality quality)
+{
+    if (!mPostProcess || quality == mPostProcess->GetQuality()) return;
+    LogProfileStats();
+    mPostProcess->SetQuality(quality);
+    SDL_Log("post process: %s", PostProcess::GetQualityName(quality));
+}
+
+// 動的解像度の切替
+void Renderer::SetDynamicResolution(bool enable)
+{
+    if (enable == mDynamicResolution->IsEnabled()) return;
+    LogProfileStats();
+    mDynamicResolution->SetEnabled(enable);
+    SDL_Log("dynamic resolution: %s", enable ? "on" : "off");
+}
+
+// 間接描画の切替
+void Renderer::SetMultiDraw(bool enable)
+{
+    if (enable && (!mGeometryPool->IsMultiDrawSupported() || !mDepthOnlyInstancedShader))
+    {
+        SDL_Log("Multi draw indirect is not available.");
+        return;
+    }
+    if (enable == mIsMultiDraw) return;
+    LogProfileStats();
+    mIsMultiDraw = enable;
+    SDL_Log("multi draw indirect: %s", mIsMultiDraw ? "on" : "off");
+}
+
+// GPUカリングの切替
+void Renderer::SetGpuCulling(bool enable)
+{
+    if (enable && (!mGpuCulling->IsSupported() || !mGeometryPool->IsMultiDrawSupported() || !mDepthOnlyInstancedShader))
+    {
+        SDL_Log("GPU culling is not available.");
+        return;
+    }
+    if (enable == mIsGpuCulling) return;
+    LogProfileStats();
+    mIsGpuCulling = enable;
+    SDL_Log("gpu culling: %s (%s)", mIsGpuCulling ? "on" : "off",
+            mGpuCulling->IsDrawCountSupported() ? "indirect count" : "empty commands");
+}
+
+// 深度プリパスの切替
+void Renderer::SetDepthPrePass(bool enable)
+{
+    if (enable && !mDepthOnlyShader)
+    {
+        SDL_Log("Depth pre-pass is not available.");
+        return;
+    }
+    if (enable == mIsDepthPrePass) return;
+    LogProfileStats();
+    mIsDepthPrePass = enable;
+    SDL_Log("depth pre-pass: %s", mIsDepthPrePass ? "on" : "off");
+}
+
+// オクルージョンカリングの切替
+void Renderer::SetOcclusionMode(OcclusionCulling::Mode mode)
+{
+    if (mode == mOcclusionCulling->GetMode()) return;
+    LogProfileStats();
+    mOcclusionCulling->SetMode(mode);
+    SDL_Log("occlusion culling: %s", OcclusionCulling::GetModeName(mode));
+}
+
+std::string Renderer::GetProfileLabel() const
+{
+    std::string label = GetRenderPathName(mRenderPath);
+    // 深度プリパスはフォワード描画のみ
+    if (mRenderPath == FORWARD && mIsDepthPrePass) label += "+prepass";
+    label += std::string(" occlusion:") + OcclusionCulling::GetModeName(mOcclusionCulling->GetMode());
+    label += " shadow:" + std::to_string(mShadowMap->GetResolution()) + "x" + std::to_string(mShadowMap->GetCascadeCount());
+    if (mPostProcess)
+    {
+        label += std::string(" post:") + PostProcess::GetQualityName(mPostProcess->GetQuality());
+        label += mDynamicResolution->IsEnabled() ? " scale:auto" : " scale:fixed";
+    }
+    if (IsGpuCullingActive()) label += " +gpucull";
+    else if (IsMultiDrawActive()) label += " +mdi";
+    return label;
+}
+
+// 計測結果の出力
+void Renderer::LogProfileStats()
+{
+    const std::string label = GetProfileLabel();
+    mProfiler->LogStats(label.c_str());
+    mGpuProfiler->LogStats(label.c_str());
+}
+
+// GPU時間の履歴の出力
+void Renderer::DumpGpuProfile() const
+{
+    mGpuProfiler->WriteCsv(mGame->GetGpuProfilePath());
+}
+
+const char* Renderer::GetRenderPathName(RenderPath path)
+{
+    switch (path)
+    {
+        case FORWARD: return "forward";
+        case DEFERRED: return "deferred";
+        default: return "unknown";
+    }
 }
 
 // 終了処理
 void Renderer::ShutDown()
 {
-    // テクスチャを破棄
-    for (auto i : mCachedTextures)
+    LogResourceStats();
+    mTextureStreamer->LogStats();
+    LogProfileStats();
+    DumpGpuProfile();
+    delete mProfiler;
+    mProfiler = nullptr;
+    mGpuProfiler->Shutdown();
+    delete mGpuProfiler;
+    mGpuProfiler = nullptr;
+    glDeleteQueries(2, mOverdrawQueries);
+    mOcclusionCulling->Shutdown();
+    delete mOcclusionCulling;
+    mOcclusionCulling = nullptr;
+    mShadowMap->Shutdown();
+    delete mShadowMap;
+    mShadowMap = nullptr;
+    mFrameGraph->Shutdown();
+    delete mFrameGraph;
+    mFrameGraph = nullptr;
+    SDL_Log("dynamic resolution: scale %.0f%%, %d changes", mDynamicResolution->GetScale() * 100.0f,
+            mDynamicResolution->GetChangeCount());
+    mDynamicResolution->Shutdown();
+    delete mDynamicResolution;
+    mDynamicResolution = nullptr;
+    if (mPostProcess)
     {
-        i.second->Unload();
-        delete i.second;
+        mPostProcess->Shutdown();
+        delete mPostProcess;
+        mPostProcess = nullptr;
     }
-    mCachedTextures.clear();
 
-    // メッシュを破棄
-    for (auto i : mCachedMeshes)
+    // メッシュを破棄（参照しているテクスチャより先に破棄する）
+    delete mMeshCache;
+    mMeshCache = nullptr;
+    // メッシュの共有バッファを破棄（メッシュの解放後）
+    mGeometryPool->Shutdown();
+    delete mGeometryPool;
+    mGeometryPool = nullptr;
+
+    // テクスチャを破棄
+    delete mTextureCache;
+    mTextureCache = nullptr;
+    delete mTextureStreamer;
+    mTextureStreamer = nullptr;
+
+    // Gバッファ、ライティング用シェーダを破棄
+    if (mDeferredShading)
     {
-        i.second->Unload();
-        delete i.second;
+        mDeferredShading->Shutdown();
+        delete mDeferredShading;
+        mDeferredShading = nullptr;
     }
-    mCachedMeshes.clear();
+
+    // GPUカリング用バッファ、シェーダを破棄
+    mGpuCulling->Shutdown();
+    delete mGpuCulling;
+    mGpuCulling = nullptr;
+
+    // ボーン行列パレットを破棄
+    mSkinning->Shutdown();
+    delete mSkinning;
+    mSkinning = nullptr;
+
+    // 光源用バッファを破棄
+    mClusteredLighting->Shutdown();
+    delete mClusteredLighting;
+    mClusteredLighting = nullptr;
 
     // シェーダを破棄
-    for (auto i : mCachedShaders)
+    if (mDepthOnlyShader)
+    {
+        mDepthOnlyShader->Unload();
+        delete mDepthOnlyShader;
+        mDepthOnlyShader = nullptr;
+    }
+    if (mDepthOnlyInstancedShader)
+    {
+        mDepthOnlyInstancedShader->Unload();
+        delete mDepthOnlyInstancedShader;
+        mDepthOnlyInstancedShader = nullptr;
+    }
+    if (mDepthOnlySkinnedShader)
     {
-        i.second->Unload();
-        delete i.second;
+        mDepthOnlySkinnedShader->Unload();
+        delete mDepthOnlySkinnedShader;
+        mDepthOnlySkinnedShader = nullptr;
     }
-    mCachedShaders.clear();
+    for (auto& instanced : mInstancedShaders)
+    {
+        if (instanced.second) mShaderCache->Release(instanced.second);
+    }
+    mInstancedShaders.clear();
+    mShaderCache->Release(m2DSpriteShader);
+    m2DSpriteShader = nullptr;
+    delete mShaderCache;
+    mShaderCache = nullptr;
+    SDL_Log("program binary cache: hit %d, miss %d",
+            mProgramBinaryCache->GetHitCount(), mProgramBinaryCache->GetMissCount());
+    delete mProgramBinaryCache;
+    mProgramBinaryCache = nullptr;
+    delete mShaderWatcher;
+    mShaderWatcher = nullptr;
 
     // 2DSprite用クラスを破棄
-    m2DSpriteShader->Unload();
-    delete m2DSpriteShader;
     delete m2DSpriteVertexArray;
 
     // SDL関連の変数を破棄
@@ -193,16 +1221,12 @@ void Renderer::ShutDown()
 // スプライトコンポーネント追加・削除処理
 void Renderer::AddSpriteComp(SpriteComponent* sprite)
 {
-    // 描画順にソートして追加
+    // 描画順にソートして追加（同じ描画順なら後ろに追加）
     int myDrawOrder = sprite->GetDrawOrder();
-    auto iter = mSpriteComps.begin();
-    for (; iter != mSpriteComps.end(); ++iter)
-    {
-        if (myDrawOrder < (*iter)->GetDrawOrder())
-        {
-            break;
-        }
-    }
+    auto iter = std::upper_bound(mSpriteComps.begin(), mSpriteComps.end(), myDrawOrder,
+                                 [](int drawOrder, const SpriteComponent* other) {
+                                     return drawOrder < other->GetDrawOrder();
+                                 });
     mSpriteComps.insert(iter, sprite);
 }
 void Renderer::RemoveSpriteComp(SpriteComponent* sprite)
@@ -222,67 +1246,314 @@ void Renderer::RemoveMeshComp(class MeshComponent* mesh)
     mMeshComps.erase(iter);
 }
 
-// テクスチャロード処理
-Texture* Renderer::GetTexture(const std::string &filePath)
+// 光源コンポーネント追加・削除処理
+void Renderer::AddLightComp(class LightComponent* light)
 {
-    // キャッシュ済なら返却
-    auto iter = mCachedTextures.find(filePath);
-    if (iter != mCachedTextures.end()) return iter->second;
+    mLightComps.emplace_back(light);
+}
+void Renderer::RemoveLightComp(class LightComponent* light)
+{
+    auto iter = std::find(mLightComps.begin(), mLightComps.end(), light);
+    mLightComps.erase(iter);
+}
 
-    Texture* texture = nullptr;
-    texture = new Texture();
-    if (texture->Load(filePath))
+// 使用するシェーダバリアントのコンパイル
+// *先に全てのコンパイルを発行し、後から結果を確認することで並列コンパイルを活かす
+// *それ以外のバリアントはGetShaderで初めて要求された時にコンパイルする
+bool Renderer::PreloadShaders()
+{
+    const Shader::ShaderType types[] = {
+        Shader::ShaderType::BASIC,
+        Shader::ShaderType::SPRITE,
+        Shader::ShaderType::LAMBERT,
+        Shader::ShaderType::PHONG,
+    };
+    std::vector<Shader*> shaders;
+    for (auto type : types)
     {
-        mCachedTextures.emplace(filePath, texture);
+        Shader* shader = new Shader(Shader::GetTypeFeatures(type));
+        if (!shader->BeginLoad(mGame))
+        {
+            delete shader;
+            continue;
+        }
+        shaders.emplace_back(shader);
     }
-    else
+
+    bool success = true;
+    for (auto shader : shaders)
     {
-        delete texture;
-        texture = nullptr;
+        if (!shader->FinishLoad())
+        {
+            shader->Unload();
+            delete shader;
+            success = false;
+            continue;
+        }
+        shader->SetViewProjectionUniform(mProjectionMatrix * mViewMatrix);
+        mShaderCache->Add(GetShaderId(shader->GetFeatures()), shader);
     }
-    return texture;
+    return success;
 }
 
-// メッシュロード処理
+// テクスチャ取得処理
+Texture* Renderer::GetTexture(const std::string &filePath)
+{
+    return mTextureCache->Get(filePath);
+}
+Texture* Renderer::GetTexture(ResourceId id)
+{
+    return mTextureCache->Get(id);
+}
+
+// メッシュ取得処理
 Mesh* Renderer::GetMesh(const std::string &filePath)
 {
-    // キャッシュ済なら返却
-    auto iter = mCachedMeshes.find(filePath);
-    if (iter != mCachedMeshes.end()) return iter->second;
+    return mMeshCache->Get(filePath);
+}
+Mesh* Renderer::GetMesh(ResourceId id)
+{
+    return mMeshCache->Get(id);
+}
 
-    Mesh* mesh = nullptr;
-    mesh = new Mesh();
-    if (mesh->Load(filePath, mGame))
+// パスのインターン
+ResourceId Renderer::InternTexture(const std::string &filePath)
+{
+    return mTextureCache->Intern(filePath);
+}
+ResourceId Renderer::InternMesh(const std::string &filePath)
+{
+    return mMeshCache->Intern(filePath);
+}
+
+// テクスチャの先読み
+// *ファイル読込、ミップマップ生成、未対応フォーマットの展開をジョブシステムで並列に行い、
+//  GPUへの転送とキャッシュへの登録はメインスレッドでまとめて行う
+// *読み込めなかったテクスチャは登録しない（GetTextureで改めて読み込む）
+int Renderer::PrefetchTextures(const std::vector<std::string>& filePaths)
+{
+    std::vector<std::string> pending;
+    for (const auto& filePath : filePaths)
     {
-        mCachedMeshes.emplace(filePath, mesh);
+        if (!mTextureCache->IsLoaded(filePath)) pending.emplace_back(filePath);
     }
-    else
+    std::vector<Texture*> textures(pending.size(), nullptr);
+    auto decode = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            Texture* texture = new Texture();
+            if (texture->Decode(pending[i], mGame->GetFileSystem())) textures[i] = texture;
+            else delete texture;
+        }
+    };
+    if (mGame->GetJobSystem()) mGame->GetJobSystem()->ParallelFor(pending.size(), 1, decode);
+    else decode(0, pending.size());
+
+    int loadedCount = 0;
+    for (size_t i = 0; i < pending.size(); i++)
     {
-        delete mesh;
-        mesh = nullptr;
+        if (!textures[i]) continue;
+        textures[i]->Upload(0);
+        mTextureStreamer->AddTexture(textures[i]);
+        mTextureCache->Add(pending[i], textures[i]);
+        loadedCount++;
     }
-    return mesh;
+    return loadedCount;
 }
 
-// シェーダロード処理
+// コンポーネントの配列の確保
+void Renderer::ReserveComponents(int spriteCount, int meshCount, int lightCount)
+{
+    mSpriteComps.reserve(mSpriteComps.size() + spriteCount);
+    mMeshComps.reserve(mMeshComps.size() + meshCount);
+    mLightComps.reserve(mLightComps.size() + lightCount);
+}
+
+// シェーダ取得処理
 Shader* Renderer::GetShader(const Shader::ShaderType type)
 {
-    // キャッシュ済なら返却
-    auto iter = mCachedShaders.find(type);
-    if (iter != mCachedShaders.end()) return iter->second;
+    return GetShader(Shader::GetTypeFeatures(type));
+}
+Shader* Renderer::GetShader(unsigned int features)
+{
+    if (!Shader::IsValidFeatures(features))
+    {
+        SDL_Log("Invalid shader features. (%s)", Shader::GetVariantName(features).c_str());
+        return nullptr;
+    }
+    return mShaderCache->Get(GetShaderId(features));
+}
+
+// 機能フラグのID
+// *キャッシュのキーの文字列はバリアントごとに最初の1回だけ作り、以降は表から引く
+ResourceId Renderer::GetShaderId(unsigned int features)
+{
+    ResourceId& id = mShaderIds[features];
+    if (id == INVALID_RESOURCE_ID) id = mShaderCache->Intern(std::to_string(features));
+    return id;
+}
 
-    Shader* shader = nullptr;
-    shader = new Shader(type);
-    if (shader->Load(mGame))
+// シェーダの再読込
+// *読込済のバリアントを全てまとめてコンパイルし、成功したものだけプログラムを入れ替える
+// *失敗したものはエラーを出力して古いプログラムを使い続ける
+void Renderer::ReloadShaders()
+{
+    std::vector<Shader*> targets;
+    mShaderCache->ForEachLoaded([&](const std::string&, Shader* shader, int) {
+        targets.emplace_back(shader);
+    });
+    if (mDepthOnlyShader) targets.emplace_back(mDepthOnlyShader);
+    if (mDepthOnlyInstancedShader) targets.emplace_back(mDepthOnlyInstancedShader);
+    if (mDepthOnlySkinnedShader) targets.emplace_back(mDepthOnlySkinnedShader);
+    if (mGpuCulling->GetShader()) targets.emplace_back(mGpuCulling->GetShader());
+    if (mDeferredShading)
     {
-        // ViewProjection座標の設定
-        shader->SetViewProjectionUniform(mProjectionMatrix * mViewMatrix);
-        mCachedShaders.emplace(type, shader);
+        auto deferredShaders = mDeferredShading->GetShaders();
+        targets.insert(targets.end(), deferredShaders.begin(), deferredShaders.end());
     }
-    else
+    if (mPostProcess)
+    {
+        auto postShaders = mPostProcess->GetShaders();
+        targets.insert(targets.end(), postShaders.begin(), postShaders.end());
+    }
+
+    std::vector<std::pair<Shader*, Shader*>> reloads; // 差し替え先、新しいシェーダ
+    for (auto shader : targets)
     {
+        Shader* reload = shader->Clone();
+        if (!reload->BeginLoad(mGame))
+        {
+            delete reload;
+            SDL_Log("Failed reload shader. (%s)", shader->GetVariantName().c_str());
+            continue;
+        }
+        reloads.emplace_back(shader, reload);
+    }
+
+    int successCount = 0;
+    for (auto& reload : reloads)
+    {
+        if (reload.second->FinishLoad())
+        {
+            reload.first->SwapProgram(reload.second);
+            successCount++;
+        }
+        else
+        {
+            SDL_Log("Failed reload shader, keep previous program. (%s)", reload.first->GetVariantName().c_str());
+        }
+        // 入れ替えた場合は古いプログラムを破棄
+        reload.second->Unload();
+        delete reload.second;
+    }
+    SDL_Log("shader reload: %d/%d variants", successCount, static_cast<int>(reloads.size()));
+}
+
+// 参照されていないリソースを全て破棄
+void Renderer::UnloadUnusedResources()
+{
+    mMeshCache->UnloadUnused();
+    mTextureCache->UnloadUnused();
+    mShaderCache->UnloadUnused();
+    // 解放で空いた領域を詰める
+    mGeometryPool->Defragment();
+}
+
+// リソース使用状況のログ出力
+void Renderer::LogResourceStats() const
+{
+    auto texture = mTextureCache->GetStats();
+    auto mesh = mMeshCache->GetStats();
+    auto shader = mShaderCache->GetStats();
+    SDL_Log("texture cache: %d loaded (%d referenced), %.2f/%.2f MB, loads %d, evictions %d",
+            texture.loadedCount, texture.referencedCount,
+            texture.bytes / (1024.0f * 1024.0f), texture.budgetBytes / (1024.0f * 1024.0f),
+            texture.loadCount, texture.evictionCount);
+    SDL_Log("mesh cache: %d loaded (%d referenced), %.2f/%.2f MB, loads %d, evictions %d",
+            mesh.loadedCount, mesh.referencedCount,
+            mesh.bytes / (1024.0f * 1024.0f), mesh.budgetBytes / (1024.0f * 1024.0f),
+            mesh.loadCount, mesh.evictionCount);
+    SDL_Log("shader cache: %d loaded (%d referenced), loads %d, evictions %d",
+            shader.loadedCount, shader.referencedCount, shader.loadCount, shader.evictionCount);
+    auto graph = mFrameGraph->GetStats();
+    SDL_Log("frame graph: %d passes (%d culled), %d transient textures in %d physical, %.2f/%.2f MB",
+            graph.passCount, graph.culledPassCount, graph.transientCount, graph.physicalCount,
+            graph.physicalBytes / (1024.0f * 1024.0f), graph.transientBytes / (1024.0f * 1024.0f));
+    auto geometry = mGeometryPool->GetStats();
+    SDL_Log("geometry pool: %d meshes, vertices %u/%u, indices %u/%u, %d free ranges, %.2f MB, defragments %d, grows %d",
+            geometry.meshCount, geometry.usedVertices, geometry.vertexCapacity,
+            geometry.usedIndices, geometry.indexCapacity, geometry.freeRangeCount,
+            geometry.gpuBytes / (1024.0f * 1024.0f), geometry.defragmentCount, geometry.growCount);
+    auto lighting = mClusteredLighting->GetStats();
+    SDL_Log("clustered lighting: %d/%d lights visible, %d indices, max %d per cluster, assign %.3f ms",
+            lighting.visibleLightCount, lighting.lightCount, lighting.indexCount,
+            lighting.maxLightsPerCluster, lighting.assignMs);
+    auto files = mGame->GetFileSystem()->GetStats();
+    SDL_Log("file system: %d packs, pack reads %d (%d mapped), loose reads %d, decompressed %.2f MB",
+            files.mountCount, files.packReadCount, files.mappedReadCount, files.looseReadCount,
+            files.decompressedBytes / (1024.0f * 1024.0f));
+
+    // コンパイル済のシェーダバリアント
+    SDL_Log("shader variants: %d compiled / %d possible", shader.loadedCount, Shader::GetVariantCount());
+    mShaderCache->ForEachLoaded([](const std::string&, const Shader* variant, int refCount) {
+        SDL_Log("  %s (refs %d)", variant->GetVariantName().c_str(), refCount);
+    });
+}
+
+// テクスチャロード処理
+Texture* Renderer::LoadTexture(const std::string &filePath)
+{
+    Texture* texture = new Texture();
+    if (!texture->Load(filePath, mGame->GetFileSystem()))
+    {
+        delete texture;
+        return nullptr;
+    }
+    mTextureStreamer->AddTexture(texture);
+    return texture;
+}
+
+// メッシュロード処理
+Mesh* Renderer::LoadMesh(const std::string &filePath)
+{
+    Mesh* mesh = new Mesh();
+    if (!mesh->Load(filePath, mGame))
+    {
+        // 途中まで読み込んだスケルトンやアニメーションも解放する
+        mesh->Unload();
+        delete mesh;
+        return nullptr;
+    }
+    // メッシュのマテリアルが使用するテクスチャを参照する
+    for (auto& material : mesh->GetMaterials())
+    {
+        if (material.texture) mTextureCache->AddRef(material.textureId);
+    }
+    return mesh;
+}
+
+// シェーダロード処理
+Shader* Renderer::LoadShader(unsigned int features)
+{
+    Shader* shader = new Shader(features);
+    if (!shader->Load(mGame))
+    {
+        shader->Unload();
         delete shader;
-        shader = nullptr;
+        return nullptr;
     }
+    // ViewProjection座標の設定
+    shader->SetViewProjectionUniform(mProjectionMatrix * mViewMatrix);
     return shader;
 }
+
+// 画面上のサイズの概算
+float Renderer::EstimateScreenSize(const Vector3& center, float radius) const
+{
+    // ビュー空間の奥行きで割り、射影行列の縦方向スケールを掛ける
+    const Matrix4& v = mViewMatrix;
+    float viewZ = v.matrix[2][0]*center.x + v.matrix[2][1]*center.y + v.matrix[2][2]*center.z + v.matrix[2][3];
+    if (viewZ <= radius) return mGame->ScreenHeight; // カメラに接している場合は画面全体
+    float yScale = mProjectionMatrix.matrix[1][1];
+    return radius * 2.0f * yScale / viewZ * mGame->ScreenHeight * 0.5f;
+}
@@ -3,10 +3,21 @@
 #include <unordered_map>
 #include "../Commons/Math.h"
 #include "../Commons/Shader.h"
+#include "../Commons/ResourceCache.h"
+#include "../Commons/ClusteredLighting.h"
+#include "../Commons/OcclusionCulling.h"
+#include "../Commons/PostProcess.h"
 
 // 描画クラス
 class Renderer {
 public:
+    // 描画方式
+    enum RenderPath
+    {
+        FORWARD,  // フォワード（クラスタードライティング）
+        DEFERRED, // ディファード（Gバッファ + ライトボリューム）
+    };
+
     Renderer(class Game* game);
     ~Renderer();
 
@@ -19,14 +30,99 @@ public:
     void RemoveSpriteComp(class SpriteComponent* sprite);   // スプライトコンポーネント削除
     void AddMeshComp(class MeshComponent* mesh);            // メッシュコンポーネント追加
     void RemoveMeshComp(class MeshComponent* mesh);         // メッシュコンポーネント削除
+    void AddLightComp(class LightComponent* light);         // 光源コンポーネント追加
+    void RemoveLightComp(class LightComponent* light);      // 光源コンポーネント削除
     class Texture* GetTexture(const std::string& filePath); // テクスチャ取得、キャッシュ
+    class Texture* GetTexture(ResourceId id);               // テクスチャ取得（インターン済ID）
     class Mesh* GetMesh(const std::string& filePath);       // メッシュ取得、キャッシュ
+    class Mesh* GetMesh(ResourceId id);                     // メッシュ取得（インターン済ID）
+    // パスをIDに変換（読込時に一度だけ呼び、以降はIDで取得する）
+    ResourceId InternTexture(const std::string& filePath);
+    ResourceId InternMesh(const std::string& filePath);
+    // テクスチャの先読み（未読込のものをワーカースレッドで並列にデコードし、転送してキャッシュに登録）
+    int PrefetchTextures(const std::vector<std::string>& filePaths);
+    // コンポーネントの配列の確保（シーンの読込時に、まとめて追加する数を先に確保する）
+    void ReserveComponents(int spriteCount, int meshCount, int lightCount);
     class Shader* GetShader(const Shader::ShaderType type); // シェーダ取得、キャッシュ
+    class Shader* GetShader(unsigned int features);         // シェーダバリアント取得（未コンパイルなら初回に作成）
+    void ReloadShaders(); // 読込済シェーダの再コンパイル（失敗したものは古いまま）
+    void UnloadUnusedResources(); // 参照されていないリソースを全て破棄（シーン切替時）
+    void LogResourceStats() const; // リソース使用状況のログ出力
+    void SetRenderPath(RenderPath path); // 描画方式の切替（切替前の計測結果を出力）
+    void SetDepthPrePass(bool enable);   // 深度プリパスの切替（切替前の計測結果を出力）
+    void SetOcclusionMode(OcclusionCulling::Mode mode); // オクルージョンカリングの切替（切替前の計測結果を出力）
+    void SetShadowQuality(int resolution, int cascadeCount); // 影の解像度、カスケード数（0で影無し）
+    void SetPostQuality(PostProcess::Quality quality);        // ポストプロセスの品質（切替前の計測結果を出力）
+    void SetDynamicResolution(bool enable);                   // 動的解像度の切替（無効時は等倍）
+    void SetMultiDraw(bool enable);      // 間接描画でまとめて描画するかの切替（切替前の計測結果を出力）
+    void SetGpuCulling(bool enable);     // GPUカリングの切替（切替前の計測結果を出力）
+    void SetGpuCullingValidation(bool enable) { mIsGpuCullingValidation = enable; } // 毎フレームCPUの参照実装と比較
+    void DumpFrameGraph() const;         // 今フレームの描画パスの構成をログ出力
+    void DumpGpuProfile() const;         // パスごとのGPU時間の履歴をCSVで出力
+    static const char* GetRenderPathName(RenderPath path);
+
+    // ワールド座標の球が画面上で占める縦方向のピクセル数を概算
+    float EstimateScreenSize(const Vector3& center, float radius) const;
 
 private:
     bool InitSDL(); // SDL関連初期化
+    bool PreloadShaders(); // 全シェーダをまとめてコンパイル
+    void BuildFrameGraph(); // 今フレームの描画パスの構築
+    void DrawForward();    // フォワード描画（メッシュ）
+    void BeginOcclusion();  // 遮蔽判定に使う階層Zの用意
+    void SortOpaqueDraws(); // 遮蔽されていない不透明メッシュを手前から順に並べる
+    bool IsGpuCullingActive() const; // 今フレームをGPUカリングで描画するか？
+    void SyncGpuCulling();   // メッシュをGPUカリングのオブジェクトに同期し、まとまりを作成
+    void CullOnGpu();        // GPUカリングの実行（検証時はCPUの参照実装と比較）
+    bool IsMultiDrawActive() const; // 今フレームを間接描画でまとめて描画するか？
+    void BuildMultiDraws();  // 不透明メッシュの間接描画の命令を作成、転送
+    void DrawMultiDrawBatches(bool isGBuffer); // シェーダ、テクスチャごとにまとめて描画
+    void DrawOpaqueDraws(bool isGBuffer); // 不透明メッシュの描画（階層Zが無い場合は条件付き描画）
+    void DrawDepthPrePass(); // 深度のみ描画
+    void DrawSkinnedDepth(); // スキンを持つメッシュの深度のみ描画（まとめて描画する場合）
+    void DrawShadows();      // 平行光源のシャドウマップ描画
+    void BeginOverdrawQuery(); // カラーパスで描画された画素数の計測
+    void EndOverdrawQuery();
+    std::string GetProfileLabel() const; // 計測結果の出力名（描画方式、プリパス有無）
+    void LogProfileStats();              // CPU、GPUの計測結果を出力してリセット
+
+    // キャッシュから呼ばれる読込処理
+    class Texture* LoadTexture(const std::string& filePath);
+    class Mesh* LoadMesh(const std::string& filePath);
+    class Shader* LoadShader(unsigned int features);
+    ResourceId GetShaderId(unsigned int features); // 機能フラグのID（初回のみインターン）
 
     class Game* mGame;
+    class TextureStreamer* mTextureStreamer; // テクスチャストリーミング
+    class ProgramBinaryCache* mProgramBinaryCache; // シェーダバイナリキャッシュ
+    class ShaderWatcher* mShaderWatcher;           // シェーダファイル監視（ホットリロード）
+    class ClusteredLighting* mClusteredLighting;   // 点光源、スポットライトのクラスタ割当
+    class DeferredShading* mDeferredShading;       // ディファード描画用Gバッファ、ライトボリューム
+    class Profiler* mProfiler;                     // 描画ステージの計測
+    class GpuProfiler* mGpuProfiler;               // 描画パスごとのGPU時間の計測
+    class OcclusionCulling* mOcclusionCulling;     // 遮蔽されたメッシュの除外
+    class CascadedShadowMap* mShadowMap;           // 平行光源の影
+    class FrameGraph* mFrameGraph;                 // 描画パスの構成、一時テクスチャの割り当て
+    class PostProcess* mPostProcess;               // ブルーム、トーンマップ、FXAA（無ければ直接画面に描画）
+    class DynamicResolution* mDynamicResolution;   // GPU時間に応じた内部解像度
+    class GeometryPool* mGeometryPool;             // 全メッシュの頂点、インデックスの共有バッファ
+    class GpuCulling* mGpuCulling;                 // コンピュートシェーダによるカリング、間接描画の命令の作成
+    class Skinning* mSkinning;                     // スキンを持つメッシュのポーズ評価、ボーン行列パレット
+    int mRenderWidth;                              // 今フレームの内部解像度（ポストプロセスで画面の大きさに拡大）
+    int mRenderHeight;
+    std::vector<OcclusionCulling::Occluder> mOccluders; // 今フレームの遮蔽物（容量を使い回す）
+    RenderPath mRenderPath;                        // 描画方式
+    bool mIsDepthPrePass;                          // フォワード描画で深度プリパスを行うか？
+    class Shader* mDepthOnlyShader;                // 深度プリパス用シェーダ
+    class Shader* mDepthOnlyInstancedShader;       // 深度プリパス用シェーダ（ワールド行列を頂点属性から取得）
+    class Shader* mDepthOnlySkinnedShader;         // 深度プリパス、影用シェーダ（スキニング）
+    bool mIsMultiDraw;                             // 不透明メッシュを間接描画でまとめて描画するか？
+    bool mIsGpuCulling;                            // GPUカリングを使うか？
+    bool mIsGpuCullingValidation;                  // GPUカリングの結果をCPUの参照実装と比較するか？
+    int mGpuCullingMismatchCount;                  // 比較で不一致だったオブジェクト数（累計）
+    unsigned int mOverdrawQueries[2];              // 描画画素数のクエリ（前フレームの結果を読むため2つ）
+    int mOverdrawQueryIndex;                       // 今フレームで使うクエリ
+    bool mIsOverdrawQueryIssued[2];                // クエリを発行済か？
     SDL_Window* mWindow;    // SDLウィンドウ
     SDL_GLContext mContext; // SDLコンテキスト
 
@@ -47,9 +143,40 @@ private:
 
     std::vector<class SpriteComponent*> mSpriteComps; // アクタのスプライトリスト
     std::vector<class MeshComponent*> mMeshComps;     // アクタのメッシュリスト
-    std::unordered_map<std::string, class Texture*> mCachedTextures; // キャッシュ済テクスチャリスト
-    std::unordered_map<std::string, class Mesh*> mCachedMeshes;      // キャッシュ済メッシュリスト
-    std::unordered_map<Shader::ShaderType, class Shader*> mCachedShaders; // キャッシュ済シェーダリスト
+    // 不透明メッシュの描画順（ビュー空間の奥行きでソート）
+    struct OpaqueDraw
+    {
+        float depth;
+        class MeshComponent* mesh;
+    };
+    std::vector<OpaqueDraw> mOpaqueDraws;
+    // 間接描画のまとまり（同じシェーダ、テクスチャの命令の範囲）
+    // *命令の先頭mDepthDrawCount個は深度プリパス用（手前から順）、以降がまとまりごとに並ぶ
+    // *GPUカリングではGpuCullingのまとまりの番号順（firstは命令の領域の先頭、countはオブジェクト数）
+    struct MultiDrawBatch
+    {
+        unsigned int features; // メッシュのシェーダの機能フラグ
+        class Texture* texture;
+        int first;
+        int count;
+    };
+    std::vector<MultiDrawBatch> mMultiDrawBatches;
+    // カラーパスの命令の元（描画の番号とサブメッシュの番号）
+    struct MultiDrawItem
+    {
+        int draw;
+        int subMesh;
+    };
+    std::vector<MultiDrawItem> mMultiDrawOrder;              // まとまり順に並べたサブメッシュ（容量を使い回す）
+    std::unordered_map<unsigned int, class Shader*> mInstancedShaders; // 機能フラグ -> インスタンス描画版
+    int mDepthDrawCount;
+    int mMultiDrawCalls;                                     // 今フレームの間接描画の回数
+    std::vector<class LightComponent*> mLightComps;   // アクタの光源リスト
+    std::vector<ClusteredLighting::Light> mLights;    // 今フレームの光源（容量を使い回す）
+    ResourceCache<class Texture>* mTextureCache; // テクスチャキャッシュ
+    ResourceCache<class Mesh>* mMeshCache;       // メッシュキャッシュ
+    ResourceCache<class Shader>* mShaderCache;   // シェーダキャッシュ（キーは機能フラグ）
+    std::vector<ResourceId> mShaderIds;          // 機能フラグ -> シェーダのID（未インターンはINVALID_RESOURCE_ID）
 
 public:
     void SetViewMatrix(const Matrix4& view) { mViewMatrix = view; }
@@ -58,9 +185,42 @@ public:
     const Matrix4& GetProjectionMatrix() const { return mProjectionMatrix; }
 
     class Camera* GetCamera() const { return mCamera; }
+    class TextureStreamer* GetTextureStreamer() const { return mTextureStreamer; }
+    class ProgramBinaryCache* GetProgramBinaryCache() const { return mProgramBinaryCache; }
+    class ShaderWatcher* GetShaderWatcher() const { return mShaderWatcher; }
+    class ClusteredLighting* GetClusteredLighting() const { return mClusteredLighting; }
+    class DeferredShading* GetDeferredShading() const { return mDeferredShading; }
+    class Profiler* GetProfiler() const { return mProfiler; }
+    class GpuProfiler* GetGpuProfiler() const { return mGpuProfiler; }
+    class OcclusionCulling* GetOcclusionCulling() const { return mOcclusionCulling; }
+    class CascadedShadowMap* GetShadowMap() const { return mShadowMap; }
+    class FrameGraph* GetFrameGraph() const { return mFrameGraph; }
+    class PostProcess* GetPostProcess() const { return mPostProcess; }
+    class DynamicResolution* GetDynamicResolution() const { return mDynamicResolution; }
+    class GeometryPool* GetGeometryPool() const { return mGeometryPool; }
+    bool IsMultiDraw() const { return mIsMultiDraw; }
+    class GpuCulling* GetGpuCulling() const { return mGpuCulling; }
+    bool IsGpuCulling() const { return mIsGpuCulling; }
+    int GetGpuCullingMismatchCount() const { return mGpuCullingMismatchCount; }
+    class Skinning* GetSkinning() const { return mSkinning; }
+    class Shader* GetDepthOnlySkinnedShader() const { return mDepthOnlySkinnedShader; }
+    int GetRenderWidth() const { return mRenderWidth; }
+    int GetRenderHeight() const { return mRenderHeight; }
+    RenderPath GetRenderPath() const { return mRenderPath; }
+    bool IsDepthPrePass() const { return mIsDepthPrePass; }
+    ResourceCache<class Texture>* GetTextureCache() const { return mTextureCache; }
+    ResourceCache<class Mesh>* GetMeshCache() const { return mMeshCache; }
+    ResourceCache<class Shader>* GetShaderCache() const { return mShaderCache; }
     const Vector3& GetAmbientLight() const { return mAmbientLight; }
     const Vector3& GetDirLightDirection() const { return mDirLightDirection; }
     const Vector3& GetDirLightDiffuseColor() const { return mDirLightDiffuseColor; }
     const Vector3& GetDirLightSpecColor() const { return mDirLightSpecColor; }
 
+    // 光源用テクスチャバッファのユニット（0はマテリアルのテクスチャ）
+    static const int LIGHT_TEXTURE_UNIT = 1;
+    // シャドウマップのユニット（1〜3は光源用、4〜6はGバッファ）
+    static const int SHADOW_TEXTURE_UNIT = 7;
+    // ボーン行列パレットのユニット
+    static const int SKIN_TEXTURE_UNIT = 8;
+
 };
@@ -0,0 +1,262 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// リソースID（インターン済パスの番号）
+typedef unsigned int ResourceId;
+const ResourceId INVALID_RESOURCE_ID = 0xFFFFFFFF;
+
+// リソースキャッシュクラス
+// *パスをIDにインターンし、ID -> リソースを配列で引く（毎回の文字列ハッシュを避ける）
+// *参照カウントが0になったリソースは予算を超えた時に最近使われていない順で破棄する（LRU）
+template <class T>
+class ResourceCache
+{
+public:
+    typedef std::function<T*(const std::string&)> LoadFunc; // 読込処理（失敗時nullptr）
+    typedef std::function<void(T*)> UnloadFunc;              // 破棄処理
+    typedef std::function<size_t(const T*)> SizeFunc;        // メモリ使用量
+
+    // 使用状況
+    struct Stats
+    {
+        int loadedCount;     // 読込済のリソース数
+        int referencedCount; // 参照中のリソース数
+        size_t bytes;        // 読込済リソースの合計バイト数
+        size_t budgetBytes;  // 予算
+        int loadCount;       // 読込回数（累計）
+        int evictionCount;   // 破棄回数（累計）
+    };
+
+    ResourceCache(LoadFunc load, UnloadFunc unload, SizeFunc size, size_t budgetBytes)
+    :mLoad(load)
+    ,mUnload(unload)
+    ,mSize(size)
+    ,mBudgetBytes(budgetBytes)
+    ,mBytes(0)
+    ,mClock(0)
+    ,mLoadCount(0)
+    ,mEvictionCount(0)
+    {}
+
+    ~ResourceCache()
+    {
+        Clear();
+    }
+
+    // パスをIDに変換（初回のみ登録）
+    ResourceId Intern(const std::string& path)
+    {
+        auto iter = mIds.find(path);
+        if (iter != mIds.end()) return iter->second;
+
+        ResourceId id = static_cast<ResourceId>(mSlots.size());
+        Slot slot;
+        slot.path = path;
+        slot.resource = nullptr;
+        slot.refCount = 0;
+        slot.bytes = 0;
+        slot.lastUsed = 0;
+        mSlots.emplace_back(slot);
+        mIds.emplace(path, id);
+        return id;
+    }
+
+    // リソース取得（未読込なら読み込む）
+    T* Get(ResourceId id)
+    {
+        if (id >= mSlots.size()) return nullptr;
+        Slot& slot = mSlots[id];
+        slot.lastUsed = ++mClock;
+        if (slot.resource) return slot.resource;
+
+        slot.resource = mLoad(slot.path);
+        if (!slot.resource) return nullptr;
+        slot.bytes = mSize(slot.resource);
+        mBytes += slot.bytes;
+        mResourceIds.emplace(slot.resource, id);
+        mLoadCount++;
+        return slot.resource;
+    }
+    T* Get(const std::string& path)
+    {
+        return Get(Intern(path));
+    }
+
+    // 読込済のリソースを登録（まとめて先読みした場合など）
+    void Add(const std::string& path, T* resource)
+    {
+        Add(Intern(path), resource);
+    }
+    void Add(ResourceId id, T* resource)
+    {
+        if (id >= mSlots.size()) return;
+        Slot& slot = mSlots[id];
+        if (slot.resource) return;
+        slot.resource = resource;
+        slot.bytes = mSize(resource);
+        slot.lastUsed = ++mClock;
+        mBytes += slot.bytes;
+        mResourceIds.emplace(resource, id);
+        mLoadCount++;
+    }
+
+    // 読込済か？（読み込まない）
+    bool IsLoaded(const std::string& path) const
+    {
+        auto iter = mIds.find(path);
+        return iter != mIds.end() && mSlots[iter->second].resource;
+    }
+    // 読込済のリソースのパス（キャッシュに無ければ空）
+    std::string GetPath(const T* resource) const
+    {
+        auto iter = mResourceIds.find(resource);
+        return iter != mResourceIds.end() ? mSlots[iter->second].path : std::string();
+    }
+
+    // 読込済のリソースのパス（IDから）
+    std::string GetPath(ResourceId id) const
+    {
+        return id < mSlots.size() ? mSlots[id].path : std::string();
+    }
+
+    // 参照カウントの増減（IDで、コンポーネントはこちらを使う）
+    void AddRef(ResourceId id)
+    {
+        if (id >= mSlots.size() || !mSlots[id].resource) return;
+        mSlots[id].refCount++;
+    }
+    void Release(ResourceId id)
+    {
+        if (id >= mSlots.size() || !mSlots[id].resource) return;
+        Slot& slot = mSlots[id];
+        if (slot.refCount > 0) slot.refCount--;
+        slot.lastUsed = ++mClock;
+    }
+    // 参照カウントの増減（リソースから）
+    void AddRef(const T* resource)
+    {
+        auto iter = mResourceIds.find(resource);
+        if (iter == mResourceIds.end()) return;
+        mSlots[iter->second].refCount++;
+    }
+    void Release(const T* resource)
+    {
+        auto iter = mResourceIds.find(resource);
+        if (iter == mResourceIds.end()) return;
+        Slot& slot = mSlots[iter->second];
+        if (slot.refCount > 0) slot.refCount--;
+        slot.lastUsed = ++mClock;
+    }
+
+    // 予算を超えている場合、参照されていないリソースを破棄する
+    void Trim()
+    {
+        TrimTo(mBudgetBytes, false);
+    }
+    // 参照されていないリソースを全て破棄する（シーン切替時など）
+    void UnloadUnused()
+    {
+        TrimTo(0, true);
+    }
+
+    // 全てのリソースを破棄する
+    void Clear()
+    {
+        for (auto& slot : mSlots)
+        {
+            if (!slot.resource) continue;
+            mUnload(slot.resource);
+            slot.resource = nullptr;
+            slot.refCount = 0;
+            slot.bytes = 0;
+        }
+        mResourceIds.clear();
+        mBytes = 0;
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats = {};
+        for (const auto& slot : mSlots)
+        {
+            if (!slot.resource) continue;
+            stats.loadedCount++;
+            if (slot.refCount > 0) stats.referencedCount++;
+        }
+        stats.bytes = mBytes;
+        stats.budgetBytes = mBudgetBytes;
+        stats.loadCount = mLoadCount;
+        stats.evictionCount = mEvictionCount;
+        return stats;
+    }
+
+    // 読込済のリソースを列挙（パス、リソース、参照カウント）
+    template <class F>
+    void ForEachLoaded(F func) const
+    {
+        for (const auto& slot : mSlots)
+        {
+            if (slot.resource) func(slot.path, slot.resource, slot.refCount);
+        }
+    }
+
+    void SetBudgetBytes(size_t bytes) { mBudgetBytes = bytes; }
+    size_t GetBudgetBytes() const { return mBudgetBytes; }
+    size_t GetBytes() const { return mBytes; }
+
+private:
+    struct Slot
+    {
+        std::string path;   // インターン元のパス
+        T* resource;        // 読込済リソース（未読込ならnullptr）
+        int refCount;       // 参照カウント
+        size_t bytes;       // 読込時のメモリ使用量
+        uint32_t lastUsed;  // 最後に使われた時刻（LRU用）
+    };
+
+    void TrimTo(size_t budgetBytes, bool unloadAll)
+    {
+        if (!unloadAll && mBytes <= budgetBytes) return;
+
+        // 参照されていないリソースを古い順に並べる
+        std::vector<ResourceId> candidates;
+        for (ResourceId id = 0; id < mSlots.size(); id++)
+        {
+            if (mSlots[id].resource && mSlots[id].refCount == 0) candidates.emplace_back(id);
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](ResourceId a, ResourceId b) {
+            return mSlots[a].lastUsed < mSlots[b].lastUsed;
+        });
+
+        for (auto id : candidates)
+        {
+            if (!unloadAll && mBytes <= budgetBytes) break;
+            Slot& slot = mSlots[id];
+            mResourceIds.erase(slot.resource);
+            mUnload(slot.resource);
+            slot.resource = nullptr;
+            mBytes -= slot.bytes;
+            slot.bytes = 0;
+            mEvictionCount++;
+        }
+    }
+
+    LoadFunc mLoad;
+    UnloadFunc mUnload;
+    SizeFunc mSize;
+
+    std::vector<Slot> mSlots;                                // ID -> リソース
+    std::unordered_map<std::string, ResourceId> mIds;        // パス -> ID（インターン）
+    std::unordered_map<const T*, ResourceId> mResourceIds;   // リソース -> ID（参照カウント用）
+    size_t mBudgetBytes;
+    size_t mBytes;
+    uint32_t mClock;
+    int mLoadCount;
+    int mEvictionCount;
+
+};
@@ -0,0 +1,523 @@
+#include "SceneFile.h"
+#include <SDL.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <typeinfo>
+#include "FileSystem.h"
+#include "Renderer.h"
+#include "SceneGraph.h"
+#include "Mesh.h"
+#include "Texture.h"
+#include "../Game.h"
+#include "../Actors/Actor.h"
+#include "../Actors/Saikoro.h"
+#include "../Components/MeshComponent.h"
+#include "../Components/SkinnedMeshComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/LightComponent.h"
+
+namespace
+{
+    // ファイルのヘッダ
+    // *ヘッダの後にリソース、アクタ、コンポーネントの配列、文字列テーブルの順に並べる
+    const uint32_t SCENE_MAGIC = 0x454E4353; // "SCNE"
+    const uint32_t SCENE_VERSION = 1;
+
+    struct SceneHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t resourceCount;
+        uint32_t actorCount;
+        uint32_t componentCount;
+        uint32_t stringBytes;
+    };
+
+    const char* RESOURCE_TYPE_NAMES[] = { "texture", "mesh" };
+    const char* ACTOR_TYPE_NAMES[] = { "actor", "saikoro" };
+    const char* COMPONENT_TYPE_NAMES[] = { "mesh", "skinnedMesh", "sprite", "light" };
+    const int RESOURCE_TYPE_COUNT = 2;
+    const int ACTOR_TYPE_COUNT = 2;
+    const int COMPONENT_TYPE_COUNT = 4;
+
+    // コンポーネントの種類（対応していなければ-1）
+    int GetComponentType(const Component* component)
+    {
+        if (dynamic_cast<const SkinnedMeshComponent*>(component)) return SceneFile::COMPONENT_SKINNED_MESH;
+        if (dynamic_cast<const MeshComponent*>(component)) return SceneFile::COMPONENT_MESH;
+        if (dynamic_cast<const SpriteComponent*>(component)) return SceneFile::COMPONENT_SPRITE;
+        if (dynamic_cast<const LightComponent*>(component)) return SceneFile::COMPONENT_LIGHT;
+        return -1;
+    }
+
+    float GetElapsedMs(Uint64 startCounter, Uint64 endCounter)
+    {
+        return (endCounter - startCounter) * 1000.0f / SDL_GetPerformanceFrequency();
+    }
+}
+
+SceneFile::SceneFile()
+:mStats()
+{}
+
+SceneFile::~SceneFile()
+{}
+
+void SceneFile::Clear()
+{
+    mStrings.clear();
+    mResources.clear();
+    mActors.clear();
+    mComponents.clear();
+    mResourceIndices.clear();
+    mStats = Stats();
+}
+
+// ファイルの読込
+// *ファイル全体を1回で読み、ヘッダの数から各配列にコピーする
+bool SceneFile::Load(const std::string& filePath, const FileSystem* fileSystem)
+{
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    Clear();
+    FileSystem::File file;
+    if (fileSystem ? !fileSystem->ReadFile(filePath, file) : !FileSystem::ReadLooseFile(filePath, file))
+    {
+        return false;
+    }
+    const size_t bytes = file.GetSize();
+    const unsigned char* data = file.GetData();
+
+    SceneHeader header;
+    bool isValid = bytes >= sizeof(header);
+    if (isValid)
+    {
+        std::memcpy(&header, data, sizeof(header));
+        const uint64_t expectedBytes = sizeof(header)
+            + static_cast<uint64_t>(header.resourceCount) * sizeof(ResourceRecord)
+            + static_cast<uint64_t>(header.actorCount) * sizeof(ActorRecord)
+            + static_cast<uint64_t>(header.componentCount) * sizeof(ComponentRecord)
+            + header.stringBytes;
+        isValid = header.magic == SCENE_MAGIC && header.version == SCENE_VERSION && expectedBytes == bytes;
+    }
+    if (!isValid)
+    {
+        SDL_Log("Invalid scene file. (%s)", filePath.c_str());
+        return false;
+    }
+
+    const unsigned char* cursor = data + sizeof(header);
+    mResources.resize(header.resourceCount);
+    std::memcpy(mResources.data(), cursor, mResources.size() * sizeof(ResourceRecord));
+    cursor += mResources.size() * sizeof(ResourceRecord);
+    mActors.resize(header.actorCount);
+    std::memcpy(mActors.data(), cursor, mActors.size() * sizeof(ActorRecord));
+    cursor += mActors.size() * sizeof(ActorRecord);
+    mComponents.resize(header.componentCount);
+    std::memcpy(mComponents.data(), cursor, mComponents.size() * sizeof(ComponentRecord));
+    cursor += mComponents.size() * sizeof(ComponentRecord);
+    mStrings.assign(cursor, cursor + header.stringBytes);
+
+    if (!Validate())
+    {
+        SDL_Log("Broken scene file. (%s)", filePath.c_str());
+        Clear();
+        return false;
+    }
+    mStats.bytes = bytes;
+    mStats.readMs = GetElapsedMs(startCounter, SDL_GetPerformanceCounter());
+    return true;
+}
+
+bool SceneFile::Save(const std::string& filePath) const
+{
+    SceneHeader header;
+    header.magic = SCENE_MAGIC;
+    header.version = SCENE_VERSION;
+    header.resourceCount = static_cast<uint32_t>(mResources.size());
+    header.actorCount = static_cast<uint32_t>(mActors.size());
+    header.componentCount = static_cast<uint32_t>(mComponents.size());
+    header.stringBytes = static_cast<uint32_t>(mStrings.size());
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        SDL_Log("Failed open scene file for write. (%s)", filePath.c_str());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(mResources.data()), mResources.size() * sizeof(ResourceRecord));
+    file.write(reinterpret_cast<const char*>(mActors.data()), mActors.size() * sizeof(ActorRecord));
+    file.write(reinterpret_cast<const char*>(mComponents.data()), mComponents.size() * sizeof(ComponentRecord));
+    file.write(mStrings.data(), mStrings.size());
+    return static_cast<bool>(file);
+}
+
+// テキストでの書出し（差分の確認用）
+bool SceneFile::ExportText(const std::string& filePath) const
+{
+    FILE* file = fopen(filePath.c_str(), "w");
+    if (!file)
+    {
+        SDL_Log("Failed open scene text for write. (%s)", filePath.c_str());
+        return false;
+    }
+    fprintf(file, "scene version %u\n", SCENE_VERSION);
+    fprintf(file, "resources %d\n", GetResourceCount());
+    for (size_t i = 0; i < mResources.size(); i++)
+    {
+        fprintf(file, "  %d %s \"%s\"\n", static_cast<int>(i), RESOURCE_TYPE_NAMES[mResources[i].type],
+                GetString(mResources[i].pathOffset));
+    }
+    fprintf(file, "actors %d\n", GetActorCount());
+    for (size_t i = 0; i < mActors.size(); i++)
+    {
+        const ActorRecord& actor = mActors[i];
+        fprintf(file, "  %d %s parent %d position (%g %g %g) rotation (%g %g %g %g) scale (%g %g %g)\n",
+                static_cast<int>(i), ACTOR_TYPE_NAMES[actor.type], actor.parent,
+                actor.position[0], actor.position[1], actor.position[2],
+                actor.rotation[0], actor.rotation[1], actor.rotation[2], actor.rotation[3],
+                actor.scale[0], actor.scale[1], actor.scale[2]);
+        for (uint32_t c = actor.firstComponent; c < actor.firstComponent + actor.componentCount; c++)
+        {
+            const ComponentRecord& component = mComponents[c];
+            fprintf(file, "    %s resource %d", COMPONENT_TYPE_NAMES[component.type], component.resource);
+            if (component.flags & FLAG_SHADER)
+            {
+                fprintf(file, " shader %s", Shader::GetVariantName(component.shaderFeatures).c_str());
+            }
+            switch (component.type)
+            {
+                case COMPONENT_MESH:
+                    fprintf(file, " occluder %d", (component.flags & FLAG_OCCLUDER) ? 1 : 0);
+                    break;
+                case COMPONENT_SKINNED_MESH:
+                    fprintf(file, " clip %d loop %d time %g rate %g", component.intParam,
+                            (component.flags & FLAG_LOOP) ? 1 : 0, component.params[0], component.params[1]);
+                    break;
+                case COMPONENT_SPRITE:
+                    fprintf(file, " drawOrder %d", component.intParam);
+                    break;
+                case COMPONENT_LIGHT:
+                    fprintf(file, " type %d color (%g %g %g) radius %g angles (%g %g)", component.intParam,
+                            component.params[0], component.params[1], component.params[2],
+                            component.params[3], component.params[4], component.params[5]);
+                    break;
+                default:
+                    break;
+            }
+            fprintf(file, "\n");
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// 現在のシーンから作成
+// *親の無いアクタから順に子を深さ優先でたどる（親が子より前に並ぶ）
+void SceneFile::Capture(Game* game)
+{
+    Clear();
+    for (auto actor : game->GetActors())
+    {
+        if (!actor->GetParent()) CaptureActor(game, actor, -1);
+    }
+    mResourceIndices.clear();
+}
+
+// シーンの生成
+// *リソースを全て読み込んでから、配列を確保してアクタを作成する
+//  （作成中にファイルの読込が挟まらず、配列の再確保も起きない）
+bool SceneFile::Instantiate(Game* game)
+{
+    Renderer* renderer = game->GetRenderer();
+    const std::string assetsPath = game->GetAssetsPath();
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+
+    // テクスチャを先に並列に読み込み、メッシュのマテリアルはキャッシュから取得させる
+    std::vector<std::string> texturePaths;
+    for (const auto& resource : mResources)
+    {
+        if (resource.type == RESOURCE_TEXTURE) texturePaths.emplace_back(assetsPath + GetString(resource.pathOffset));
+    }
+    mStats.textureCount = renderer->PrefetchTextures(texturePaths);
+    // パスはここで一度だけIDにし、コンポーネントにはIDで設定する
+    std::vector<ResourceId> resourceIds(mResources.size(), INVALID_RESOURCE_ID);
+    for (size_t i = 0; i < mResources.size(); i++)
+    {
+        const std::string path = assetsPath + GetString(mResources[i].pathOffset);
+        if (mResources[i].type == RESOURCE_TEXTURE)
+        {
+            resourceIds[i] = renderer->InternTexture(path);
+            renderer->GetTexture(resourceIds[i]);
+        }
+        else
+        {
+            resourceIds[i] = renderer->InternMesh(path);
+            renderer->GetMesh(resourceIds[i]);
+        }
+    }
+    Uint64 prefetchCounter = SDL_GetPerformanceCounter();
+
+    // 配列の確保
+    int componentCounts[COMPONENT_TYPE_COUNT] = {};
+    for (const auto& component : mComponents) componentCounts[component.type]++;
+    game->ReserveActors(GetActorCount());
+    game->GetSceneGraph()->Reserve(GetActorCount());
+    renderer->ReserveComponents(componentCounts[COMPONENT_SPRITE],
+                                componentCounts[COMPONENT_MESH] + componentCounts[COMPONENT_SKINNED_MESH],
+                                componentCounts[COMPONENT_LIGHT]);
+
+    // アクタ、コンポーネントの作成
+    std::vector<Actor*> actors(mActors.size(), nullptr);
+    std::vector<Component*> spares; // コンストラクタが作成した、まだ設定していないコンポーネント
+    for (size_t i = 0; i < mActors.size(); i++)
+    {
+        const ActorRecord& record = mActors[i];
+        Actor* actor = record.type == ACTOR_SAIKORO ? new Saikoro(game) : new Actor(game);
+        actors[i] = actor;
+        if (record.parent >= 0) actor->SetParent(actors[record.parent]);
+        actor->SetPosition(Vector3(record.position[0], record.position[1], record.position[2]));
+        actor->SetRotation(Quaternion(record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3]));
+        actor->SetScale(Vector3(record.scale[0], record.scale[1], record.scale[2]));
+
+        spares = actor->GetComponents();
+        for (uint32_t c = record.firstComponent; c < record.firstComponent + record.componentCount; c++)
+        {
+            const ComponentRecord& component = mComponents[c];
+            Component* target = nullptr;
+            for (auto iter = spares.begin(); iter != spares.end(); ++iter)
+            {
+                if (GetComponentType(*iter) != static_cast<int>(component.type)) continue;
+                target = *iter;
+                spares.erase(iter);
+                break;
+            }
+
+            switch (component.type)
+            {
+                case COMPONENT_MESH:
+                case COMPONENT_SKINNED_MESH:
+                {
+                    MeshComponent* mesh = static_cast<MeshComponent*>(target);
+                    SkinnedMeshComponent* skinned = nullptr;
+                    if (component.type == COMPONENT_SKINNED_MESH)
+                    {
+                        skinned = target ? static_cast<SkinnedMeshComponent*>(target) : new SkinnedMeshComponent(actor);
+                        mesh = skinned;
+                    }
+                    else if (!mesh)
+                    {
+                        mesh = new MeshComponent(actor);
+                    }
+                    if (component.resource >= 0) mesh->SetMesh(resourceIds[component.resource]);
+                    if (component.flags & FLAG_SHADER) mesh->SetShader(renderer->GetShader(component.shaderFeatures));
+                    mesh->SetOccluder((component.flags & FLAG_OCCLUDER) != 0);
+                    if (skinned)
+                    {
+                        if (component.intParam >= 0) skinned->Play(component.intParam, (component.flags & FLAG_LOOP) != 0);
+                        skinned->SetTime(component.params[0]);
+                        skinned->SetPlayRate(component.params[1]);
+                    }
+                    break;
+                }
+                case COMPONENT_SPRITE:
+                {
+                    SpriteComponent* sprite = target ? static_cast<SpriteComponent*>(target)
+                                                     : new SpriteComponent(actor, component.intParam);
+                    if (component.resource >= 0) sprite->SetTexture(resourceIds[component.resource]);
+                    break;
+                }
+                case COMPONENT_LIGHT:
+                {
+                    LightComponent* light = target ? static_cast<LightComponent*>(target)
+                        : new LightComponent(actor, static_cast<ClusteredLighting::LightType>(component.intParam));
+                    light->SetColor(Vector3(component.params[0], component.params[1], component.params[2]));
+                    light->SetRadius(component.params[3]);
+                    light->SetSpotAngles(component.params[4], component.params[5]);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+    Uint64 endCounter = SDL_GetPerformanceCounter();
+    mStats.prefetchMs = GetElapsedMs(startCounter, prefetchCounter);
+    mStats.createMs = GetElapsedMs(prefetchCounter, endCounter);
+    SDL_Log("scene: %d actors, %d components, %d resources (%d textures prefetched), %.2f KB, "
+            "read %.2f ms, prefetch %.2f ms, create %.2f ms",
+            GetActorCount(), GetComponentCount(), GetResourceCount(), mStats.textureCount,
+            mStats.bytes / 1024.0f, mStats.readMs, mStats.prefetchMs, mStats.createMs);
+    return true;
+}
+
+uint32_t SceneFile::AddString(const std::string& str)
+{
+    uint32_t offset = static_cast<uint32_t>(mStrings.size());
+    mStrings.insert(mStrings.end(), str.begin(), str.end());
+    mStrings.emplace_back('\0');
+    return offset;
+}
+
+// リソースの追加（同じパスは1つにまとめる、アセットパスは取り除く）
+int SceneFile::AddResource(ResourceType type, const std::string& path)
+{
+    auto iter = mResourceIndices.find(path);
+    if (iter != mResourceIndices.end()) return iter->second;
+
+    ResourceRecord record;
+    record.type = type;
+    record.pathOffset = AddString(path);
+    int index = static_cast<int>(mResources.size());
+    mResources.emplace_back(record);
+    mResourceIndices.emplace(path, index);
+    return index;
+}
+
+void SceneFile::CaptureActor(Game* game, Actor* actor, int parent)
+{
+    // 派生クラスは生成できるものだけ（カメラなどは子も含めて除く）
+    ActorRecord record = {};
+    if (typeid(*actor) == typeid(Saikoro)) record.type = ACTOR_SAIKORO;
+    else if (typeid(*actor) == typeid(Actor)) record.type = ACTOR_GENERIC;
+    else return;
+    if (actor->GetState() == Actor::EDead) return;
+
+    record.parent = parent;
+    const Vector3& position = actor->GetPosition();
+    const Quaternion& rotation = actor->GetRotation();
+    const Vector3& scale = actor->GetScale();
+    record.position[0] = position.x;
+    record.position[1] = position.y;
+    record.position[2] = position.z;
+    record.rotation[0] = rotation.x;
+    record.rotation[1] = rotation.y;
+    record.rotation[2] = rotation.z;
+    record.rotation[3] = rotation.w;
+    record.scale[0] = scale.x;
+    record.scale[1] = scale.y;
+    record.scale[2] = scale.z;
+    record.firstComponent = static_cast<uint32_t>(mComponents.size());
+    for (auto component : actor->GetComponents())
+    {
+        ComponentRecord componentRecord = {};
+        if (CaptureComponent(game, component, componentRecord)) mComponents.emplace_back(componentRecord);
+    }
+    record.componentCount = static_cast<uint32_t>(mComponents.size()) - record.firstComponent;
+
+    int index = static_cast<int>(mActors.size());
+    mActors.emplace_back(record);
+    for (auto child : actor->GetChildren())
+    {
+        CaptureActor(game, child, index);
+    }
+}
+
+bool SceneFile::CaptureComponent(Game* game, Component* component, ComponentRecord& outRecord)
+{
+    const int type = GetComponentType(component);
+    if (type < 0) return false;
+
+    Renderer* renderer = game->GetRenderer();
+    const std::string assetsPath = game->GetAssetsPath();
+    // キャッシュのパスからアセットパスを取り除く（キャッシュに無ければ空）
+    auto toRelative = [&assetsPath](const std::string& path) {
+        return path.compare(0, assetsPath.size(), assetsPath) == 0 ? path.substr(assetsPath.size()) : path;
+    };
+
+    outRecord.type = type;
+    outRecord.resource = -1;
+    switch (type)
+    {
+        case COMPONENT_MESH:
+        case COMPONENT_SKINNED_MESH:
+        {
+            auto* mesh = static_cast<MeshComponent*>(component);
+            if (mesh->GetMesh())
+            {
+                std::string path = renderer->GetMeshCache()->GetPath(mesh->GetMeshId());
+                if (!path.empty()) outRecord.resource = AddResource(RESOURCE_MESH, toRelative(path));
+                // マテリアルのテクスチャも先読みの対象にする
+                for (const auto& material : mesh->GetMesh()->GetMaterials())
+                {
+                    if (!material.texture) continue;
+                    path = renderer->GetTextureCache()->GetPath(material.textureId);
+                    if (!path.empty()) AddResource(RESOURCE_TEXTURE, toRelative(path));
+                }
+            }
+            if (mesh->GetShader())
+            {
+                outRecord.flags |= FLAG_SHADER;
+                outRecord.shaderFeatures = mesh->GetShader()->GetFeatures();
+            }
+            if (mesh->IsOccluder()) outRecord.flags |= FLAG_OCCLUDER;
+            if (type == COMPONENT_SKINNED_MESH)
+            {
+                auto* skinned = static_cast<SkinnedMeshComponent*>(component);
+                outRecord.intParam = skinned->GetClip();
+                if (skinned->IsLoop()) outRecord.flags |= FLAG_LOOP;
+                outRecord.params[0] = skinned->GetTime();
+                outRecord.params[1] = skinned->GetPlayRate();
+            }
+            break;
+        }
+        case COMPONENT_SPRITE:
+        {
+            auto* sprite = static_cast<SpriteComponent*>(component);
+            if (sprite->GetTexture())
+            {
+                std::string path = renderer->GetTextureCache()->GetPath(sprite->GetTextureId());
+                if (!path.empty()) outRecord.resource = AddResource(RESOURCE_TEXTURE, toRelative(path));
+            }
+            outRecord.intParam = sprite->GetDrawOrder();
+            break;
+        }
+        case COMPONENT_LIGHT:
+        {
+            auto* light = static_cast<LightComponent*>(component);
+            outRecord.intParam = light->GetType();
+            outRecord.params[0] = light->GetColor().x;
+            outRecord.params[1] = light->GetColor().y;
+            outRecord.params[2] = light->GetColor().z;
+            outRecord.params[3] = light->GetRadius();
+            outRecord.params[4] = light->GetInnerAngle();
+            outRecord.params[5] = light->GetOuterAngle();
+            break;
+        }
+        default:
+            break;
+    }
+    return true;
+}
+
+// 読み込んだ内容の検証
+// *番号で配列を引くため、生成の前に範囲外の参照が無いことを確認しておく
+bool SceneFile::Validate() const
+{
+    if (!mStrings.empty() && mStrings.back() != '\0') return false;
+    for (const auto& resource : mResources)
+    {
+        if (resource.type >= RESOURCE_TYPE_COUNT || resource.pathOffset >= mStrings.size()) return false;
+    }
+    for (size_t i = 0; i < mActors.size(); i++)
+    {
+        const ActorRecord& actor = mActors[i];
+        if (actor.type >= ACTOR_TYPE_COUNT) return false;
+        if (actor.parent >= static_cast<int32_t>(i) || actor.parent < -1) return false;
+        if (static_cast<uint64_t>(actor.firstComponent) + actor.componentCount > mComponents.size()) return false;
+    }
+    for (const auto& component : mComponents)
+    {
+        if (component.type >= COMPONENT_TYPE_COUNT) return false;
+        if (component.resource < -1 || component.resource >= static_cast<int32_t>(mResources.size())) return false;
+        // 光源は種類がenumの範囲内であること
+        if (component.type == COMPONENT_LIGHT
+            && (component.intParam < 0 || component.intParam >= ClusteredLighting::LIGHT_TYPE_COUNT)) return false;
+        if (component.resource < 0) continue;
+        // メッシュはメッシュ、スプライトはテクスチャを参照する
+        const uint32_t expected = component.type == COMPONENT_SPRITE ? RESOURCE_TEXTURE : RESOURCE_MESH;
+        if (component.type == COMPONENT_LIGHT || mResources[component.resource].type != expected) return false;
+    }
+    return true;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// シーンファイルクラス
+// *アクタ（種類、親、ローカル座標）、コンポーネント、参照するリソースのパスをバイナリで読み書きする
+// *レコードは固定長の配列で、読込はファイル全体を1回で読んで配列にコピーするだけ（要素ごとの解析は無い）
+// *生成時は先に参照する全てのリソースを読み込み（テクスチャはジョブシステムで並列にデコード）、
+//  アクタ、コンポーネント、シーングラフの配列を必要数確保してからアクタを作成する
+// *アクタは親が子より前に並ぶ（親の番号は自身より前のアクタ）
+// *リソースのパスはアセットパスからの相対で持つ
+// *確認用にテキストで書き出せる（読込はバイナリのみ）
+class SceneFile
+{
+public:
+    enum ResourceType
+    {
+        RESOURCE_TEXTURE,
+        RESOURCE_MESH,
+    };
+
+    enum ActorType
+    {
+        ACTOR_GENERIC, // Actor
+        ACTOR_SAIKORO, // Saikoro（コンストラクタが作成したコンポーネントは設定を上書きして使う）
+    };
+
+    enum ComponentType
+    {
+        COMPONENT_MESH,
+        COMPONENT_SKINNED_MESH,
+        COMPONENT_SPRITE,
+        COMPONENT_LIGHT,
+    };
+
+    // コンポーネントのフラグ
+    enum ComponentFlag
+    {
+        FLAG_SHADER   = 1 << 0, // shaderFeaturesのシェーダを設定する
+        FLAG_OCCLUDER = 1 << 1, // オクルージョンカリングの遮蔽物
+        FLAG_LOOP     = 1 << 2, // アニメーションのループ再生
+    };
+
+    // 参照するリソース
+    struct ResourceRecord
+    {
+        uint32_t type;       // ResourceType
+        uint32_t pathOffset; // 文字列テーブル内の位置
+    };
+
+    // アクタ
+    struct ActorRecord
+    {
+        uint32_t type;   // ActorType
+        int32_t parent;  // 親のアクタの番号（無ければ-1）
+        float position[3];
+        float rotation[4]; // クォータニオン(x, y, z, w)
+        float scale[3];
+        uint32_t firstComponent; // 先頭のコンポーネントの番号
+        uint32_t componentCount;
+    };
+
+    // コンポーネント
+    // *intParam: スプライトは描画順、光源は種類、スキンメッシュは再生中のクリップ（-1で停止）
+    // *params: 光源は色(r, g, b)、影響半径、減衰開始角、照射角、スキンメッシュは再生時刻、再生速度
+    struct ComponentRecord
+    {
+        uint32_t type;           // ComponentType
+        int32_t resource;        // メッシュ、テクスチャのリソース番号（無ければ-1）
+        uint32_t shaderFeatures; // FLAG_SHADERの場合のシェーダの機能フラグ
+        int32_t intParam;
+        uint32_t flags;          // ComponentFlag
+        float params[6];
+    };
+
+    // 直近の読込、生成の集計
+    struct Stats
+    {
+        size_t bytes;       // ファイルのバイト数
+        float readMs;       // ファイルの読込
+        float prefetchMs;   // リソースの読込
+        float createMs;     // アクタ、コンポーネントの作成
+        int textureCount;   // 先読みで読み込んだテクスチャ数
+    };
+
+    SceneFile();
+    ~SceneFile();
+
+    // 読込（fileSystemがあればマウントしたパックからも読む）
+    bool Load(const std::string& filePath, const class FileSystem* fileSystem = nullptr);
+    bool Save(const std::string& filePath) const;
+    bool ExportText(const std::string& filePath) const;
+    void Clear();
+
+    // 現在のシーンから作成（カメラ、対応していない種類のアクタ・コンポーネントは除く）
+    void Capture(class Game* game);
+    // リソースを先読みしてからアクタを作成する
+    bool Instantiate(class Game* game);
+
+private:
+    uint32_t AddString(const std::string& str);
+    int AddResource(ResourceType type, const std::string& path);
+    void CaptureActor(class Game* game, class Actor* actor, int parent);
+    bool CaptureComponent(class Game* game, class Component* component, ComponentRecord& outRecord);
+    bool Validate() const; // 番号、文字列の位置が範囲内か？
+    const char* GetString(uint32_t offset) const { return &mStrings[offset]; }
+
+    std::vector<char> mStrings;                 // 文字列テーブル（null終端で連結）
+    std::vector<ResourceRecord> mResources;
+    std::vector<ActorRecord> mActors;
+    std::vector<ComponentRecord> mComponents;
+    std::unordered_map<std::string, int> mResourceIndices; // パス -> リソース番号（Capture時の重複除去）
+    Stats mStats;
+
+public:
+    int GetActorCount() const { return static_cast<int>(mActors.size()); }
+    int GetComponentCount() const { return static_cast<int>(mComponents.size()); }
+    int GetResourceCount() const { return static_cast<int>(mResources.size()); }
+    const Stats& GetStats() const { return mStats; }
+
+};
@@ -0,0 +1,201 @@
+#include "SceneGraph.h"
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include "JobSystem.h"
+#include "../Actors/Actor.h"
+
+SceneGraph::SceneGraph()
+:mFrame(0)
+,mIsStructureDirty(false)
+,mStats()
+{}
+
+SceneGraph::~SceneGraph()
+{}
+
+// ノードの追加
+// *親の無いノードは末尾に追加しても深さの順を崩さないため、並べ直しは親子関係の変更時のみで済む
+int SceneGraph::AddNode(Actor* actor)
+{
+    mActors.emplace_back(actor);
+    mParents.emplace_back(-1);
+    mLevels.emplace_back(0);
+    mDirtyFlags.emplace_back(1);
+    mChangedFrames.emplace_back(0);
+    mVersions.emplace_back(0);
+    mWorldTransforms.emplace_back(Matrix4::CreateScale(1.0f, 1.0f, 1.0f));
+    if (mLevelDirtyCounts.empty()) mLevelDirtyCounts.emplace_back(0);
+    mLevelDirtyCounts[0]++;
+    if (mLevelStarts.size() < 2) mLevelStarts.assign({ 0, 0 });
+    // 深さ0の範囲を広げる（深さ1以上があれば並べ直す）
+    if (mLevelStarts.size() == 2) mLevelStarts.back() = static_cast<int>(mActors.size());
+    else mIsStructureDirty = true;
+    return static_cast<int>(mActors.size()) - 1;
+}
+
+void SceneGraph::Reserve(int count)
+{
+    const size_t capacity = mActors.size() + count;
+    mActors.reserve(capacity);
+    mParents.reserve(capacity);
+    mLevels.reserve(capacity);
+    mDirtyFlags.reserve(capacity);
+    mChangedFrames.reserve(capacity);
+    mVersions.reserve(capacity);
+    mWorldTransforms.reserve(capacity);
+}
+
+void SceneGraph::RemoveNode(int node)
+{
+    if (mDirtyFlags[node]) mLevelDirtyCounts[mLevels[node]]--;
+    mActors[node] = nullptr;
+    mDirtyFlags[node] = 0;
+    mIsStructureDirty = true;
+}
+
+void SceneGraph::MarkDirty(int node)
+{
+    if (mDirtyFlags[node]) return;
+    mDirtyFlags[node] = 1;
+    mLevelDirtyCounts[mLevels[node]]++;
+}
+
+// ワールド座標の更新
+// *深さの浅い順に処理し、前の深さで再計算したノードが無く、変更フラグも無い深さは飛ばす
+void SceneGraph::Update(JobSystem* jobSystem)
+{
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    if (mIsStructureDirty) Rebuild();
+    mFrame++;
+
+    int updatedCount = 0;
+    bool isParentChanged = false;
+    const int levelCount = static_cast<int>(mLevelStarts.size()) - 1;
+    for (int level = 0; level < levelCount; level++)
+    {
+        if (mLevelDirtyCounts[level] == 0 && !isParentChanged) continue;
+        const size_t begin = mLevelStarts[level];
+        const size_t count = mLevelStarts[level + 1] - begin;
+        std::atomic<int> levelUpdated(0);
+        auto update = [this, begin, &levelUpdated](size_t rangeBegin, size_t rangeEnd) {
+            levelUpdated += UpdateRange(begin + rangeBegin, begin + rangeEnd);
+        };
+        if (jobSystem) jobSystem->ParallelFor(count, MIN_BATCH, update);
+        else update(0, count);
+        mLevelDirtyCounts[level] = 0;
+        isParentChanged = levelUpdated > 0;
+        updatedCount += levelUpdated;
+    }
+
+    mStats.nodeCount = static_cast<int>(mActors.size());
+    mStats.levelCount = levelCount;
+    mStats.updatedCount = updatedCount;
+    mStats.updateMs = (SDL_GetPerformanceCounter() - startCounter) * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
+int SceneGraph::UpdateRange(size_t begin, size_t end)
+{
+    int updated = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        const int parent = mParents[i];
+        bool isParentChanged = parent >= 0 && mChangedFrames[parent] == mFrame;
+        if (!mDirtyFlags[i] && !isParentChanged) continue;
+
+        // 親のワールド座標 * ローカル座標
+        Matrix4 local = mActors[i]->ComputeLocalTransform();
+        mWorldTransforms[i] = parent >= 0 ? mWorldTransforms[parent] * local : local;
+        mDirtyFlags[i] = 0;
+        mChangedFrames[i] = mFrame;
+        mVersions[i]++;
+        updated++;
+    }
+    return updated;
+}
+
+// 並べ直し
+// *アクタの親から深さを求め、深さごとに元の順を保って並べる（親は必ず前の深さにある）
+// *ワールド座標、再計算の回数はノードと一緒に移動し、アクタのノード番号を付け直す
+void SceneGraph::Rebuild()
+{
+    const int oldCount = static_cast<int>(mActors.size());
+    std::vector<int> depths(oldCount, -1);
+    int maxDepth = -1;
+    for (int i = 0; i < oldCount; i++)
+    {
+        if (!mActors[i]) continue;
+        // 深さの分かっている祖先まで遡る
+        int depth = 0;
+        const Actor* actor = mActors[i];
+        for (const Actor* parent = actor->GetParent(); parent; parent = parent->GetParent())
+        {
+            if (depths[parent->mSceneNode] >= 0)
+            {
+                depth += depths[parent->mSceneNode] + 1;
+                break;
+            }
+            depth++;
+        }
+        depths[i] = depth;
+        // 途中の祖先にも深さを設定しておく
+        int ancestorDepth = depth - 1;
+        for (const Actor* parent = actor->GetParent(); parent && depths[parent->mSceneNode] < 0;
+             parent = parent->GetParent())
+        {
+            depths[parent->mSceneNode] = ancestorDepth--;
+        }
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    // 深さごとの数から先頭を求める
+    const int levelCount = maxDepth + 1;
+    mLevelStarts.assign(levelCount + 1, 0);
+    for (int i = 0; i < oldCount; i++)
+    {
+        if (depths[i] >= 0) mLevelStarts[depths[i] + 1]++;
+    }
+    for (int level = 0; level < levelCount; level++) mLevelStarts[level + 1] += mLevelStarts[level];
+    std::vector<int> newIndices(oldCount, -1);
+    std::vector<int> cursors(mLevelStarts.begin(), mLevelStarts.end() - 1);
+    for (int i = 0; i < oldCount; i++)
+    {
+        if (depths[i] >= 0) newIndices[i] = cursors[depths[i]]++;
+    }
+
+    // 配列の並べ替え
+    const int newCount = levelCount > 0 ? mLevelStarts.back() : 0;
+    std::vector<Actor*> actors(newCount);
+    std::vector<int> parents(newCount);
+    std::vector<int> levels(newCount);
+    std::vector<uint8_t> dirtyFlags(newCount);
+    std::vector<uint32_t> changedFrames(newCount);
+    std::vector<unsigned int> versions(newCount);
+    std::vector<Matrix4> worldTransforms(newCount);
+    mLevelDirtyCounts.assign(std::max(levelCount, 1), 0);
+    for (int i = 0; i < oldCount; i++)
+    {
+        const int index = newIndices[i];
+        if (index < 0) continue;
+        Actor* actor = mActors[i];
+        actors[index] = actor;
+        parents[index] = actor->GetParent() ? newIndices[actor->GetParent()->mSceneNode] : -1;
+        levels[index] = depths[i];
+        dirtyFlags[index] = mDirtyFlags[i];
+        changedFrames[index] = 0;
+        versions[index] = mVersions[i];
+        worldTransforms[index] = mWorldTransforms[i];
+        if (dirtyFlags[index]) mLevelDirtyCounts[depths[i]]++;
+    }
+    for (int i = 0; i < newCount; i++) actors[i]->mSceneNode = i;
+    mActors.swap(actors);
+    mParents.swap(parents);
+    mLevels.swap(levels);
+    mDirtyFlags.swap(dirtyFlags);
+    mChangedFrames.swap(changedFrames);
+    mVersions.swap(versions);
+    mWorldTransforms.swap(worldTransforms);
+    if (levelCount == 0) mLevelStarts.assign({ 0, 0 });
+    mIsStructureDirty = false;
+    mStats.rebuildCount++;
+}
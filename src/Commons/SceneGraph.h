@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+
+// シーングラフクラス
+// *アクタの親子関係によるワールド変換座標を、深さの順（親が子より前）に並べた1つの配列で管理する
+// *座標を変更したアクタは変更フラグを立て、更新時は変更されたノードと、ワールド座標が変わった親を持つノードだけを再計算する
+// *深さごとに順に処理し、同じ深さのノードはジョブシステムで並列に計算する（親は前の深さで計算済）
+//  変更フラグの無い深さは走査しないため、何も動かないフレームは階層の深さによらず処理が無い
+// *ノードの追加・削除、親子関係の変更は次の更新の先頭でまとめて並べ直す（それまでノード番号は変わらない）
+// *変更フラグはメインスレッドからのみ立てる（アクタの更新中）
+class SceneGraph
+{
+public:
+    // 直近の更新の集計
+    struct Stats
+    {
+        int nodeCount;    // ノード数
+        int levelCount;   // 深さの数
+        int updatedCount; // ワールド座標を再計算したノード数
+        int rebuildCount; // 並べ直した回数（累計）
+        float updateMs;   // 更新の時間
+    };
+
+    SceneGraph();
+    ~SceneGraph();
+
+    int AddNode(class Actor* actor); // ノード番号を返す（ローカル座標は変更済として扱う）
+    void Reserve(int count);         // まとめて追加するノード数を先に確保する（シーンの読込時）
+    void RemoveNode(int node);
+    void MarkDirty(int node);        // ローカル座標の変更
+    void MarkStructureDirty() { mIsStructureDirty = true; } // 親子関係の変更
+
+    // 変更されたノードのワールド座標を再計算する（jobSystemがnullptrなら呼出元のスレッドのみ）
+    void Update(class JobSystem* jobSystem);
+
+private:
+    // 削除済のノードを除き、深さの順に並べ直す
+    void Rebuild();
+    // 同じ深さの範囲のノードを再計算し、再計算した数を返す
+    int UpdateRange(size_t begin, size_t end);
+
+    // ノードごとの配列（並べ直し後は深さの順）
+    std::vector<class Actor*> mActors;     // nullptrは削除済
+    std::vector<int> mParents;             // 親のノード番号（無ければ-1）
+    std::vector<int> mLevels;              // 深さ（親が無ければ0）
+    std::vector<uint8_t> mDirtyFlags;      // ローカル座標の変更フラグ
+    std::vector<uint32_t> mChangedFrames;  // ワールド座標を最後に再計算した更新の番号
+    std::vector<unsigned int> mVersions;   // ワールド座標を再計算するたびに増える（GPUへの転送の要否の判定用）
+    std::vector<Matrix4> mWorldTransforms; // ワールド変換座標
+    std::vector<int> mLevelStarts;         // 深さごとの先頭のノード番号（末尾はノード数）
+    std::vector<int> mLevelDirtyCounts;    // 深さごとの変更フラグの数
+    uint32_t mFrame;                       // 更新の番号
+    bool mIsStructureDirty;
+    Stats mStats;
+
+public:
+    const Matrix4& GetWorldTransform(int node) const { return mWorldTransforms[node]; }
+    unsigned int GetTransformVersion(int node) const { return mVersions[node]; }
+    const Stats& GetStats() const { return mStats; }
+
+    // 並列に計算する最小の件数
+    static const int MIN_BATCH = 256;
+
+};
@@ -1,45 +1,187 @@
 #include "Shader.h"
 #include <SDL.h>
-#include <fstream>
+#include <algorithm>
 #include <sstream>
 #include "../Game.h"
 #include "../Actors/Camera.h"
+#include "ProgramBinaryCache.h"
+#include "ClusteredLighting.h"
+#include "CascadedShadowMap.h"
+#include "FileSystem.h"
 
-Shader::Shader(const ShaderType type, float specPower)
-:mType(type)
+namespace
+{
+    // 共通シェーダソース
+    const char* VERT_FILE_NAME = "UberVert.glsl";
+    const char* FRAG_FILE_NAME = "UberFrag.glsl";
+
+    // 機能フラグに対応するdefine名（ビット順）
+    const char* FEATURE_DEFINES[Shader::FEATURE_COUNT] = {
+        "TEXTURE",
+        "LIGHTING_LAMBERT",
+        "LIGHTING_PHONG",
+        "INSTANCING",
+        "SKINNING",
+        "GBUFFER",
+    };
+}
+
+Shader::Shader(unsigned int features, float specPower)
+:mVertFileName(VERT_FILE_NAME)
+,mFragFileName(FRAG_FILE_NAME)
+,mFeatures(features)
+,mVertexShader(0)
+,mFragShader(0)
 ,mShaderProgram(0)
+,mBinaryCache(nullptr)
+,mBinaryKey(0)
+,mIsPending(false)
+,mSpecPower(specPower)
+{}
+
+Shader::Shader(const std::string& vertFileName, const std::string& fragFileName,
+               unsigned int features, float specPower)
+:mVertFileName(vertFileName)
+,mFragFileName(fragFileName)
+,mFeatures(features)
 ,mVertexShader(0)
 ,mFragShader(0)
+,mShaderProgram(0)
+,mBinaryCache(nullptr)
+,mBinaryKey(0)
+,mIsPending(false)
 ,mSpecPower(specPower)
 {}
 
+Shader::Shader(const std::string& compFileName)
+:mVertFileName(compFileName)
+,mFeatures(0)
+,mVertexShader(0)
+,mFragShader(0)
+,mShaderProgram(0)
+,mBinaryCache(nullptr)
+,mBinaryKey(0)
+,mIsPending(false)
+,mSpecPower(0.0f)
+{}
+
 Shader::~Shader()
 {}
 
 bool Shader::Load(Game* game)
 {
-    // コンパイルを行う
-    if (!CompileShader(game->GetShaderPath() + GetVertFileName(), GL_VERTEX_SHADER, mVertexShader)
-    || !CompileShader(game->GetShaderPath() + GetFragFileName(), GL_FRAGMENT_SHADER, mFragShader))
+    return BeginLoad(game) && FinishLoad();
+}
+
+bool Shader::BeginLoad(Game* game)
+{
+    if (!IsValidFeatures(mFeatures))
+    {
+        SDL_Log("Invalid shader features. (%s)", GetVariantName().c_str());
+        return false;
+    }
+
+    // ソースの読込（#includeの展開、#defineの挿入）
+    std::string vertSource;
+    std::string fragSource;
+    std::vector<std::string> vertIncluded;
+    std::vector<std::string> fragIncluded;
+    const FileSystem* fileSystem = game->GetFileSystem();
+    if (!ReadSource(fileSystem, game->GetShaderPath(), mVertFileName, vertIncluded, vertSource)
+    || (!IsCompute() && !ReadSource(fileSystem, game->GetShaderPath(), mFragFileName, fragIncluded, fragSource)))
     {
         return false;
     }
+    InsertDefines(vertSource);
+    if (!IsCompute()) InsertDefines(fragSource);
+
+    // キャッシュ済のプログラムバイナリがあれば復元して終了
+    mShaderProgram = glCreateProgram();
+    mBinaryCache = game->GetRenderer()->GetProgramBinaryCache();
+    if (mBinaryCache && mBinaryCache->IsSupported())
+    {
+        mBinaryKey = mBinaryCache->ComputeKey(vertSource, fragSource, GetDefines());
+        if (mBinaryCache->Load(mBinaryKey, mShaderProgram))
+        {
+            mIsPending = false;
+            return true;
+        }
+        // 保存するためにバイナリを取得可能にしておく
+        glProgramParameteri(mShaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // コンパイルを行う
+    if (IsCompute())
+    {
+        CompileShader(vertSource, GL_COMPUTE_SHADER, mVertexShader);
+        glAttachShader(mShaderProgram, mVertexShader);
+        glLinkProgram(mShaderProgram);
+        mIsPending = true;
+        return true;
+    }
+    CompileShader(vertSource, GL_VERTEX_SHADER, mVertexShader);
+    CompileShader(fragSource, GL_FRAGMENT_SHADER, mFragShader);
 
     // 頂点シェーダ、フラグメントシェーダをリンクして
     // シェーダプログラムを作成
-    mShaderProgram = glCreateProgram();
     glAttachShader(mShaderProgram, mVertexShader);
     glAttachShader(mShaderProgram, mFragShader);
     glLinkProgram(mShaderProgram);
+    mIsPending = true;
+    return true;
+}
+
+bool Shader::FinishLoad()
+{
+    if (!mIsPending) return true;
+    mIsPending = false;
 
     // 成功したかどうか？
+    if (!IsCompiled(mVertexShader) || (!IsCompute() && !IsCompiled(mFragShader)))
+    {
+        SDL_Log("Failed compile shader. (%s)", GetVariantName().c_str());
+        return false;
+    }
     if (!IsValidProgram())
     {
         return false;
     }
+
+    // 次回起動用にバイナリを保存
+    if (mBinaryCache && mBinaryCache->IsSupported())
+    {
+        mBinaryCache->Save(mBinaryKey, mShaderProgram);
+    }
     return true;
 }
 
+bool Shader::IsReady() const
+{
+    if (!mIsPending) return true;
+    // 並列コンパイル対応時は完了状態を問い合わせる（ブロックしない）
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        GLint completed = GL_FALSE;
+        glGetProgramiv(mShaderProgram, GL_COMPLETION_STATUS_KHR, &completed);
+        return completed == GL_TRUE;
+    }
+    return true;
+}
+
+Shader* Shader::Clone() const
+{
+    if (IsCompute()) return new Shader(mVertFileName);
+    return new Shader(mVertFileName, mFragFileName, mFeatures, mSpecPower);
+}
+
+void Shader::SwapProgram(Shader* other)
+{
+    std::swap(mShaderProgram, other->mShaderProgram);
+    std::swap(mVertexShader, other->mVertexShader);
+    std::swap(mFragShader, other->mFragShader);
+    std::swap(mBinaryKey, other->mBinaryKey);
+}
+
 void Shader::Unload()
 {
     glDeleteProgram(mShaderProgram);
@@ -53,34 +195,25 @@ void Shader::SetActive()
     glUseProgram(mShaderProgram);
 }
 
-bool Shader::CompileShader(const std::string& filePath, GLenum shaderType, GLuint& outShader)
+bool Shader::ReadFile(const FileSystem* fileSystem, const std::string& filePath, std::string& outContents)
 {
-    // ファイルを開く
-    std::ifstream shaderFile(filePath);
-    if (!shaderFile.is_open())
+    // 全てのテキストを１つの文字列に読み込む（シェーダパックがあればパックから）
+    if (!fileSystem->ReadText(filePath, outContents))
     {
         SDL_Log("Failed open shader.");
         return false;
     }
+    return true;
+}
 
-    // 全てのテキストを１つの文字列に読み込む
-    std::stringstream stream;
-    stream << shaderFile.rdbuf();
-    std::string contents = stream.str();
-    const char* contentsChar = contents.c_str();
+void Shader::CompileShader(const std::string& source, GLenum shaderType, GLuint& outShader)
+{
+    const char* contentsChar = source.c_str();
 
     // 指定されたタイプのシェーダを作成
     outShader = glCreateShader(shaderType);
     glShaderSource(outShader, 1, &(contentsChar), nullptr);
     glCompileShader(outShader);
-
-    // 成功したかどうか？
-    if (!IsCompiled(outShader))
-    {
-        SDL_Log("Failed compile shader.");
-        return false;
-    }
-    return true;
 }
 
 bool Shader::IsCompiled(GLuint shader)
@@ -90,7 +223,10 @@ bool Shader::IsCompiled(GLuint shader)
 
     if (status != GL_TRUE)
     {
-        SDL_Log("gl compile status false.");
+        // エラー内容を出力（ホットリロード時の修正用）
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        SDL_Log("gl compile status false.\n%s", log);
         return false;
     }
     return true;
@@ -103,50 +239,137 @@ bool Shader::IsValidProgram()
 
     if (status != GL_TRUE)
     {
-        SDL_Log("gl link status false.");
+        char log[1024];
+        glGetProgramInfoLog(mShaderProgram, sizeof(log), nullptr, log);
+        SDL_Log("gl link status false.\n%s", log);
         return false;
     }
     return true;
 }
 
-std::string Shader::GetVertFileName() const
+// #includeを展開して読み込む
+bool Shader::ReadSource(const FileSystem* fileSystem,
+                        const std::string& shaderPath,
+                        const std::string& fileName,
+                        std::vector<std::string>& included,
+                        std::string& outSource)
 {
-    std::string fileName;
-    switch (mType) {
-        case ShaderType::BASIC:
-            fileName = "BasicVert.glsl";
-            break;
-        case ShaderType::SPRITE:
-            fileName = "SpriteVert.glsl";
-            break;
-        case ShaderType::LAMBERT:
-            fileName = "LambertVert.glsl";
-            break;
-        case ShaderType::PHONG:
-            fileName = "PhongVert.glsl";
-            break;
+    // 展開済のファイルは読み込まない（多重インクルード、循環の防止）
+    if (std::find(included.begin(), included.end(), fileName) != included.end())
+    {
+        return true;
+    }
+    included.emplace_back(fileName);
+
+    std::string contents;
+    if (!ReadFile(fileSystem, shaderPath + fileName, contents))
+    {
+        return false;
     }
-    return fileName;
+
+    // 1行ずつ確認し、#include "ファイル名" を置き換える
+    std::istringstream stream(contents);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+        {
+            size_t open = line.find('"', start);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos)
+            {
+                SDL_Log("Invalid shader include. (%s)", fileName.c_str());
+                return false;
+            }
+            if (!ReadSource(fileSystem, shaderPath, line.substr(open + 1, close - open - 1), included, outSource))
+            {
+                return false;
+            }
+            continue;
+        }
+        outSource += line;
+        outSource += '\n';
+    }
+    return true;
+}
+
+// 機能フラグの#defineを挿入
+void Shader::InsertDefines(std::string& source) const
+{
+    // #versionは先頭に置く必要があるため、その次の行に挿入する
+    size_t pos = 0;
+    size_t version = source.find("#version");
+    if (version != std::string::npos)
+    {
+        pos = source.find('\n', version);
+        pos = pos == std::string::npos ? source.size() : pos + 1;
+    }
+    source.insert(pos, GetDefines());
 }
 
-std::string Shader::GetFragFileName() const
+std::string Shader::GetDefines() const
 {
-    std::string fileName;
-    switch (mType) {
+    std::string defines;
+    for (int i = 0; i < FEATURE_COUNT; i++)
+    {
+        if (mFeatures & (1u << i))
+        {
+            defines += std::string("#define ") + FEATURE_DEFINES[i] + "\n";
+        }
+    }
+    // ライティング共通処理（Lighting.glsl）で使用
+    defines += "#define MAX_SHADOW_CASCADES " + std::to_string(CascadedShadowMap::MAX_CASCADES) + "\n";
+    return defines;
+}
+
+// シェーダタイプに対応する機能フラグ
+unsigned int Shader::GetTypeFeatures(const ShaderType type)
+{
+    unsigned int features = 0;
+    switch (type) {
         case ShaderType::BASIC:
-            fileName = "BasicFrag.glsl";
             break;
         case ShaderType::SPRITE:
-            fileName = "SpriteFrag.glsl";
+            features = FEATURE_TEXTURE;
             break;
         case ShaderType::LAMBERT:
-            fileName = "LambertFrag.glsl";
+            features = FEATURE_TEXTURE | FEATURE_LAMBERT;
             break;
         case ShaderType::PHONG:
-            fileName = "PhongFrag.glsl";
+            features = FEATURE_TEXTURE | FEATURE_PHONG;
             break;
     }
-    return fileName;
+    return features;
+}
+
+bool Shader::IsValidFeatures(unsigned int features)
+{
+    // 未定義のビット、反射モデルの重複は不可
+    if (features >> FEATURE_COUNT) return false;
+    return (features & (FEATURE_LAMBERT | FEATURE_PHONG)) != (FEATURE_LAMBERT | FEATURE_PHONG);
+}
+
+int Shader::GetVariantCount()
+{
+    int count = 0;
+    for (unsigned int features = 0; features < (1u << FEATURE_COUNT); features++)
+    {
+        if (IsValidFeatures(features)) count++;
+    }
+    return count;
+}
+
+std::string Shader::GetVariantName(unsigned int features)
+{
+    std::string name;
+    for (int i = 0; i < FEATURE_COUNT; i++)
+    {
+        if (!(features & (1u << i))) continue;
+        if (!name.empty()) name += "|";
+        name += FEATURE_DEFINES[i];
+    }
+    return name.empty() ? "BASIC" : name;
 }
 
 // ワールド座標uniform設定
@@ -164,25 +387,53 @@ void Shader::SetViewProjectionUniform(const Matrix4& viewProjection)
 // ライティングuniform設定
 void Shader::SetLightingUniform(const Renderer* renderer)
 {
-    switch (mType) {
-        case ShaderType::BASIC:
-        case ShaderType::SPRITE:
-            // 設定しない
-            break;
-        case ShaderType::LAMBERT:
-            SetVectorUniform(UNIFORM_AMBIENT_COLOR, renderer->GetAmbientLight());
-            SetVectorUniform(UNIFORM_DIR_LIGHT_DIRECTION, renderer->GetDirLightDirection());
-            SetVectorUniform(UNIFORM_DIR_LIGHT_DIFFUSE_COLOR, renderer->GetDirLightDiffuseColor());
-            break;
-        case ShaderType::PHONG:
-            SetVectorUniform(UNIFORM_CAMERA_POS, renderer->GetCamera()->GetPosition());
-            SetVectorUniform(UNIFORM_AMBIENT_COLOR, renderer->GetAmbientLight());
-            SetVectorUniform(UNIFORM_DIR_LIGHT_DIRECTION, renderer->GetDirLightDirection());
-            SetVectorUniform(UNIFORM_DIR_LIGHT_DIFFUSE_COLOR, renderer->GetDirLightDiffuseColor());
-            SetVectorUniform(UNIFORM_DIR_LIGHT_SPEC_COLOR, renderer->GetDirLightSpecColor());
-            SetFloatUniform(UNIFORM_SPEC_POWER, mSpecPower);
-            break;
+    // ライティング無しの場合は設定しない
+    if (!(mFeatures & (FEATURE_LAMBERT | FEATURE_PHONG))) return;
+
+    SetVectorUniform(UNIFORM_AMBIENT_COLOR, renderer->GetAmbientLight());
+    SetVectorUniform(UNIFORM_DIR_LIGHT_DIRECTION, renderer->GetDirLightDirection());
+    SetVectorUniform(UNIFORM_DIR_LIGHT_DIFFUSE_COLOR, renderer->GetDirLightDiffuseColor());
+    if (mFeatures & FEATURE_PHONG)
+    {
+        SetVectorUniform(UNIFORM_CAMERA_POS, renderer->GetCamera()->GetPosition());
+        SetVectorUniform(UNIFORM_DIR_LIGHT_SPEC_COLOR, renderer->GetDirLightSpecColor());
+        SetFloatUniform(UNIFORM_SPEC_POWER, mSpecPower);
     }
+
+    // クラスタードライティング（点光源、スポットライト）
+    const ClusteredLighting* lighting = renderer->GetClusteredLighting();
+    SetIntUniform(UNIFORM_LIGHT_DATA, Renderer::LIGHT_TEXTURE_UNIT);
+    SetIntUniform(UNIFORM_CLUSTER_GRID, Renderer::LIGHT_TEXTURE_UNIT + 1);
+    SetIntUniform(UNIFORM_LIGHT_INDICES, Renderer::LIGHT_TEXTURE_UNIT + 2);
+    glUniform3i(glGetUniformLocation(mShaderProgram, UNIFORM_CLUSTER_DIMS),
+                lighting->GetTilesX(), lighting->GetTilesY(), lighting->GetSlices());
+    glUniform2f(glGetUniformLocation(mShaderProgram, UNIFORM_CLUSTER_TILE_SIZE),
+                lighting->GetTileWidth(), lighting->GetTileHeight());
+    glUniform2f(glGetUniformLocation(mShaderProgram, UNIFORM_CLUSTER_Z_PARAMS),
+                lighting->GetSliceScale(), lighting->GetSliceBias());
+    glUniform4fv(glGetUniformLocation(mShaderProgram, UNIFORM_VIEW_Z_ROW), 1, lighting->GetViewZRow());
+
+    SetShadowUniform(renderer);
+}
+
+void Shader::SetShadowUniform(const Renderer* renderer)
+{
+    // 影無しでもサンプラの種類が他と重ならないユニットにしておく
+    SetIntUniform(UNIFORM_SHADOW_MAP, Renderer::SHADOW_TEXTURE_UNIT);
+    const CascadedShadowMap* shadowMap = renderer->GetShadowMap();
+    int cascadeCount = shadowMap ? shadowMap->GetCascadeCount() : 0;
+    SetIntUniform(UNIFORM_SHADOW_CASCADE_COUNT, cascadeCount);
+    if (cascadeCount == 0) return;
+    glUniformMatrix4fv(glGetUniformLocation(mShaderProgram, UNIFORM_SHADOW_MATRICES), cascadeCount, GL_TRUE,
+                       shadowMap->GetShadowMatrices()[0].GetMatrixFloatPtr());
+    glUniform4fv(glGetUniformLocation(mShaderProgram, UNIFORM_SHADOW_NORMAL_OFFSETS), 1, shadowMap->GetNormalOffsets());
+    SetFloatUniform(UNIFORM_SHADOW_TEXEL_SIZE, 1.0f / shadowMap->GetResolution());
+}
+
+void Shader::SetSkinningUniform(int paletteOffset)
+{
+    SetIntUniform(UNIFORM_SKIN_PALETTE, Renderer::SKIN_TEXTURE_UNIT);
+    SetIntUniform(UNIFORM_SKIN_PALETTE_OFFSET, paletteOffset);
 }
 
 // 指定された名前のuniformを設定
@@ -201,3 +452,8 @@ void Shader::SetFloatUniform(const char* name, float value)
     GLuint location = glGetUniformLocation(mShaderProgram, name);
     glUniform1f(location, value);
 }
+void Shader::SetIntUniform(const char* name, int value)
+{
+    GLuint location = glGetUniformLocation(mShaderProgram, name);
+    glUniform1i(location, value);
+}
@@ -1,14 +1,17 @@
 #pragma once
 #include <GL/glew.h>
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "Math.h"
 
 // シェーダクラス
-// *コンパイル後、シェーダプログラムを作成してリンクする
+// *共通のシェーダソースに機能フラグを#defineとして挿入し、バリアントごとにコンパイル・リンクする
+// *ソース中の #include "ファイル名" はシェーダパスからの相対パスで展開する
 class Shader
 {
 public:
-    // シェーダタイプ
+    // シェーダタイプ（よく使う機能の組み合わせ）
     enum ShaderType
     {
         BASIC,   // テクスチャ無し（青色）
@@ -17,20 +20,61 @@ public:
         PHONG,   // フォン反射モデル
     };
 
-    Shader(const ShaderType type, float specPower = 10.0f);
+    // 機能フラグ（ビットマスクでバリアントを表す）
+    enum Feature
+    {
+        FEATURE_TEXTURE    = 1 << 0, // テクスチャ
+        FEATURE_LAMBERT    = 1 << 1, // ランバート反射モデル
+        FEATURE_PHONG      = 1 << 2, // フォン反射モデル（LAMBERTとは排他）
+        FEATURE_INSTANCING = 1 << 3, // インスタンス描画
+        FEATURE_SKINNING   = 1 << 4, // スキニング
+        FEATURE_GBUFFER    = 1 << 5, // Gバッファへの出力（ディファードシェーディング）
+        FEATURE_COUNT      = 6,
+    };
+    static const int MAX_SKIN_BONES = 256; // スキニングの1メッシュあたりのボーン数（頂点のボーン番号は8bit）
+
+    Shader(unsigned int features, float specPower = 10.0f);
+    // 共通シェーダ以外のソースを使う場合（ディファードのライティングパスなど）
+    Shader(const std::string& vertFileName, const std::string& fragFileName,
+           unsigned int features = 0, float specPower = 10.0f);
+    // コンピュートシェーダ（GL4.3かARB_compute_shaderが必要）
+    explicit Shader(const std::string& compFileName);
     ~Shader();
 
     bool Load(class Game* game);
     void Unload();
     void SetActive();
 
-    std::string GetVertFileName() const;
-    std::string GetFragFileName() const;
+    // 非同期読込
+    // *BeginLoadでコンパイル・リンクを発行し、FinishLoadで結果を確認する
+    // *複数のシェーダをまとめて発行すると、ドライバが並列にコンパイルできる
+    bool BeginLoad(class Game* game);
+    bool FinishLoad();
+    bool IsReady() const; // FinishLoadがブロックせずに完了するか？
+
+    // 同じ設定の未読込シェーダを作成（ホットリロード用）
+    Shader* Clone() const;
+    // 読込済のプログラムを入れ替える（ホットリロード用）
+    // *参照しているコンポーネントはそのままで新しいプログラムが使われる
+    void SwapProgram(Shader* other);
+
+    unsigned int GetFeatures() const { return mFeatures; }
+    bool IsCompute() const { return mFragFileName.empty(); }
+    GLuint GetProgram() const { return mShaderProgram; }
+    float GetSpecPower() const { return mSpecPower; }
+    std::string GetVariantName() const { return GetVariantName(mFeatures); }
+
+    static unsigned int GetTypeFeatures(const ShaderType type); // シェーダタイプ -> 機能フラグ
+    static bool IsValidFeatures(unsigned int features);         // 有効な組み合わせか？
+    static int GetVariantCount();                               // 有効なバリアントの総数
+    static std::string GetVariantName(unsigned int features);   // ログ用の名前（"TEXTURE|PHONG"など）
 
     // uniformへの設定処理
     void SetWorldTransformUniform(const class Matrix4& would);          // ワールド座標
     void SetViewProjectionUniform(const class Matrix4& viewProjection); // クリップ座標
     void SetLightingUniform(const class Renderer* renderer);            // ライティング関連
+    void SetShadowUniform(const class Renderer* renderer);              // 平行光源の影
+    void SetSkinningUniform(int paletteOffset);                         // ボーン行列パレットの位置
 
     // uniform名
     const char* UNIFORM_VIEW_PROJECTION_NAME = "uViewProjection";
@@ -41,10 +85,36 @@ public:
     const char* UNIFORM_DIR_LIGHT_DIFFUSE_COLOR = "uDirLight.mDiffuseColor";
     const char* UNIFORM_DIR_LIGHT_SPEC_COLOR = "uDirLight.mSpecColor";
     const char* UNIFORM_SPEC_POWER = "uSpecPower";
+    const char* UNIFORM_LIGHT_DATA = "uLightData";
+    const char* UNIFORM_CLUSTER_GRID = "uClusterGrid";
+    const char* UNIFORM_LIGHT_INDICES = "uLightIndices";
+    const char* UNIFORM_CLUSTER_DIMS = "uClusterDims";
+    const char* UNIFORM_CLUSTER_TILE_SIZE = "uClusterTileSize";
+    const char* UNIFORM_CLUSTER_Z_PARAMS = "uClusterZParams";
+    const char* UNIFORM_VIEW_Z_ROW = "uViewZRow";
+    const char* UNIFORM_SHADOW_MAP = "uShadowMap";
+    const char* UNIFORM_SHADOW_MATRICES = "uShadowMatrices";
+    const char* UNIFORM_SHADOW_NORMAL_OFFSETS = "uShadowNormalOffsets";
+    const char* UNIFORM_SHADOW_CASCADE_COUNT = "uShadowCascadeCount";
+    const char* UNIFORM_SHADOW_TEXEL_SIZE = "uShadowTexelSize";
+    const char* UNIFORM_SKIN_PALETTE = "uSkinPalette";
+    const char* UNIFORM_SKIN_PALETTE_OFFSET = "uSkinPaletteOffset";
 
 private:
-    // コンパイル処理
-    bool CompileShader(const std::string& fileName,
+    // ファイル読込処理
+    bool ReadFile(const class FileSystem* fileSystem, const std::string& filePath, std::string& outContents);
+    // #includeを展開して読み込む（同じファイルは1度だけ展開）
+    bool ReadSource(const class FileSystem* fileSystem,
+                    const std::string& shaderPath,
+                    const std::string& fileName,
+                    std::vector<std::string>& included,
+                    std::string& outSource);
+    // 機能フラグの#defineを#versionの直後に挿入
+    void InsertDefines(std::string& source) const;
+    std::string GetDefines() const;
+
+    // コンパイル処理（結果の確認はFinishLoadで行う）
+    void CompileShader(const std::string& source,
                        GLenum shaderType,
                        GLuint& outShader);
 
@@ -55,18 +125,30 @@ private:
     bool IsValidProgram();
 
     // uniformへの設定処理
+public:
     void SetMatrixUniform(const char* name, const Matrix4& matrix);
     void SetVectorUniform(const char* name, const Vector3& vector);
     void SetFloatUniform(const char* name, float value);
+    void SetIntUniform(const char* name, int value);
 
-    // シェーダタイプ
-    ShaderType mType;
+private:
+
+    // ソースファイル名、機能フラグ
+    // *コンピュートシェーダはmVertFileNameのみ（mFragFileNameは空）
+    std::string mVertFileName;
+    std::string mFragFileName;
+    unsigned int mFeatures;
 
     // シェーダのIDを格納
-    GLuint mVertexShader;
+    GLuint mVertexShader; // コンピュートシェーダの場合はここに持つ
     GLuint mFragShader;
     GLuint mShaderProgram;
 
+    // プログラムバイナリキャッシュ
+    class ProgramBinaryCache* mBinaryCache; // キャッシュ（無効ならnullptr）
+    uint64_t mBinaryKey;                    // キャッシュキー
+    bool mIsPending;                        // コンパイル結果の確認待ちか？
+
     // ライティングパラメータ
     float mSpecPower; // 鏡面反射指数 a
 };
@@ -0,0 +1,191 @@
+#include "ShaderWatcher.h"
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+ShaderWatcher::ShaderWatcher(const std::string& shaderPath)
+:mShaderPath(shaderPath)
+,mIsWatching(false)
+,mIsPending(false)
+,mLastChangeTime(0)
+,mSettleMs(100)
+,mNotifyFd(-1)
+,mLastScanTime(0)
+,mScanIntervalMs(500)
+{}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    Shutdown();
+}
+
+bool ShaderWatcher::Initialize()
+{
+#if defined(__linux__)
+    mNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mNotifyFd < 0)
+    {
+        SDL_Log("Failed init inotify, shader hot reload disabled.");
+        return false;
+    }
+    // 保存方法（上書き、一時ファイルからのリネーム）に関わらず検知する
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    for (const auto& dir : GetWatchDirs())
+    {
+        if (inotify_add_watch(mNotifyFd, dir.c_str(), mask) < 0)
+        {
+            SDL_Log("Failed watch shader directory. (%s)", dir.c_str());
+        }
+    }
+    mIsWatching = true;
+#elif !defined(_WIN32)
+    // 初回の更新時刻を記録
+    ScanModified();
+    mLastScanTime = SDL_GetTicks();
+    mIsWatching = true;
+#else
+    SDL_Log("Shader hot reload is not supported on this platform.");
+#endif
+    return mIsWatching;
+}
+
+void ShaderWatcher::Shutdown()
+{
+#if defined(__linux__)
+    if (mNotifyFd >= 0)
+    {
+        // 監視は記述子を閉じると全て解除される
+        close(mNotifyFd);
+        mNotifyFd = -1;
+    }
+#endif
+    mFileTimes.clear();
+    mIsWatching = false;
+}
+
+bool ShaderWatcher::Poll()
+{
+    if (!mIsWatching) return false;
+
+    Uint32 now = SDL_GetTicks();
+#if defined(__linux__)
+    ReadEvents();
+#else
+    if (now - mLastScanTime >= mScanIntervalMs)
+    {
+        mLastScanTime = now;
+        if (ScanModified())
+        {
+            mIsPending = true;
+            mLastChangeTime = now;
+        }
+    }
+#endif
+
+    // 書込が落ち着いてから通知
+    if (mIsPending && now - mLastChangeTime >= mSettleMs)
+    {
+        mIsPending = false;
+        return true;
+    }
+    return false;
+}
+
+void ShaderWatcher::ReadEvents()
+{
+#if defined(__linux__)
+    alignas(struct inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t length = read(mNotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break; // 読み切った（EAGAIN）
+
+        for (char* ptr = buffer; ptr < buffer + length; )
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            if (event->len > 0 && IsShaderFile(event->name))
+            {
+                mIsPending = true;
+                mLastChangeTime = SDL_GetTicks();
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+}
+
+bool ShaderWatcher::ScanModified()
+{
+    bool isModified = false;
+#if !defined(_WIN32)
+    std::vector<FileTime> fileTimes;
+    for (const auto& dir : GetWatchDirs())
+    {
+        DIR* handle = opendir(dir.c_str());
+        if (!handle) continue;
+        while (struct dirent* entry = readdir(handle))
+        {
+            if (!IsShaderFile(entry->d_name)) continue;
+            FileTime fileTime;
+            fileTime.path = dir + entry->d_name;
+            struct stat info;
+            if (stat(fileTime.path.c_str(), &info) != 0) continue;
+            fileTime.mtime = static_cast<long long>(info.st_mtime);
+            fileTimes.emplace_back(fileTime);
+        }
+        closedir(handle);
+    }
+
+    // 前回から追加・更新されたファイルがあるか？
+    for (const auto& fileTime : fileTimes)
+    {
+        bool isFound = false;
+        for (const auto& prev : mFileTimes)
+        {
+            if (prev.path != fileTime.path) continue;
+            isFound = true;
+            if (prev.mtime != fileTime.mtime) isModified = true;
+            break;
+        }
+        if (!isFound && !mFileTimes.empty()) isModified = true;
+    }
+    mFileTimes.swap(fileTimes);
+#endif
+    return isModified;
+}
+
+// シェーダパスと直下のサブディレクトリ（Include等）
+std::vector<std::string> ShaderWatcher::GetWatchDirs() const
+{
+    std::vector<std::string> dirs;
+    dirs.emplace_back(mShaderPath);
+#if !defined(_WIN32)
+    DIR* handle = opendir(mShaderPath.c_str());
+    if (!handle) return dirs;
+    while (struct dirent* entry = readdir(handle))
+    {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        std::string path = mShaderPath + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+        {
+            dirs.emplace_back(path + "/");
+        }
+    }
+    closedir(handle);
+#endif
+    return dirs;
+}
+
+bool ShaderWatcher::IsShaderFile(const std::string& fileName)
+{
+    const std::string ext = ".glsl";
+    return fileName.size() > ext.size()
+        && fileName.compare(fileName.size() - ext.size(), ext.size(), ext) == 0;
+}
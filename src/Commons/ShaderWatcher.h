@@ -0,0 +1,51 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+// シェーダファイル監視クラス
+// *Linuxではinotifyでシェーダパス（直下のサブディレクトリを含む）の.glslの変更を検知する
+// *inotifyが無い環境では一定間隔で更新時刻を確認する（Windowsは未対応）
+// *エディタの保存は複数回の書込になることがあるため、最後の変更から少し待ってから通知する
+class ShaderWatcher
+{
+public:
+    ShaderWatcher(const std::string& shaderPath);
+    ~ShaderWatcher();
+
+    bool Initialize(); // 監視開始（未対応の場合はfalse）
+    void Shutdown();   // 監視終了
+
+    // 変更があったか？（毎フレーム呼ぶ、ブロックしない）
+    bool Poll();
+
+private:
+    void ReadEvents();     // inotifyのイベント読込
+    bool ScanModified();   // 更新時刻の確認（inotifyが無い環境）
+    std::vector<std::string> GetWatchDirs() const; // 監視するディレクトリ
+    static bool IsShaderFile(const std::string& fileName);
+
+    std::string mShaderPath;  // 監視するシェーダパス
+    bool mIsWatching;         // 監視中か？
+    bool mIsPending;          // 通知待ちの変更があるか？
+    Uint32 mLastChangeTime;   // 最後に変更を検知した時刻
+    Uint32 mSettleMs;         // 変更が落ち着くまでの待ち時間
+
+    // inotify
+    int mNotifyFd;
+
+    // 更新時刻の確認用
+    struct FileTime
+    {
+        std::string path;
+        long long mtime;
+    };
+    std::vector<FileTime> mFileTimes;
+    Uint32 mLastScanTime;
+    Uint32 mScanIntervalMs;
+
+public:
+    bool IsWatching() const { return mIsWatching; }
+    void SetSettleMs(Uint32 ms) { mSettleMs = ms; }
+
+};
@@ -0,0 +1,93 @@
+#include "Skinning.h"
+#include <SDL.h>
+#include <algorithm>
+#include "Animation.h"
+#include "JobSystem.h"
+#include "../Components/SkinnedMeshComponent.h"
+
+Skinning::Skinning()
+:mPaletteBuffer(0)
+,mPaletteTexture(0)
+,mStats()
+{}
+
+Skinning::~Skinning()
+{}
+
+bool Skinning::Initialize()
+{
+    // バッファとテクスチャを関連付けておく（データは毎フレーム再確保）
+    glGenBuffers(1, &mPaletteBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, mPaletteBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(float) * Skeleton::PALETTE_FLOATS, nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, &mPaletteTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, mPaletteTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mPaletteBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    return true;
+}
+
+void Skinning::Shutdown()
+{
+    glDeleteTextures(1, &mPaletteTexture);
+    glDeleteBuffers(1, &mPaletteBuffer);
+    mPaletteTexture = mPaletteBuffer = 0;
+    mMeshComps.clear();
+}
+
+void Skinning::AddMeshComp(SkinnedMeshComponent* mesh)
+{
+    mMeshComps.emplace_back(mesh);
+}
+
+void Skinning::RemoveMeshComp(SkinnedMeshComponent* mesh)
+{
+    auto iter = std::find(mMeshComps.begin(), mMeshComps.end(), mesh);
+    if (iter != mMeshComps.end()) mMeshComps.erase(iter);
+}
+
+// ポーズの評価とパレットの転送
+// *先にメッシュごとのパレットの範囲を決めておき、各ジョブは自分の範囲にのみ書き込む
+void Skinning::Update(JobSystem* jobSystem)
+{
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    int jointCount = 0;
+    mPaletteOffsets.resize(mMeshComps.size());
+    for (size_t i = 0; i < mMeshComps.size(); i++)
+    {
+        mPaletteOffsets[i] = jointCount;
+        jointCount += mMeshComps[i]->GetPaletteJointCount();
+    }
+    mPalette.resize(std::max(jointCount, 1) * Skeleton::PALETTE_FLOATS);
+
+    auto evaluate = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            mMeshComps[i]->EvaluatePalette(mPaletteOffsets[i], &mPalette[mPaletteOffsets[i] * Skeleton::PALETTE_FLOATS]);
+        }
+    };
+    if (jobSystem) jobSystem->ParallelFor(mMeshComps.size(), MIN_BATCH, evaluate);
+    else evaluate(0, mMeshComps.size());
+
+    // 再確保してから書き込む（前フレームの描画を待たない）
+    if (jointCount > 0)
+    {
+        const size_t bytes = mPalette.size() * sizeof(float);
+        glBindBuffer(GL_TEXTURE_BUFFER, mPaletteBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, mPalette.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    mStats.meshCount = static_cast<int>(mMeshComps.size());
+    mStats.jointCount = jointCount;
+    mStats.updateMs = (SDL_GetPerformanceCounter() - startCounter) * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
+void Skinning::Bind(int textureUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, mPaletteTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+
+// スキニングクラス
+// *スキンを持つメッシュコンポーネントのポーズを毎フレーム評価し、全員分のボーン行列パレットを
+//  1つのテクスチャバッファにまとめて転送する（描画ごとのuniform配列の転送を行わない）
+// *ポーズの評価はキャラクターごとに独立しているため、ジョブシステムで並列に行う
+// *シェーダはuSkinPaletteOffsetを先頭として、ボーン番号の行列（3テクセル）を読む
+class Skinning
+{
+public:
+    // 今フレームの集計
+    struct Stats
+    {
+        int meshCount;   // スキンを持つメッシュ数
+        int jointCount;  // パレットの関節数の合計
+        float updateMs;  // 評価と転送の時間
+    };
+
+    Skinning();
+    ~Skinning();
+
+    bool Initialize();
+    void Shutdown();
+
+    void AddMeshComp(class SkinnedMeshComponent* mesh);
+    void RemoveMeshComp(class SkinnedMeshComponent* mesh);
+
+    // 全員のポーズを評価してパレットを転送する（jobSystemがnullptrなら呼出元のスレッドのみ）
+    void Update(class JobSystem* jobSystem);
+    void Bind(int textureUnit) const;
+
+private:
+    std::vector<class SkinnedMeshComponent*> mMeshComps;
+    std::vector<int> mPaletteOffsets; // メッシュごとのパレットの先頭の関節番号
+    std::vector<float> mPalette;      // 全員分のパレット（容量を使い回す）
+    GLuint mPaletteBuffer;
+    GLuint mPaletteTexture;
+    Stats mStats;
+
+public:
+    const Stats& GetStats() const { return mStats; }
+
+    // 並列に評価する最小の件数
+    static const int MIN_BATCH = 8;
+
+};
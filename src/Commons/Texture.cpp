@@ -2,47 +2,336 @@
 #include <GL/glew.h>
 #include <SDL.h>
 #include <SDL_image.h>
+#include <algorithm>
+#include <cmath>
+#include "DDSFile.h"
+#include "FileSystem.h"
+
+namespace
+{
+    // GPU側のフォーマット
+    GLenum GetInternalFormat(TextureCodec::Format format)
+    {
+        switch (format)
+        {
+            case TextureCodec::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case TextureCodec::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case TextureCodec::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            default: return GL_RGBA8;
+        }
+    }
+}
 
 Texture::Texture()
 :mTextureID(0)
-,mTexture(nullptr)
+,mWidth(0)
+,mHeight(0)
+,mFormat(TextureCodec::RGBA8)
+,mLoadedMip(0)
+,mAllocatedMip(0)
+,mUploadedMip(0)
+,mResidentMip(0)
+,mAnisotropy(1.0f)
+,mFileSystem(nullptr)
 {}
 
 Texture::~Texture()
 {}
 
-bool Texture::Load(const std::string &filePath)
+bool Texture::Load(const std::string &filePath, const FileSystem* fileSystem)
+{
+    if (!Decode(filePath, fileSystem)) return false;
+    Upload(0);
+    return true;
+}
+
+// CPU側の読込（GLを呼ばないため、ワーカースレッドで並列に読み込める）
+bool Texture::Decode(const std::string &filePath, const FileSystem* fileSystem)
 {
-    // ファイル読込
-    mTexture = IMG_Load(filePath.c_str());
-    if (!mTexture)
+    mFilePath = filePath;
+    mFileSystem = fileSystem;
+    mLoadedMip = 0;
+
+    // DDSが指定された場合はそのまま読み込む
+    std::string cookedPath = DDSFile::GetCookedPath(filePath);
+    if (cookedPath == filePath) return LoadCompressed(filePath, fileSystem);
+
+    // 変換済のDDSが存在する場合は優先する
+    if (fileSystem->Exists(cookedPath))
+    {
+        if (LoadCompressed(cookedPath, fileSystem)) return true;
+        SDL_Log("Failed load cooked texture, fallback to source image.");
+    }
+    return LoadUncompressed(filePath, fileSystem);
+}
+
+bool Texture::LoadUncompressed(const std::string &filePath, const FileSystem* fileSystem)
+{
+    // ファイル読込（メモリ上の画像をデコード）
+    FileSystem::File file;
+    SDL_Surface* loaded = nullptr;
+    if (fileSystem->ReadFile(filePath, file))
+    {
+        loaded = IMG_Load_RW(SDL_RWFromConstMem(file.GetData(), static_cast<int>(file.GetSize())), 1);
+    }
+    if (!loaded)
     {
         SDL_Log("Failed load texture.");
         return false;
     }
 
-    // RGBフォーマットの指定
-    int rgbFormat = GL_RGB;
-    if (mTexture->format->BitsPerPixel >= 4) rgbFormat = GL_RGBA;
+    // ミップマップ生成のためRGBA8に揃える
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface)
+    {
+        SDL_Log("Failed convert texture.");
+        return false;
+    }
+    mWidth = surface->w;
+    mHeight = surface->h;
+    std::vector<unsigned char> rgba(mWidth * mHeight * 4);
+    for (int y = 0; y < mHeight; y++)
+    {
+        const unsigned char* row = static_cast<const unsigned char*>(surface->pixels) + y * surface->pitch;
+        std::copy(row, row + mWidth * 4, rgba.begin() + y * mWidth * 4);
+    }
+    // 複製したためサーフェスを破棄
+    SDL_FreeSurface(surface);
 
-    // テクスチャオブジェクトの作成
+    // 読込時にミップマップを生成しておく
+    mFormat = TextureCodec::RGBA8;
+    mMips = TextureCodec::GenerateMipChain(rgba.data(), mWidth, mHeight);
+    return true;
+}
+
+bool Texture::LoadCompressed(const std::string &filePath, const FileSystem* fileSystem)
+{
+    FileSystem::File file;
+    if (!fileSystem->ReadFile(filePath, file))
+    {
+        SDL_Log("Failed open dds.");
+        return false;
+    }
+    DDSFile dds;
+    if (!dds.Load(file.GetData(), file.GetSize())) return false;
+
+    // GPUが対応しているフォーマットか？
+    bool isSupported = false;
+    switch (dds.GetFormat())
+    {
+        case TextureCodec::BC1:
+        case TextureCodec::BC3:
+            isSupported = GLEW_EXT_texture_compression_s3tc;
+            break;
+        case TextureCodec::BC7:
+            isSupported = GLEW_ARB_texture_compression_bptc;
+            break;
+        default:
+            break;
+    }
+
+    mWidth = dds.GetWidth();
+    mHeight = dds.GetHeight();
+    if (isSupported)
+    {
+        // 圧縮したまま保持
+        mFormat = dds.GetFormat();
+        mMips = dds.GetMips();
+    }
+    else
+    {
+        // 未対応の場合はCPUで展開して保持
+        mFormat = TextureCodec::RGBA8;
+        mMips.clear();
+        for (const auto& mip : dds.GetMips())
+        {
+            TextureCodec::MipLevel decoded;
+            decoded.width = mip.width;
+            decoded.height = mip.height;
+            if (!TextureCodec::Decompress(dds.GetFormat(), mip.data.data(), mip.width, mip.height, decoded.data))
+            {
+                SDL_Log("Compressed texture format is not supported.");
+                mMips.clear();
+                return false;
+            }
+            mMips.emplace_back(std::move(decoded));
+        }
+    }
+    return true;
+}
+
+// GPUへの転送
+// *指定段以降の領域を確保し直す（段数が変わる場合のみ、範囲内の変更はSetResidentMipで行う）
+void Texture::Upload(int baseMip)
+{
+    if (mMips.empty()) return;
+    baseMip = std::max(0, std::min(baseMip, static_cast<int>(mMips.size()) - 1));
+    if (!LoadMips(baseMip)) return;
+
+    const GLenum internalFormat = GetInternalFormat(mFormat);
+    if (mTextureID) glDeleteTextures(1, &mTextureID);
     glGenTextures(1, &mTextureID);
     glBindTexture(GL_TEXTURE_2D, mTextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, rgbFormat, mTexture->w, mTexture->h, 0, rgbFormat,
-                 GL_UNSIGNED_BYTE, mTexture->pixels);
+    int levelCount = static_cast<int>(mMips.size()) - baseMip;
+    if (GLEW_ARB_texture_storage)
+    {
+        // 不変の領域として全ての段をまとめて確保
+        glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, mMips[baseMip].width, mMips[baseMip].height);
+    }
+    else
+    {
+        // 使えない場合は段ごとに領域だけ確保
+        for (size_t i = baseMip; i < mMips.size(); i++)
+        {
+            const auto& mip = mMips[i];
+            int level = static_cast<int>(i) - baseMip;
+            if (TextureCodec::IsCompressed(mFormat))
+            {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0,
+                                       TextureCodec::GetImageBytes(mFormat, mip.width, mip.height), nullptr);
+            }
+            else
+            {
+                glTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0, GL_RGBA,
+                             GL_UNSIGNED_BYTE, nullptr);
+            }
+        }
+    }
+    mAllocatedMip = baseMip;
+    mUploadedMip = static_cast<int>(mMips.size());
 
-    // バイリニアフィルタを有効にする
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    // ミップマップを使用したトライリニアフィルタ
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (GLEW_EXT_texture_filter_anisotropic)
+    {
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, mAnisotropy);
+    }
+
+    UploadMips(baseMip);
+    DropMips();
+}
+
+// 未転送の段の転送と常駐する段の変更
+void Texture::UploadMips(int baseMip)
+{
+    for (int i = baseMip; i < mUploadedMip; i++)
+    {
+        const auto& mip = mMips[i];
+        int level = i - mAllocatedMip;
+        if (TextureCodec::IsCompressed(mFormat))
+        {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height,
+                                      GetInternalFormat(mFormat),
+                                      mip.data.size(), mip.data.data());
+        }
+        else
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, GL_RGBA,
+                            GL_UNSIGNED_BYTE, mip.data.data());
+        }
+    }
+    mUploadedMip = std::min(mUploadedMip, baseMip);
+    mResidentMip = baseMip;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseMip - mAllocatedMip);
+}
+
+// 破棄した段をファイルから読み直す
+// *読込の負荷がかかるため、TextureStreamerは常駐する段を頻繁に変えないようにしている
+bool Texture::LoadMips(int baseMip)
+{
+    if (baseMip >= mLoadedMip) return true;
+    Texture source;
+    if (!mFileSystem || !source.Decode(mFilePath, mFileSystem)
+        || source.mFormat != mFormat || source.mMips.size() != mMips.size())
+    {
+        SDL_Log("Failed reload texture mips. (%s)", mFilePath.c_str());
+        return false;
+    }
+    for (int i = baseMip; i < mLoadedMip; i++)
+    {
+        mMips[i].data = std::move(source.mMips[i].data);
+    }
+    mLoadedMip = baseMip;
     return true;
 }
 
+// 常駐している段より細かい段をCPU側から破棄
+void Texture::DropMips()
+{
+    if (!mFileSystem) return;
+    for (int i = mLoadedMip; i < mResidentMip; i++)
+    {
+        std::vector<unsigned char>().swap(mMips[i].data);
+    }
+    mLoadedMip = std::max(mLoadedMip, mResidentMip);
+}
+
 void Texture::Unload()
 {
     glDeleteTextures(1, &mTextureID);
+    mTextureID = 0;
+    mMips.clear();
+    mLoadedMip = mAllocatedMip = mUploadedMip = mResidentMip = 0;
 }
 
 void Texture::SetActive()
 {
     glBindTexture(GL_TEXTURE_2D, mTextureID);
 }
+
+// 常駐するミップマップの変更
+// *確保済の領域内であれば、未転送の段を転送して描画に使う先頭の段を変えるだけで済む
+void Texture::SetResidentMip(int baseMip)
+{
+    if (mMips.empty()) return;
+    baseMip = std::max(0, std::min(baseMip, static_cast<int>(mMips.size()) - 1));
+    if (baseMip == mResidentMip) return;
+    if (baseMip < mAllocatedMip)
+    {
+        Upload(baseMip);
+        return;
+    }
+    // 転送済の段は読み直さない
+    if (baseMip < mUploadedMip && !LoadMips(baseMip)) return;
+    glBindTexture(GL_TEXTURE_2D, mTextureID);
+    UploadMips(baseMip);
+    DropMips();
+}
+
+// 常駐している段より細かい段のGPUの領域を解放する
+void Texture::ReleaseUnusedMips()
+{
+    if (mAllocatedMip < mResidentMip) Upload(mResidentMip);
+}
+
+// 異方性フィルタの設定
+void Texture::SetAnisotropy(float anisotropy)
+{
+    mAnisotropy = anisotropy;
+    if (!mTextureID || !GLEW_EXT_texture_filter_anisotropic) return;
+    glBindTexture(GL_TEXTURE_2D, mTextureID);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, mAnisotropy);
+}
+
+size_t Texture::GetMipChainBytes(int baseMip) const
+{
+    size_t bytes = 0;
+    for (size_t i = std::max(0, baseMip); i < mMips.size(); i++)
+    {
+        bytes += TextureCodec::GetImageBytes(mFormat, mMips[i].width, mMips[i].height);
+    }
+    return bytes;
+}
+
+int Texture::GetMipForScreenSize(float screenPixels) const
+{
+    if (mMips.empty()) return 0;
+    if (screenPixels <= 1.0f) return static_cast<int>(mMips.size()) - 1;
+    // 画面上のサイズより大きい段は不要
+    float ratio = static_cast<float>(std::max(mWidth, mHeight)) / screenPixels;
+    int mip = ratio > 1.0f ? static_cast<int>(floorf(log2f(ratio))) : 0;
+    return std::min(mip, static_cast<int>(mMips.size()) - 1);
+}
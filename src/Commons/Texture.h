@@ -1,23 +1,68 @@
 #pragma once
 #include <string>
-#include <SDL_image.h>
+#include <vector>
+#include "TextureCodec.h"
 
 // テクスチャクラス
+// *変換済のDDSファイル(.dds)があれば圧縮テクスチャとして優先して読み込む
+// *GPUには必要な段だけを転送する（ストリーミング）
+//  確保した領域内で常駐する段を変える場合は、GL_TEXTURE_BASE_LEVELの変更と未転送の段の転送だけで済ませる
+// *CPU側には常駐している段以降のミップマップだけを保持し、それより細かい段が必要になればファイルから読み直す
 class Texture {
 public:
     Texture();
     ~Texture();
 
-    bool Load(const std::string& fileName);
+    // ファイルはfileSystemを通して読む（アセットパックか個別のファイル）
+    bool Load(const std::string& fileName, const class FileSystem* fileSystem); // Decode + Upload(0)
+    // CPU側の読込のみ（ワーカースレッドから呼べる、GPUへの転送はメインスレッドでUploadを呼ぶ）
+    bool Decode(const std::string& fileName, const class FileSystem* fileSystem);
+    void Upload(int baseMip);                 // GPUへの転送（指定段以降の領域を確保し直す）
     void Unload();
     void SetActive();
 
+    // 指定段以降のミップマップのみをGPUに常駐させる
+    void SetResidentMip(int baseMip);
+    // 常駐している段より細かい段のGPUの領域を解放する（領域を確保し直す）
+    void ReleaseUnusedMips();
+    // 異方性フィルタの設定（1.0fで無効）
+    void SetAnisotropy(float anisotropy);
+
+    // 指定段以降のミップマップのバイト数
+    size_t GetMipChainBytes(int baseMip) const;
+    // 画面上のピクセル数から必要なミップマップの段を計算
+    int GetMipForScreenSize(float screenPixels) const;
+
 private:
+    bool LoadUncompressed(const std::string& filePath, const class FileSystem* fileSystem); // PNG等の読込（非圧縮）
+    bool LoadCompressed(const std::string& filePath, const class FileSystem* fileSystem);   // DDSの読込（ブロック圧縮）
+    bool LoadMips(int baseMip);   // 破棄した段をファイルから読み直す
+    void UploadMips(int baseMip); // 未転送の段の転送と常駐する段の変更（バインド済のテクスチャに対して）
+    void DropMips();              // 常駐している段より細かい段をCPU側から破棄
+
     unsigned int mTextureID;
-    class SDL_Surface* mTexture;
+    int mWidth;  // 横幅
+    int mHeight; // 縦幅
+
+    // ミップマップ
+    TextureCodec::Format mFormat;              // GPUへ転送するフォーマット
+    std::vector<TextureCodec::MipLevel> mMips; // ミップマップ（mLoadedMipより前の段はデータを破棄済）
+    int mLoadedMip;                            // CPU側に保持している先頭の段
+    int mAllocatedMip;                         // GPUに領域を確保している先頭の段
+    int mUploadedMip;                          // GPUに転送済の先頭の段
+    int mResidentMip;                          // GPUに常駐している（描画に使う）先頭の段
+    float mAnisotropy;                         // 異方性フィルタの強さ
+
+    // 読み直し用
+    std::string mFilePath;
+    const class FileSystem* mFileSystem;
 
 public:
-    int GetWidth() const { return mTexture ? mTexture->w : 0; }
-    int GetHeight() const { return mTexture ? mTexture->h : 0; }
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+    int GetMipCount() const { return static_cast<int>(mMips.size()); }
+    int GetResidentMip() const { return mResidentMip; }
+    size_t GetResidentBytes() const { return GetMipChainBytes(mAllocatedMip); }
+    size_t GetLoadedBytes() const { return GetMipChainBytes(mLoadedMip); }
 
 };
@@ -0,0 +1,396 @@
+#include "TextureCodec.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace
+{
+    // 4x4ブロックのピクセルを取り出す（端は最終ピクセルで埋める）
+    void FetchBlock(const unsigned char* rgba, int width, int height,
+                    int blockX, int blockY, unsigned char outBlock[16][4])
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            int py = std::min(blockY * 4 + y, height - 1);
+            for (int x = 0; x < 4; x++)
+            {
+                int px = std::min(blockX * 4 + x, width - 1);
+                const unsigned char* src = rgba + (py * width + px) * 4;
+                for (int c = 0; c < 4; c++)
+                {
+                    outBlock[y * 4 + x][c] = src[c];
+                }
+            }
+        }
+    }
+
+    // デコードした4x4ブロックを画像に書き戻す（はみ出し部分は破棄）
+    void StoreBlock(const unsigned char block[16][4], int width, int height,
+                    int blockX, int blockY, unsigned char* rgba)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            int py = blockY * 4 + y;
+            if (py >= height) break;
+            for (int x = 0; x < 4; x++)
+            {
+                int px = blockX * 4 + x;
+                if (px >= width) break;
+                unsigned char* dst = rgba + (py * width + px) * 4;
+                for (int c = 0; c < 4; c++)
+                {
+                    dst[c] = block[y * 4 + x][c];
+                }
+            }
+        }
+    }
+
+    // RGB888 <-> RGB565
+    uint16_t PackRGB565(const unsigned char* color)
+    {
+        return static_cast<uint16_t>(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+    }
+    void UnpackRGB565(uint16_t packed, unsigned char* outColor)
+    {
+        unsigned char r = (packed >> 11) & 0x1f;
+        unsigned char g = (packed >> 5) & 0x3f;
+        unsigned char b = packed & 0x1f;
+        outColor[0] = static_cast<unsigned char>((r << 3) | (r >> 2));
+        outColor[1] = static_cast<unsigned char>((g << 2) | (g >> 4));
+        outColor[2] = static_cast<unsigned char>((b << 3) | (b >> 2));
+        outColor[3] = 255;
+    }
+
+    // カラーブロック(8byte)のエンコード
+    // *各チャネルの最小・最大値を端点とする簡易フィッティング
+    void EncodeColorBlock(const unsigned char block[16][4], unsigned char* out)
+    {
+        unsigned char minColor[3] = { 255, 255, 255 };
+        unsigned char maxColor[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                minColor[c] = std::min(minColor[c], block[i][c]);
+                maxColor[c] = std::max(maxColor[c], block[i][c]);
+            }
+        }
+        // 量子化誤差を減らすため、端点を少し内側に寄せる
+        for (int c = 0; c < 3; c++)
+        {
+            int inset = (maxColor[c] - minColor[c]) >> 4;
+            minColor[c] = static_cast<unsigned char>(std::min(255, minColor[c] + inset));
+            maxColor[c] = static_cast<unsigned char>(std::max(0, maxColor[c] - inset));
+        }
+
+        uint16_t c0 = PackRGB565(maxColor);
+        uint16_t c1 = PackRGB565(minColor);
+        // c0 > c1 で4色モードとなる
+        if (c0 < c1) std::swap(c0, c1);
+
+        unsigned char palette[4][4];
+        UnpackRGB565(c0, palette[0]);
+        UnpackRGB565(c1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = static_cast<unsigned char>((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = static_cast<unsigned char>((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+
+        // 各ピクセルに最も近いパレットを割り当てる
+        uint32_t indices = 0;
+        if (c0 != c1)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                int bestIndex = 0;
+                int bestDist = INT32_MAX;
+                for (int p = 0; p < 4; p++)
+                {
+                    int dr = block[i][0] - palette[p][0];
+                    int dg = block[i][1] - palette[p][1];
+                    int db = block[i][2] - palette[p][2];
+                    int dist = dr*dr + dg*dg + db*db;
+                    if (dist < bestDist)
+                    {
+                        bestDist = dist;
+                        bestIndex = p;
+                    }
+                }
+                indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+            }
+        }
+
+        out[0] = c0 & 0xff;
+        out[1] = c0 >> 8;
+        out[2] = c1 & 0xff;
+        out[3] = c1 >> 8;
+        out[4] = indices & 0xff;
+        out[5] = (indices >> 8) & 0xff;
+        out[6] = (indices >> 16) & 0xff;
+        out[7] = (indices >> 24) & 0xff;
+    }
+
+    // カラーブロック(8byte)のデコード
+    void DecodeColorBlock(const unsigned char* in, bool allowThreeColor, unsigned char outBlock[16][4])
+    {
+        uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+        uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+        uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | (static_cast<uint32_t>(in[7]) << 24);
+
+        unsigned char palette[4][4];
+        UnpackRGB565(c0, palette[0]);
+        UnpackRGB565(c1, palette[1]);
+        if (c0 > c1 || !allowThreeColor)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                palette[2][c] = static_cast<unsigned char>((2 * palette[0][c] + palette[1][c]) / 3);
+                palette[3][c] = static_cast<unsigned char>((palette[0][c] + 2 * palette[1][c]) / 3);
+            }
+            palette[2][3] = 255;
+            palette[3][3] = 255;
+        }
+        else
+        {
+            // 3色 + 透明モード
+            for (int c = 0; c < 3; c++)
+            {
+                palette[2][c] = static_cast<unsigned char>((palette[0][c] + palette[1][c]) / 2);
+                palette[3][c] = 0;
+            }
+            palette[2][3] = 255;
+            palette[3][3] = 0;
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            int index = (indices >> (i * 2)) & 0x3;
+            for (int c = 0; c < 4; c++)
+            {
+                outBlock[i][c] = palette[index][c];
+            }
+        }
+    }
+
+    // アルファブロック(8byte)のエンコード
+    void EncodeAlphaBlock(const unsigned char block[16][4], unsigned char* out)
+    {
+        unsigned char a0 = 0;
+        unsigned char a1 = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            a0 = std::max(a0, block[i][3]);
+            a1 = std::min(a1, block[i][3]);
+        }
+
+        // a0 > a1 で8段階モードとなる
+        unsigned char palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+        for (int p = 1; p < 7; p++)
+        {
+            palette[p + 1] = static_cast<unsigned char>(((7 - p) * a0 + p * a1) / 7);
+        }
+
+        uint64_t indices = 0;
+        if (a0 != a1)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                int bestIndex = 0;
+                int bestDist = INT32_MAX;
+                for (int p = 0; p < 8; p++)
+                {
+                    int dist = std::abs(block[i][3] - palette[p]);
+                    if (dist < bestDist)
+                    {
+                        bestDist = dist;
+                        bestIndex = p;
+                    }
+                }
+                indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+            }
+        }
+
+        out[0] = a0;
+        out[1] = a1;
+        for (int b = 0; b < 6; b++)
+        {
+            out[2 + b] = static_cast<unsigned char>((indices >> (b * 8)) & 0xff);
+        }
+    }
+
+    // アルファブロック(8byte)のデコード
+    void DecodeAlphaBlock(const unsigned char* in, unsigned char outBlock[16][4])
+    {
+        unsigned char a0 = in[0];
+        unsigned char a1 = in[1];
+        uint64_t indices = 0;
+        for (int b = 0; b < 6; b++)
+        {
+            indices |= static_cast<uint64_t>(in[2 + b]) << (b * 8);
+        }
+
+        unsigned char palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int p = 1; p < 7; p++)
+            {
+                palette[p + 1] = static_cast<unsigned char>(((7 - p) * a0 + p * a1) / 7);
+            }
+        }
+        else
+        {
+            for (int p = 1; p < 5; p++)
+            {
+                palette[p + 1] = static_cast<unsigned char>(((5 - p) * a0 + p * a1) / 5);
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            outBlock[i][3] = palette[(indices >> (i * 3)) & 0x7];
+        }
+    }
+}
+
+namespace TextureCodec
+{
+    int GetBlockBytes(Format format)
+    {
+        switch (format)
+        {
+            case RGBA8: return 4;
+            case BC1:   return 8;
+            case BC3:   return 16;
+            case BC7:   return 16;
+        }
+        return 0;
+    }
+
+    int GetImageBytes(Format format, int width, int height)
+    {
+        if (!IsCompressed(format)) return width * height * 4;
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        return blocksX * blocksY * GetBlockBytes(format);
+    }
+
+    bool HasAlpha(const unsigned char* rgba, int width, int height)
+    {
+        for (int i = 0; i < width * height; i++)
+        {
+            if (rgba[i * 4 + 3] != 255) return true;
+        }
+        return false;
+    }
+
+    std::vector<MipLevel> GenerateMipChain(const unsigned char* rgba, int width, int height)
+    {
+        std::vector<MipLevel> mips;
+        MipLevel base;
+        base.width = width;
+        base.height = height;
+        base.data.assign(rgba, rgba + width * height * 4);
+        mips.emplace_back(base);
+
+        while (mips.back().width > 1 || mips.back().height > 1)
+        {
+            const MipLevel& src = mips.back();
+            MipLevel dst;
+            dst.width = std::max(1, src.width / 2);
+            dst.height = std::max(1, src.height / 2);
+            dst.data.resize(dst.width * dst.height * 4);
+            // 2x2ピクセルの平均を取る
+            for (int y = 0; y < dst.height; y++)
+            {
+                int y0 = std::min(y * 2, src.height - 1);
+                int y1 = std::min(y * 2 + 1, src.height - 1);
+                for (int x = 0; x < dst.width; x++)
+                {
+                    int x0 = std::min(x * 2, src.width - 1);
+                    int x1 = std::min(x * 2 + 1, src.width - 1);
+                    for (int c = 0; c < 4; c++)
+                    {
+                        int sum = src.data[(y0 * src.width + x0) * 4 + c]
+                                + src.data[(y0 * src.width + x1) * 4 + c]
+                                + src.data[(y1 * src.width + x0) * 4 + c]
+                                + src.data[(y1 * src.width + x1) * 4 + c];
+                        dst.data[(y * dst.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                    }
+                }
+            }
+            mips.emplace_back(dst);
+        }
+        return mips;
+    }
+
+    void CompressBC1(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& outBlocks)
+    {
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        outBlocks.resize(blocksX * blocksY * 8);
+        unsigned char block[16][4];
+        for (int by = 0; by < blocksY; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                FetchBlock(rgba, width, height, bx, by, block);
+                EncodeColorBlock(block, &outBlocks[(by * blocksX + bx) * 8]);
+            }
+        }
+    }
+
+    void CompressBC3(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& outBlocks)
+    {
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        outBlocks.resize(blocksX * blocksY * 16);
+        unsigned char block[16][4];
+        for (int by = 0; by < blocksY; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                FetchBlock(rgba, width, height, bx, by, block);
+                unsigned char* out = &outBlocks[(by * blocksX + bx) * 16];
+                EncodeAlphaBlock(block, out);
+                EncodeColorBlock(block, out + 8);
+            }
+        }
+    }
+
+    bool Decompress(Format format, const unsigned char* blocks, int width, int height,
+                    std::vector<unsigned char>& outRGBA)
+    {
+        if (format != BC1 && format != BC3) return false;
+
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        int blockBytes = GetBlockBytes(format);
+        outRGBA.resize(width * height * 4);
+        unsigned char block[16][4];
+        for (int by = 0; by < blocksY; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                const unsigned char* in = blocks + (by * blocksX + bx) * blockBytes;
+                if (format == BC1)
+                {
+                    DecodeColorBlock(in, true, block);
+                }
+                else
+                {
+                    DecodeColorBlock(in + 8, false, block);
+                    DecodeAlphaBlock(in, block);
+                }
+                StoreBlock(block, width, height, bx, by, outRGBA.data());
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+
+// テクスチャ圧縮処理をまとめたライブラリ
+// *ブロック圧縮(BC1/BC3)のエンコード・デコードとミップマップ生成を行う
+// *GPUを使わないため、オフライン変換やGPU非搭載環境での検証に利用できる
+namespace TextureCodec
+{
+    // ピクセルフォーマット
+    enum Format
+    {
+        RGBA8, // 非圧縮 8bit * 4ch
+        BC1,   // DXT1 4bpp（アルファ無し）
+        BC3,   // DXT5 8bpp（アルファ有り）
+        BC7,   // BPTC 8bpp（読込のみ対応）
+    };
+
+    // ミップマップ１段分のデータ
+    struct MipLevel
+    {
+        int width;
+        int height;
+        std::vector<unsigned char> data;
+    };
+
+    // 4x4ブロック１つ分のバイト数（RGBA8は１ピクセル分）
+    int GetBlockBytes(Format format);
+    // 指定サイズの画像を格納するのに必要なバイト数
+    int GetImageBytes(Format format, int width, int height);
+    // ブロック圧縮フォーマットか？
+    inline bool IsCompressed(Format format) { return format != RGBA8; }
+
+    // RGBA8画像にアルファが含まれているか？
+    bool HasAlpha(const unsigned char* rgba, int width, int height);
+
+    // RGBA8画像から1x1までのミップマップを生成（ボックスフィルタ）
+    // *先頭要素は元画像のコピーとなる
+    std::vector<MipLevel> GenerateMipChain(const unsigned char* rgba, int width, int height);
+
+    // RGBA8 -> ブロック圧縮
+    void CompressBC1(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& outBlocks);
+    void CompressBC3(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& outBlocks);
+
+    // ブロック圧縮 -> RGBA8
+    // *BC7のデコードには未対応のためfalseを返す
+    bool Decompress(Format format, const unsigned char* blocks, int width, int height,
+                    std::vector<unsigned char>& outRGBA);
+}
@@ -0,0 +1,52 @@
+#include "TextureCook.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <algorithm>
+#include "DDSFile.h"
+#include "TextureCodec.h"
+
+bool TextureCook::LoadRGBA(const std::string& filePath, std::vector<unsigned char>& outRGBA, int& outWidth, int& outHeight)
+{
+    SDL_Surface* loaded = IMG_Load(filePath.c_str());
+    if (!loaded) return false;
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface) return false;
+    outRGBA.resize(surface->w * surface->h * 4);
+    for (int y = 0; y < surface->h; y++)
+    {
+        const unsigned char* row = static_cast<const unsigned char*>(surface->pixels) + y * surface->pitch;
+        std::copy(row, row + surface->w * 4, outRGBA.begin() + y * surface->w * 4);
+    }
+    outWidth = surface->w;
+    outHeight = surface->h;
+    SDL_FreeSurface(surface);
+    return true;
+}
+
+void TextureCook::Cook(const std::vector<unsigned char>& rgba, int width, int height, int forceFormat, bool generateMips,
+                       DDSFile& outDDS)
+{
+    // ミップマップ生成
+    std::vector<TextureCodec::MipLevel> mips;
+    if (generateMips)
+    {
+        mips = TextureCodec::GenerateMipChain(rgba.data(), width, height);
+    }
+    else
+    {
+        TextureCodec::MipLevel base;
+        base.width = width;
+        base.height = height;
+        base.data = rgba;
+        mips.emplace_back(base);
+    }
+
+    // アルファの有無でフォーマットを決定
+    TextureCodec::Format format = TextureCodec::HasAlpha(rgba.data(), width, height)
+            ? TextureCodec::BC3 : TextureCodec::BC1;
+    if (forceFormat >= 0) format = static_cast<TextureCodec::Format>(forceFormat);
+
+    // 圧縮
+    outDDS.Create(format, mips);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class DDSFile;
+
+// テクスチャ変換処理をまとめたライブラリ
+// *PNG等の画像からミップマップ付きのブロック圧縮DDSを作成する（TextureCooker、AssetBuilderで使う）
+// *GLを使わず、別々の画像なら複数のスレッドで同時に変換できる
+namespace TextureCook
+{
+    // 画像の読込（RGBA8に変換）
+    bool LoadRGBA(const std::string& filePath, std::vector<unsigned char>& outRGBA, int& outWidth, int& outHeight);
+
+    // RGBA8画像からDDSを作成（forceFormatが負ならアルファの有無でBC1/BC3を決める）
+    void Cook(const std::vector<unsigned char>& rgba, int width, int height, int forceFormat, bool generateMips,
+              DDSFile& outDDS);
+}
@@ -0,0 +1,194 @@
+#include "TextureStreamer.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "Texture.h"
+
+TextureStreamer::TextureStreamer(size_t budgetBytes)
+:mBudgetBytes(budgetBytes)
+,mFrame(0)
+,mEvictFrames(120)
+,mDwellFrames(30)
+,mMinResidentSize(32)
+,mAnisotropy(1.0f)
+,mUploadCount(0)
+,mEvictionCount(0)
+{}
+
+TextureStreamer::~TextureStreamer()
+{}
+
+// 管理対象に追加・削除
+void TextureStreamer::AddTexture(Texture* texture)
+{
+    Entry entry;
+    entry.wantedMip = 0;
+    entry.lastUsedFrame = mFrame;
+    entry.pendingMip = texture->GetResidentMip();
+    entry.pendingFrames = 0;
+    mEntries.emplace(texture, entry);
+    texture->SetAnisotropy(mAnisotropy);
+}
+void TextureStreamer::RemoveTexture(Texture* texture)
+{
+    mEntries.erase(texture);
+}
+
+// 画面上のサイズの通知
+void TextureStreamer::RequestScreenSize(Texture* texture, float screenPixels)
+{
+    auto iter = mEntries.find(texture);
+    if (iter == mEntries.end()) return;
+    Entry& entry = iter->second;
+    // 同一フレーム内では最も大きい要求を採用する
+    int mip = texture->GetMipForScreenSize(screenPixels);
+    if (entry.lastUsedFrame != mFrame) entry.wantedMip = mip;
+    else entry.wantedMip = std::min(entry.wantedMip, mip);
+    entry.lastUsedFrame = mFrame;
+}
+
+// 常駐するミップマップの決定
+void TextureStreamer::Update()
+{
+    struct Target
+    {
+        Texture* texture;
+        Uint32 lastUsedFrame;
+        int mip;
+        size_t bytes;   // GPUに確保する領域のバイト数
+        bool isEvicted; // 未使用か予算超過で落とした（GPUの領域も解放する）
+    };
+    std::vector<Target> targets;
+    targets.reserve(mEntries.size());
+    size_t totalBytes = 0;
+
+    for (auto& i : mEntries)
+    {
+        Texture* texture = i.first;
+        Entry& entry = i.second;
+        Target target;
+        target.texture = texture;
+        target.lastUsedFrame = entry.lastUsedFrame;
+        target.isEvicted = false;
+        const int current = texture->GetResidentMip();
+        if (entry.lastUsedFrame == mFrame)
+        {
+            // 今フレームで描画されたものは要求通り
+            // *2段以上違えばすぐに変更し、1段違いは同じ要求が続いた場合のみ変更する
+            if (entry.wantedMip != entry.pendingMip) entry.pendingFrames = 0;
+            entry.pendingMip = entry.wantedMip;
+            entry.pendingFrames++;
+            const bool isFar = std::abs(entry.wantedMip - current) >= 2;
+            target.mip = isFar || entry.pendingFrames >= mDwellFrames ? entry.wantedMip : current;
+        }
+        else if (mFrame - entry.lastUsedFrame > mEvictFrames)
+        {
+            // しばらく使われていないものは最小解像度まで落とす
+            target.mip = std::max(current, GetMinResidentMip(texture));
+            target.isEvicted = true;
+        }
+        else
+        {
+            target.mip = texture->GetResidentMip();
+        }
+        // 解放しないものは確保済の領域が残る
+        target.bytes = texture->GetMipChainBytes(target.mip);
+        if (!target.isEvicted) target.bytes = std::max(target.bytes, texture->GetResidentBytes());
+        totalBytes += target.bytes;
+        targets.emplace_back(target);
+    }
+
+    // 予算を超えている場合、最近使われていないものから解像度を落とす
+    if (totalBytes > mBudgetBytes)
+    {
+        std::sort(targets.begin(), targets.end(), [](const Target& a, const Target& b) {
+            return a.lastUsedFrame < b.lastUsedFrame;
+        });
+        for (auto& target : targets)
+        {
+            // まず確保済で使っていない段の領域を解放し、足りなければ解像度を落とす
+            int minMip = GetMinResidentMip(target.texture);
+            bool isFirst = !target.isEvicted;
+            while (totalBytes > mBudgetBytes && (isFirst || target.mip < minMip))
+            {
+                if (!isFirst) target.mip++;
+                isFirst = false;
+                target.isEvicted = true;
+                const size_t bytes = target.texture->GetMipChainBytes(target.mip);
+                totalBytes -= target.bytes - bytes;
+                target.bytes = bytes;
+            }
+            if (totalBytes <= mBudgetBytes) break;
+        }
+    }
+
+    // 反映
+    for (auto& target : targets)
+    {
+        int current = target.texture->GetResidentMip();
+        if (target.mip < current) mUploadCount++;
+        else if (target.mip > current) mEvictionCount++;
+        target.texture->SetResidentMip(target.mip);
+        // 落としたものは細かい段のGPUの領域も解放する（描画中のものは領域を残し、戻す時の転送を省く）
+        if (target.isEvicted) target.texture->ReleaseUnusedMips();
+    }
+    mFrame++;
+}
+
+// 異方性フィルタの設定（GPUの上限に丸める）
+void TextureStreamer::SetAnisotropy(float anisotropy)
+{
+    mAnisotropy = 1.0f;
+    if (GLEW_EXT_texture_filter_anisotropic)
+    {
+        float maxAnisotropy = 1.0f;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+        mAnisotropy = std::max(1.0f, std::min(anisotropy, maxAnisotropy));
+    }
+    for (auto& i : mEntries)
+    {
+        i.first->SetAnisotropy(mAnisotropy);
+    }
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats() const
+{
+    Stats stats = {};
+    stats.textureCount = static_cast<int>(mEntries.size());
+    stats.budgetBytes = mBudgetBytes;
+    stats.uploadCount = mUploadCount;
+    stats.evictionCount = mEvictionCount;
+    for (auto& i : mEntries)
+    {
+        const Texture* texture = i.first;
+        stats.residentBytes += texture->GetResidentBytes();
+        stats.loadedBytes += texture->GetLoadedBytes();
+        stats.fullBytes += texture->GetMipChainBytes(0);
+        if (texture->GetResidentMip() == 0) stats.fullResidentCount++;
+    }
+    return stats;
+}
+
+void TextureStreamer::LogStats() const
+{
+    Stats stats = GetStats();
+    SDL_Log("texture residency: %d/%d full, %.2f/%.2f MB resident (budget %.2f MB), %.2f MB on CPU, uploads %d, evictions %d",
+            stats.fullResidentCount, stats.textureCount,
+            stats.residentBytes / (1024.0f * 1024.0f), stats.fullBytes / (1024.0f * 1024.0f),
+            stats.budgetBytes / (1024.0f * 1024.0f), stats.loadedBytes / (1024.0f * 1024.0f),
+            stats.uploadCount, stats.evictionCount);
+}
+
+// 常に常駐させる段（最小解像度以下になる最初の段）
+int TextureStreamer::GetMinResidentMip(const Texture* texture) const
+{
+    int mip = 0;
+    int size = std::max(texture->GetWidth(), texture->GetHeight());
+    while (size > mMinResidentSize && mip < texture->GetMipCount() - 1)
+    {
+        size /= 2;
+        mip++;
+    }
+    return mip;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <SDL.h>
+#include <unordered_map>
+
+// テクスチャストリーミングクラス
+// *描画時に要求された画面上のサイズから必要なミップマップだけをGPUに常駐させる
+// *VRAM予算を超えた場合は最近使われていないテクスチャから解像度を落とす（LRU）
+// *要求された段が境界付近で揺れても転送し直さないよう、2段以上違うか一定フレーム同じ段が続いた場合のみ変更する
+class TextureStreamer
+{
+public:
+    // 常駐状況
+    struct Stats
+    {
+        int textureCount;       // 管理中のテクスチャ数
+        int fullResidentCount;  // 最大解像度で常駐しているテクスチャ数
+        size_t residentBytes;   // 常駐中のバイト数
+        size_t loadedBytes;     // CPU側に保持しているバイト数
+        size_t fullBytes;       // 全て最大解像度で常駐させた場合のバイト数
+        size_t budgetBytes;     // VRAM予算
+        int uploadCount;        // 解像度を上げた回数（累計）
+        int evictionCount;      // 解像度を落とした回数（累計）
+    };
+
+    TextureStreamer(size_t budgetBytes = 256 * 1024 * 1024);
+    ~TextureStreamer();
+
+    void AddTexture(class Texture* texture);    // 管理対象に追加
+    void RemoveTexture(class Texture* texture); // 管理対象から削除
+
+    // 描画時に画面上のサイズ(ピクセル)を通知する
+    void RequestScreenSize(class Texture* texture, float screenPixels);
+    // 要求と予算から常駐するミップマップを決定して反映する（フレーム毎）
+    void Update();
+
+    void SetAnisotropy(float anisotropy); // 異方性フィルタの設定
+    void LogStats() const;                // 常駐状況のログ出力
+
+private:
+    // テクスチャごとの要求状況
+    struct Entry
+    {
+        int wantedMip;        // 今フレームで要求された段
+        Uint32 lastUsedFrame; // 最後に描画されたフレーム
+        int pendingMip;       // 変更待ちの段
+        Uint32 pendingFrames; // 変更待ちの段が続いたフレーム数
+    };
+
+    std::unordered_map<class Texture*, Entry> mEntries;
+    size_t mBudgetBytes;  // VRAM予算
+    Uint32 mFrame;        // フレーム番号
+    Uint32 mEvictFrames;  // 未使用とみなすまでのフレーム数
+    Uint32 mDwellFrames;  // 段を変更するまでに同じ要求が続くフレーム数
+    int mMinResidentSize; // 常に常駐させる最小解像度(ピクセル)
+    float mAnisotropy;    // 異方性フィルタの強さ
+    int mUploadCount;
+    int mEvictionCount;
+
+    int GetMinResidentMip(const class Texture* texture) const;
+
+public:
+    void SetBudgetBytes(size_t bytes) { mBudgetBytes = bytes; }
+    size_t GetBudgetBytes() const { return mBudgetBytes; }
+    void SetEvictFrames(Uint32 frames) { mEvictFrames = frames; }
+    void SetDwellFrames(Uint32 frames) { mDwellFrames = frames; }
+    Stats GetStats() const;
+
+};
@@ -1,5 +1,6 @@
 #include "VertexArray.h"
 #include <GL/glew.h>
+#include <vector>
 
 VertexArray::VertexArray(const float *vertices,
                          unsigned int numVertices,
@@ -40,6 +41,28 @@ VertexArray::VertexArray(const float *vertices,
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8,
                           reinterpret_cast<void*>(sizeof(float) * 6)); // オフセット値
+
+    // 位置座標のみの頂点配列の作成
+    // *深度のみの描画で法線、UVを読まないよう、位置座標を詰めて別のバッファに持つ
+    std::vector<float> positions(numVertices * POSITION_FLOATS);
+    for (unsigned int i = 0; i < numVertices; i++)
+    {
+        for (int j = 0; j < POSITION_FLOATS; j++)
+        {
+            positions[i * POSITION_FLOATS + j] = vertices[i * VERTEX_FLOATS + j];
+        }
+    }
+    glGenVertexArrays(1, &mPositionVertexArray);
+    glBindVertexArray(mPositionVertexArray);
+    glGenBuffers(1, &mPositionBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mPositionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+    // インデックスバッファは共有する
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+    // 頂点属性0: 位置(x,y,z)
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * POSITION_FLOATS, 0);
+    glBindVertexArray(0);
 }
 
 VertexArray::~VertexArray()
@@ -47,9 +70,22 @@ VertexArray::~VertexArray()
     glDeleteBuffers(1, &mVertexBuffer);
     glDeleteBuffers(1, &mIndexBuffer);
     glDeleteVertexArrays(1, &mVertexArray);
+    glDeleteBuffers(1, &mPositionBuffer);
+    glDeleteVertexArrays(1, &mPositionVertexArray);
 }
 
 void VertexArray::SetActive()
 {
     glBindVertexArray(mVertexArray);
 }
+
+void VertexArray::SetPositionOnlyActive()
+{
+    glBindVertexArray(mPositionVertexArray);
+}
+
+size_t VertexArray::GetGpuBytes() const
+{
+    return mNumVertices * (VERTEX_FLOATS + POSITION_FLOATS) * sizeof(float)
+         + mNumIndices * sizeof(unsigned int);
+}
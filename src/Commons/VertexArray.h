@@ -1,6 +1,8 @@
 #pragma once
+#include <cstddef>
 
 // 頂点配列クラス
+// *深度のみの描画用に、位置座標だけを詰めた頂点バッファも持つ（インデックスバッファは共有）
 class VertexArray
 {
 public:
@@ -11,6 +13,7 @@ public:
     ~VertexArray();
 
     void SetActive();
+    void SetPositionOnlyActive(); // 位置座標のみの頂点配列（深度プリパス用）
 
 private:
     unsigned int mNumVertices;  // 頂点バッファの頂点数
@@ -18,8 +21,16 @@ private:
     unsigned int mVertexBuffer; // 頂点バッファのOpenGLID
     unsigned int mIndexBuffer;  // インデックスバッファのOpenGLID
     unsigned int mVertexArray;  // 頂点配列オブジェクトのOpenGLID
+    unsigned int mPositionBuffer;      // 位置座標のみの頂点バッファのOpenGLID
+    unsigned int mPositionVertexArray; // 位置座標のみの頂点配列オブジェクトのOpenGLID
 
 public:
-    unsigned int GetNumIndices() { return mNumIndices; }
+    unsigned int GetNumVertices() const { return mNumVertices; }
+    unsigned int GetNumIndices() const { return mNumIndices; }
+    size_t GetGpuBytes() const; // 頂点・インデックスバッファのバイト数
+
+    // 1頂点のfloat数
+    static const int VERTEX_FLOATS = 8;   // 位置(xyz), 法線(xyz), u, v
+    static const int POSITION_FLOATS = 3; // 位置(xyz)
 
 };
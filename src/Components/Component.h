@@ -16,4 +16,5 @@ protected:
 public:
     // Getter, Setter
     int GetUpdateOrder() const { return mUpdateOrder; }
+    class Actor* GetActor() const { return mActor; }
 };
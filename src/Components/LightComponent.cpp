@@ -0,0 +1,33 @@
+#include "LightComponent.h"
+#include <cmath>
+#include "../Game.h"
+#include "../Actors/Actor.h"
+
+LightComponent::LightComponent(class Actor* actor, ClusteredLighting::LightType type)
+:Component(actor)
+,mType(type)
+,mColor(Math::VEC3_UNIT)
+,mRadius(200.0f)
+,mInnerAngle(Math::ToRadians(20.0f))
+,mOuterAngle(Math::ToRadians(30.0f))
+{
+    mActor->GetGame()->GetRenderer()->AddLightComp(this);
+}
+
+LightComponent::~LightComponent()
+{
+    mActor->GetGame()->GetRenderer()->RemoveLightComp(this);
+}
+
+ClusteredLighting::Light LightComponent::GetLight() const
+{
+    ClusteredLighting::Light light;
+    light.type = mType;
+    light.position = mActor->GetWorldPosition();
+    light.radius = mRadius;
+    light.color = mColor;
+    light.direction = mActor->GetWorldForward();
+    light.innerCos = cosf(mInnerAngle);
+    light.outerCos = cosf(mOuterAngle);
+    return light;
+}
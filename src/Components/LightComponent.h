@@ -0,0 +1,35 @@
+#pragma once
+#include "Component.h"
+#include "../Commons/ClusteredLighting.h"
+
+// 光源コンポーネントクラス
+// *アクタの位置に点光源、アクタの前方にスポットライトを配置する
+// *描画前にRendererが全ての光源を集めてクラスタに割り当てる
+class LightComponent : public Component
+{
+public:
+    LightComponent(class Actor* actor, ClusteredLighting::LightType type = ClusteredLighting::POINT);
+    ~LightComponent();
+
+    // 描画用の光源データ（ワールド座標）
+    ClusteredLighting::Light GetLight() const;
+
+private:
+    ClusteredLighting::LightType mType;
+    Vector3 mColor;   // 色
+    float mRadius;    // 影響半径
+    float mInnerAngle;// 減衰開始角（スポットライトのみ、ラジアン）
+    float mOuterAngle;// 照射角（スポットライトのみ、ラジアン）
+
+public:
+    // Getter, Setter
+    ClusteredLighting::LightType GetType() const { return mType; }
+    const Vector3& GetColor() const { return mColor; }
+    void SetColor(const Vector3& color) { mColor = color; }
+    float GetRadius() const { return mRadius; }
+    void SetRadius(float radius) { mRadius = radius; }
+    float GetInnerAngle() const { return mInnerAngle; }
+    float GetOuterAngle() const { return mOuterAngle; }
+    void SetSpotAngles(float inner, float outer) { mInnerAngle = inner; mOuterAngle = outer; }
+
+};
@@ -1,51 +1,135 @@
 #include "MeshComponent.h"
+#include <algorithm>
 #include "../Game.h"
 #include "../Commons/Texture.h"
 #include "../Commons/Mesh.h"
-#include "../Commons/VertexArray.h"
+#include "../Commons/GeometryPool.h"
+#include "../Commons/TextureStreamer.h"
 #include "../Actors/Actor.h"
 
 MeshComponent::MeshComponent(class Actor *actor)
 : Component(actor)
 , mMesh(nullptr)
+, mMeshId(INVALID_RESOURCE_ID)
 , mShader(nullptr)
+, mGBufferShader(nullptr)
+, mIsOccluder(false)
 {
     mActor->GetGame()->GetRenderer()->AddMeshComp(this);
 }
 
 MeshComponent::~MeshComponent()
 {
-    mActor->GetGame()->GetRenderer()->RemoveMeshComp(this);
+    auto renderer = mActor->GetGame()->GetRenderer();
+    renderer->RemoveMeshComp(this);
+    // 参照していたリソースを解放
+    if (mMesh) renderer->GetMeshCache()->Release(mMeshId);
+    if (mShader) renderer->GetShaderCache()->Release(mShader);
+    if (mGBufferShader) renderer->GetShaderCache()->Release(mGBufferShader);
+}
+
+void MeshComponent::SetMesh(ResourceId id)
+{
+    auto cache = mActor->GetGame()->GetRenderer()->GetMeshCache();
+    Mesh* mesh = cache->Get(id);
+    if (mesh) cache->AddRef(id);
+    if (mMesh) cache->Release(mMeshId);
+    mMesh = mesh;
+    mMeshId = id;
+}
+
+void MeshComponent::SetShader(Shader* shader)
+{
+    auto cache = mActor->GetGame()->GetRenderer()->GetShaderCache();
+    if (shader) cache->AddRef(shader);
+    if (mShader) cache->Release(mShader);
+    mShader = shader;
+    // Gバッファ版は次回描画時に取り直す
+    if (mGBufferShader) cache->Release(mGBufferShader);
+    mGBufferShader = nullptr;
 }
 
 void MeshComponent::Draw()
 {
-    if (!mMesh) return;
+    DrawWithShader(mShader);
+}
+
+void MeshComponent::DrawGBuffer()
+{
     if (!mShader) return;
+    if (!mGBufferShader)
+    {
+        auto renderer = mActor->GetGame()->GetRenderer();
+        mGBufferShader = renderer->GetShader(mShader->GetFeatures() | Shader::FEATURE_GBUFFER);
+        if (!mGBufferShader) return;
+        renderer->GetShaderCache()->AddRef(mGBufferShader);
+    }
+    DrawWithShader(mGBufferShader);
+}
+
+// viewProjectionはスキンを持つ派生クラスが別のシェーダで描画する場合に使う
+void MeshComponent::DrawDepth(Shader* depthShader, const Matrix4& /*viewProjection*/)
+{
+    if (!mMesh) return;
+
+    // ワールド座標のみ設定し、位置座標のみの頂点配列で描画する
+    depthShader->SetWorldTransformUniform(mActor->GetWorldTransform());
+    auto pool = mActor->GetGame()->GetRenderer()->GetGeometryPool();
+    pool->Bind(GeometryPool::FORMAT_POSITION);
+    pool->Draw(mMesh->GetGeometry());
+}
+
+// shaderは頂点の形式に応じたuniformを設定する派生クラスが使う
+void MeshComponent::BindVertices(Shader* /*shader*/)
+{
+    mActor->GetGame()->GetRenderer()->GetGeometryPool()->Bind(GeometryPool::FORMAT_STANDARD);
+}
+
+void MeshComponent::RequestTextureStreaming()
+{
+    if (!mMesh || mMesh->GetMaterials().empty()) return;
+    // 画面上のサイズを全てのマテリアルのテクスチャについてストリーミングに通知
+    auto renderer = mActor->GetGame()->GetRenderer();
+    const Vector3 scale = mActor->GetWorldScale();
+    float radius = mMesh->GetRadius() * std::max(scale.x, std::max(scale.y, scale.z));
+    float screenSize = renderer->EstimateScreenSize(mActor->GetWorldPosition(), radius);
+    for (auto& material : mMesh->GetMaterials())
+    {
+        if (material.texture) renderer->GetTextureStreamer()->RequestScreenSize(material.texture, screenSize);
+    }
+}
+
+void MeshComponent::DrawWithShader(Shader* shader)
+{
+    if (!mMesh) return;
+    if (!shader) return;
 
     // シェーダをアクティブにする
-    mShader->SetActive();
+    shader->SetActive();
     // ビュー射影行列、ライティングパラメータを設定
     auto renderer = mActor->GetGame()->GetRenderer();
-    mShader->SetViewProjectionUniform(renderer->GetProjectionMatrix() * renderer->GetViewMatrix());
-    mShader->SetLightingUniform(renderer);
+    shader->SetViewProjectionUniform(renderer->GetProjectionMatrix() * renderer->GetViewMatrix());
+    shader->SetLightingUniform(renderer);
     // ワールド座標を設定
     Matrix4 world = mActor->GetWorldTransform();
-    mShader->SetWorldTransformUniform(world);
-
-    // テクスチャをアクティブにする
-    auto texture = mMesh->GetTexture();
-    if (texture) texture->SetActive();
-
-    // 頂点座標をアクティブにする
-    auto vertexArray = mMesh->GetVertexArray();
-    vertexArray->SetActive();
-
-    // シェーダを描画する
-    glDrawElements(
-        GL_TRIANGLES,   // 描画するポリゴンの種類
-        vertexArray->GetNumIndices(), // インデックスバッファの数
-        GL_UNSIGNED_INT, // インデックスの型
-        nullptr   // 設定済のためnullptr
-        );
+    shader->SetWorldTransformUniform(world);
+
+    RequestTextureStreaming();
+
+    // 共有の頂点配列をアクティブにして、サブメッシュごとに描画する
+    // *シェーダ、uniform、頂点配列はメッシュで1回だけ設定し、テクスチャは変わる時だけ切り替える
+    auto pool = renderer->GetGeometryPool();
+    BindVertices(shader);
+    Texture* activeTexture = nullptr;
+    for (int i = 0; i < mMesh->GetSubMeshCount(); i++)
+    {
+        const Mesh::SubMesh& subMesh = mMesh->GetSubMeshes()[i];
+        Texture* texture = mMesh->GetSubMeshTexture(i);
+        if (texture && texture != activeTexture)
+        {
+            texture->SetActive();
+            activeTexture = texture;
+        }
+        pool->Draw(mMesh->GetGeometry(), subMesh.firstIndex, subMesh.indexCount);
+    }
 }
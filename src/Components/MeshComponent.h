@@ -1,5 +1,7 @@
 #pragma once
 #include "Component.h"
+#include "../Commons/Math.h"
+#include "../Commons/ResourceCache.h"
 
 // メッシュコンポーネントクラス
 class MeshComponent : public Component
@@ -9,13 +11,33 @@ public:
     ~MeshComponent();
 
     virtual void Draw();
+    virtual void DrawGBuffer(); // ディファード用（設定したシェーダのGバッファ版で描画）
+    // 深度プリパス、影用（シェーダはアクティブにしておく、別のシェーダで描画する派生クラスはviewProjectionを使う）
+    virtual void DrawDepth(class Shader* depthShader, const Matrix4& viewProjection);
+    // 画面上のサイズをテクスチャストリーミングに通知（まとめて描画する場合はRendererが呼ぶ）
+    void RequestTextureStreaming();
 
 protected:
+    void DrawWithShader(class Shader* shader);
+    // 頂点配列のアクティブ化と、頂点の形式に応じたuniformの設定
+    virtual void BindVertices(class Shader* shader);
+
     class Mesh* mMesh;
+    ResourceId mMeshId; // メッシュのID（参照カウント用）
     class Shader* mShader;
+    class Shader* mGBufferShader; // 初回のDrawGBufferで取得
+    bool mIsOccluder;             // ソフトウェアオクルージョンカリングの遮蔽物か？
 
 public:
-    virtual void SetMesh(class Mesh* mesh) { mMesh = mesh; }
-    virtual void SetShader(class Shader* shader) { mShader = shader; }
+    // 設定したリソースは参照カウントで保持する
+    virtual void SetMesh(ResourceId id); // インターン済のIDで指定する
+    virtual void SetShader(class Shader* shader);
+    class Mesh* GetMesh() const { return mMesh; }
+    ResourceId GetMeshId() const { return mMeshId; }
+    class Shader* GetShader() const { return mShader; }
+    void SetOccluder(bool isOccluder) { mIsOccluder = isOccluder; }
+    bool IsOccluder() const { return mIsOccluder; }
+    // スキンを持つか？（まとめた描画、GPUカリングの対象外）
+    virtual bool IsSkinned() const { return false; }
 
 };
@@ -0,0 +1,124 @@
+#include "SkinnedMeshComponent.h"
+#include "../Game.h"
+#include "../Commons/Mesh.h"
+#include "../Commons/GeometryPool.h"
+#include "../Commons/Skinning.h"
+#include "../Actors/Actor.h"
+
+SkinnedMeshComponent::SkinnedMeshComponent(class Actor* actor)
+:MeshComponent(actor)
+,mClip(-1)
+,mTime(0.0f)
+,mPlayRate(1.0f)
+,mIsLoop(true)
+,mPaletteOffset(0)
+{
+    mActor->GetGame()->GetRenderer()->GetSkinning()->AddMeshComp(this);
+}
+
+SkinnedMeshComponent::~SkinnedMeshComponent()
+{
+    mActor->GetGame()->GetRenderer()->GetSkinning()->RemoveMeshComp(this);
+}
+
+void SkinnedMeshComponent::SetMesh(ResourceId id)
+{
+    MeshComponent::SetMesh(id);
+    mClip = -1;
+    mTime = 0.0f;
+    if (mMesh && !mMesh->GetSkeleton()) SDL_Log("skinned mesh component: mesh has no skeleton.");
+}
+
+void SkinnedMeshComponent::SetShader(Shader* shader)
+{
+    // スキニング版に差し替える
+    if (shader && !(shader->GetFeatures() & Shader::FEATURE_SKINNING))
+    {
+        Shader* skinned = mActor->GetGame()->GetRenderer()->GetShader(shader->GetFeatures() | Shader::FEATURE_SKINNING);
+        if (skinned) shader = skinned;
+    }
+    MeshComponent::SetShader(shader);
+}
+
+void SkinnedMeshComponent::Update(float deltaTime)
+{
+    if (mClip >= 0) mTime += deltaTime * mPlayRate;
+}
+
+bool SkinnedMeshComponent::Play(const std::string& name, bool isLoop)
+{
+    return mMesh && Play(mMesh->FindAnimation(name), isLoop);
+}
+
+bool SkinnedMeshComponent::Play(int clip, bool isLoop)
+{
+    if (!HasSkeleton() || clip < 0 || clip >= static_cast<int>(mMesh->GetAnimations().size())) return false;
+    mClip = clip;
+    mTime = 0.0f;
+    mIsLoop = isLoop;
+    return true;
+}
+
+void SkinnedMeshComponent::Stop()
+{
+    mClip = -1;
+    mTime = 0.0f;
+}
+
+void SkinnedMeshComponent::EvaluatePalette(int offset, float* outPalette)
+{
+    mPaletteOffset = offset;
+    if (!HasSkeleton()) return;
+    const Skeleton* skeleton = mMesh->GetSkeleton();
+    if (mClip < 0)
+    {
+        skeleton->ComputeBindPalette(outPalette);
+        return;
+    }
+    mMesh->GetAnimations()[mClip]->Sample(mTime, mIsLoop, mPose);
+    skeleton->ComputePalette(mPose, mModels, outPalette);
+}
+
+int SkinnedMeshComponent::GetPaletteJointCount() const
+{
+    return HasSkeleton() ? mMesh->GetSkeleton()->GetJointCount() : 0;
+}
+
+void SkinnedMeshComponent::Draw()
+{
+    if (HasSkeleton()) MeshComponent::Draw();
+}
+
+void SkinnedMeshComponent::DrawGBuffer()
+{
+    if (HasSkeleton()) MeshComponent::DrawGBuffer();
+}
+
+// 深度プリパス、影の描画
+// *スキニング版の深度シェーダで描画し、呼出元のシェーダに戻す
+void SkinnedMeshComponent::DrawDepth(Shader* depthShader, const Matrix4& viewProjection)
+{
+    auto renderer = mActor->GetGame()->GetRenderer();
+    Shader* skinnedShader = renderer->GetDepthOnlySkinnedShader();
+    if (!HasSkeleton() || !skinnedShader) return;
+
+    skinnedShader->SetActive();
+    skinnedShader->SetViewProjectionUniform(viewProjection);
+    skinnedShader->SetWorldTransformUniform(mActor->GetWorldTransform());
+    skinnedShader->SetSkinningUniform(mPaletteOffset);
+    auto pool = renderer->GetGeometryPool();
+    pool->Bind(GeometryPool::FORMAT_SKINNED);
+    pool->Draw(mMesh->GetGeometry());
+    depthShader->SetActive();
+}
+
+void SkinnedMeshComponent::BindVertices(Shader* shader)
+{
+    mActor->GetGame()->GetRenderer()->GetGeometryPool()->Bind(GeometryPool::FORMAT_SKINNED);
+    shader->SetSkinningUniform(mPaletteOffset);
+}
+
+bool SkinnedMeshComponent::HasSkeleton() const
+{
+    return mMesh && mMesh->GetSkeleton();
+}
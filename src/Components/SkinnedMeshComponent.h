@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "MeshComponent.h"
+#include "../Commons/Animation.h"
+
+// スキンメッシュコンポーネントクラス
+// *メッシュのスケルトン、アニメーションクリップを再生し、GPUスキニングで描画する
+// *ポーズはRendererの描画前にSkinningが全員分を並列に評価する（Updateでは時刻を進めるだけ）
+// *シェーダはスキニング版に差し替える、スケルトンの無いメッシュは描画しない
+class SkinnedMeshComponent : public MeshComponent
+{
+public:
+    SkinnedMeshComponent(class Actor* actor);
+    ~SkinnedMeshComponent();
+
+    void Update(float deltaTime) override;
+    void Draw() override;
+    void DrawGBuffer() override;
+    void DrawDepth(class Shader* depthShader, const Matrix4& viewProjection) override;
+
+    // クリップの再生（見つからなければfalse）
+    bool Play(const std::string& name, bool isLoop = true);
+    bool Play(int clip, bool isLoop = true);
+    void Stop(); // バインド時のポーズに戻す
+
+    // 関節ごとのパレットを書き込む（Skinningのジョブから呼ばれる）
+    // *offsetは全員分のパレットの中の先頭の関節番号で、描画時にシェーダに設定する
+    void EvaluatePalette(int offset, float* outPalette);
+    int GetPaletteJointCount() const;
+
+protected:
+    void BindVertices(class Shader* shader) override;
+
+private:
+    bool HasSkeleton() const;
+
+    int mClip;          // 再生中のクリップ（-1はバインド時のポーズ）
+    float mTime;        // 再生時刻（秒）
+    float mPlayRate;    // 再生速度
+    bool mIsLoop;
+    int mPaletteOffset; // 今フレームのパレットの先頭
+    AnimationPose mPose;          // 評価の作業領域
+    std::vector<Matrix4> mModels; // 関節のモデル座標の作業領域
+
+public:
+    void SetMesh(ResourceId id) override;
+    void SetShader(class Shader* shader) override;
+    bool IsSkinned() const override { return true; }
+    int GetClip() const { return mClip; }
+    bool IsLoop() const { return mIsLoop; }
+    float GetTime() const { return mTime; }
+    void SetTime(float time) { mTime = time; }
+    float GetPlayRate() const { return mPlayRate; }
+    void SetPlayRate(float rate) { mPlayRate = rate; }
+
+};
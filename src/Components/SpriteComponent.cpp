@@ -1,12 +1,15 @@
 #include "SpriteComponent.h"
 #include <GL/glew.h>
+#include <algorithm>
 #include "../Game.h"
 #include "../Actors/Actor.h"
 #include "../Commons/Texture.h"
+#include "../Commons/TextureStreamer.h"
 
 SpriteComponent::SpriteComponent(class Actor *actor, int drawOrder)
 :Component(actor)
 ,mTexture(nullptr)
+,mTextureId(INVALID_RESOURCE_ID)
 ,mDrawOrder(drawOrder)
 {
     // 描画中のスプライトとして追加
@@ -16,7 +19,20 @@ SpriteComponent::SpriteComponent(class Actor *actor, int drawOrder)
 SpriteComponent::~SpriteComponent()
 {
     // 描画中のスプライトから削除
-    mActor->GetGame()->GetRenderer()->RemoveSpriteComp(this);
+    auto renderer = mActor->GetGame()->GetRenderer();
+    renderer->RemoveSpriteComp(this);
+    // 参照していたテクスチャを解放
+    if (mTexture) renderer->GetTextureCache()->Release(mTextureId);
+}
+
+void SpriteComponent::SetTexture(ResourceId id)
+{
+    auto cache = mActor->GetGame()->GetRenderer()->GetTextureCache();
+    Texture* texture = cache->Get(id);
+    if (texture) cache->AddRef(id);
+    if (mTexture) cache->Release(mTextureId);
+    mTexture = texture;
+    mTextureId = id;
 }
 
 void SpriteComponent::Draw(Shader* shader)
@@ -30,8 +46,11 @@ void SpriteComponent::Draw(Shader* shader)
     Matrix4 world = mActor->GetWorldTransform() * scaleMatrix;
     shader->SetWorldTransformUniform(world);
 
-    // テクスチャをアクティブにする
+    // テクスチャをアクティブにし、画面上のサイズをストリーミングに通知
     mTexture->SetActive();
+    const Vector3 scale = mActor->GetWorldScale();
+    float screenSize = std::max(mTexture->GetWidth() * scale.x, mTexture->GetHeight() * scale.y);
+    mActor->GetGame()->GetRenderer()->GetTextureStreamer()->RequestScreenSize(mTexture, screenSize);
 
     // 設定されたシェーダを描画
     glDrawElements(
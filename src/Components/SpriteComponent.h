@@ -1,6 +1,7 @@
 #pragma once
 #include <SDL.h>
 #include "Component.h"
+#include "../Commons/ResourceCache.h"
 
 // スプライトコンポーネントクラス
 // *描画を行うコンポーネントはこのクラスを継承する
@@ -14,10 +15,13 @@ public:
 
 protected:
     class Texture* mTexture; // テクスチャ
+    ResourceId mTextureId;   // テクスチャのID（参照カウント用）
     int mDrawOrder; // 描画順
 
 public:
     // Getter, Setter
     int GetDrawOrder() const { return mDrawOrder; }
-    void SetTexture(class Texture* texture) { mTexture = texture; }
+    class Texture* GetTexture() const { return mTexture; }
+    ResourceId GetTextureId() const { return mTextureId; }
+    void SetTexture(ResourceId id); // インターン済のIDで指定し、参照カウントで保持する
 };
@@ -4,18 +4,43 @@
 #include "Actors/Actor.h"
 #include "Actors/Saikoro.h"
 #include "Commons/Renderer.h"
+#include "Commons/InputSystem.h"
+#include "Commons/JobSystem.h"
+#include "Commons/FileSystem.h"
+#include "Commons/SceneGraph.h"
+#include "Commons/SceneFile.h"
 #include "Components/SpriteComponent.h"
+#include "Components/LightComponent.h"
+#include "Commons/DynamicResolution.h"
 
 Game::Game()
-:mTicksCount(0)
+:mRenderer(nullptr)
+,mInputSystem(nullptr)
+,mJobSystem(nullptr)
+,mFileSystem(nullptr)
+,mSceneGraph(nullptr)
+,mTicksCount(0)
 ,mIsRunning(true)
 ,mUpdatingActors(false)
+,mIsHeadless(false)
+,mShadowPreset(0)
 {
 }
 
 // ゲーム初期化
-bool Game::Initialize()
+bool Game::Initialize(bool isHeadless)
 {
+    mIsHeadless = isHeadless;
+
+    // ファイルシステム初期化（パックがあればマウント、無ければ個別のファイルを読む）
+    mFileSystem = new FileSystem();
+    mFileSystem->Mount(AssetPackPath, AssetsPath);
+    mFileSystem->Mount(ShaderPackPath, ShaderPath);
+    // ジョブシステム初期化（論理コア数 - 1のワーカー）
+    mJobSystem = new JobSystem();
+    // シーングラフ（アクタより先に作成）
+    mSceneGraph = new SceneGraph();
+
     // レンダラー初期化
     mRenderer = new Renderer(this);
     if (!mRenderer->Initialize())
@@ -26,6 +51,9 @@ bool Game::Initialize()
         return false;
     }
 
+    // 入力管理クラス初期化
+    mInputSystem = new InputSystem();
+
     // ゲーム時間取得
     mTicksCount = SDL_GetTicks();
 
@@ -43,6 +71,12 @@ bool Game::LoadData()
 {
     // 描画データロード
     if (!mRenderer->LoadData()) return false;
+    // ヘッドレスではシーンを呼出元が作成する
+    if (mIsHeadless) return true;
+
+    // シーンファイルがあれば読み込む（無ければ以下のコードで作成し、F12で保存できる）
+    SceneFile sceneFile;
+    if (sceneFile.Load(SceneFilePath, mFileSystem)) return sceneFile.Instantiate(this);
 
     // サイコロ作成
     auto* saikoro = new Saikoro(this, Shader::ShaderType::BASIC);
@@ -61,12 +95,29 @@ bool Game::LoadData()
     saikoro4->SetPosition(Vector3(120.0f, -100.0f, 0.0f));
     saikoro4->SetScale(Vector3(50.0f, 50.0f, 50.0f));
 
+    // 点光源作成（クラスタードライティング）
+    const Vector3 lightColors[] = {
+        Vector3(1.0f, 0.3f, 0.3f),
+        Vector3(0.3f, 1.0f, 0.3f),
+        Vector3(0.3f, 0.3f, 1.0f),
+        Vector3(1.0f, 0.8f, 0.3f),
+    };
+    for (int i = 0; i < 4; i++)
+    {
+        auto* lightActor = new Actor(this);
+        float angle = Math::Pi * 0.5f * i;
+        lightActor->SetPosition(Vector3(cosf(angle) * 200.0f, sinf(angle) * 200.0f, -80.0f));
+        auto* light = new LightComponent(lightActor);
+        light->SetColor(lightColors[i]);
+        light->SetRadius(250.0f);
+    }
+
     // UI作成
     auto* ui1 = new Actor(this);
     ui1->SetPosition(Vector3(250.0f, 300.0f, 0.0f));
     ui1->SetScale(Vector3(0.8f, 0.8f, 0.0f));
     auto* sc = new SpriteComponent(ui1);
-    sc->SetTexture(mRenderer->GetTexture(AssetsPath + "msg_start.png"));
+    sc->SetTexture(mRenderer->InternTexture(AssetsPath + "msg_start.png"));
 
     return true;
 }
@@ -95,6 +146,21 @@ void Game::Update()
     }
     mTicksCount = SDL_GetTicks();
 
+    UpdateActors(deltaTime);
+}
+
+// 1フレーム処理
+// *フレームレートの調整を行わないため、処理時間をそのまま計測できる
+void Game::RunFrame(float deltaTime)
+{
+    ProcessInput();
+    UpdateActors(deltaTime);
+    GenerateOutput();
+}
+
+// アクタ更新、追加、破棄
+void Game::UpdateActors(float deltaTime)
+{
     // アクタ更新処理
     mUpdatingActors = true;
     for (auto actor : mActors)
@@ -123,11 +189,17 @@ void Game::Update()
     {
         delete actor;
     }
+
+    // 座標が変わったアクタのワールド変換座標を親子の順に再計算
+    mSceneGraph->Update(mJobSystem);
 }
 
 // ゲームループ 入力検知
 void Game::ProcessInput()
 {
+    // 前フレームのイベントを破棄
+    mInputSystem->ClearEvents();
+
     // SDLイベント
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -137,20 +209,73 @@ void Game::ProcessInput()
             case SDL_QUIT: // ウィンドウが閉じられた時
             mIsRunning = false;
             break;
+            default: // キー入力はタイムスタンプを付けてキューに追加
+            mInputSystem->ProcessEvent(event);
+            break;
         }
     }
-    // キー入力イベント
-    const Uint8* state = SDL_GetKeyboardState(NULL);
-    if (state[SDL_SCANCODE_ESCAPE])
+    // キー押下状態の更新
+    mInputSystem->Update();
+    if (mInputSystem->IsActionHeld(InputSystem::QUIT))
     {
         mIsRunning = false;
     }
-
-    // 各アクタの入力イベント
-    for (auto actor : mActors)
+    if (mInputSystem->WasActionPressed(InputSystem::TOGGLE_RENDER_PATH))
     {
-        actor->ProcessInput(state);
+        mRenderer->SetRenderPath(mRenderer->GetRenderPath() == Renderer::FORWARD
+                                 ? Renderer::DEFERRED : Renderer::FORWARD);
     }
+    if (mInputSystem->WasActionPressed(InputSystem::TOGGLE_DEPTH_PREPASS))
+    {
+        mRenderer->SetDepthPrePass(!mRenderer->IsDepthPrePass());
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::CYCLE_OCCLUSION_MODE))
+    {
+        auto mode = mRenderer->GetOcclusionCulling()->GetMode();
+        mRenderer->SetOcclusionMode(static_cast<OcclusionCulling::Mode>((mode + 1) % OcclusionCulling::MODE_COUNT));
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::CYCLE_SHADOW_QUALITY))
+    {
+        // 影の品質（解像度、カスケード数）を順に切り替える
+        const int presets[][2] = { {2048, 4}, {1024, 2}, {1024, 0} };
+        const int presetCount = sizeof(presets) / sizeof(presets[0]);
+        mShadowPreset = (mShadowPreset + 1) % presetCount;
+        mRenderer->SetShadowQuality(presets[mShadowPreset][0], presets[mShadowPreset][1]);
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::DUMP_FRAME_GRAPH))
+    {
+        // 直前のフレームの構成
+        mRenderer->DumpFrameGraph();
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::TOGGLE_DYNAMIC_RESOLUTION))
+    {
+        mRenderer->SetDynamicResolution(!mRenderer->GetDynamicResolution()->IsEnabled());
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::CYCLE_POST_QUALITY) && mRenderer->GetPostProcess())
+    {
+        auto quality = mRenderer->GetPostProcess()->GetQuality();
+        mRenderer->SetPostQuality(static_cast<PostProcess::Quality>((quality + 1) % PostProcess::QUALITY_COUNT));
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::DUMP_GPU_PROFILE))
+    {
+        // 読み戻した履歴（平均はモードの切替時、終了時にログに出力される）
+        mRenderer->DumpGpuProfile();
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::TOGGLE_MULTI_DRAW))
+    {
+        mRenderer->SetMultiDraw(!mRenderer->IsMultiDraw());
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::TOGGLE_GPU_CULLING))
+    {
+        mRenderer->SetGpuCulling(!mRenderer->IsGpuCulling());
+    }
+    if (mInputSystem->WasActionPressed(InputSystem::SAVE_SCENE))
+    {
+        SaveScene(SceneFilePath);
+    }
+
+    // 購読しているアクタにのみ入力を通知
+    mInputSystem->Dispatch();
 }
 
 // ゲームループ 出力処理
@@ -167,8 +292,20 @@ void Game::Shutdown()
     {
         delete mActors.back();
     }
+    // シーングラフ破棄
+    delete mSceneGraph;
+    mSceneGraph = nullptr;
+    // 入力管理クラス破棄
+    delete mInputSystem;
+    mInputSystem = nullptr;
     // レンダラー破棄
     mRenderer->ShutDown();
+    // ジョブシステム破棄（ワーカーの終了を待つ）
+    delete mJobSystem;
+    mJobSystem = nullptr;
+    // ファイルシステム破棄（パックのアンマウント）
+    delete mFileSystem;
+    mFileSystem = nullptr;
 }
 
 // アクタ追加・削除処理
@@ -179,6 +316,10 @@ void Game::AddActor(Actor* actor)
     ? mPendingActors.emplace_back(actor)
     : mActors.emplace_back(actor);
 }
+void Game::ReserveActors(int count)
+{
+    mActors.reserve(mActors.size() + count);
+}
 void Game::RemoveActor(Actor* actor)
 {
     auto iter = std::find(mPendingActors.begin(), mPendingActors.end(), actor);
@@ -192,3 +333,16 @@ void Game::RemoveActor(Actor* actor)
         mActors.erase(iter);
     }
 }
+
+// シーンファイルの保存
+// *確認用のテキストを同じ名前に.txtを付けて書き出す
+bool Game::SaveScene(const std::string& filePath)
+{
+    SceneFile sceneFile;
+    sceneFile.Capture(this);
+    if (!sceneFile.Save(filePath)) return false;
+    sceneFile.ExportText(filePath + ".txt");
+    SDL_Log("scene saved: %d actors, %d components, %d resources (%s)",
+            sceneFile.GetActorCount(), sceneFile.GetComponentCount(), sceneFile.GetResourceCount(), filePath.c_str());
+    return true;
+}
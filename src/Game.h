@@ -11,20 +11,26 @@ class Game
 {
 public:
     Game();
-    bool Initialize(); // ゲーム初期化
+    bool Initialize(bool isHeadless = false); // ゲーム初期化（ヘッドレスはウィンドウ非表示、垂直同期無し、デモシーン無し）
     bool LoadData();   // データロード処理
     void RunLoop();    // ゲームループ処理
+    void RunFrame(float deltaTime); // 1フレーム処理（待機せず固定の経過時間で更新、ベンチマーク用）
     void Shutdown();   // シャットダウン処理
 
     // アクタ追加・削除
     void AddActor(class Actor* actor);
     void RemoveActor(class Actor* actor);
+    void ReserveActors(int count); // まとめて追加するアクタ数を先に確保する（シーンの読込時）
+
+    // シーンファイルの保存（バイナリと、確認用のテキスト）
+    bool SaveScene(const std::string& filePath);
 
     constexpr static const float ScreenWidth  = 1024.0f; // スクリーン横幅
     constexpr static const float ScreenHeight = 768.0f;  // スクリーン縦幅
 
 private:
     void Update();         // シーン更新処理
+    void UpdateActors(float deltaTime); // アクタ更新、追加、破棄
     void ProcessInput();   // 入力検知
     void GenerateOutput(); // 出力処理
 
@@ -32,23 +38,48 @@ private:
     std::vector<class Actor*> mPendingActors; // 待機中のアクタリスト
 
     class Renderer* mRenderer;
+    class InputSystem* mInputSystem;
+    class JobSystem* mJobSystem; // ワーカースレッド（光源割当などの並列処理）
+    class FileSystem* mFileSystem; // アセットの読込（アセットパックか個別のファイル）
+    class SceneGraph* mSceneGraph; // アクタの親子関係、ワールド変換座標
 
     Uint32 mTicksCount;   // ゲーム時間
     bool mIsRunning;      // 実行中か否か？
     bool mUpdatingActors; // アクタ更新中か否か？
+    bool mIsHeadless;     // ヘッドレス（ベンチマーク）で実行中か？
+    int mShadowPreset;    // 影の品質の番号
     
     // Mac + CLion環境での相対パス
     const std::string AssetsPath = "../Assets/";      // Assetsパス
     const std::string ShaderPath = "../src/Shaders/"; // シェーダーパス
+    const std::string ShaderCachePath = "../ShaderCache/"; // シェーダーバイナリキャッシュパス
+    const std::string GpuProfilePath = "../gpu_profile.csv"; // GPU時間の出力パス
+    const std::string SceneFilePath = "../Assets/demo.scene"; // シーンファイルのパス（無ければコードで作成）
+    const std::string AssetPackPath = "../Assets.pak";   // アセットパック（無ければAssetsの個別のファイル）
+    const std::string ShaderPackPath = "../Shaders.pak"; // シェーダパック（無ければシェーダーパスの個別のファイル）
 
     // Win + VisualStudio環境での相対パス
     //const std::string AssetsPath = "Assets\\";       // Assetsパス
     //const std::string ShaderPath = "src\\Shaders\\"; // シェーダーパス
+    //const std::string ShaderCachePath = "ShaderCache\\"; // シェーダーバイナリキャッシュパス
+    //const std::string GpuProfilePath = "gpu_profile.csv"; // GPU時間の出力パス
+    //const std::string SceneFilePath = "Assets\\demo.scene"; // シーンファイルのパス（無ければコードで作成）
+    //const std::string AssetPackPath = "Assets.pak";   // アセットパック（無ければAssetsの個別のファイル）
+    //const std::string ShaderPackPath = "Shaders.pak"; // シェーダパック（無ければシェーダーパスの個別のファイル）
 
 public:
     // getter, setter
     std::string GetAssetsPath() const { return AssetsPath; }
     std::string GetShaderPath() const { return ShaderPath; }
+    std::string GetShaderCachePath() const { return ShaderCachePath; }
+    std::string GetGpuProfilePath() const { return GpuProfilePath; }
+    std::string GetSceneFilePath() const { return SceneFilePath; }
+    const std::vector<class Actor*>& GetActors() const { return mActors; }
     class Renderer* GetRenderer() const { return mRenderer; }
+    class InputSystem* GetInputSystem() const { return mInputSystem; }
+    class JobSystem* GetJobSystem() const { return mJobSystem; }
+    class FileSystem* GetFileSystem() const { return mFileSystem; }
+    class SceneGraph* GetSceneGraph() const { return mSceneGraph; }
+    bool IsHeadless() const { return mIsHeadless; }
 
 };
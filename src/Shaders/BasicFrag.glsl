@@ -1,8 +0,0 @@
-#version 330
-
-out vec4 outColor;
-
-void main() {
-    // 青色を出力
-    outColor = vec4(0.0, 0.0, 1.0, 1.0);
-}
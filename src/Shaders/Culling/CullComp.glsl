@@ -0,0 +1,129 @@
+#version 430
+// GPUカリング用コンピュートシェーダ
+// *1スレッドで1オブジェクトを判定し、見えるものの命令をまとまりの領域に詰めて書き込む
+// *判定はGpuCulling::IsBoxVisible、HiZBuffer::IsBoxOccludedと同じ計算順序で行う（CPUの参照実装と比較するため）
+
+layout(local_size_x = 64) in;
+
+// オブジェクト（GpuCulling::GpuObjectと同じ並び）
+struct Object
+{
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint batch;
+    vec4 boxMin;
+    vec4 boxMax;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 1) readonly buffer Transforms { mat4 transforms[]; }; // 行優先のまま転送
+layout(std430, binding = 2) readonly buffer BatchOffsets { uint batchOffsets[]; };
+layout(std430, binding = 3) writeonly buffer Commands { uint commands[]; };    // 5要素で1命令
+layout(std430, binding = 4) buffer DrawCounts { uint drawCounts[]; };
+layout(std430, binding = 5) readonly buffer HiZ { float hizDepth[]; };
+
+uniform mat4 uViewProjection;    // ビュー射影行列
+uniform uint uObjectCount;
+uniform mat4 uHiZViewProjection; // 階層Zを作成した時のビュー射影行列
+uniform int uHiZLevelCount;      // 0なら階層Zで判定しない
+uniform ivec3 uHiZLevels[16];    // 段ごとの幅、高さ、先頭
+
+vec3 Corner(Object object, int i)
+{
+    return vec3((i & 1) != 0 ? object.boxMax.x : object.boxMin.x,
+                (i & 2) != 0 ? object.boxMax.y : object.boxMin.y,
+                (i & 4) != 0 ? object.boxMax.z : object.boxMin.z);
+}
+
+// 視錐台の判定（いずれかの面の外側に8頂点とも入っていれば見えない）
+bool IsBoxVisible(mat4 m, Object object)
+{
+    int outside[6] = int[6](0, 0, 0, 0, 0, 0);
+    for (int i = 0; i < 8; i++)
+    {
+        vec4 c = m * vec4(Corner(object, i), 1.0);
+        if (c.w + c.x < 0.0) outside[0]++;
+        if (c.w - c.x < 0.0) outside[1]++;
+        if (c.w + c.y < 0.0) outside[2]++;
+        if (c.w - c.y < 0.0) outside[3]++;
+        if (c.w + c.z < 0.0) outside[4]++;
+        if (c.w - c.z < 0.0) outside[5]++;
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        if (outside[i] == 8) return false;
+    }
+    return true;
+}
+
+float HiZDepth(int level, int x, int y)
+{
+    ivec3 info = uHiZLevels[level];
+    return hizDepth[info.z + y * info.x + x];
+}
+
+// 階層Zの判定（HiZBuffer::IsBoxOccludedと同じ）
+bool IsBoxOccluded(mat4 world, Object object)
+{
+    mat4 m = uHiZViewProjection * world;
+    float minX = 1.0, maxX = -1.0, minY = 1.0, maxY = -1.0;
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++)
+    {
+        vec4 c = m * vec4(Corner(object, i), 1.0);
+        // ニアクリップ面より手前にはみ出す
+        if (c.w <= 0.0 || c.z < -c.w) return false;
+        float invW = 1.0 / c.w;
+        minX = min(minX, c.x * invW);
+        maxX = max(maxX, c.x * invW);
+        minY = min(minY, c.y * invW);
+        maxY = max(maxY, c.y * invW);
+        nearest = min(nearest, c.z * invW * 0.5 + 0.5);
+    }
+    // 画面外の部分は深度が無いため判定しない
+    if (minX < -1.0 || maxX > 1.0 || minY < -1.0 || maxY > 1.0) return false;
+
+    int width = uHiZLevels[0].x;
+    int height = uHiZLevels[0].y;
+    int x0 = min(width - 1, int((minX * 0.5 + 0.5) * float(width)));
+    int x1 = min(width - 1, int((maxX * 0.5 + 0.5) * float(width)));
+    int y0 = min(height - 1, int((minY * 0.5 + 0.5) * float(height)));
+    int y1 = min(height - 1, int((maxY * 0.5 + 0.5) * float(height)));
+
+    // 矩形が2x2画素以内に収まる段を選ぶ
+    int level = 0;
+    while (level < uHiZLevelCount - 1
+           && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+    {
+        level++;
+    }
+    float farthest = 0.0;
+    for (int y = y0 >> level; y <= (y1 >> level); y++)
+    {
+        for (int x = x0 >> level; x <= (x1 >> level); x++)
+        {
+            farthest = max(farthest, HiZDepth(level, x, y));
+        }
+    }
+    return nearest > farthest;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uObjectCount) return;
+
+    Object object = objects[index];
+    mat4 world = transpose(transforms[index]);
+    if (!IsBoxVisible(uViewProjection * world, object)) return;
+    if (uHiZLevelCount > 0 && IsBoxOccluded(world, object)) return;
+
+    // まとまりの領域に詰めて書き込む
+    uint slot = atomicAdd(drawCounts[object.batch], 1u);
+    uint command = (batchOffsets[object.batch] + slot) * 5u;
+    commands[command + 0u] = object.indexCount;
+    commands[command + 1u] = 1u;
+    commands[command + 2u] = object.firstIndex;
+    commands[command + 3u] = uint(object.baseVertex);
+    commands[command + 4u] = index; // ワールド行列の番号
+}
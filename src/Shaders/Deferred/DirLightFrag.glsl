@@ -0,0 +1,41 @@
+#version 330
+// ディファード 平行光源、環境光パス
+// *画面全体を1回描画し、ライティング無しの画素はアルベドをそのまま出力する
+
+#include "Include/Lighting.glsl"
+#include "Deferred/GBuffer.glsl"
+
+in vec2 fragTexCoord; // UV座標
+
+out vec4 outColor;
+
+void main() {
+    float depth = texture(uGDepth, fragTexCoord).r;
+    if (depth >= 1.0) discard; // 背景
+    vec4 albedo = texture(uGAlbedo, fragTexCoord);
+    vec4 normal = texture(uGNormal, fragTexCoord);
+    if (normal.w == 0.0)
+    {
+        outColor = albedo;
+        return;
+    }
+
+    vec3 N = normalize(normal.xyz);
+    vec3 L = normalize(-uDirLight.mDirection);
+    vec3 light = uAmbientColor; // ka
+    float NdotL = dot(N, L);
+    if (NdotL > 0)
+    {
+        vec3 worldPos = ReconstructWorldPos(fragTexCoord, depth);
+        vec3 direct = uDirLight.mDiffuseColor * NdotL; // kd * N・L
+        // フォンのみ鏡面反射
+        if (normal.w >= 1.0)
+        {
+            vec3 V = normalize(uCameraPos - worldPos);
+            vec3 R = normalize(reflect(-L, N));
+            direct += uDirLight.mSpecColor * pow(max(0.0, dot(R, V)), normal.w); // ks * (R・V)^a
+        }
+        light += direct * CalcShadow(N, worldPos);
+    }
+    outColor = vec4(albedo.rgb * light, albedo.a);
+}
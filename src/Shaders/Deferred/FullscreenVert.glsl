@@ -0,0 +1,11 @@
+#version 330
+// 画面全体を覆う三角形
+// *頂点バッファは使わず、gl_VertexID(0〜2)から座標を生成する
+
+out vec2 fragTexCoord; // UV座標
+
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    fragTexCoord = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,15 @@
+// Gバッファの参照処理
+// *ディファードのライティングパスで共有する
+
+uniform sampler2D uGAlbedo; // アルベド
+uniform sampler2D uGNormal; // 法線、反射モデル（0: 無し、0.5: ランバート、1以上: フォンの鏡面反射指数）
+uniform sampler2D uGDepth;  // 深度
+uniform mat4 uInvViewProjection; // ビュー射影行列の逆行列
+
+// 深度からワールド座標を復元
+vec3 ReconstructWorldPos(vec2 uv, float depth)
+{
+    vec4 clip = vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = uInvViewProjection * clip;
+    return world.xyz / world.w;
+}
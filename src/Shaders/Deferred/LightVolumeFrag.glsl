@@ -0,0 +1,30 @@
+#version 330
+// ディファード ライトボリューム
+// *ボリュームが覆う画素だけを加算合成でライティングする
+
+#include "Include/Lighting.glsl"
+#include "Deferred/GBuffer.glsl"
+
+uniform vec2 uScreenSize; // 画面サイズ
+
+flat in vec4 fragPosRadius;
+flat in vec4 fragColorCone;
+flat in vec4 fragDirInner;
+
+out vec4 outColor;
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / uScreenSize;
+    float depth = texture(uGDepth, uv).r;
+    vec4 normal = texture(uGNormal, uv);
+    if (depth >= 1.0 || normal.w == 0.0) discard;
+
+    vec3 N = normalize(normal.xyz);
+    vec3 worldPos = ReconstructWorldPos(uv, depth);
+    vec3 V = normalize(uCameraPos - worldPos);
+    vec3 diffuse = vec3(0.0);
+    vec3 specular = vec3(0.0);
+    EvalLocalLight(fragPosRadius, fragColorCone, fragDirInner,
+                   N, worldPos, V, normal.w, normal.w >= 1.0, diffuse, specular);
+    outColor = vec4(texture(uGAlbedo, uv).rgb * (diffuse + specular), 0.0);
+}
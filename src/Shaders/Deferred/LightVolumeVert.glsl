@@ -0,0 +1,22 @@
+#version 330
+// ディファード ライトボリューム
+// *単位球を光源ごとのインスタンスとして影響半径まで拡大する
+
+uniform mat4 uViewProjection; // ビュー射影行列
+
+layout(location = 0) in vec3 inPosition;  // 単位球の位置座標
+layout(location = 1) in vec4 inPosRadius; // 光源の位置、半径
+layout(location = 2) in vec4 inColorCone; // 色、照射角のcos
+layout(location = 3) in vec4 inDirInner;  // 向き、減衰開始角のcos
+
+flat out vec4 fragPosRadius;
+flat out vec4 fragColorCone;
+flat out vec4 fragDirInner;
+
+void main() {
+    vec3 worldPos = inPosRadius.xyz + inPosition * inPosRadius.w;
+    gl_Position = uViewProjection * vec4(worldPos, 1.0);
+    fragPosRadius = inPosRadius;
+    fragColorCone = inColorCone;
+    fragDirInner = inDirInner;
+}
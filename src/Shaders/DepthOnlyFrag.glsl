@@ -0,0 +1,6 @@
+#version 330
+// 深度プリパス用フラグメントシェーダ
+// *深度のみ書き込むため出力は無い
+
+void main() {
+}
@@ -0,0 +1,35 @@
+#version 330
+// 深度プリパス用頂点シェーダ
+// *位置座標のみの頂点配列を使う
+// *カラーパスをGL_EQUALで描画するため、UberVert.glslと同じ計算順序でクリップ座標を求める
+// *INSTANCINGではワールド変換座標を頂点属性から取得する（間接描画でまとめて描画する場合）
+// *SKINNINGではボーン番号、重みを含む頂点配列を使い、UberVert.glslと同じ順にボーン行列を掛ける
+
+uniform mat4 uViewProjection; // ビュー射影行列
+#ifndef INSTANCING
+uniform mat4 uWorldTransform; // ワールド変換座標
+#endif
+
+layout(location = 0) in vec3 inPosition; // 位置座標
+#ifdef INSTANCING
+layout(location = 3) in mat4 inWorldTransform; // ワールド変換座標（3〜6を使用、行優先のまま転送）
+#endif
+#ifdef SKINNING
+#include "Include/Skinning.glsl"
+#endif
+
+invariant gl_Position;
+
+void main() {
+#ifdef INSTANCING
+    mat4 world = transpose(inWorldTransform);
+#else
+    mat4 world = uWorldTransform;
+#endif
+    vec4 pos = vec4(inPosition, 1.0);
+#ifdef SKINNING
+    pos = GetSkinMatrix() * pos;
+#endif
+    vec4 worldPos = world * pos;
+    gl_Position = uViewProjection * worldPos;
+}
@@ -0,0 +1,160 @@
+// ライティング共通処理
+// *LambertとPhongで共有する
+// *点光源、スポットライトはクラスタに割り当てられたものだけをループする
+
+uniform vec3 uCameraPos;    // カメラ座標
+uniform float uSpecPower;   // 鏡面反射指数 a
+uniform vec3 uAmbientColor; // 環境色 ka
+
+// 平行光源
+struct DirectionalLight
+{
+    vec3 mDirection;    // 向き
+    vec3 mDiffuseColor; // 拡散反射色 kd
+    vec3 mSpecColor;    // 鏡面反射色 ks
+};
+uniform DirectionalLight uDirLight;
+
+// クラスタードライティング（ClusteredLightingクラスが設定）
+uniform samplerBuffer uLightData;     // 光源データ（1光源につき3テクセル）
+uniform usamplerBuffer uClusterGrid;  // クラスタごとの(開始位置, 数)
+uniform usamplerBuffer uLightIndices; // 光源番号リスト
+uniform ivec3 uClusterDims;           // クラスタ分割数(タイルX, タイルY, スライス)
+uniform vec2 uClusterTileSize;        // タイルのピクセルサイズ
+uniform vec2 uClusterZParams;         // log(z) * x + y = スライス番号
+uniform vec4 uViewZRow;               // ビュー行列のZ行
+
+// 平行光源の影（CascadedShadowMapクラスが設定）
+uniform sampler2DArrayShadow uShadowMap;            // カスケードごとのレイヤー
+uniform mat4 uShadowMatrices[MAX_SHADOW_CASCADES];  // ワールド -> シャドウマップ(uv, 深度)
+uniform vec4 uShadowNormalOffsets;                  // 法線方向のずらし量（カスケードごと）
+uniform int uShadowCascadeCount;                    // 0なら影無し
+uniform float uShadowTexelSize;                     // 1テクセルのuv
+
+// 平行光源が届く割合（1: 影無し）
+// *範囲に収まる最も手前のカスケードを選び、3x3のPCFで平均する
+float CalcShadow(vec3 N, vec3 worldPos)
+{
+    for (int i = 0; i < uShadowCascadeCount; i++)
+    {
+        vec4 coord = uShadowMatrices[i] * vec4(worldPos + N * uShadowNormalOffsets[i], 1.0);
+        // PCFで隣のテクセルも読むため1テクセル内側に収まるものを選ぶ
+        if (any(lessThan(coord.xy, vec2(uShadowTexelSize))) ||
+            any(greaterThan(coord.xy, vec2(1.0 - uShadowTexelSize))) ||
+            coord.z > 1.0)
+        {
+            continue;
+        }
+        float lit = 0.0;
+        for (int y = -1; y <= 1; y++)
+        {
+            for (int x = -1; x <= 1; x++)
+            {
+                lit += texture(uShadowMap, vec4(coord.xy + vec2(x, y) * uShadowTexelSize, float(i), coord.z));
+            }
+        }
+        return lit / 9.0;
+    }
+    return 1.0;
+}
+
+// フラグメントが属するクラスタ番号
+int GetClusterIndex(vec3 worldPos)
+{
+    float viewZ = dot(uViewZRow, vec4(worldPos, 1.0));
+    int slice = clamp(int(log(max(viewZ, 1e-4)) * uClusterZParams.x + uClusterZParams.y), 0, uClusterDims.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / uClusterTileSize), ivec2(0), uClusterDims.xy - 1);
+    return (slice * uClusterDims.y + tile.y) * uClusterDims.x + tile.x;
+}
+
+// 点光源、スポットライト1つ分の拡散反射・鏡面反射を加算
+// *ディファードのライトボリュームと共有する
+void EvalLocalLight(vec4 posRadius, vec4 colorCone, vec4 dirInner,
+                    vec3 N, vec3 worldPos, vec3 V, float specPower, bool useSpecular,
+                    inout vec3 diffuse, inout vec3 specular)
+{
+    vec3 toLight = posRadius.xyz - worldPos;
+    float dist = length(toLight);
+    if (dist >= posRadius.w) return;
+    vec3 L = toLight / dist;
+    float NdotL = dot(N, L);
+    if (NdotL <= 0.0) return;
+
+    // 半径で0になる距離減衰
+    float atten = 1.0 - dist / posRadius.w;
+    atten *= atten;
+    // スポットライトの角度減衰（点光源は照射角のcosが-2）
+    if (colorCone.w >= -1.0)
+    {
+        atten *= smoothstep(colorCone.w, dirInner.w, dot(-L, dirInner.xyz));
+    }
+
+    diffuse += colorCone.rgb * NdotL * atten;
+    if (useSpecular)
+    {
+        vec3 R = normalize(reflect(-L, N));
+        specular += colorCone.rgb * pow(max(0.0, dot(R, V)), specPower) * atten;
+    }
+}
+
+// クラスタ内の点光源、スポットライトの拡散反射・鏡面反射を加算
+void CalcLocalLights(vec3 N, vec3 worldPos, vec3 V, bool useSpecular,
+                     inout vec3 diffuse, inout vec3 specular)
+{
+    uvec2 cluster = texelFetch(uClusterGrid, GetClusterIndex(worldPos)).xy;
+    for (uint i = 0u; i < cluster.y; i++)
+    {
+        int light = int(texelFetch(uLightIndices, int(cluster.x + i)).x) * 3;
+        EvalLocalLight(texelFetch(uLightData, light),     // 位置、半径
+                       texelFetch(uLightData, light + 1), // 色、照射角のcos
+                       texelFetch(uLightData, light + 2), // 向き、減衰開始角のcos
+                       N, worldPos, V, uSpecPower, useSpecular, diffuse, specular);
+    }
+}
+
+// ランバート反射モデル
+vec3 CalcLambert(vec3 N, vec3 worldPos)
+{
+    vec3 L = normalize(-uDirLight.mDirection); // 表面→光源
+
+    // ベースとなる環境色を設定
+    vec3 Lambert = uAmbientColor; // ka
+    // N・Lが0より大きい場合
+    float NdotL = dot(N, L);
+    if (NdotL > 0)
+    {
+        // 拡散反射色を加える（影の部分は環境色のみ）
+        Lambert += uDirLight.mDiffuseColor * NdotL * CalcShadow(N, worldPos); // kd * N・L
+    }
+
+    // 点光源、スポットライト
+    vec3 specular = vec3(0.0);
+    CalcLocalLights(N, worldPos, vec3(0.0), false, Lambert, specular);
+    return Lambert;
+}
+
+// フォン反射モデル
+vec3 CalcPhong(vec3 N, vec3 worldPos)
+{
+    vec3 L = normalize(-uDirLight.mDirection);  // 表面→光源
+    vec3 V = normalize(uCameraPos - worldPos);  // 表面→視点
+    vec3 R = normalize(reflect(-L, N));         // Nを軸としてLを反射させたもの
+
+    // ベースとなる環境色を設定
+    vec3 Phong = uAmbientColor; // ka
+    // N・Lが0より大きい場合
+    float NdotL = dot(N, L);
+    if (NdotL > 0)
+    {
+        // 拡散反射色、鏡面反射色を加える
+        vec3 Diffuse = uDirLight.mDiffuseColor * NdotL; // kd * N・L
+        vec3 Specular = uDirLight.mSpecColor * pow(max(0.0, dot(R, V)), uSpecPower); // ks * (R・V)^a
+        Phong += (Diffuse + Specular) * CalcShadow(N, worldPos);
+    }
+
+    // 点光源、スポットライト
+    vec3 localDiffuse = vec3(0.0);
+    vec3 localSpecular = vec3(0.0);
+    CalcLocalLights(N, worldPos, V, true, localDiffuse, localSpecular);
+    return Phong + localDiffuse + localSpecular;
+}
@@ -0,0 +1,29 @@
+// スキニング共通処理
+// *ボーン行列パレットは全メッシュ分を1つのテクスチャバッファに並べる（1関節あたり行優先の3x4行列、3テクセル）
+// *uSkinPaletteOffsetはこのメッシュのパレットの先頭の関節番号
+
+uniform samplerBuffer uSkinPalette; // ボーン行列パレット
+uniform int uSkinPaletteOffset;     // このメッシュのパレットの先頭
+
+layout(location = 7) in uvec4 inSkinBones;  // ボーン番号
+layout(location = 8) in vec4 inSkinWeights; // ボーンの重み（合計1）
+
+// ボーン行列（3行を読み、4行目は(0, 0, 0, 1)とする）
+mat4 GetBoneMatrix(uint bone)
+{
+    int texel = (uSkinPaletteOffset + int(bone)) * 3;
+    vec4 row0 = texelFetch(uSkinPalette, texel);
+    vec4 row1 = texelFetch(uSkinPalette, texel + 1);
+    vec4 row2 = texelFetch(uSkinPalette, texel + 2);
+    return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+// ボーン行列を重み付きで合成する
+// *深度プリパスとカラーパスで同じ深度になるよう、どちらもこの関数で合成する
+mat4 GetSkinMatrix()
+{
+    return GetBoneMatrix(inSkinBones.x) * inSkinWeights.x
+         + GetBoneMatrix(inSkinBones.y) * inSkinWeights.y
+         + GetBoneMatrix(inSkinBones.z) * inSkinWeights.z
+         + GetBoneMatrix(inSkinBones.w) * inSkinWeights.w;
+}
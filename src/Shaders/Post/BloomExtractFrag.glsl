@@ -0,0 +1,18 @@
+#version 330
+// ブルーム 輝度抽出
+// *縦横1/2のバッファに描画し、元の2x2画素の境界を線形補間で1回読むことで平均を取る
+// *しきい値を超えた分だけを残す（色味は保つ）
+
+uniform sampler2D uSource;
+uniform float uThreshold; // 輝度のしきい値
+
+in vec2 fragTexCoord; // UV座標
+
+out vec4 outColor;
+
+void main() {
+    vec3 color = texture(uSource, fragTexCoord).rgb;
+    float brightness = max(color.r, max(color.g, color.b));
+    float contribution = max(brightness - uThreshold, 0.0) / max(brightness, 1e-4);
+    outColor = vec4(color * contribution, 1.0);
+}
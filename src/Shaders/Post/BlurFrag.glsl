@@ -0,0 +1,25 @@
+#version 330
+// ガウスぼかし（1方向）
+// *9タップのガウス分布を、線形補間で隣り合う2画素をまとめて読むことで5回の読み込みで行う
+
+uniform sampler2D uSource;
+uniform vec2 uInvSourceSize;
+uniform vec2 uDirection; // (1, 0)で横、(0, 1)で縦
+
+in vec2 fragTexCoord; // UV座標
+
+out vec4 outColor;
+
+const float OFFSETS[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float WEIGHTS[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+void main() {
+    vec2 texelStep = uDirection * uInvSourceSize;
+    vec3 color = texture(uSource, fragTexCoord).rgb * WEIGHTS[0];
+    for (int i = 1; i < 3; i++)
+    {
+        color += texture(uSource, fragTexCoord + texelStep * OFFSETS[i]).rgb * WEIGHTS[i];
+        color += texture(uSource, fragTexCoord - texelStep * OFFSETS[i]).rgb * WEIGHTS[i];
+    }
+    outColor = vec4(color, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330
+// コピー（線形補間で出力の解像度へ拡大）
+
+uniform sampler2D uSource;
+
+in vec2 fragTexCoord; // UV座標
+
+out vec4 outColor;
+
+void main() {
+    outColor = vec4(texture(uSource, fragTexCoord).rgb, 1.0);
+}
@@ -0,0 +1,47 @@
+#version 330
+// FXAA
+// *周囲4画素の輝度の勾配から輪郭の向きを求め、その方向に沿って読んだ色を混ぜる
+// *入力の解像度で計算するため、内部解像度から出力の解像度への拡大を兼ねる
+
+uniform sampler2D uSource;
+uniform vec2 uInvSourceSize;
+
+in vec2 fragTexCoord; // UV座標
+
+out vec4 outColor;
+
+const float SPAN_MAX = 8.0;           // 読む範囲の最大（画素）
+const float REDUCE_MUL = 1.0 / 8.0;   // 暗い部分で方向を鈍らせる割合
+const float REDUCE_MIN = 1.0 / 128.0;
+
+float Luma(vec3 color) {
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+void main() {
+    vec2 uv = fragTexCoord;
+    vec2 texel = uInvSourceSize;
+    vec3 rgbM = texture(uSource, uv).rgb;
+    float lumaNW = Luma(texture(uSource, uv + vec2(-1.0, -1.0) * texel).rgb);
+    float lumaNE = Luma(texture(uSource, uv + vec2( 1.0, -1.0) * texel).rgb);
+    float lumaSW = Luma(texture(uSource, uv + vec2(-1.0,  1.0) * texel).rgb);
+    float lumaSE = Luma(texture(uSource, uv + vec2( 1.0,  1.0) * texel).rgb);
+    float lumaM = Luma(rgbM);
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    // 輪郭に沿う方向
+    vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)),
+                     ((lumaNW + lumaSW) - (lumaNE + lumaSE)));
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * REDUCE_MUL), REDUCE_MIN);
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+    dir = clamp(dir * rcpDirMin, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texel;
+
+    vec3 rgbA = 0.5 * (texture(uSource, uv + dir * (1.0 / 3.0 - 0.5)).rgb
+                     + texture(uSource, uv + dir * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(uSource, uv - dir * 0.5).rgb
+                                   + texture(uSource, uv + dir * 0.5).rgb);
+    // 広く読みすぎて別の物体の色が混ざった場合は狭い方を使う
+    float lumaB = Luma(rgbB);
+    outColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330
+// トーンマップ
+// *ブルームを加算し、露出を掛けてACES近似のカーブで0〜1に収める
+
+uniform sampler2D uSource;
+uniform sampler2D uBloom;
+uniform float uExposure;       // 露出
+uniform float uBloomIntensity; // ブルームの強さ（0でブルーム無し）
+
+in vec2 fragTexCoord; // UV座標
+
+out vec4 outColor;
+
+vec3 ACESFilm(vec3 x) {
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main() {
+    vec3 color = texture(uSource, fragTexCoord).rgb;
+    if (uBloomIntensity > 0.0)
+    {
+        color += texture(uBloom, fragTexCoord).rgb * uBloomIntensity;
+    }
+    outColor = vec4(ACESFilm(color * uExposure), 1.0);
+}
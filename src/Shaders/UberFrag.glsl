@@ -0,0 +1,51 @@
+#version 330
+// フラグメントシェーダ（全バリアント共通）
+// *機能はShaderクラスが挿入する#defineで切り替える
+//  TEXTURE        : テクスチャ色を使用（無い場合は青色）
+//  LIGHTING_LAMBERT: ランバート反射モデル
+//  LIGHTING_PHONG : フォン反射モデル
+//  GBUFFER        : ライティングせずにGバッファ（アルベド、法線）へ出力
+
+#if defined(LIGHTING_LAMBERT) || defined(LIGHTING_PHONG)
+#include "Include/Lighting.glsl"
+#endif
+
+uniform sampler2D uTexture; // テクスチャ（自動で設定される）
+
+in vec2 fragTexCoord; // UV座標
+in vec3 fragNormal;   // 法線座標
+in vec3 fragWorldPos; // ワールド座標
+
+#ifdef GBUFFER
+layout(location = 0) out vec4 outColor;  // アルベド
+layout(location = 1) out vec4 outNormal; // 法線、反射モデル（0: 無し、0.5: ランバート、1以上: フォンの鏡面反射指数）
+#else
+out vec4 outColor;
+#endif
+
+void main() {
+#ifdef TEXTURE
+    vec4 color = texture(uTexture, fragTexCoord);
+#else
+    vec4 color = vec4(0.0, 0.0, 1.0, 1.0); // 青色
+#endif
+
+#if defined(GBUFFER)
+    // ライティングはスクリーン空間で行う
+    outColor = color;
+  #if defined(LIGHTING_PHONG)
+    outNormal = vec4(normalize(fragNormal), max(uSpecPower, 1.0));
+  #elif defined(LIGHTING_LAMBERT)
+    outNormal = vec4(normalize(fragNormal), 0.5);
+  #else
+    outNormal = vec4(0.0);
+  #endif
+    return;
+#elif defined(LIGHTING_PHONG)
+    // テクスチャ色 * 反射色
+    color *= vec4(CalcPhong(normalize(fragNormal), fragWorldPos), 1.0f);
+#elif defined(LIGHTING_LAMBERT)
+    color *= vec4(CalcLambert(normalize(fragNormal), fragWorldPos), 1.0f);
+#endif
+    outColor = color;
+}
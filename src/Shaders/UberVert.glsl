@@ -0,0 +1,54 @@
+#version 330
+// 頂点シェーダ（全バリアント共通）
+// *機能はShaderクラスが挿入する#defineで切り替える
+//  INSTANCING: インスタンスごとのワールド変換座標を頂点属性から取得
+//  SKINNING  : ボーン行列パレット（テクスチャバッファ）によるスキニング
+
+uniform mat4 uViewProjection; // ビュー射影行列
+#ifndef INSTANCING
+uniform mat4 uWorldTransform; // ワールド変換座標
+#endif
+
+layout(location = 0) in vec3 inPosition; // 位置座標
+layout(location = 1) in vec3 inNormal;   // 法線座標
+layout(location = 2) in vec2 inTexCoord; // UV座標
+#ifdef INSTANCING
+layout(location = 3) in mat4 inWorldTransform; // ワールド変換座標（3〜6を使用、行優先のまま転送）
+#endif
+#ifdef SKINNING
+#include "Include/Skinning.glsl"
+#endif
+
+out vec2 fragTexCoord; // UV座標
+out vec3 fragNormal;   // 法線座標
+out vec3 fragWorldPos; // ワールド座標
+// 深度プリパス（DepthOnlyVert.glsl）と同じ深度になるよう最適化による誤差を禁止
+invariant gl_Position;
+
+void main() {
+#ifdef INSTANCING
+    mat4 world = transpose(inWorldTransform);
+#else
+    mat4 world = uWorldTransform;
+#endif
+
+    // w成分を加える
+    vec4 pos = vec4(inPosition, 1.0);
+    vec4 normal = vec4(inNormal, 0.0);
+#ifdef SKINNING
+    mat4 skin = GetSkinMatrix();
+    pos = skin * pos;
+    normal = skin * normal;
+#endif
+
+    // ローカル座標 * ワールド変換座標 * ビュー射影行列
+    // を逆に計算して、クリップ空間座標に変換
+    vec4 worldPos = world * pos;
+    gl_Position = uViewProjection * worldPos;
+
+    // テクスチャ情報を設定
+    fragTexCoord = inTexCoord;
+    // ワールド座標に変換する
+    fragNormal = (world * normal).xyz;
+    fragWorldPos = worldPos.xyz;
+}
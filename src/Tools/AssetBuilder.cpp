@@ -0,0 +1,451 @@
+#include <SDL.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Commons/AssetPack.h"
+#include "../Commons/DDSFile.h"
+#include "../Commons/FbxMeshImporter.h"
+#include "../Commons/FileSystem.h"
+#include "../Commons/JobSystem.h"
+#include "../Commons/MeshFile.h"
+#include "../Commons/TextureCook.h"
+
+// アセット変換ツール（差分ビルド）
+// *Assets以下のFBXを変換済メッシュ(.mesh)に、画像をミップマップ付きのDDSに変換する（ゲームは変換済があればそちらを読む）
+// *FBXはマテリアルが参照するテクスチャ（Mesh::Loadで読むもの）に依存する
+//  対象のFBXを変換すると参照先のテクスチャも対象に加え、依存先を順に段ごとに変換する
+// *ソースの内容のハッシュと変換の設定から変換のキーを作り、前回と同じキーで成果物が残っていれば変換しない
+//  （更新時刻とサイズが前回と同じソースはハッシュも計算し直さない）
+// *変換結果はキーをファイル名としてローカルのキャッシュに保存する
+//  内容を前に戻したソースや、別の作業場所での同じソースはキャッシュからコピーするだけで済む
+// *ハッシュの計算と変換はジョブシステムで全てのコアに分けて並列に行う
+// 使い方: AssetBuilder <assets dir> [target ...] [--cache dir] [--rebuild]
+//         targetはassets dirからの相対パス（省略すると全てのFBXと画像）
+namespace
+{
+    // 変換の設定（処理や成果物の形式を変えたら番号を上げ、以前の変換結果を使わないようにする）
+    const char* MESH_COOK_SETTINGS = "mesh 1";
+    const char* TEXTURE_COOK_SETTINGS = "texture 1 auto-format mips";
+
+    // 前回のビルドの記録
+    const uint32_t MANIFEST_MAGIC = 0x444C4241; // "ABLD"
+    const uint32_t MANIFEST_VERSION = 1;
+    const char* MANIFEST_FILE_NAME = "manifest";
+
+    enum AssetType
+    {
+        ASSET_MESH,    // FBX -> .mesh
+        ASSET_TEXTURE, // 画像 -> .dds
+    };
+
+    enum State
+    {
+        STATE_UP_TO_DATE, // 前回の成果物のまま
+        STATE_CACHED,     // キャッシュからコピー
+        STATE_COOKED,     // 変換した
+        STATE_FAILED,
+        STATE_MISSING,    // ソースが無い
+    };
+    const char* STATE_NAMES[] = { "up-to-date", "cached", "cooked", "failed", "missing" };
+
+    // ソース1つ分の記録
+    struct Record
+    {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t contentHash;  // ソースの内容のハッシュ
+        uint64_t cookKey;      // 変換のキー（内容のハッシュと設定から）
+        uint64_t productSize;  // 成果物のサイズと更新時刻（消された、書き換えられたら変換し直す）
+        int64_t productTime;
+        std::vector<std::string> dependencies; // 依存先のソース（ルートからの相対パス）
+    };
+
+    // 依存グラフのノード（今回のビルドの対象）
+    struct Node
+    {
+        std::string path;     // ルートからの相対パス
+        std::string referrer; // 依存元（対象に加えたソース、直接の対象なら空）
+        int type;             // AssetType
+        int state;            // State
+        float cookMs;
+        Record record;        // 今回の結果
+    };
+
+    // 拡張子から種類を決める（対象外なら-1）
+    int GetAssetType(const std::string& path)
+    {
+        std::string::size_type dot = path.find_last_of('.');
+        if (dot == std::string::npos) return -1;
+        std::string ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (ext == "fbx") return ASSET_MESH;
+        if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "tga" || ext == "bmp") return ASSET_TEXTURE;
+        return -1;
+    }
+
+    float GetElapsedMs(Uint64 startCounter)
+    {
+        return (SDL_GetPerformanceCounter() - startCounter) * 1000.0f / SDL_GetPerformanceFrequency();
+    }
+
+    // ファイルのコピー（一時ファイルに書いてから置き換え、途中で止まっても壊れたファイルを残さない）
+    // *同じ内容のソースは同じキャッシュに書くため、一時ファイルは書込元ごとに分ける
+    bool CopyLooseFile(const std::string& srcPath, const std::string& dstPath, const std::string& tempSuffix)
+    {
+        FileSystem::File file;
+        if (!FileSystem::ReadLooseFile(srcPath, file)) return false;
+        const std::string tempPath = dstPath + "." + tempSuffix + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+            if (!out) return false;
+        }
+        std::remove(dstPath.c_str());
+        return std::rename(tempPath.c_str(), dstPath.c_str()) == 0;
+    }
+
+    void WriteString(std::ofstream& file, const std::string& text)
+    {
+        uint32_t length = static_cast<uint32_t>(text.size());
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(text.data(), length);
+    }
+
+    bool ReadString(std::ifstream& file, std::string& outText)
+    {
+        uint32_t length = 0;
+        if (!file.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > 4096) return false;
+        outText.resize(length);
+        return static_cast<bool>(file.read(&outText[0], length));
+    }
+
+    // 差分ビルド
+    class AssetBuilder
+    {
+    public:
+        AssetBuilder(const std::string& rootPath, const std::string& cachePath, bool isRebuild, JobSystem* jobSystem)
+        :mRootPath(rootPath)
+        ,mCachePath(cachePath)
+        ,mIsRebuild(isRebuild)
+        ,mJobSystem(jobSystem)
+        {}
+
+        // 対象の追加（既にあれば何もしない）
+        void AddNode(const std::string& path, const std::string& referrer)
+        {
+            if (mNodeIndices.count(path) > 0) return;
+            Node node;
+            node.path = path;
+            node.referrer = referrer;
+            node.type = GetAssetType(path);
+            node.state = STATE_FAILED;
+            node.cookMs = 0.0f;
+            node.record = Record();
+            mNodeIndices[path] = mNodes.size();
+            mNodes.emplace_back(node);
+        }
+
+        // 依存先を段ごとに変換する
+        // *同じ段のノードは並列に処理し、変換して分かった依存先を次の段に加える
+        void Build()
+        {
+            size_t begin = 0;
+            while (begin < mNodes.size())
+            {
+                const size_t end = mNodes.size();
+                mJobSystem->ParallelFor(end - begin, 1, [&](size_t first, size_t last) {
+                    for (size_t i = first; i < last; i++) BuildNode(mNodes[begin + i]);
+                });
+                for (size_t i = begin; i < end; i++)
+                {
+                    // 追加するとmNodesが再確保されるため、依存先とパスをコピーしてから追加する
+                    const std::vector<std::string> dependencies = mNodes[i].record.dependencies;
+                    const std::string referrer = mNodes[i].path;
+                    for (const auto& dependency : dependencies) AddNode(dependency, referrer);
+                }
+                begin = end;
+            }
+        }
+
+        bool LoadManifest()
+        {
+            std::ifstream file(mCachePath + MANIFEST_FILE_NAME, std::ios::binary);
+            if (!file.is_open()) return false;
+            uint32_t header[3] = {};
+            file.read(reinterpret_cast<char*>(header), sizeof(header));
+            if (!file || header[0] != MANIFEST_MAGIC || header[1] != MANIFEST_VERSION) return false;
+            for (uint32_t i = 0; i < header[2]; i++)
+            {
+                std::string path;
+                Record record;
+                uint32_t dependencyCount = 0;
+                if (!ReadString(file, path)) return false;
+                file.read(reinterpret_cast<char*>(&record.sourceSize), sizeof(record.sourceSize));
+                file.read(reinterpret_cast<char*>(&record.sourceTime), sizeof(record.sourceTime));
+                file.read(reinterpret_cast<char*>(&record.contentHash), sizeof(record.contentHash));
+                file.read(reinterpret_cast<char*>(&record.cookKey), sizeof(record.cookKey));
+                file.read(reinterpret_cast<char*>(&record.productSize), sizeof(record.productSize));
+                file.read(reinterpret_cast<char*>(&record.productTime), sizeof(record.productTime));
+                file.read(reinterpret_cast<char*>(&dependencyCount), sizeof(dependencyCount));
+                if (!file || dependencyCount > 4096) return false;
+                record.dependencies.resize(dependencyCount);
+                for (auto& dependency : record.dependencies)
+                {
+                    if (!ReadString(file, dependency)) return false;
+                }
+                mRecords[path] = record;
+            }
+            return true;
+        }
+
+        // 今回の結果を記録に反映して保存（全体のビルドでは無くなったソースの記録を消す）
+        bool SaveManifest(bool isFullBuild)
+        {
+            if (isFullBuild)
+            {
+                for (auto iter = mRecords.begin(); iter != mRecords.end();)
+                {
+                    iter = mNodeIndices.count(iter->first) > 0 ? std::next(iter) : mRecords.erase(iter);
+                }
+            }
+            for (const auto& node : mNodes)
+            {
+                if (node.state == STATE_FAILED || node.state == STATE_MISSING) mRecords.erase(node.path);
+                else mRecords[node.path] = node.record;
+            }
+
+            // パス順に書き出す（同じ内容なら同じファイルになる）
+            std::vector<std::string> paths;
+            for (const auto& pair : mRecords) paths.emplace_back(pair.first);
+            std::sort(paths.begin(), paths.end());
+            const std::string manifestPath = mCachePath + MANIFEST_FILE_NAME;
+            std::ofstream file(manifestPath + ".tmp", std::ios::binary);
+            if (!file.is_open()) return false;
+            uint32_t header[3] = { MANIFEST_MAGIC, MANIFEST_VERSION, static_cast<uint32_t>(paths.size()) };
+            file.write(reinterpret_cast<const char*>(header), sizeof(header));
+            for (const auto& path : paths)
+            {
+                const Record& record = mRecords[path];
+                uint32_t dependencyCount = static_cast<uint32_t>(record.dependencies.size());
+                WriteString(file, path);
+                file.write(reinterpret_cast<const char*>(&record.sourceSize), sizeof(record.sourceSize));
+                file.write(reinterpret_cast<const char*>(&record.sourceTime), sizeof(record.sourceTime));
+                file.write(reinterpret_cast<const char*>(&record.contentHash), sizeof(record.contentHash));
+                file.write(reinterpret_cast<const char*>(&record.cookKey), sizeof(record.cookKey));
+                file.write(reinterpret_cast<const char*>(&record.productSize), sizeof(record.productSize));
+                file.write(reinterpret_cast<const char*>(&record.productTime), sizeof(record.productTime));
+                file.write(reinterpret_cast<const char*>(&dependencyCount), sizeof(dependencyCount));
+                for (const auto& dependency : record.dependencies) WriteString(file, dependency);
+            }
+            file.close();
+            if (!file) return false;
+            std::remove(manifestPath.c_str());
+            return std::rename((manifestPath + ".tmp").c_str(), manifestPath.c_str()) == 0;
+        }
+
+    private:
+        // ノード1つ分の処理（ワーカースレッドから呼ぶ、他のノードには触れない）
+        void BuildNode(Node& node)
+        {
+            Uint64 startCounter = SDL_GetPerformanceCounter();
+            const std::string sourcePath = mRootPath + node.path;
+            const std::string productPath = GetProductPath(node);
+            Record& record = node.record;
+            if (node.type < 0 || !FileSystem::GetFileStatus(sourcePath, record.sourceSize, record.sourceTime))
+            {
+                node.state = STATE_MISSING;
+                return;
+            }
+            auto iter = mRecords.find(node.path);
+            const Record* previous = !mIsRebuild && iter != mRecords.end() ? &iter->second : nullptr;
+
+            // 内容のハッシュ（更新時刻とサイズが前回と同じなら前回の値を使う）
+            if (previous && previous->sourceSize == record.sourceSize && previous->sourceTime == record.sourceTime)
+            {
+                record.contentHash = previous->contentHash;
+            }
+            else
+            {
+                FileSystem::File file;
+                if (!FileSystem::ReadLooseFile(sourcePath, file))
+                {
+                    node.state = STATE_MISSING;
+                    return;
+                }
+                record.contentHash = AssetPack::HashContent(file.GetData(), file.GetSize());
+            }
+            const char* settings = node.type == ASSET_MESH ? MESH_COOK_SETTINGS : TEXTURE_COOK_SETTINGS;
+            record.cookKey = AssetPack::HashContent(reinterpret_cast<const unsigned char*>(settings), strlen(settings),
+                                                    record.contentHash);
+
+            // 前回と同じキーで、成果物が前回のまま残っていれば変換しない
+            uint64_t productSize = 0;
+            int64_t productTime = 0;
+            if (previous && previous->cookKey == record.cookKey
+                && FileSystem::GetFileStatus(productPath, productSize, productTime)
+                && productSize == previous->productSize && productTime == previous->productTime)
+            {
+                record.productSize = productSize;
+                record.productTime = productTime;
+                record.dependencies = previous->dependencies;
+                node.state = STATE_UP_TO_DATE;
+                return;
+            }
+
+            // キャッシュにあればコピー、無ければ変換してキャッシュに保存する
+            const std::string cachePath = GetCachePath(node, record.cookKey);
+            const std::string tempSuffix = std::to_string(mNodeIndices.at(node.path));
+            MeshFile meshFile;
+            if (!mIsRebuild && CopyLooseFile(cachePath, productPath, tempSuffix)
+                && (node.type != ASSET_MESH || meshFile.Load(productPath)))
+            {
+                node.state = STATE_CACHED;
+            }
+            else if (Cook(node, sourcePath, productPath, meshFile))
+            {
+                node.state = STATE_COOKED;
+                if (!CopyLooseFile(productPath, cachePath, tempSuffix)) SDL_Log("Failed store asset cache. (%s)", cachePath.c_str());
+            }
+            else
+            {
+                node.state = STATE_FAILED;
+                return;
+            }
+            FileSystem::GetFileStatus(productPath, record.productSize, record.productTime);
+
+            // メッシュの依存先（マテリアルのテクスチャ、Mesh::Loadと同じくアセットのルートから）
+            record.dependencies.clear();
+            for (const auto& material : meshFile.GetMaterials())
+            {
+                const std::string& dependency = material.textureFileName;
+                if (std::find(record.dependencies.begin(), record.dependencies.end(), dependency) == record.dependencies.end())
+                {
+                    record.dependencies.emplace_back(dependency);
+                }
+            }
+            node.cookMs = GetElapsedMs(startCounter);
+        }
+
+        bool Cook(const Node& node, const std::string& sourcePath, const std::string& productPath, MeshFile& outMeshFile)
+        {
+            if (node.type == ASSET_MESH)
+            {
+                FbxMeshImporter importer;
+                return importer.Import(sourcePath, nullptr, 0, outMeshFile) && outMeshFile.Save(productPath);
+            }
+            std::vector<unsigned char> rgba;
+            int width = 0;
+            int height = 0;
+            if (!TextureCook::LoadRGBA(sourcePath, rgba, width, height))
+            {
+                SDL_Log("Failed load image. (%s)", sourcePath.c_str());
+                return false;
+            }
+            DDSFile dds;
+            TextureCook::Cook(rgba, width, height, -1, true, dds);
+            return dds.Save(productPath);
+        }
+
+        std::string GetProductPath(const Node& node) const
+        {
+            const std::string sourcePath = mRootPath + node.path;
+            return node.type == ASSET_MESH ? MeshFile::GetCookedPath(sourcePath) : DDSFile::GetCookedPath(sourcePath);
+        }
+
+        // キャッシュのファイル（変換のキーをファイル名とする）
+        std::string GetCachePath(const Node& node, uint64_t cookKey) const
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(cookKey));
+            return mCachePath + name + (node.type == ASSET_MESH ? ".mesh" : ".dds");
+        }
+
+        std::string mRootPath;
+        std::string mCachePath;
+        bool mIsRebuild;
+        JobSystem* mJobSystem;
+        std::vector<Node> mNodes;
+        std::unordered_map<std::string, size_t> mNodeIndices;
+        std::unordered_map<std::string, Record> mRecords; // 前回のビルドの記録（パス -> 記録）
+
+    public:
+        const std::vector<Node>& GetNodes() const { return mNodes; }
+
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: AssetBuilder <assets dir> [target ...] [--cache dir] [--rebuild]\n");
+        return 1;
+    }
+
+    // 引数解析
+    std::string rootPath = FileSystem::NormalizePath(argv[1]);
+    if (rootPath.back() != '/') rootPath += '/';
+    std::string cachePath = "../AssetCache/";
+    bool isRebuild = false;
+    std::vector<std::string> targets;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--cache" && i + 1 < argc) cachePath = FileSystem::NormalizePath(argv[++i]);
+        else if (arg == "--rebuild") isRebuild = true;
+        else targets.emplace_back(FileSystem::NormalizePath(arg));
+    }
+    if (cachePath.back() != '/') cachePath += '/';
+    FileSystem::MakeDirectory(cachePath);
+
+    // 対象の収集（指定が無ければルート以下の全てのFBXと画像）
+    JobSystem jobSystem;
+    AssetBuilder builder(rootPath, cachePath, isRebuild, &jobSystem);
+    const bool isFullBuild = targets.empty();
+    if (isFullBuild)
+    {
+        std::vector<std::string> paths;
+        FileSystem::ListFiles(rootPath, paths);
+        for (const auto& path : paths)
+        {
+            if (GetAssetType(path) >= 0) targets.emplace_back(path);
+        }
+    }
+    for (const auto& target : targets) builder.AddNode(target, "");
+    if (!isRebuild && !builder.LoadManifest()) printf("no build manifest, hashing all sources\n");
+
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    builder.Build();
+    const float buildMs = GetElapsedMs(startCounter);
+
+    // 結果の出力（変換したもの、失敗したものを1行ずつ）
+    int stateCounts[5] = {};
+    for (const auto& node : builder.GetNodes())
+    {
+        stateCounts[node.state]++;
+        if (node.state == STATE_UP_TO_DATE) continue;
+        if (node.state == STATE_MISSING && !node.referrer.empty())
+        {
+            printf("%-10s %s (referenced by %s)\n", STATE_NAMES[node.state], node.path.c_str(), node.referrer.c_str());
+        }
+        else if (node.state == STATE_COOKED)
+        {
+            printf("%-10s %s (%.1f ms)\n", STATE_NAMES[node.state], node.path.c_str(), node.cookMs);
+        }
+        else
+        {
+            printf("%-10s %s\n", STATE_NAMES[node.state], node.path.c_str());
+        }
+    }
+    if (!builder.SaveManifest(isFullBuild)) printf("failed write build manifest: %s\n", cachePath.c_str());
+    printf("%d assets: %d up-to-date, %d cached, %d cooked, %d failed, %d missing (%d threads, %.1f ms)\n",
+           static_cast<int>(builder.GetNodes().size()), stateCounts[STATE_UP_TO_DATE], stateCounts[STATE_CACHED],
+           stateCounts[STATE_COOKED], stateCounts[STATE_FAILED], stateCounts[STATE_MISSING],
+           jobSystem.GetThreadCount(), buildMs);
+    return stateCounts[STATE_FAILED] + stateCounts[STATE_MISSING] > 0 ? 1 : 0;
+}
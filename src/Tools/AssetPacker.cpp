@@ -0,0 +1,90 @@
+#include <SDL.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../Commons/AssetPack.h"
+#include "../Commons/FileSystem.h"
+#include "../Commons/JobSystem.h"
+
+// アセットパック作成ツール
+// *ディレクトリ以下の全てのファイルを1つのパックにまとめる（パック内のパスはディレクトリからの相対パス）
+// *ゲームはパックをアセット、シェーダのパスにマウントして読む（Game::Initialize）
+// 使い方: AssetPacker <root dir> <output.pak> [--no-compress] [--align N] [--verify]
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        printf("usage: AssetPacker <root dir> <output.pak> [--no-compress] [--align N] [--verify]\n");
+        return 1;
+    }
+
+    // 引数解析
+    std::string rootPath = argv[1];
+    std::string outputPath = argv[2];
+    bool compress = true;
+    bool verify = false;
+    uint32_t alignment = AssetPack::DEFAULT_ALIGNMENT;
+    for (int i = 3; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--no-compress") compress = false;
+        else if (arg == "--align" && i + 1 < argc) alignment = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--verify") verify = true;
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        printf("alignment must be a power of two: %u\n", alignment);
+        return 1;
+    }
+    rootPath = FileSystem::NormalizePath(rootPath);
+    if (rootPath.back() != '/') rootPath += '/';
+
+    // ファイル収集（パス順に並べ、パック内の配置を毎回同じにする）
+    std::vector<std::string> paths;
+    FileSystem::ListFiles(rootPath, paths);
+    std::vector<AssetPack::Source> sources;
+    for (const auto& path : paths) sources.push_back({ path, rootPath + path });
+    if (sources.empty())
+    {
+        printf("no files: %s\n", rootPath.c_str());
+        return 1;
+    }
+
+    // パック作成（ブロックの圧縮は並列）
+    JobSystem jobSystem;
+    AssetPack::WriteStats stats;
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    if (!AssetPack::Write(outputPath, sources, compress, alignment, &jobSystem, &stats))
+    {
+        printf("failed write pack: %s\n", outputPath.c_str());
+        return 1;
+    }
+    double writeMs = static_cast<double>(SDL_GetPerformanceCounter() - startCounter) * 1000.0
+                   / static_cast<double>(SDL_GetPerformanceFrequency());
+    printf("%s: %d entries (%d shared, %d compressed), %.2f MB -> %.2f MB (%.1f%%), %.1f ms\n",
+           outputPath.c_str(), stats.entryCount, stats.sharedCount, stats.compressedCount,
+           stats.sourceBytes / (1024.0 * 1024.0), stats.packBytes / (1024.0 * 1024.0),
+           stats.sourceBytes > 0 ? 100.0 * stats.packBytes / stats.sourceBytes : 0.0, writeMs);
+
+    // 検証（開き直して全エントリの内容のハッシュを確認）
+    if (verify)
+    {
+        AssetPack pack;
+        if (!pack.Open(outputPath))
+        {
+            printf("failed open pack: %s\n", outputPath.c_str());
+            return 1;
+        }
+        int failedCount = 0;
+        for (int i = 0; i < pack.GetEntryCount(); i++)
+        {
+            if (pack.Verify(i)) continue;
+            printf("verify failed: %s\n", pack.GetPath(i));
+            failedCount++;
+        }
+        printf("verify: %d/%d ok\n", pack.GetEntryCount() - failedCount, pack.GetEntryCount());
+        if (failedCount > 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,389 @@
+#include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+#include "../Game.h"
+#include "../Actors/Actor.h"
+#include "../Actors/Saikoro.h"
+#include "../Components/SpriteComponent.h"
+#include "../Commons/Renderer.h"
+#include "../Commons/Profiler.h"
+#include "../Commons/GpuProfiler.h"
+#include "../Commons/FrameGraph.h"
+#include "../Commons/SceneGraph.h"
+#include "../Commons/SceneFile.h"
+#include "../Commons/Texture.h"
+
+// ベンチマーク
+// *パラメータで指定したシーン（サイコロN個、スプライトM個、シェーダの種類、生成・破棄の頻度）を作成し、
+//  ウィンドウを表示せずに固定フレーム数を描画してフレーム時間の分布、描画数、メモリをJSONで出力する
+// *乱数の種を固定するため、同じ引数なら同じシーン、同じ生成・破棄の順序になる
+// *--attach-depthではサイコロをD個ずつ親子に繋ぎ、シーングラフの階層の深さによる更新時間を比較できる
+// *--save-sceneで作成したシーンを保存し、--load-sceneでは作成せずに読み込む（読込時間を出力する）
+// *--max-で始まる引数は回帰の閾値で、超えたら失敗で終了する（ctestから閾値付きで実行する）
+// 使い方: Benchmark [--dice N] [--sprites M] [--shader basic|sprite|lambert|phong|mixed] [--churn R]
+//                   [--frames F] [--warmup W] [--seed S] [--deferred] [--dynamic-resolution]
+//                   [--gpu-culling] [--validate-culling] [--attach-depth D] [--max-p99-ms T]
+//                   [--max-draw-calls N] [--max-memory-mb M] [--save-scene file.scene] [--load-scene file.scene] [--out result.json]
+namespace
+{
+    // シーンのパラメータ
+    struct Options
+    {
+        int diceCount = 256;      // サイコロの数
+        int spriteCount = 64;     // スプライトの数
+        std::string shader = "mixed"; // サイコロのシェーダ（mixedは4種類から乱数で選ぶ）
+        float churnRate = 0.0f;   // 1フレームに作り直すサイコロの数（小数分は次フレームに繰り越す）
+        int frameCount = 600;     // 計測するフレーム数
+        int warmupCount = 60;     // 計測前に捨てるフレーム数（シェーダのコンパイル、テクスチャの読込など）
+        unsigned int seed = 1;    // 乱数の種
+        bool isDeferred = false;  // ディファード描画で計測するか？
+        bool isDynamicResolution = false; // 動的解像度を有効にするか？（結果が時間に依存するため既定は無効）
+        bool isGpuCulling = false; // GPUカリングで計測するか？
+        bool isValidateCulling = false; // GPUカリングの結果をCPUの参照実装と比較するか？（不一致なら失敗で終了）
+        int attachDepth = 1;      // 親子に繋ぐサイコロの数（1なら全て親無し）
+        float maxP99Ms = 0.0f;    // 99パーセンタイルの上限（超えたら失敗で終了、0で判定しない）
+        float maxDrawCalls = 0.0f; // 1フレームの平均描画数の上限（0で判定しない）
+        float maxMemoryMB = 0.0f; // 最大の常駐メモリの上限（0で判定しない）
+        std::string saveScenePath; // 作成したシーンの保存先（空なら保存しない）
+        std::string loadScenePath; // 読み込むシーン（空ならパラメータから作成、読み込んだシーンは生成・破棄しない）
+        std::string outputPath;   // 結果の出力先（空なら標準出力）
+    };
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--dice" && hasValue) options.diceCount = atoi(argv[++i]);
+            else if (arg == "--sprites" && hasValue) options.spriteCount = atoi(argv[++i]);
+            else if (arg == "--shader" && hasValue) options.shader = argv[++i];
+            else if (arg == "--churn" && hasValue) options.churnRate = static_cast<float>(atof(argv[++i]));
+            else if (arg == "--frames" && hasValue) options.frameCount = atoi(argv[++i]);
+            else if (arg == "--warmup" && hasValue) options.warmupCount = atoi(argv[++i]);
+            else if (arg == "--seed" && hasValue) options.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--attach-depth" && hasValue) options.attachDepth = atoi(argv[++i]);
+            else if (arg == "--max-p99-ms" && hasValue) options.maxP99Ms = static_cast<float>(atof(argv[++i]));
+            else if (arg == "--max-draw-calls" && hasValue) options.maxDrawCalls = static_cast<float>(atof(argv[++i]));
+            else if (arg == "--max-memory-mb" && hasValue) options.maxMemoryMB = static_cast<float>(atof(argv[++i]));
+            else if (arg == "--save-scene" && hasValue) options.saveScenePath = argv[++i];
+            else if (arg == "--load-scene" && hasValue) options.loadScenePath = argv[++i];
+            else if (arg == "--out" && hasValue) options.outputPath = argv[++i];
+            else if (arg == "--deferred") options.isDeferred = true;
+            else if (arg == "--dynamic-resolution") options.isDynamicResolution = true;
+            else if (arg == "--gpu-culling") options.isGpuCulling = true;
+            else if (arg == "--validate-culling") options.isValidateCulling = true;
+            else
+            {
+                printf("unknown option: %s\n", arg.c_str());
+                return false;
+            }
+        }
+        return options.frameCount > 0 && options.diceCount >= 0 && options.spriteCount >= 0 && options.attachDepth >= 1;
+    }
+
+    // シェーダの種類（名前から）
+    bool GetShaderType(const std::string& name, Shader::ShaderType& type)
+    {
+        const char* names[] = { "basic", "sprite", "lambert", "phong" };
+        for (int i = 0; i < 4; i++)
+        {
+            if (name == names[i])
+            {
+                type = static_cast<Shader::ShaderType>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // シーンの作成、生成・破棄
+    class BenchmarkScene
+    {
+    public:
+        BenchmarkScene(Game* game, const Options& options)
+        :mGame(game)
+        ,mOptions(options)
+        ,mChurnCarry(0.0f)
+        ,mSpawnCount(0)
+        ,mDestroyCount(0)
+        {}
+
+        void Create()
+        {
+            for (int i = 0; i < mOptions.diceCount; i++)
+            {
+                mDice.emplace_back(SpawnDice());
+                // 直前のサイコロの子にする（親の上に少し小さく載せる）
+                if (i % mOptions.attachDepth != 0)
+                {
+                    Actor* dice = mDice.back();
+                    dice->SetParent(mDice[i - 1]);
+                    dice->SetPosition(Vector3(0.0f, 1.5f, 0.0f));
+                    dice->SetScale(Vector3(0.8f, 0.8f, 0.8f));
+                }
+            }
+            ResourceId texture = mGame->GetRenderer()->InternTexture(mGame->GetAssetsPath() + "msg_start.png");
+            for (int i = 0; i < mOptions.spriteCount; i++)
+            {
+                // スプライトは画面座標（中心が原点）
+                auto* actor = new Actor(mGame);
+                actor->SetPosition(Vector3(Math::GetRand(-Game::ScreenWidth * 0.5f, Game::ScreenWidth * 0.5f),
+                                           Math::GetRand(-Game::ScreenHeight * 0.5f, Game::ScreenHeight * 0.5f), 0.0f));
+                float scale = Math::GetRand(0.1f, 0.3f);
+                actor->SetScale(Vector3(scale, scale, 0.0f));
+                auto* sprite = new SpriteComponent(actor);
+                sprite->SetTexture(texture);
+            }
+        }
+
+        // 今フレームの生成・破棄（破棄したアクタはゲームの更新で削除される）
+        void Churn()
+        {
+            mChurnCarry += mOptions.churnRate;
+            while (mChurnCarry >= 1.0f && !mDice.empty())
+            {
+                mChurnCarry -= 1.0f;
+                size_t index = static_cast<size_t>(Math::GetRand(0.0f, static_cast<float>(mDice.size())));
+                index = std::min(index, mDice.size() - 1);
+                // 子は作り直したサイコロに付け替え、階層の形を保つ
+                Actor* dead = mDice[index];
+                Actor* dice = SpawnDice();
+                std::vector<Actor*> children = dead->GetChildren();
+                for (auto child : children) child->SetParent(dice);
+                if (dead->GetParent())
+                {
+                    dice->SetParent(dead->GetParent());
+                    dice->SetPosition(dead->GetPosition());
+                    dice->SetScale(dead->GetScale());
+                }
+                dead->SetState(Actor::EDead);
+                mDice[index] = dice;
+                mDestroyCount++;
+            }
+        }
+
+    private:
+        Actor* SpawnDice()
+        {
+            Shader::ShaderType type = Shader::ShaderType::BASIC;
+            if (!GetShaderType(mOptions.shader, type))
+            {
+                type = static_cast<Shader::ShaderType>(static_cast<int>(Math::GetRand(0.0f, 4.0f)) % 4);
+            }
+            // カメラ（z = -700、+z向き）の視錐台に収まる範囲
+            auto* dice = new Saikoro(mGame, type);
+            dice->SetPosition(Vector3(Math::GetRand(-400.0f, 400.0f), Math::GetRand(-300.0f, 300.0f),
+                                      Math::GetRand(-200.0f, 800.0f)));
+            float scale = Math::GetRand(20.0f, 50.0f);
+            dice->SetScale(Vector3(scale, scale, scale));
+            dice->SetRotationX(Math::GetRand(0.0f, Math::Pi * 2.0f));
+            mSpawnCount++;
+            return dice;
+        }
+
+        Game* mGame;
+        const Options& mOptions;
+        std::vector<Actor*> mDice; // 生きているサイコロ
+        float mChurnCarry;         // 繰り越した生成・破棄の数
+        int mSpawnCount;
+        int mDestroyCount;
+
+    public:
+        int GetSpawnCount() const { return mSpawnCount; }
+        int GetDestroyCount() const { return mDestroyCount; }
+    };
+
+    // パーセンタイル（ソート済、最近傍）
+    double Percentile(const std::vector<double>& sorted, double percent)
+    {
+        if (sorted.empty()) return 0.0;
+        size_t index = static_cast<size_t>(percent / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    double Mean(const std::vector<double>& values)
+    {
+        if (values.empty()) return 0.0;
+        double total = 0.0;
+        for (double value : values) total += value;
+        return total / values.size();
+    }
+
+    // プロセスの最大常駐メモリ（取得できない環境では0）
+    long long GetPeakResidentBytes()
+    {
+#if defined(_WIN32)
+        return 0;
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+        return static_cast<long long>(usage.ru_maxrss);        // バイト
+#else
+        return static_cast<long long>(usage.ru_maxrss) * 1024; // キロバイト
+#endif
+#endif
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        printf("usage: Benchmark [--dice N] [--sprites M] [--shader basic|sprite|lambert|phong|mixed] [--churn R]\n"
+               "                 [--frames F] [--warmup W] [--seed S] [--deferred] [--dynamic-resolution]\n"
+               "                 [--gpu-culling] [--validate-culling] [--attach-depth D] [--max-p99-ms T]\n"
+               "                 [--max-draw-calls N] [--max-memory-mb M] [--save-scene file.scene] [--load-scene file.scene] [--out result.json]\n");
+        return 1;
+    }
+
+    Game game;
+    if (!game.Initialize(true))
+    {
+        printf("failed initialize game.\n");
+        game.Shutdown();
+        return 1;
+    }
+    Renderer* renderer = game.GetRenderer();
+    renderer->SetRenderPath(options.isDeferred ? Renderer::DEFERRED : Renderer::FORWARD);
+    renderer->SetDynamicResolution(options.isDynamicResolution);
+    renderer->SetGpuCulling(options.isGpuCulling || options.isValidateCulling);
+    renderer->SetGpuCullingValidation(options.isValidateCulling);
+
+    // シーン作成
+    Math::SetRandSeed(options.seed);
+    BenchmarkScene scene(&game, options);
+    SceneFile sceneFile;
+    if (!options.loadScenePath.empty())
+    {
+        if (!sceneFile.Load(options.loadScenePath, game.GetFileSystem()) || !sceneFile.Instantiate(&game))
+        {
+            printf("failed load scene: %s\n", options.loadScenePath.c_str());
+            game.Shutdown();
+            return 1;
+        }
+    }
+    else
+    {
+        scene.Create();
+    }
+    if (!options.saveScenePath.empty())
+    {
+        game.SaveScene(options.saveScenePath);
+    }
+
+    // 固定の経過時間で更新し、1フレームの処理時間（更新、描画、スワップ）を計測する
+    const float deltaTime = 1.0f / 60.0f;
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    std::vector<double> frameMs;
+    std::vector<double> gpuMs;
+    std::vector<double> drawCalls;
+    std::vector<double> sceneUpdated;
+    std::vector<double> sceneMs;
+    frameMs.reserve(options.frameCount);
+    gpuMs.reserve(options.frameCount);
+    drawCalls.reserve(options.frameCount);
+    for (int frame = 0; frame < options.warmupCount + options.frameCount; frame++)
+    {
+        scene.Churn();
+        Uint64 start = SDL_GetPerformanceCounter();
+        game.RunFrame(deltaTime);
+        Uint64 end = SDL_GetPerformanceCounter();
+        if (frame < options.warmupCount) continue;
+
+        frameMs.emplace_back((end - start) * 1000.0 / frequency);
+        // GPU時間は数フレーム遅れて読まれた値（読めていない間は0）
+        gpuMs.emplace_back(renderer->GetGpuProfiler()->GetLastFrameMs());
+        const Profiler* profiler = renderer->GetProfiler();
+        drawCalls.emplace_back(static_cast<double>(profiler->GetCounter("MeshDraws") + profiler->GetCounter("SpriteDraws")));
+        const SceneGraph::Stats& sceneStats = game.GetSceneGraph()->GetStats();
+        sceneUpdated.emplace_back(sceneStats.updatedCount);
+        sceneMs.emplace_back(sceneStats.updateMs);
+    }
+
+    // 集計
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<double> sortedGpu = gpuMs;
+    std::sort(sortedGpu.begin(), sortedGpu.end());
+    const double p99 = Percentile(sorted, 99.0);
+    const double drawCallsPerFrame = Mean(drawCalls);
+    const long long peakResidentBytes = GetPeakResidentBytes();
+    auto texture = renderer->GetTextureCache()->GetStats();
+    auto mesh = renderer->GetMeshCache()->GetStats();
+
+    FILE* file = options.outputPath.empty() ? stdout : fopen(options.outputPath.c_str(), "w");
+    if (!file)
+    {
+        printf("failed write result: %s\n", options.outputPath.c_str());
+        game.Shutdown();
+        return 1;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"scene\": {\"dice\": %d, \"sprites\": %d, \"shader\": \"%s\", \"churn\": %.3f, \"seed\": %u, "
+                  "\"renderPath\": \"%s\", \"dynamicResolution\": %s},\n",
+            options.diceCount, options.spriteCount, options.shader.c_str(), options.churnRate, options.seed,
+            Renderer::GetRenderPathName(renderer->GetRenderPath()), options.isDynamicResolution ? "true" : "false");
+    fprintf(file, "  \"frames\": %d,\n", static_cast<int>(frameMs.size()));
+    fprintf(file, "  \"warmupFrames\": %d,\n", options.warmupCount);
+    fprintf(file, "  \"frameMs\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f, "
+                  "\"min\": %.4f, \"max\": %.4f},\n",
+            Mean(frameMs), Percentile(sorted, 50.0), Percentile(sorted, 90.0), Percentile(sorted, 95.0), p99,
+            sorted.front(), sorted.back());
+    fprintf(file, "  \"gpuMs\": {\"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f},\n",
+            Mean(gpuMs), Percentile(sortedGpu, 50.0), Percentile(sortedGpu, 99.0));
+    fprintf(file, "  \"drawCallsPerFrame\": %.1f,\n", drawCallsPerFrame);
+    fprintf(file, "  \"actors\": {\"spawned\": %d, \"destroyed\": %d},\n", scene.GetSpawnCount(), scene.GetDestroyCount());
+    const SceneGraph::Stats& sceneStats = game.GetSceneGraph()->GetStats();
+    fprintf(file, "  \"sceneGraph\": {\"attachDepth\": %d, \"nodes\": %d, \"levels\": %d, \"updatedPerFrame\": %.1f, "
+                  "\"updateMs\": %.4f},\n",
+            options.attachDepth, sceneStats.nodeCount, sceneStats.levelCount, Mean(sceneUpdated), Mean(sceneMs));
+    const SceneFile::Stats& fileStats = sceneFile.GetStats();
+    fprintf(file, "  \"sceneFile\": {\"loaded\": %s, \"actors\": %d, \"bytes\": %lld, \"readMs\": %.4f, "
+                  "\"prefetchMs\": %.4f, \"createMs\": %.4f},\n",
+            options.loadScenePath.empty() ? "false" : "true", sceneFile.GetActorCount(),
+            static_cast<long long>(fileStats.bytes), fileStats.readMs, fileStats.prefetchMs, fileStats.createMs);
+    fprintf(file, "  \"memory\": {\"peakResidentBytes\": %lld, \"textureCacheBytes\": %lld, \"meshCacheBytes\": %lld, "
+                  "\"transientTextureBytes\": %lld},\n",
+            peakResidentBytes, static_cast<long long>(texture.bytes), static_cast<long long>(mesh.bytes),
+            static_cast<long long>(renderer->GetFrameGraph()->GetStats().physicalBytes));
+    fprintf(file, "  \"gpuCulling\": {\"enabled\": %s, \"mismatches\": %d}\n",
+            renderer->IsGpuCulling() ? "true" : "false", renderer->GetGpuCullingMismatchCount());
+    fprintf(file, "}\n");
+    if (file != stdout) fclose(file);
+
+    const int mismatchCount = renderer->GetGpuCullingMismatchCount();
+    game.Shutdown();
+
+    // 回帰の判定
+    if (options.maxP99Ms > 0.0f && p99 > options.maxP99Ms)
+    {
+        printf("regression: p99 %.3f ms exceeds %.3f ms\n", p99, options.maxP99Ms);
+        return 2;
+    }
+    if (mismatchCount > 0)
+    {
+        printf("regression: gpu culling mismatched %d objects\n", mismatchCount);
+        return 3;
+    }
+    if (options.maxDrawCalls > 0.0f && drawCallsPerFrame > options.maxDrawCalls)
+    {
+        printf("regression: %.1f draw calls per frame exceeds %.1f\n", drawCallsPerFrame, options.maxDrawCalls);
+        return 4;
+    }
+    const double peakResidentMB = peakResidentBytes / (1024.0 * 1024.0);
+    if (options.maxMemoryMB > 0.0f && peakResidentMB > options.maxMemoryMB)
+    {
+        printf("regression: peak resident %.1f MB exceeds %.1f MB\n", peakResidentMB, options.maxMemoryMB);
+        return 5;
+    }
+    return 0;
+}
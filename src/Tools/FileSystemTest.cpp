@@ -0,0 +1,92 @@
+#include <SDL.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../Commons/AssetPack.h"
+#include "../Commons/FileSystem.h"
+
+// ファイルシステムのテスト（ctestで実行、失敗があれば1を返す）
+// *パックをマウントしたディレクトリの個別のファイルを編集すると、新しい内容が読めること
+//  （シェーダのパックをマウントしたままホットリロードできるように）
+namespace
+{
+    int failedCount = 0;
+
+    void Check(bool condition, const char* name)
+    {
+        printf("%s: %s\n", condition ? "ok" : "FAILED", name);
+        if (!condition) failedCount++;
+    }
+
+    bool WriteText(const std::string& filePath, const std::string& text)
+    {
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        file << text;
+        return static_cast<bool>(file);
+    }
+
+    std::string ReadText(const FileSystem& fileSystem, const std::string& path)
+    {
+        std::string text;
+        if (!fileSystem.ReadText(path, text)) return "(read failed)";
+        return text;
+    }
+}
+
+int main(int, char*[])
+{
+    // 作業ディレクトリに個別のファイルを作ってパックにまとめる
+    const std::string rootPath = "FileSystemTest/";
+    const std::string mountPoint = rootPath + "Shaders/";
+    const std::string packPath = rootPath + "Shaders.pak";
+    const std::string filePath = mountPoint + "Test.frag";
+    FileSystem::MakeDirectory(rootPath);
+    FileSystem::MakeDirectory(mountPoint);
+    if (!WriteText(filePath, "packed"))
+    {
+        printf("failed write file: %s\n", filePath.c_str());
+        return 1;
+    }
+    std::vector<AssetPack::Source> sources = { { "Test.frag", filePath } };
+    if (!AssetPack::Write(packPath, sources, true, AssetPack::DEFAULT_ALIGNMENT, nullptr))
+    {
+        printf("failed write pack: %s\n", packPath.c_str());
+        return 1;
+    }
+
+    FileSystem fileSystem;
+    fileSystem.SetLooseOverride(true);
+    if (!fileSystem.Mount(packPath, mountPoint))
+    {
+        printf("failed mount pack: %s\n", packPath.c_str());
+        return 1;
+    }
+    Check(fileSystem.IsPacked(filePath), "unmodified file is read from pack");
+    Check(ReadText(fileSystem, filePath) == "packed", "pack contents");
+
+    // パックより新しい更新時刻になるまで書き直す（秒単位の環境もあるため）
+    uint64_t size = 0;
+    int64_t packTime = 0;
+    int64_t fileTime = 0;
+    FileSystem::GetFileStatus(packPath, size, packTime);
+    for (int i = 0; i < 300 && fileTime <= packTime; i++)
+    {
+        SDL_Delay(10);
+        WriteText(filePath, "edited");
+        FileSystem::GetFileStatus(filePath, size, fileTime);
+    }
+    Check(fileTime > packTime, "loose file is newer than pack");
+    Check(!fileSystem.IsPacked(filePath), "edited file is not read from pack");
+    Check(ReadText(fileSystem, filePath) == "edited", "edited contents");
+
+    // 無効にすればパックを優先する
+    fileSystem.SetLooseOverride(false);
+    Check(ReadText(fileSystem, filePath) == "packed", "pack wins when override is disabled");
+
+    fileSystem.UnmountAll();
+    std::remove(packPath.c_str());
+    std::remove(filePath.c_str());
+    printf("%s\n", failedCount == 0 ? "all passed" : "some checks failed");
+    return failedCount == 0 ? 0 : 1;
+}
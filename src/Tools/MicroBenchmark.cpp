@@ -0,0 +1,566 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../Commons/Animation.h"
+#include "../Commons/Lz4Codec.h"
+#include "../Commons/Math.h"
+#include "../Commons/MeshImport.h"
+#include "../Commons/ResourceCache.h"
+
+// マイクロベンチマーク
+// *行列、クォータニオンの計算、メッシュ読込の頂点分割、リソースキャッシュの検索、
+//  アニメーションのポーズ評価、アセットパックのLZ4の圧縮と展開を個別に計測する
+// *各項目は1回の処理時間がmin-time秒を超えるまで反復回数を倍にして決め、repetitions回計測した中央値を出す
+// *--outで結果をJSONに書き出し、--baselineで以前の結果（別のコミットなど）と比較する
+// *メッシュはFBX SDKを使わず合成した格子（N x N）を使う
+// 使い方: MicroBenchmark [--filter NAME] [--min-time SEC] [--repetitions N] [--mesh-grid N]
+//                        [--out result.json] [--baseline base.json]
+namespace
+{
+    // 最適化で計測対象の計算が消されないようにする
+    template <class T>
+    void DoNotOptimize(const T& value)
+    {
+#if defined(_MSC_VER)
+        static volatile const void* sink;
+        sink = &value;
+#else
+        asm volatile("" : : "r"(&value) : "memory");
+#endif
+    }
+
+    // 計測の状態（ループ中のみ時間を計る）
+    // *for (; state.KeepRunning();) の形で、ループ前の準備は計測に含めない
+    class State
+    {
+    public:
+        State(long long iterations, int arg)
+        :mIterations(iterations)
+        ,mCount(0)
+        ,mArg(arg)
+        ,mElapsedNs(0.0)
+        {}
+
+        bool KeepRunning()
+        {
+            if (mCount == 0) mStart = std::chrono::steady_clock::now();
+            if (mCount++ < mIterations) return true;
+            mElapsedNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - mStart).count());
+            return false;
+        }
+
+    private:
+        long long mIterations;
+        long long mCount;
+        int mArg;
+        double mElapsedNs;
+        std::chrono::steady_clock::time_point mStart;
+
+    public:
+        int GetArg() const { return mArg; }
+        long long GetIterations() const { return mIterations; }
+        double GetElapsedNs() const { return mElapsedNs; }
+    };
+
+    typedef std::function<void(State&)> BenchmarkFunc;
+
+    // 計測項目（argsごとに別の項目として計測する、空なら引数無し）
+    struct Benchmark
+    {
+        std::string name;
+        BenchmarkFunc func;
+        std::vector<int> args;
+    };
+
+    // 計測結果
+    struct Result
+    {
+        std::string name;
+        long long iterations;
+        double nsPerOp;    // 中央値
+        double minNsPerOp; // 最小
+    };
+
+    // 乱数の入力（種を固定してコミット間で同じ入力にする）
+    Matrix4 RandomMatrix()
+    {
+        float temp[4][4];
+        for (int r = 0; r < 4; r++)
+        {
+            for (int c = 0; c < 4; c++) temp[r][c] = Math::GetRand(-1.0f, 1.0f);
+        }
+        return Matrix4(temp);
+    }
+    Quaternion RandomQuaternion()
+    {
+        Vector3 axis = Vector3::Normalize(Vector3(Math::GetRand(-1.0f, 1.0f), Math::GetRand(-1.0f, 1.0f),
+                                                  Math::GetRand(-1.0f, 1.0f)));
+        return Quaternion(axis, Math::GetRand(0.0f, Math::Pi * 2.0f));
+    }
+    Vector3 RandomVector()
+    {
+        return Vector3(Math::GetRand(-100.0f, 100.0f), Math::GetRand(-100.0f, 100.0f), Math::GetRand(-100.0f, 100.0f));
+    }
+
+    // 入力の個数（キャッシュに収まる数で使い回す）
+    const int INPUT_COUNT = 256;
+
+    void BM_Matrix4Multiply(State& state)
+    {
+        std::vector<Matrix4> a, b;
+        for (int i = 0; i < INPUT_COUNT; i++)
+        {
+            a.emplace_back(RandomMatrix());
+            b.emplace_back(RandomMatrix());
+        }
+        int i = 0;
+        while (state.KeepRunning())
+        {
+            Matrix4 result = a[i] * b[i];
+            DoNotOptimize(result);
+            i = (i + 1) % INPUT_COUNT;
+        }
+    }
+
+    void BM_Matrix4CreateQuaternion(State& state)
+    {
+        std::vector<Quaternion> q;
+        for (int i = 0; i < INPUT_COUNT; i++) q.emplace_back(RandomQuaternion());
+        int i = 0;
+        while (state.KeepRunning())
+        {
+            Matrix4 result = Matrix4::CreateQuaternion(q[i]);
+            DoNotOptimize(result);
+            i = (i + 1) % INPUT_COUNT;
+        }
+    }
+
+    void BM_Matrix4CreateLookAt(State& state)
+    {
+        std::vector<Vector3> eye, target;
+        for (int i = 0; i < INPUT_COUNT; i++)
+        {
+            eye.emplace_back(RandomVector());
+            target.emplace_back(RandomVector());
+        }
+        int i = 0;
+        while (state.KeepRunning())
+        {
+            Matrix4 result = Matrix4::CreateLookAt(eye[i], target[i], Math::VEC3_UNIT_Y);
+            DoNotOptimize(result);
+            i = (i + 1) % INPUT_COUNT;
+        }
+    }
+
+    void BM_QuaternionRotateVec(State& state)
+    {
+        std::vector<Quaternion> q;
+        std::vector<Vector3> v;
+        for (int i = 0; i < INPUT_COUNT; i++)
+        {
+            q.emplace_back(RandomQuaternion());
+            v.emplace_back(RandomVector());
+        }
+        int i = 0;
+        while (state.KeepRunning())
+        {
+            Vector3 result = Quaternion::RotateVec(v[i], q[i]);
+            DoNotOptimize(result);
+            i = (i + 1) % INPUT_COUNT;
+        }
+    }
+
+    // 合成メッシュ（N x Nの格子、1マス2三角形）
+    // *isFacetedでは高さを乱数にして面ごとの法線を付ける（角の位置を共有する頂点が面の数だけ分割される）
+    // *そうでなければ平面で法線、UV座標とも連続（分割されない）
+    void CreateGridMesh(int gridSize, bool isFaceted, std::vector<float>& controlPoints,
+                        std::vector<MeshImport::PolygonVertex>& polygonVertices)
+    {
+        const int pointCount = gridSize + 1;
+        controlPoints.clear();
+        for (int y = 0; y < pointCount; y++)
+        {
+            for (int x = 0; x < pointCount; x++)
+            {
+                controlPoints.push_back(static_cast<float>(x));
+                controlPoints.push_back(static_cast<float>(y));
+                controlPoints.push_back(isFaceted ? Math::GetRand(0.0f, 1.0f) : 0.0f);
+            }
+        }
+        auto addTriangle = [&](int a, int b, int c) {
+            Vector3 normal = Math::VEC3_UNIT_Z;
+            if (isFaceted)
+            {
+                Vector3 pa(controlPoints[a*3], controlPoints[a*3+1], controlPoints[a*3+2]);
+                Vector3 pb(controlPoints[b*3], controlPoints[b*3+1], controlPoints[b*3+2]);
+                Vector3 pc(controlPoints[c*3], controlPoints[c*3+1], controlPoints[c*3+2]);
+                normal = Vector3::Normalize(Vector3::Cross(pb - pa, pc - pa));
+            }
+            for (int index : { a, b, c })
+            {
+                MeshImport::PolygonVertex vertex;
+                vertex.controlPoint = index;
+                vertex.normal[0] = normal.x;
+                vertex.normal[1] = normal.y;
+                vertex.normal[2] = normal.z;
+                vertex.uv[0] = controlPoints[index*3] / gridSize;
+                vertex.uv[1] = controlPoints[index*3+1] / gridSize;
+                polygonVertices.push_back(vertex);
+            }
+        };
+        polygonVertices.clear();
+        for (int y = 0; y < gridSize; y++)
+        {
+            for (int x = 0; x < gridSize; x++)
+            {
+                int i = y * pointCount + x;
+                addTriangle(i, i + 1, i + pointCount + 1);
+                addTriangle(i, i + pointCount + 1, i + pointCount);
+            }
+        }
+    }
+
+    void SplitVerticesBenchmark(State& state, bool isFaceted)
+    {
+        std::vector<float> controlPoints;
+        std::vector<MeshImport::PolygonVertex> polygonVertices;
+        CreateGridMesh(state.GetArg(), isFaceted, controlPoints, polygonVertices);
+        std::vector<std::vector<float>> vertexList;
+        std::vector<int> indexList;
+        while (state.KeepRunning())
+        {
+            MeshImport::SplitVertices(controlPoints, polygonVertices, vertexList, indexList);
+            DoNotOptimize(indexList.data());
+        }
+    }
+    void BM_MeshSplitSmooth(State& state) { SplitVerticesBenchmark(state, false); }
+    void BM_MeshSplitFaceted(State& state) { SplitVerticesBenchmark(state, true); }
+
+    // リソースキャッシュの検索（Renderer::GetTextureはResourceCache<Texture>::Getをそのまま呼ぶ）
+    // *読込済のリソースの取得のみを計測する（GLのテクスチャは作らない）
+    struct DummyResource
+    {
+        size_t bytes;
+    };
+    ResourceCache<DummyResource>* CreateCache(int count, std::vector<std::string>& paths)
+    {
+        auto* cache = new ResourceCache<DummyResource>(
+            [](const std::string&) { return new DummyResource{ 1024 }; },
+            [](DummyResource* resource) { delete resource; },
+            [](const DummyResource* resource) { return resource->bytes; },
+            static_cast<size_t>(-1));
+        paths.clear();
+        for (int i = 0; i < count; i++)
+        {
+            paths.emplace_back("../Assets/Textures/texture_" + std::to_string(i) + ".png");
+            cache->Get(paths.back());
+        }
+        return cache;
+    }
+
+    void BM_ResourceCacheGetPath(State& state)
+    {
+        std::vector<std::string> paths;
+        auto* cache = CreateCache(state.GetArg(), paths);
+        size_t i = 0;
+        while (state.KeepRunning())
+        {
+            DoNotOptimize(cache->Get(paths[i]));
+            i = (i + 1) % paths.size();
+        }
+        delete cache;
+    }
+
+    void BM_ResourceCacheGetId(State& state)
+    {
+        std::vector<std::string> paths;
+        auto* cache = CreateCache(state.GetArg(), paths);
+        std::vector<ResourceId> ids;
+        for (auto& path : paths) ids.emplace_back(cache->Intern(path));
+        size_t i = 0;
+        while (state.KeepRunning())
+        {
+            DoNotOptimize(cache->Get(ids[i]));
+            i = (i + 1) % ids.size();
+        }
+        delete cache;
+    }
+
+    // 合成スケルトン（64関節、各関節の親はそれより前の関節）と2秒のクリップ（30fps）
+    const int SKELETON_JOINTS = 64;
+    void CreateSkeleton(Skeleton& skeleton, AnimationClip& clip)
+    {
+        Matrix4 identity = Matrix4::CreateScale(1.0f, 1.0f, 1.0f);
+        for (int joint = 0; joint < SKELETON_JOINTS; joint++)
+        {
+            int parent = joint == 0 ? -1 : static_cast<int>(Math::GetRand(0.0f, static_cast<float>(joint) - 0.01f));
+            skeleton.AddJoint("joint" + std::to_string(joint), parent, identity);
+        }
+        const int frameCount = 61;
+        std::vector<AnimationClip::Key> keys(frameCount * SKELETON_JOINTS);
+        for (auto& key : keys)
+        {
+            key.rotation = RandomQuaternion();
+            key.translation = 0.1f * RandomVector();
+            key.scale = Vector3(1.0f, 1.0f, 1.0f);
+        }
+        clip.Build("bench", SKELETON_JOINTS, frameCount, 30.0f, keys);
+    }
+
+    // キャラクター数（arg）分のポーズの評価とパレットの計算（1スレッド分）
+    // *Skinningは同じ処理をキャラクターごとにジョブシステムで並列に行う
+    void BM_AnimationEvaluate(State& state)
+    {
+        Skeleton skeleton;
+        AnimationClip clip;
+        CreateSkeleton(skeleton, clip);
+        const int characterCount = state.GetArg();
+        std::vector<AnimationPose> poses(characterCount);
+        std::vector<Matrix4> models;
+        std::vector<float> palette(characterCount * SKELETON_JOINTS * Skeleton::PALETTE_FLOATS);
+        float time = 0.0f;
+        while (state.KeepRunning())
+        {
+            for (int i = 0; i < characterCount; i++)
+            {
+                // キャラクターごとに再生時刻をずらす
+                clip.Sample(time + i * 0.037f, true, poses[i]);
+                skeleton.ComputePalette(poses[i], models, &palette[i * SKELETON_JOINTS * Skeleton::PALETTE_FLOATS]);
+            }
+            DoNotOptimize(palette.data());
+            time += 1.0f / 60.0f;
+        }
+    }
+
+    // クリップのサンプリングのみ（量子化したキーの補間）
+    void BM_AnimationSample(State& state)
+    {
+        Skeleton skeleton;
+        AnimationClip clip;
+        CreateSkeleton(skeleton, clip);
+        AnimationPose pose;
+        float time = 0.0f;
+        while (state.KeepRunning())
+        {
+            clip.Sample(time, true, pose);
+            DoNotOptimize(pose.rotation[0].data());
+            time += 1.0f / 60.0f;
+        }
+    }
+
+    // アセットパックのブロック（argはKB）
+    // *頂点データに近い、隣同士で値の近いfloatの並びに同じ区間の繰り返しを混ぜる
+    void CreateBlockData(int kilobytes, std::vector<unsigned char>& outData)
+    {
+        std::vector<float> values(kilobytes * 1024 / sizeof(float));
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            values[i] = (i % 64 < 16 && i >= 64)
+                      ? values[i - 64]
+                      : static_cast<float>(static_cast<int>(i % 1024) / 8) * 0.125f + Math::GetRand(0.0f, 1.0f);
+        }
+        outData.resize(values.size() * sizeof(float));
+        std::memcpy(outData.data(), values.data(), outData.size());
+    }
+
+    void BM_Lz4Compress(State& state)
+    {
+        std::vector<unsigned char> data;
+        CreateBlockData(state.GetArg(), data);
+        std::vector<unsigned char> compressed(Lz4Codec::GetMaxCompressedBytes(data.size()));
+        while (state.KeepRunning())
+        {
+            DoNotOptimize(Lz4Codec::Compress(data.data(), data.size(), compressed.data()));
+        }
+    }
+
+    void BM_Lz4Decompress(State& state)
+    {
+        std::vector<unsigned char> data;
+        CreateBlockData(state.GetArg(), data);
+        std::vector<unsigned char> compressed(Lz4Codec::GetMaxCompressedBytes(data.size()));
+        compressed.resize(Lz4Codec::Compress(data.data(), data.size(), compressed.data()));
+        std::vector<unsigned char> decompressed(data.size());
+        while (state.KeepRunning())
+        {
+            DoNotOptimize(Lz4Codec::Decompress(compressed.data(), compressed.size(),
+                                               decompressed.data(), decompressed.size()));
+        }
+    }
+
+    // 1項目の計測
+    Result Run(const std::string& name, const BenchmarkFunc& func, int arg, double minTimeSec, int repetitions)
+    {
+        // 反復回数の決定
+        long long iterations = 1;
+        for (;;)
+        {
+            Math::SetRandSeed(1);
+            State state(iterations, arg);
+            func(state);
+            if (state.GetElapsedNs() >= minTimeSec * 1.0e9 || iterations >= (1LL << 40)) break;
+            // 短すぎる場合は一気に増やす（最大10倍）
+            double scale = state.GetElapsedNs() > 0.0 ? minTimeSec * 1.0e9 * 1.4 / state.GetElapsedNs() : 10.0;
+            iterations = static_cast<long long>(iterations * std::max(2.0, std::min(10.0, scale)));
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < repetitions; i++)
+        {
+            Math::SetRandSeed(1);
+            State state(iterations, arg);
+            func(state);
+            samples.emplace_back(state.GetElapsedNs() / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        result.nsPerOp = samples[samples.size() / 2];
+        result.minNsPerOp = samples.front();
+        return result;
+    }
+
+    bool WriteJson(const std::string& filePath, const std::vector<Result>& results)
+    {
+        FILE* file = fopen(filePath.c_str(), "w");
+        if (!file) return false;
+        fprintf(file, "{\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result& result = results[i];
+            // 比較時に1行ずつ読むため、1項目1行で書く
+            fprintf(file, "    {\"name\": \"%s\", \"iterations\": %lld, \"nsPerOp\": %.4f, \"minNsPerOp\": %.4f}%s\n",
+                    result.name.c_str(), result.iterations, result.nsPerOp, result.minNsPerOp,
+                    i + 1 < results.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+        fclose(file);
+        return true;
+    }
+
+    // WriteJsonで書いた結果の読込（名前 -> ns/op）
+    bool ReadJson(const std::string& filePath, std::vector<Result>& results)
+    {
+        FILE* file = fopen(filePath.c_str(), "r");
+        if (!file) return false;
+        char line[512];
+        while (fgets(line, sizeof(line), file))
+        {
+            const char* name = strstr(line, "\"name\": \"");
+            const char* nsPerOp = strstr(line, "\"nsPerOp\": ");
+            if (!name || !nsPerOp) continue;
+            name += strlen("\"name\": \"");
+            const char* nameEnd = strchr(name, '"');
+            if (!nameEnd) continue;
+            Result result;
+            result.name.assign(name, nameEnd);
+            result.iterations = 0;
+            result.nsPerOp = atof(nsPerOp + strlen("\"nsPerOp\": "));
+            result.minNsPerOp = result.nsPerOp;
+            results.emplace_back(result);
+        }
+        fclose(file);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // 引数解析
+    std::string filter;
+    double minTimeSec = 0.2;
+    int repetitions = 5;
+    int meshGrid = 0;
+    std::string outputPath;
+    std::string baselinePath;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--min-time" && hasValue) minTimeSec = atof(argv[++i]);
+        else if (arg == "--repetitions" && hasValue) repetitions = std::max(1, atoi(argv[++i]));
+        else if (arg == "--mesh-grid" && hasValue) meshGrid = atoi(argv[++i]);
+        else if (arg == "--out" && hasValue) outputPath = argv[++i];
+        else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else
+        {
+            printf("usage: MicroBenchmark [--filter NAME] [--min-time SEC] [--repetitions N] [--mesh-grid N]\n"
+                   "                      [--out result.json] [--baseline base.json]\n");
+            return 1;
+        }
+    }
+
+    // 格子の大きさ（分割する場合は頂点の検索が線形のため小さめ）
+    std::vector<int> smoothGrids = { 16, 64, 256 };
+    std::vector<int> facetedGrids = { 8, 16, 32 };
+    if (meshGrid > 0)
+    {
+        smoothGrids = { meshGrid };
+        facetedGrids = { meshGrid };
+    }
+    const std::vector<Benchmark> benchmarks = {
+        { "Matrix4Multiply", BM_Matrix4Multiply, {} },
+        { "Matrix4CreateQuaternion", BM_Matrix4CreateQuaternion, {} },
+        { "Matrix4CreateLookAt", BM_Matrix4CreateLookAt, {} },
+        { "QuaternionRotateVec", BM_QuaternionRotateVec, {} },
+        { "MeshSplitSmooth", BM_MeshSplitSmooth, smoothGrids },
+        { "MeshSplitFaceted", BM_MeshSplitFaceted, facetedGrids },
+        { "ResourceCacheGetPath", BM_ResourceCacheGetPath, { 64, 4096 } },
+        { "ResourceCacheGetId", BM_ResourceCacheGetId, { 64, 4096 } },
+        { "AnimationSample", BM_AnimationSample, {} },
+        { "AnimationEvaluate", BM_AnimationEvaluate, { 100, 500 } },
+        { "Lz4Compress", BM_Lz4Compress, { 256 } },
+        { "Lz4Decompress", BM_Lz4Decompress, { 256 } },
+    };
+
+    std::vector<Result> baseline;
+    if (!baselinePath.empty() && !ReadJson(baselinePath, baseline))
+    {
+        printf("failed read baseline: %s\n", baselinePath.c_str());
+        return 1;
+    }
+
+    printf("%-32s %14s %12s %12s %10s\n", "benchmark", "iterations", "ns/op", "min ns/op", "baseline");
+    std::vector<Result> results;
+    for (auto& benchmark : benchmarks)
+    {
+        std::vector<int> args = benchmark.args.empty() ? std::vector<int>{ 0 } : benchmark.args;
+        for (int arg : args)
+        {
+            std::string name = benchmark.name;
+            if (!benchmark.args.empty()) name += "/" + std::to_string(arg);
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+            Result result = Run(name, benchmark.func, arg, minTimeSec, repetitions);
+            results.emplace_back(result);
+
+            // 以前の結果との比較（負は速くなった）
+            std::string change = "-";
+            for (auto& base : baseline)
+            {
+                if (base.name != name || base.nsPerOp <= 0.0) continue;
+                char text[32];
+                snprintf(text, sizeof(text), "%+.1f%%", (result.nsPerOp / base.nsPerOp - 1.0) * 100.0);
+                change = text;
+            }
+            printf("%-32s %14lld %12.2f %12.2f %10s\n", name.c_str(), result.iterations, result.nsPerOp,
+                   result.minNsPerOp, change.c_str());
+        }
+    }
+
+    if (!outputPath.empty() && !WriteJson(outputPath, results))
+    {
+        printf("failed write result: %s\n", outputPath.c_str());
+        return 1;
+    }
+    return 0;
+}
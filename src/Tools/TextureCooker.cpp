@@ -0,0 +1,100 @@
+#include <SDL.h>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "../Commons/DDSFile.h"
+#include "../Commons/TextureCodec.h"
+#include "../Commons/TextureCook.h"
+
+// テクスチャ変換ツール
+// *PNG等の画像からミップマップ付きのブロック圧縮DDSを作成する
+// 使い方: TextureCooker <input> [output.dds] [--bc1|--bc3] [--no-mips] [--verify]
+namespace
+{
+    // 元画像と展開後の画像のPSNRを計算（RGBのみ）
+    double ComputePSNR(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b)
+    {
+        double mse = 0.0;
+        int count = 0;
+        for (size_t i = 0; i < a.size(); i += 4)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                double diff = static_cast<double>(a[i + c]) - static_cast<double>(b[i + c]);
+                mse += diff * diff;
+                count++;
+            }
+        }
+        if (count == 0) return 0.0;
+        mse /= count;
+        if (mse <= 0.0) return 99.0;
+        return 10.0 * log10(255.0 * 255.0 / mse);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: TextureCooker <input> [output.dds] [--bc1|--bc3] [--no-mips] [--verify]\n");
+        return 1;
+    }
+
+    // 引数解析
+    std::string inputPath = argv[1];
+    std::string outputPath = DDSFile::GetCookedPath(inputPath);
+    int forceFormat = -1;
+    bool generateMips = true;
+    bool verify = false;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--bc1") forceFormat = TextureCodec::BC1;
+        else if (arg == "--bc3") forceFormat = TextureCodec::BC3;
+        else if (arg == "--no-mips") generateMips = false;
+        else if (arg == "--verify") verify = true;
+        else outputPath = arg;
+    }
+
+    // 画像読込（RGBA8に変換）
+    std::vector<unsigned char> rgba;
+    int width = 0;
+    int height = 0;
+    if (!TextureCook::LoadRGBA(inputPath, rgba, width, height))
+    {
+        printf("failed load image: %s\n", inputPath.c_str());
+        return 1;
+    }
+
+    // ミップマップ生成、圧縮して書き出し
+    DDSFile dds;
+    TextureCook::Cook(rgba, width, height, forceFormat, generateMips, dds);
+    if (!dds.Save(outputPath))
+    {
+        printf("failed write dds: %s\n", outputPath.c_str());
+        return 1;
+    }
+    const TextureCodec::Format format = dds.GetFormat();
+    const auto& mips = dds.GetMips();
+
+    int srcBytes = 0;
+    int dstBytes = 0;
+    for (size_t i = 0; i < mips.size(); i++)
+    {
+        srcBytes += TextureCodec::GetImageBytes(TextureCodec::RGBA8, mips[i].width, mips[i].height);
+        dstBytes += mips[i].data.size();
+    }
+    printf("%s -> %s (%s, %dx%d, %d mips, %d -> %d bytes)\n",
+           inputPath.c_str(), outputPath.c_str(), format == TextureCodec::BC3 ? "BC3" : "BC1",
+           width, height, static_cast<int>(mips.size()), srcBytes, dstBytes);
+
+    // CPUで展開して画質を検証
+    if (verify)
+    {
+        std::vector<unsigned char> decoded;
+        const auto& base = dds.GetMips()[0];
+        TextureCodec::Decompress(dds.GetFormat(), base.data.data(), base.width, base.height, decoded);
+        printf("verify: PSNR %.2f dB\n", ComputePSNR(rgba, decoded));
+    }
+    return 0;
+}